@@ -1619,11 +1619,17 @@ VOID CAutoCamera::FrameMove(FLOAT fElapsedTime)
 		if (!bIgnoreGlobalTerrain)
 		{
 			// for all five point, test
+			float pX[6], pZ[6], pHeights[6];
 			for (int i = 0; i < 6; i++)
 			{
-				float fMinHeight = CGlobals::GetGlobalTerrain()->GetElevation(vecFrustum[i].x, vecFrustum[i].z);
-				if (fShiftHeight < (fMinHeight - vecFrustum[i].y))
-					fShiftHeight = fMinHeight - vecFrustum[i].y;
+				pX[i] = vecFrustum[i].x;
+				pZ[i] = vecFrustum[i].z;
+			}
+			CGlobals::GetGlobalTerrain()->GetElevationBatch(pX, pZ, 6, pHeights);
+			for (int i = 0; i < 6; i++)
+			{
+				if (fShiftHeight < (pHeights[i] - vecFrustum[i].y))
+					fShiftHeight = pHeights[i] - vecFrustum[i].y;
 			}
 			/// ignore camera collision with the terrain object, if the camera is well below the terrain surface.(may be in a cave or something)
 			/// 2 meters is just an arbitrary value. 
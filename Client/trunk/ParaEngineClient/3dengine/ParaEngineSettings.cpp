@@ -27,6 +27,7 @@
 #include "SelectionManager.h"
 #include "BufferPicking.h"
 #include "FrameRateController.h"
+#include "BMaxModel/BMaxModelCache.h"
 
 #ifdef USE_DIRECTX_RENDERER
 #include "DirectXEngine.h"
@@ -930,6 +931,51 @@ bool ParaEngine::ParaEngineSettings::IsProfilingEnabled()
 	return CProfiler::IsProfilingEnabled_S();
 }
 
+void ParaEngine::ParaEngineSettings::EnableTracing(bool bEnable)
+{
+	CTraceProfiler::SetEnabled(bEnable);
+}
+
+bool ParaEngine::ParaEngineSettings::IsTracingEnabled()
+{
+	return CTraceProfiler::IsEnabled();
+}
+
+void ParaEngine::ParaEngineSettings::SetTraceBufferSize(int nEventCount)
+{
+	CTraceProfiler::GetInstance().SetBufferSize(nEventCount);
+}
+
+int ParaEngine::ParaEngineSettings::GetTraceBufferSize()
+{
+	return CTraceProfiler::GetInstance().GetBufferSize();
+}
+
+void ParaEngine::ParaEngineSettings::DumpTrace(const char* filename)
+{
+	CTraceProfiler::GetInstance().DumpChromeTrace(filename);
+}
+
+void ParaEngine::ParaEngineSettings::ClearTrace()
+{
+	CTraceProfiler::GetInstance().Clear();
+}
+
+void ParaEngine::ParaEngineSettings::EnableBMaxCache(bool bEnable)
+{
+	BMaxModelCache::GetInstance().SetEnabled(bEnable);
+}
+
+bool ParaEngine::ParaEngineSettings::IsBMaxCacheEnabled()
+{
+	return BMaxModelCache::GetInstance().IsEnabled();
+}
+
+void ParaEngine::ParaEngineSettings::SetBMaxCacheDir(const char* sDir)
+{
+	BMaxModelCache::GetInstance().SetCacheDir(sDir);
+}
+
 int ParaEngine::ParaEngineSettings::GetAsyncLoaderItemsLeft(int nItemType)
 {
 	return CAsyncLoader::GetSingleton().GetItemsLeft(nItemType);
@@ -1553,6 +1599,12 @@ int ParaEngineSettings::InstallFields(CAttributeClass* pClass, bool bOverride)
 	pClass->AddField("UpdateScreenMode", FieldType_void, (void*)UpdateScreenMode_s, NULL, NULL, NULL, bOverride);
 	pClass->AddField("ShowMenu", FieldType_Bool, (void*)SetShowMenu_s, NULL, NULL, NULL, bOverride);
 	pClass->AddField("EnableProfiling", FieldType_Bool, (void*)EnableProfiling_s, (void*)IsProfilingEnabled_s, NULL, NULL, bOverride);
+	pClass->AddField("EnableTracing", FieldType_Bool, (void*)EnableTracing_s, (void*)IsTracingEnabled_s, NULL, NULL, bOverride);
+	pClass->AddField("TraceBufferSize", FieldType_Int, (void*)SetTraceBufferSize_s, (void*)GetTraceBufferSize_s, NULL, NULL, bOverride);
+	pClass->AddField("DumpTrace", FieldType_String, (void*)DumpTrace_s, NULL, NULL, NULL, bOverride);
+	pClass->AddField("ClearTrace", FieldType_void, (void*)ClearTrace_s, NULL, NULL, NULL, bOverride);
+	pClass->AddField("EnableBMaxCache", FieldType_Bool, (void*)EnableBMaxCache_s, (void*)IsBMaxCacheEnabled_s, NULL, NULL, bOverride);
+	pClass->AddField("BMaxCacheDir", FieldType_String, (void*)SetBMaxCacheDir_s, NULL, NULL, NULL, bOverride);
 	pClass->AddField("Enable3DRendering", FieldType_Bool, (void*)Enable3DRendering_s, (void*)Is3DRenderingEnabled_s, NULL, NULL, bOverride);
 
 	pClass->AddField("PixelShaderVersion", FieldType_Int, NULL, (void*)GetPixelShaderVersion_s, NULL, NULL, bOverride);
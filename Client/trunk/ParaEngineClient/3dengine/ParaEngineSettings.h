@@ -142,6 +142,17 @@ namespace ParaEngine
 
 		ATTRIBUTE_METHOD1(ParaEngineSettings, IsProfilingEnabled_s, bool*)	{*p1 = cls->IsProfilingEnabled(); return S_OK;}
 		ATTRIBUTE_METHOD1(ParaEngineSettings, EnableProfiling_s, bool)	{cls->EnableProfiling(p1); return S_OK;}
+
+		ATTRIBUTE_METHOD1(ParaEngineSettings, IsTracingEnabled_s, bool*)	{*p1 = cls->IsTracingEnabled(); return S_OK;}
+		ATTRIBUTE_METHOD1(ParaEngineSettings, EnableTracing_s, bool)	{cls->EnableTracing(p1); return S_OK;}
+		ATTRIBUTE_METHOD1(ParaEngineSettings, GetTraceBufferSize_s, int*)	{*p1 = cls->GetTraceBufferSize(); return S_OK;}
+		ATTRIBUTE_METHOD1(ParaEngineSettings, SetTraceBufferSize_s, int)	{cls->SetTraceBufferSize(p1); return S_OK;}
+		ATTRIBUTE_METHOD1(ParaEngineSettings, DumpTrace_s, const char*)	{cls->DumpTrace(p1); return S_OK;}
+		ATTRIBUTE_METHOD(ParaEngineSettings, ClearTrace_s)	{cls->ClearTrace(); return S_OK;}
+
+		ATTRIBUTE_METHOD1(ParaEngineSettings, IsBMaxCacheEnabled_s, bool*)	{*p1 = cls->IsBMaxCacheEnabled(); return S_OK;}
+		ATTRIBUTE_METHOD1(ParaEngineSettings, EnableBMaxCache_s, bool)	{cls->EnableBMaxCache(p1); return S_OK;}
+		ATTRIBUTE_METHOD1(ParaEngineSettings, SetBMaxCacheDir_s, const char*)	{cls->SetBMaxCacheDir(p1); return S_OK;}
 		
 		ATTRIBUTE_METHOD1(ParaEngineSettings, Is3DRenderingEnabled_s, bool*)	{*p1 = cls->Is3DRenderingEnabled(); return S_OK;}
 		ATTRIBUTE_METHOD1(ParaEngineSettings, Enable3DRendering_s, bool)	{cls->Enable3DRendering(p1); return S_OK;}
@@ -311,6 +322,23 @@ namespace ParaEngine
 		static void EnableProfiling(bool bEnable);
 		static bool IsProfilingEnabled();
 
+		/** start/stop the per thread trace profiler. see CTraceProfiler */
+		static void EnableTracing(bool bEnable);
+		static bool IsTracingEnabled();
+		/** number of trace events kept per thread */
+		static void SetTraceBufferSize(int nEventCount);
+		static int GetTraceBufferSize();
+		/** write all trace events in Chrome trace json format to the given file, which can be opened in chrome://tracing or perfetto. */
+		static void DumpTrace(const char* filename);
+		/** clear all recorded trace events */
+		static void ClearTrace();
+
+		/** whether compiled bmax models are cached to disk. see BMaxModelCache */
+		static void EnableBMaxCache(bool bEnable);
+		static bool IsBMaxCacheEnabled();
+		/** directory of compiled bmax model cache. default to "temp/cache/bmax/" */
+		static void SetBMaxCacheDir(const char* sDir);
+
 		/** get the render engine stats to output. 
 		* @param output: the output buffer. 
 		* @param dwFields: current it is 0, which just collect graphics card settings. 
@@ -11,6 +11,7 @@
 #include "ParaMeshXMLFile.h"
 #include "ParaXAnimInstance.h"
 #include "ParaXSerializer.h"
+#include "ParaXModel/ParaXBone.h"
 #include "ContentLoaders.h"
 #include "AsyncLoader.h"
 #include "ParaXEntity.h"
@@ -191,6 +192,21 @@ bool ParaXEntity::IsLoaded()
 	return TryGetModel()!=0;
 }
 
+int64 ParaXEntity::GetMemoryBytes()
+{
+	int64 nBytes = 0;
+	for (MeshLOD& lod : m_MeshLODs)
+	{
+		CParaXModel* pModel = lod.m_pParaXMesh.get();
+		if (pModel)
+		{
+			const ParaXModelObjNum& objNum = pModel->GetObjectNum();
+			nBytes += (int64)objNum.nVertices * sizeof(ModelVertex) + (int64)objNum.nIndices * sizeof(uint16) + (int64)objNum.nBones * sizeof(Bone);
+		}
+	}
+	return nBytes;
+}
+
 void ParaXEntity::CreateMeshLODLevel( float fromDepth, const string& sFilename )
 {
 	MeshLOD meshLOD;
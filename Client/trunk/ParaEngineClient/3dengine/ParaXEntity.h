@@ -139,6 +139,9 @@ namespace ParaEngine
 		/** Get AABB bounding box of the asset object. if the asset contains an OOB, it will return true. */
 		virtual bool GetBoundingBox(Vector3* pMin, Vector3* pMax);
 
+		/** vertices, indices and bones of all loaded LOD models. */
+		virtual int64 GetMemoryBytes();
+
 		void SetMergeCoplanerBlockFace(bool val);
 		bool GetMergeCoplanerBlockFace();
 
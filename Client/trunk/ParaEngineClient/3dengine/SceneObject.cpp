@@ -143,7 +143,8 @@ m_dropShadowRenderer(new DropShadowRenderer()),
 #endif
 m_globalTerrain(new ParaTerrain::CGlobalTerrain()),
 m_sceneState(new ParaTerrain::SceneState()),
-m_dwPhysicsGroupMask(DEFAULT_PHYSICS_GROUP_MASK), m_renderDropShadow(false), m_bShowMainPlayer(true), m_bCanShowMainPlayer(true), m_fPostRenderQueueOrder(100.f)
+m_dwPhysicsGroupMask(DEFAULT_PHYSICS_GROUP_MASK), m_renderDropShadow(false), m_bShowMainPlayer(true), m_bCanShowMainPlayer(true), m_fPostRenderQueueOrder(100.f),
+m_pBatchCulledObject(NULL), m_bBatchCulledVisible(false)
 {
 #ifdef _DEBUG
 	// test local light
@@ -1308,19 +1309,53 @@ int RemoveZoneObjects(T& renderlist)
 	}
 	return 0;
 }
-bool CSceneObject::PrepareRenderObject(CBaseObject* pObj, CBaseCamera* pCamera, SceneState& sceneState)
+/** get the object used for view culling of pObj. */
+static IViewClippingObject* GetCullingObject(CBaseObject* pObj)
 {
 	IViewClippingObject* pViewClippingObject = pObj->GetViewClippingObject();
-	// fNewViewRadius is usually the camera far plane distance, however, it can be set to a smaller value according to the size of the object. 
-	float fNewViewRadius;
-	float fR = pViewClippingObject->GetRadius();
-	if(fR == 0.f && pObj->CheckVolumnField(OBJ_BIG_STATIC_OBJECT))
+	if (pViewClippingObject->GetRadius() == 0.f && pObj->CheckVolumnField(OBJ_BIG_STATIC_OBJECT))
 	{
 		// This is tricky: due to asynchronous loading of mesh entity, we do not know how big the associated mesh is when game world is loaded. 
 		// so in case, the object is marked as big static object, we will use the radius of the object instead of mesh entity for view culling. 
 		pViewClippingObject = pObj;
-		fR = pViewClippingObject->GetRadius();
 	}
+	return pViewClippingObject;
+}
+
+template <class T>
+void CSceneObject::BatchCullObjects(T& objects, CBaseCamera* pCamera)
+{
+	int nCount = (int)objects.size();
+	m_cullingX.resize(nCount);
+	m_cullingY.resize(nCount);
+	m_cullingZ.resize(nCount);
+	m_cullingRadius.resize(nCount);
+	m_cullingVisibleMask.resize((nCount + 31) / 32 + 1);
+	int i = 0;
+	for (auto& pObj : objects)
+	{
+		IViewClippingObject* pViewClippingObject = GetCullingObject(pObj);
+		Vector3 vCenter = pViewClippingObject->GetRenderOffset();
+		vCenter += pViewClippingObject->GetLocalAABBCenter();
+		m_cullingX[i] = vCenter.x;
+		m_cullingY[i] = vCenter.y;
+		m_cullingZ[i] = vCenter.z;
+		m_cullingRadius[i] = pViewClippingObject->GetRadius();
+		++i;
+	}
+	// the same planes as IViewClippingObject::TestCollisionSphere(), which tests near, right, bottom, top and far planes but not the left plane. 
+	// PrepareRenderObject() further tests the near plane distance against the per-object view radius. 
+	const uint32 nPlaneMask = CShapeFrustum::PLANE_MASK_NEAR | CShapeFrustum::PLANE_MASK_RIGHT | CShapeFrustum::PLANE_MASK_BOTTOM | CShapeFrustum::PLANE_MASK_TOP | CShapeFrustum::PLANE_MASK_FAR;
+	if (nCount > 0)
+		pCamera->GetObjectFrustum()->TestSpheres(&m_cullingX[0], &m_cullingY[0], &m_cullingZ[0], &m_cullingRadius[0], nCount, &m_cullingVisibleMask[0], nPlaneMask);
+}
+
+bool CSceneObject::PrepareRenderObject(CBaseObject* pObj, CBaseCamera* pCamera, SceneState& sceneState)
+{
+	IViewClippingObject* pViewClippingObject = GetCullingObject(pObj);
+	// fNewViewRadius is usually the camera far plane distance, however, it can be set to a smaller value according to the size of the object. 
+	float fNewViewRadius;
+	float fR = pViewClippingObject->GetRadius();
 	
 	float fRenderDistance = pObj->GetRenderDistance();
 	if(fRenderDistance <= 0.f)
@@ -1338,6 +1373,18 @@ bool CSceneObject::PrepareRenderObject(CBaseObject* pObj, CBaseCamera* pCamera,
 		fNewViewRadius = m_fFogEnd;
 
 	bool bDrawObj = false;
+
+	bool bRoughTestPassed;
+	if (pObj == m_pBatchCulledObject && pObj->GetMyType() != _PC_Zone && pObj->GetMyType() != _PC_Portal)
+	{
+		// the object was tested against the side and near planes by BatchCullObjects(), only the view radius is left. 
+		m_pBatchCulledObject = NULL;
+		Vector3 vCenter = pViewClippingObject->GetRenderOffset();
+		vCenter += pViewClippingObject->GetLocalAABBCenter();
+		bRoughTestPassed = m_bBatchCulledVisible && pCamera->GetObjectFrustum()->GetPlane(0).PlaneDotCoord(vCenter) < (fNewViewRadius + fR);
+	}
+	else
+		bRoughTestPassed = pViewClippingObject->TestCollisionSphere(pCamera, fNewViewRadius);
 	
 	/*  the intersection of two spheres: one sphere with center at the eye position; another at the camera frustum's bounding volumne origin. 
 	bool bEyeRoughTestPassed = bRoughTestPassed = pViewClippingObject->TestCollisionSphere(& (sceneState.vEye), fNewViewRadius,1);
@@ -1347,8 +1394,7 @@ bool CSceneObject::PrepareRenderObject(CBaseObject* pObj, CBaseCamera* pCamera,
 	}*/
 	
 	///  rough test is performed first followed by precise bounding box test, with the camera's view frustum.
-	if( pViewClippingObject->TestCollisionSphere(pCamera, fNewViewRadius)
-		&& pViewClippingObject->TestCollision(pCamera))
+	if( bRoughTestPassed && pViewClippingObject->TestCollision(pCamera))
 	{
 		bDrawObj = true;
 		
@@ -1643,12 +1689,21 @@ void CSceneObject::PrepareTileObjects(CBaseCamera* pCamera, SceneState &sceneSta
 			queueTiles.pop();
 			{
 				/// add all solid objects to the queue for further view clipping test
+				BatchCullObjects(pTile->m_listSolidObj, pCamera);
+				int nIndex = 0;
 				for (auto& pObj : pTile->m_listSolidObj)
 				{
+					bool bVisible = (m_cullingVisibleMask[nIndex >> 5] & (1u << (nIndex & 31))) != 0;
+					++nIndex;
 					/// We will not render Biped that can perceive its surroundings.
 					/// since they will be in the visitor biped list. 
 					if (pObj->IsRenderable() && pObj->CheckAttribute(OBJ_VOLUMN_TILE_VISITOR) == false)
+					{
+						m_pBatchCulledObject = pObj;
+						m_bBatchCulledVisible = bVisible;
 						pObj->PrepareRender(pCamera, &sceneState);
+						m_pBatchCulledObject = NULL;
+					}
 					else
 					{
 						if (pObj->IsVisible())
@@ -1679,10 +1734,19 @@ void CSceneObject::PrepareTileObjects(CBaseCamera* pCamera, SceneState &sceneSta
 			}
 			{
 				/// add all free space objects to the queue
+				BatchCullObjects(pTile->m_listFreespace, pCamera);
+				int nIndex = 0;
 				for (auto& pObj : pTile->m_listFreespace)
 				{
+					bool bVisible = (m_cullingVisibleMask[nIndex >> 5] & (1u << (nIndex & 31))) != 0;
+					++nIndex;
 					if (pObj->IsRenderable())
+					{
+						m_pBatchCulledObject = pObj;
+						m_bBatchCulledVisible = bVisible;
 						pObj->PrepareRender(pCamera, &sceneState);
+						m_pBatchCulledObject = NULL;
+					}
 					else
 					{
 						if (pObj->IsVisible())
@@ -4504,6 +4568,13 @@ int CSceneObject::GetObjectsByScreenRect( list<CBaseObject*>& output, const RECT
 	return nCount;
 }
 
+int CSceneObject::GetObjectsBySpheres(std::vector<CBaseObject*>& output, std::vector<int>& offsets, const CShapeSphere* pSpheres, int nCount, OBJECT_FILTER_CALLBACK pFnctFilter, bool bParallel)
+{
+	if (pFnctFilter == 0)
+		pFnctFilter = g_fncPickingAll;
+	return GetRootTile()->GetSpatialIndex().QueryBatch(pSpheres, nCount, output, offsets, pFnctFilter, bParallel);
+}
+
 int CSceneObject::GetObjectsBySphere( list<CBaseObject*>& output, const CShapeSphere& sphere, OBJECT_FILTER_CALLBACK pFnctFilter, int nMethod/*=0*/ )
 {
 	if(pFnctFilter==0)
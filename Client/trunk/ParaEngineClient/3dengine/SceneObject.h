@@ -641,6 +641,19 @@ namespace ParaEngine
 		*/
 		int GetObjectsBySphere(list<CBaseObject*>& output, const CShapeSphere& sphere, OBJECT_FILTER_CALLBACK pFnctFilter=NULL, int nMethod=0);
 
+		/**
+		* Get objects inside or intersect with each of the given spheres in one call. It is much faster than calling GetObjectsBySphere() 
+		* many times, since objects are queried from a spatial index that is kept up to date when objects are attached, detached or moved,
+		* rather than from the tile tree. see CSceneSpatialIndex.
+		* Spheres are tested against object bounding spheres, the same as GetObjectsBySphere() with nMethod=2.
+		* @param output: objects of sphere i are output[offsets[i], offsets[i+1]). it is cleared before use. 
+		* @param offsets: it will be resized to nCount+1. 
+		* @param pFnctFilter: a callback function to further filter selected object. if it is NULL, any scene object could be selected.
+		* @param bParallel: whether to answer spheres in multiple threads. The filter function is always called in the calling thread. 
+		* @return: total number of objects in output.
+		*/
+		int GetObjectsBySpheres(std::vector<CBaseObject*>& output, std::vector<int>& offsets, const CShapeSphere* pSpheres, int nCount, OBJECT_FILTER_CALLBACK pFnctFilter = NULL, bool bParallel = false);
+
 		/**
 		* Get objects inside or intersect with a screen rect. screen rect is translated to a 3d cone from the camera eye position to a plane fMaxDistance away.
 		* This function is usually used for finding other static mesh objects near a certain character. 
@@ -1203,6 +1216,14 @@ namespace ParaEngine
 		/// some coefficients during the auto radius calculation.
 		float m_fCoefF, m_fCoefN, m_fCoefK;
 
+		/// scratch arrays of BatchCullObjects(), in structure-of-arrays layout.
+		std::vector<float> m_cullingX, m_cullingY, m_cullingZ, m_cullingRadius;
+		std::vector<uint32> m_cullingVisibleMask;
+		/// the object whose PrepareRender() is being called with a batch culling result. 
+		CBaseObject* m_pBatchCulledObject;
+		/// whether m_pBatchCulledObject passed the batch sphere test.
+		bool m_bBatchCulledVisible;
+
 		/** decide whether pObj is visible by the pCamera, if so, it will add it to the proper render queue in sceneState. 
 		* @note: this function is only used by RebuildSceneState
 		* @note: This function may be recursive if child node of pObj needs processing. 
@@ -1228,6 +1249,12 @@ namespace ParaEngine
 		*/
 		void PrepareTileObjects(CBaseCamera* pCamera, SceneState &sceneState);
 
+		/** test the bounding spheres of all objects in a tile list against the camera frustum in a single batch.
+		* the result is saved to m_cullingVisibleMask, and is used by PrepareRenderObject() in place of the per-object sphere test.
+		* @param objects: ObjectRefArray_type of a terrain tile. */
+		template <class T>
+		void BatchCullObjects(T& objects, CBaseCamera* pCamera);
+
 		void UpdateMovableObjectZone(SceneState &sceneState, SceneState::List_PostRenderObject_Type& listPRBiped);
 
 		/** auto generate player ripple for the current player. */
@@ -0,0 +1,193 @@
+//-----------------------------------------------------------------------------
+// Class:	CSceneSpatialIndex
+// Authors:	LiXizhi
+// Emails:	LiXizhi@yeah.net
+// Company: ParaEngine
+// Date:	2026.10.18
+// Desc: incrementally maintained spatial index for batched sphere queries on scene objects
+//-----------------------------------------------------------------------------
+#include "ParaEngine.h"
+#include "BaseObject.h"
+#include "IViewClippingObject.h"
+#include "SceneSpatialIndex.h"
+#include <thread>
+
+using namespace ParaEngine;
+
+/** min number of spheres per worker thread in QueryBatch */
+#define SPATIAL_INDEX_MIN_QUERIES_PER_THREAD	64
+
+CSceneSpatialIndex::CSceneSpatialIndex()
+{
+}
+
+CSceneSpatialIndex::~CSceneSpatialIndex()
+{
+}
+
+bool CSceneSpatialIndex::IsDynamicObject(CBaseObject* pObject)
+{
+	return pObject->QueryIGameObject() != NULL;
+}
+
+void CSceneSpatialIndex::AddObject(CBaseObject* pObject)
+{
+	if (pObject == NULL)
+		return;
+	if (IsDynamicObject(pObject))
+	{
+		// the same objects as in tile visitor lists or local tile object lists
+		if (!pObject->IsGlobal() || pObject->CheckAttribute(OBJ_VOLUMN_TILE_VISITOR))
+		{
+			for (auto& obj : m_dynamicObjects)
+			{
+				if (obj.get() == pObject)
+					return;
+			}
+			m_dynamicObjects.push_back(CBaseObject::WeakPtr_type(pObject));
+		}
+	}
+	else if (!pObject->IsGlobal())
+	{
+		UpdateObject(pObject);
+	}
+}
+
+void CSceneSpatialIndex::RemoveObject(CBaseObject* pObject)
+{
+	if (pObject == NULL || m_grid.Remove(pObject))
+		return;
+	for (auto it = m_dynamicObjects.begin(); it != m_dynamicObjects.end(); ++it)
+	{
+		if (it->get() == pObject)
+		{
+			*it = m_dynamicObjects.back();
+			m_dynamicObjects.pop_back();
+			return;
+		}
+	}
+}
+
+void CSceneSpatialIndex::UpdateObject(CBaseObject* pObject)
+{
+	if (pObject == NULL || IsDynamicObject(pObject) || pObject->IsGlobal())
+		return;
+	IViewClippingObject* pViewClippingObject = pObject->GetViewClippingObject();
+	Vector3 vCenter = pViewClippingObject->GetObjectCenter();
+	m_grid.Update(pObject, CBaseObject::WeakPtr_type(pObject), vCenter.x, vCenter.y, vCenter.z, pViewClippingObject->GetRadius());
+}
+
+void CSceneSpatialIndex::Clear()
+{
+	m_grid.Clear();
+	m_dynamicObjects.clear();
+	m_dynamicBatchObjects.clear();
+	m_dynamicBounds.clear();
+}
+
+void CSceneSpatialIndex::PrepareDynamicObjects()
+{
+	m_dynamicBatchObjects.clear();
+	m_dynamicBounds.clear();
+	for (int i = 0; i < (int)m_dynamicObjects.size();)
+	{
+		CBaseObject* pObject = m_dynamicObjects[i].get();
+		if (pObject == NULL)
+		{
+			// the object is already released
+			m_dynamicObjects[i] = m_dynamicObjects.back();
+			m_dynamicObjects.pop_back();
+			continue;
+		}
+		IViewClippingObject* pViewClippingObject = pObject->GetViewClippingObject();
+		Vector3 vCenter = pViewClippingObject->GetObjectCenter();
+		m_dynamicBatchObjects.push_back(pObject);
+		m_dynamicBounds.push_back(vCenter.x);
+		m_dynamicBounds.push_back(vCenter.y);
+		m_dynamicBounds.push_back(vCenter.z);
+		m_dynamicBounds.push_back(pViewClippingObject->GetRadius());
+		++i;
+	}
+}
+
+int CSceneSpatialIndex::Query(const CShapeSphere& sphere, std::vector<CBaseObject*>& output) const
+{
+	int nOldSize = (int)output.size();
+	const Vector3& vCenter = sphere.GetCenter();
+	const float fRadius = sphere.GetRadius();
+
+	const int nDynamicCount = (int)m_dynamicBatchObjects.size();
+	const float* pBound = (nDynamicCount > 0) ? &m_dynamicBounds[0] : NULL;
+	for (int i = 0; i < nDynamicCount; ++i, pBound += 4)
+	{
+		float dx = pBound[0] - vCenter.x, dy = pBound[1] - vCenter.y, dz = pBound[2] - vCenter.z;
+		float fRange = pBound[3] + fRadius;
+		if ((dx*dx + dy*dy + dz*dz) <= fRange*fRange)
+			output.push_back(m_dynamicBatchObjects[i]);
+	}
+
+	m_grid.Query(vCenter.x, vCenter.y, vCenter.z, fRadius, [&output](const CBaseObject::WeakPtr_type& obj) {
+		CBaseObject* pObject = obj.get();
+		if (pObject)
+			output.push_back(pObject);
+	});
+	return (int)output.size() - nOldSize;
+}
+
+int CSceneSpatialIndex::QueryBatch(const CShapeSphere* pSpheres, int nCount, std::vector<CBaseObject*>& output, std::vector<int>& offsets, OBJECT_FILTER_CALLBACK pFnctFilter, bool bParallel)
+{
+	output.clear();
+	offsets.resize(nCount + 1);
+	offsets[0] = 0;
+	PrepareDynamicObjects();
+	int nThreadCount = bParallel ? (std::min)((int)std::thread::hardware_concurrency(), nCount / SPATIAL_INDEX_MIN_QUERIES_PER_THREAD) : 1;
+	if (nThreadCount <= 1)
+	{
+		for (int i = 0; i < nCount; ++i)
+			offsets[i + 1] = offsets[i] + Query(pSpheres[i], output);
+		return FilterOutput(output, offsets, nCount, pFnctFilter);
+	}
+
+	// each worker answers a contiguous range of spheres into its own buffer, which are then concatenated in order.
+	std::vector< std::vector<CBaseObject*> > results(nThreadCount);
+	auto worker = [&](int nThread) {
+		int nFrom = nCount * nThread / nThreadCount;
+		int nTo = nCount * (nThread + 1) / nThreadCount;
+		for (int i = nFrom; i < nTo; ++i)
+			offsets[i + 1] = Query(pSpheres[i], results[nThread]);
+	};
+	std::vector<std::thread> workers;
+	for (int i = 1; i < nThreadCount; ++i)
+		workers.push_back(std::thread(worker, i));
+	worker(0);
+	for (auto& thread : workers)
+		thread.join();
+
+	for (int i = 0; i < nCount; ++i)
+		offsets[i + 1] += offsets[i];
+	output.reserve(offsets[nCount]);
+	for (auto& result : results)
+		output.insert(output.end(), result.begin(), result.end());
+	return FilterOutput(output, offsets, nCount, pFnctFilter);
+}
+
+int CSceneSpatialIndex::FilterOutput(std::vector<CBaseObject*>& output, std::vector<int>& offsets, int nCount, OBJECT_FILTER_CALLBACK pFnctFilter)
+{
+	if (pFnctFilter == 0)
+		return (int)output.size();
+	// compact in place
+	int nOutput = 0;
+	for (int i = 0; i < nCount; ++i)
+	{
+		int nFrom = offsets[i], nTo = offsets[i + 1];
+		offsets[i] = nOutput;
+		for (int k = nFrom; k < nTo; ++k)
+		{
+			if (pFnctFilter(output[k]))
+				output[nOutput++] = output[k];
+		}
+	}
+	offsets[nCount] = nOutput;
+	output.resize(nOutput);
+	return nOutput;
+}
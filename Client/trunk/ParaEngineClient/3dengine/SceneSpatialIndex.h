@@ -0,0 +1,68 @@
+#pragma once
+#include "ShapeSphere.h"
+#include "BaseObject.h"
+#include "SpatialHashGrid.h"
+#include <vector>
+
+namespace ParaEngine
+{
+	class CBaseObject;
+	typedef bool(*OBJECT_FILTER_CALLBACK)(CBaseObject* obj);
+
+	/**
+	* spatial index of the tile objects in the scene, for answering many sphere queries in one call.
+	* It is maintained incrementally by CTerrainTileRoot when objects are attached, detached or moved, so queries never traverse the tile tree.
+	* - static objects (local objects that are not game objects) are kept in a SpatialHashGrid with their bounding spheres at attach time.
+	*   if a static object is moved without detaching, call UpdateObject() (see CTerrainTileRoot::OnObjectMoved).
+	* - game objects (characters, etc) move every frame, so only their membership is kept, and their bounding spheres are read once per batch.
+	* Global objects that are not tile visitors are not indexed, since they are never found by GetObjectsBySphere() either.
+	*
+	* The result is the same as CSceneObject::GetObjectsBySphere() with nMethod=2 (sphere to sphere test).
+	*/
+	class CSceneSpatialIndex
+	{
+	public:
+		CSceneSpatialIndex();
+		~CSceneSpatialIndex();
+
+		/** add an attached tile object. it does nothing if the object should not be indexed. */
+		void AddObject(CBaseObject* pObject);
+		/** remove a detached object. */
+		void RemoveObject(CBaseObject* pObject);
+		/** re-read the bounding sphere of a static object after it has been moved or resized. */
+		void UpdateObject(CBaseObject* pObject);
+		/** remove all objects */
+		void Clear();
+
+		/** answer many spheres. the result of sphere i is output[offsets[i], offsets[i+1]).
+		* @param pFnctFilter: only objects that pass the filter are returned. if NULL, all objects are returned.
+		* The filter is always called in the calling thread, once for each hit.
+		* @param bParallel: if true, spheres are split among worker threads when there are many of them.
+		* @return total number of objects in output. */
+		int QueryBatch(const CShapeSphere* pSpheres, int nCount, std::vector<CBaseObject*>& output, std::vector<int>& offsets, OBJECT_FILTER_CALLBACK pFnctFilter, bool bParallel);
+
+		/** number of indexed static and game objects */
+		int GetObjectCount() const { return m_grid.GetCount() + (int)m_dynamicObjects.size(); }
+
+		/** cell size of the static object grid, default to 16. it can only be changed when there is no static object. */
+		bool SetCellSize(float fCellSize) { return m_grid.SetCellSize(fCellSize); }
+	private:
+		/** whether the object is a game object that may move every frame. */
+		static bool IsDynamicObject(CBaseObject* pObject);
+		/** copy bounding spheres of game objects and remove dead ones. */
+		void PrepareDynamicObjects();
+		/** read only, so that it can be called from multiple threads after PrepareDynamicObjects().
+		* @return number of objects appended. */
+		int Query(const CShapeSphere& sphere, std::vector<CBaseObject*>& output) const;
+		/** remove objects that do not pass the filter and update offsets. */
+		static int FilterOutput(std::vector<CBaseObject*>& output, std::vector<int>& offsets, int nCount, OBJECT_FILTER_CALLBACK pFnctFilter);
+
+	private:
+		SpatialHashGrid<CBaseObject*, CBaseObject::WeakPtr_type> m_grid;
+
+		/** game objects, and their bounding spheres as x,y,z,radius at the beginning of current batch. */
+		std::vector<CBaseObject::WeakPtr_type> m_dynamicObjects;
+		std::vector<CBaseObject*> m_dynamicBatchObjects;
+		std::vector<float> m_dynamicBounds;
+	};
+}
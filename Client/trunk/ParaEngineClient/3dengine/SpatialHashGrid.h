@@ -0,0 +1,229 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+namespace ParaEngine
+{
+	/**
+	* incrementally maintained hash grid of bounding spheres on the XZ plane.
+	* Each sphere is stored in the cell of its center, and the bounds of a cell are kept in a contiguous array,
+	* so that a query only reads a few small cache-friendly ranges. Spheres bigger than a cell are kept in a separate list
+	* that is tested by every query. Insert, Update and Remove are O(1), so the grid never needs to be rebuilt.
+	* It only depends on the standard library, so that it can be tested on its own.
+	*
+	* [not thread safe]: queries are read only, so that many threads can query at the same time, but not while it is modified.
+	* @param Key: hashable object identity, such as a pointer.
+	* @param Value: what queries return for a key, such as a weak reference to the object.
+	*/
+	template <class Key, class Value = Key>
+	class SpatialHashGrid
+	{
+	public:
+		SpatialHashGrid(float fCellSize = 16.f) : m_fCellSize(fCellSize), m_fMaxRadius(0.f){};
+
+		/** cell size in world units. it can only be changed when the grid is empty. */
+		float GetCellSize() const { return m_fCellSize; }
+		bool SetCellSize(float fCellSize)
+		{
+			if (!m_slotMap.empty() || fCellSize <= 0.f)
+				return false;
+			m_fCellSize = fCellSize;
+			return true;
+		}
+
+		/** number of spheres in the grid */
+		int GetCount() const { return (int)m_slotMap.size(); }
+
+		bool Contains(const Key& key) const { return m_slotMap.find(key) != m_slotMap.end(); }
+
+		/** add the sphere of key, or move it if key is already in the grid. */
+		void Update(const Key& key, const Value& value, float x, float y, float z, float fRadius)
+		{
+			auto it = m_slotMap.find(key);
+			int nSlot;
+			if (it == m_slotMap.end())
+			{
+				if (m_freeSlots.empty())
+				{
+					nSlot = (int)m_slots.size();
+					m_slots.push_back(Slot());
+				}
+				else
+				{
+					nSlot = m_freeSlots.back();
+					m_freeSlots.pop_back();
+				}
+				m_slotMap[key] = nSlot;
+				m_slots[nSlot].m_key = key;
+			}
+			else
+			{
+				nSlot = it->second;
+				RemoveFromCell(nSlot);
+			}
+			Slot& slot = m_slots[nSlot];
+			slot.m_value = value;
+			slot.m_nCell = (fRadius > m_fCellSize) ? LargeCellKey() : GetCellKey(GetCellIndex(x), GetCellIndex(z));
+			Cell& cell = m_cells[slot.m_nCell];
+			slot.m_nIndex = (int)cell.m_slots.size();
+			cell.m_slots.push_back(nSlot);
+			cell.m_bounds.push_back(x);
+			cell.m_bounds.push_back(y);
+			cell.m_bounds.push_back(z);
+			cell.m_bounds.push_back(fRadius);
+			if (fRadius <= m_fCellSize && m_fMaxRadius < fRadius)
+				m_fMaxRadius = fRadius;
+		}
+
+		/** return false if key is not in the grid. */
+		bool Remove(const Key& key)
+		{
+			auto it = m_slotMap.find(key);
+			if (it == m_slotMap.end())
+				return false;
+			int nSlot = it->second;
+			RemoveFromCell(nSlot);
+			m_slots[nSlot] = Slot();
+			m_freeSlots.push_back(nSlot);
+			m_slotMap.erase(it);
+			return true;
+		}
+
+		void Clear()
+		{
+			m_cells.clear();
+			m_slots.clear();
+			m_freeSlots.clear();
+			m_slotMap.clear();
+			m_fMaxRadius = 0.f;
+		}
+
+		/** call callback(const Value&) for each sphere that intersects the given sphere.
+		* @return number of intersecting spheres. */
+		template <class Callback>
+		int Query(float x, float y, float z, float fRadius, Callback callback) const
+		{
+			int nCount = 0;
+			auto itLarge = m_cells.find(LargeCellKey());
+			if (itLarge != m_cells.end())
+				nCount += QueryCell(itLarge->second, x, y, z, fRadius, callback);
+
+			// spheres are stored in the cell of their center, so the search rect is expanded by the biggest radius in cells.
+			float fSearchRadius = fRadius + m_fMaxRadius;
+			int nX0 = GetCellIndex(x - fSearchRadius), nX1 = GetCellIndex(x + fSearchRadius);
+			int nZ0 = GetCellIndex(z - fSearchRadius), nZ1 = GetCellIndex(z + fSearchRadius);
+			if ((int64_t)(nX1 - nX0 + 1) * (nZ1 - nZ0 + 1) > (int64_t)m_cells.size())
+			{
+				// the search rect covers more cells than there are, so test the used cells instead.
+				for (auto& item : m_cells)
+				{
+					if (item.first == LargeCellKey())
+						continue;
+					int nX = (int)(int32_t)(item.first >> 32), nZ = (int)(int32_t)(item.first & 0xffffffff);
+					if (nX >= nX0 && nX <= nX1 && nZ >= nZ0 && nZ <= nZ1)
+						nCount += QueryCell(item.second, x, y, z, fRadius, callback);
+				}
+				return nCount;
+			}
+			for (int nZ = nZ0; nZ <= nZ1; ++nZ)
+			{
+				for (int nX = nX0; nX <= nX1; ++nX)
+				{
+					auto it = m_cells.find(GetCellKey(nX, nZ));
+					if (it != m_cells.end())
+						nCount += QueryCell(it->second, x, y, z, fRadius, callback);
+				}
+			}
+			return nCount;
+		}
+
+	private:
+		struct Cell
+		{
+			/** x,y,z,radius of each sphere */
+			std::vector<float> m_bounds;
+			std::vector<int> m_slots;
+		};
+		struct Slot
+		{
+			Slot() : m_key(), m_value(), m_nCell(0), m_nIndex(-1){};
+			Key m_key;
+			Value m_value;
+			/** cell key and index in the cell */
+			int64_t m_nCell;
+			int m_nIndex;
+		};
+
+		inline int GetCellIndex(float x) const
+		{
+			float fIndex = floorf(x / m_fCellSize);
+			// clamp, so that huge coordinates never overflow
+			return (fIndex < -1e9f) ? -1000000000 : ((fIndex > 1e9f) ? 1000000000 : (int)fIndex);
+		}
+
+		static inline int64_t GetCellKey(int nX, int nZ)
+		{
+			return (int64_t)(((uint64_t)(uint32_t)nX << 32) | (uint32_t)nZ);
+		}
+
+		/** no grid cell has this key, since cell indices are clamped to 1e9 */
+		static inline int64_t LargeCellKey()
+		{
+			return GetCellKey(0x7fffffff, 0x7fffffff);
+		}
+
+		void RemoveFromCell(int nSlot)
+		{
+			Slot& slot = m_slots[nSlot];
+			auto it = m_cells.find(slot.m_nCell);
+			if (it == m_cells.end())
+				return;
+			Cell& cell = it->second;
+			// swap with the last one
+			int nLast = (int)cell.m_slots.size() - 1;
+			if (slot.m_nIndex != nLast)
+			{
+				int nMovedSlot = cell.m_slots[nLast];
+				cell.m_slots[slot.m_nIndex] = nMovedSlot;
+				std::copy(cell.m_bounds.begin() + nLast * 4, cell.m_bounds.begin() + nLast * 4 + 4, cell.m_bounds.begin() + slot.m_nIndex * 4);
+				m_slots[nMovedSlot].m_nIndex = slot.m_nIndex;
+			}
+			cell.m_slots.pop_back();
+			cell.m_bounds.resize(nLast * 4);
+			if (cell.m_slots.empty())
+				m_cells.erase(it);
+			slot.m_nIndex = -1;
+		}
+
+		template <class Callback>
+		int QueryCell(const Cell& cell, float x, float y, float z, float fRadius, Callback& callback) const
+		{
+			int nCount = 0;
+			const int nSize = (int)cell.m_slots.size();
+			const float* pBound = &cell.m_bounds[0];
+			for (int i = 0; i < nSize; ++i, pBound += 4)
+			{
+				float dx = pBound[0] - x, dy = pBound[1] - y, dz = pBound[2] - z;
+				float fRange = pBound[3] + fRadius;
+				if ((dx*dx + dy*dy + dz*dz) <= fRange*fRange)
+				{
+					callback(m_slots[cell.m_slots[i]].m_value);
+					++nCount;
+				}
+			}
+			return nCount;
+		}
+
+	private:
+		float m_fCellSize;
+		/** max radius of spheres in grid cells. it never shrinks, which only makes queries a little more conservative. */
+		float m_fMaxRadius;
+		std::unordered_map<int64_t, Cell> m_cells;
+		std::vector<Slot> m_slots;
+		std::vector<int> m_freeSlots;
+		std::unordered_map<Key, int> m_slotMap;
+	};
+}
@@ -22,6 +22,13 @@ void CTerrainTileRoot::Cleanup()
 {
 	CTerrainTile::Cleanup();
 	m_globalMeshNameMapping.clear();
+	m_spatialIndex.Clear();
+}
+
+void CTerrainTileRoot::OnObjectMoved(CBaseObject* obj)
+{
+	if (obj && obj->GetTileContainer() != NULL)
+		m_spatialIndex.UpdateObject(obj);
 }
 
 /**
@@ -289,6 +296,7 @@ CTerrainTile* CTerrainTileRoot::AttachGlobalObject(CBaseObject* obj)
 			gameObj->UpdateTileContainer();
 			gameObj->On_Attached();
 		}
+		m_spatialIndex.AddObject(obj);
 		return obj->GetTileContainer();
 	}
 	return NULL;
@@ -349,6 +357,7 @@ CTerrainTile* CTerrainTileRoot::AttachLocalObject(CBaseObject* obj)
 			}
 		}
 		obj->SetTileContainer(pTile);
+		m_spatialIndex.AddObject(obj);
 		if (gameObj != NULL)
 		{
 			gameObj->On_Attached();
@@ -448,6 +457,7 @@ bool CTerrainTileRoot::DetachObject(CBaseObject * obj)
 	if (bSuccess)
 	{
 		obj->SetTileContainer(NULL);
+		m_spatialIndex.RemoveObject(obj);
 
 		IGameObject* pGameObject = obj->QueryIGameObject();
 		if (pGameObject != NULL)
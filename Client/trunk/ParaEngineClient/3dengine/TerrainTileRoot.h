@@ -1,6 +1,7 @@
 #pragma once
 #include "TerrainTile.h"
 #include "BaseObject.h"
+#include "SceneSpatialIndex.h"
 
 namespace ParaEngine
 {
@@ -151,6 +152,12 @@ namespace ParaEngine
 		*/
 		CBaseObject* GetObjectByViewBox(const CShapeAABB& viewbox);
 
+		/** spatial index of all attached objects. it is updated when objects are attached, detached or moved. */
+		CSceneSpatialIndex& GetSpatialIndex() { return m_spatialIndex; }
+
+		/** call this when an attached object is moved or resized without being detached, so that the spatial index is updated. */
+		void OnObjectMoved(CBaseObject* obj);
+
 	private:
 		/// Get and create tile
 		CTerrainTile* CreateTileByRect(float fAbsoluteX, float fAbsoluteY, float fPtWidth, float fPtHeight);
@@ -160,6 +167,8 @@ namespace ParaEngine
 		/** local meshes which have global names: global mesh name mapping.
 		* all mesh name should begin with "g_" */
 		map<string, CBaseObject*> m_globalMeshNameMapping;
+		/** used by batched sphere queries */
+		CSceneSpatialIndex m_spatialIndex;
 		/// the tile depth.
 		int		m_nDepth;
 		float	m_fSmallestTileRadius;
@@ -22,6 +22,7 @@
 #include <list>
 #include <fstream>
 #include <algorithm>
+#include <mutex>
 
 using namespace ParaEngine;
 using namespace Pinocchio;
@@ -709,6 +710,7 @@ CAutoRigger::CAutoRigger()
 	: m_pTargetModel(nullptr)
 	, m_ModelTemplates(new ModelTemplateMap())
 	, m_bIsRunnging(false)
+	, m_fMatchThreshold(0.f)
 {
 }
 
@@ -734,6 +736,8 @@ void CAutoRigger::RemoveModelTemplate(const char* fileName)
 {
 	ModelTemplateMap::iterator iter = m_ModelTemplates->find(fileName);
 	if (iter != m_ModelTemplates->end()) m_ModelTemplates->erase(iter);
+	std::lock_guard<std::mutex> lock_(m_TemplateFeaturesMutex);
+	m_TemplateFeatures.erase(fileName);
 }
 
 void CAutoRigger::SetTargetModel(const char* fileName)
@@ -748,9 +752,14 @@ void  CAutoRigger::SetOutputFilePath(const char* filePath)
 	m_OutputFilePath = filePath;
 }
 
-void CAutoRigger::SetThreshold()
+void CAutoRigger::SetThreshold(float fThreshold)
 {
-	OUTPUT_LOG("SetThreshold \n");
+	m_fMatchThreshold = fThreshold;
+}
+
+float CAutoRigger::GetThreshold()
+{
+	return m_fMatchThreshold;
 }
 
 void CAutoRigger::AutoRigModel()
@@ -758,20 +767,69 @@ void CAutoRigger::AutoRigModel()
 	if (m_bIsRunnging) {
 		OUTPUT_LOG("error: Another task is running! \n");
 		On_AddRiggedFile(0, NULL, "Thread busy!");
-	}else {
-		try {
-			m_workerThread = std::thread(std::bind(&CAutoRigger::AutoRigThreadFunc, this));
-			m_workerThread.detach();
-		}catch (std::exception& e) {
-			OUTPUT_LOG("error: AutoRigModel worker thread error %s\n", e.what());
-			On_AddRiggedFile(0, NULL, "unknown thread error");
+		return;
+	}
+	if (m_pTargetModel == nullptr || m_ModelTemplates->empty()) {
+		On_AddRiggedFile(0, NULL, "empty model templates");
+		return;
+	}
+	RigJobList jobs;
+	jobs.push_back(std::make_pair(m_pTargetModel, m_OutputFilePath));
+	StartRigJobs(jobs);
+}
+
+void CAutoRigger::StartRigJobs(const RigJobList& jobs)
+{
+	try {
+		m_bIsRunnging = true;
+		// the worker gets its own copy of the template list, which is only modified by the main thread. 
+		m_workerThread = std::thread(std::bind(&CAutoRigger::AutoRigBatchThreadFunc, this, jobs, *m_ModelTemplates));
+		m_workerThread.detach();
+	}
+	catch (std::exception& e) {
+		m_bIsRunnging = false;
+		OUTPUT_LOG("error: AutoRigModel worker thread error %s\n", e.what());
+		On_AddRiggedFile(0, NULL, "unknown thread error");
+	}
+}
+
+void CAutoRigger::AutoRigModels(const char* sFileList)
+{
+	if (m_bIsRunnging) {
+		OUTPUT_LOG("error: Another task is running! \n");
+		On_AddRiggedFile(0, NULL, "Thread busy!");
+		return;
+	}
+	RigJobList rigJobs;
+	std::vector<std::string> jobs;
+	StringHelper::split(sFileList ? sFileList : "", ";", jobs);
+	for (const std::string& job : jobs) {
+		std::vector<std::string> files;
+		StringHelper::split(job, ",", files);
+		if (files.size() != 2 || files[0].empty() || files[1].empty()) {
+			OUTPUT_LOG("warning: AutoRigModels invalid job %s\n", job.c_str());
+			continue;
 		}
-	}	
+		// target assets are created in the calling thread, and loaded asynchronously. 
+		ParaXEntity* pTarget = CParaWorldAsset::GetSingleton()->LoadParaX("", files[0]);
+		pTarget->SetMergeCoplanerBlockFace(false);
+		pTarget->LoadAsset();
+		rigJobs.push_back(std::make_pair(pTarget, files[1]));
+	}
+	if (rigJobs.empty() || m_ModelTemplates->empty()) {
+		On_AddRiggedFile(0, NULL, "empty model templates or target models");
+		return;
+	}
+	StartRigJobs(rigJobs);
 }
 
 void CAutoRigger::Clear()
 {
 	m_ModelTemplates->clear();
+	{
+		std::lock_guard<std::mutex> lock_(m_TemplateFeaturesMutex);
+		m_TemplateFeatures.clear();
+	}
 	m_pTargetModel = nullptr;
 }
 
@@ -798,11 +856,13 @@ int CAutoRigger::InstallFields(CAttributeClass* pClass, bool bOverride)
 	pClass->AddField("SetTargetModel", FieldType_String, (void*)SetTargetModel_s, (void*)0, NULL, "", bOverride);
 	pClass->AddField("SetOutputFilePath", FieldType_String, (void*)SetOutputFilePath_s, (void*)0, NULL, "", bOverride);
 	pClass->AddField("AutoRigModel", FieldType_String, (void*)AutoRigModel_s, (void*)0, NULL, "", bOverride);
+	pClass->AddField("AutoRigModels", FieldType_String, (void*)AutoRigModels_s, (void*)0, NULL, "", bOverride);
+	pClass->AddField("Threshold", FieldType_Float, (void*)SetThreshold_s, (void*)GetThreshold_s, NULL, "", bOverride);
 	pClass->AddField("On_AddRiggedFile", FieldType_String, (void*)SetAddRiggedFile_s, (void*)GetAddRiggedFile_s, NULL, "", bOverride);
 	return S_OK;
 }
 
-CAutoRigger::ModelTemplateMap::iterator CAutoRigger::FindBestMatch(Mesh* targetMesh)
+CAutoRigger::ModelTemplateMap::const_iterator CAutoRigger::FindBestMatch(Mesh* targetMesh, const ModelTemplateMap& templates)
 {
 	Matcher matcher;
 	// constructing target model feature
@@ -827,9 +887,9 @@ CAutoRigger::ModelTemplateMap::iterator CAutoRigger::FindBestMatch(Mesh* targetM
 
 	// match the most close model template to the target model
 	int matchness = std::numeric_limits<int>::max();
-	ModelTemplateMap::iterator bestMatch = m_ModelTemplates->end();
-	ModelTemplateMap::iterator iter = m_ModelTemplates->begin();
-	for (; iter != m_ModelTemplates->end(); ++iter) {
+	ModelTemplateMap::const_iterator bestMatch = templates.end();
+	ModelTemplateMap::const_iterator iter = templates.begin();
+	for (; iter != templates.end(); ++iter) {
 		while (!iter->second->IsLoaded()) std::this_thread::sleep_for(std::chrono::milliseconds(25));
 		// constructing source model feature
 		matcher.SetModelFeatureType(1);
@@ -851,77 +911,171 @@ CAutoRigger::ModelTemplateMap::iterator CAutoRigger::FindBestMatch(Mesh* targetM
 	return bestMatch;
 }
 
-CAutoRigger::ModelTemplateMap::iterator CAutoRigger::FindBestMatch2(Mesh* targetMesh)
+CAutoRigger::TemplateFeaturePtr CAutoRigger::GetTemplateFeature(ModelTemplateMap::const_iterator iter)
+{
+	{
+		std::lock_guard<std::mutex> lock_(m_TemplateFeaturesMutex);
+		auto itFeature = m_TemplateFeatures.find(iter->first);
+		if (itFeature != m_TemplateFeatures.end())
+			return itFeature->second;
+	}
+
+	while (!iter->second->IsLoaded()) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(25));
+	}
+	// normalized source model vertices, which only depend on the template. 
+	// it is built without the lock, and then swapped in. 
+	std::shared_ptr<std::vector<double> > pFeature(new std::vector<double>());
+	std::vector<double>& feature = *pFeature;
+	CParaXModel* source = iter->second->GetModel();
+	Mesh* srcMesh = RigHelper::ExtractParaXMesh(source, true);
+	if (srcMesh)
+	{
+		srcMesh->normalizeBoundingBox();
+		feature.reserve(srcMesh->m_Vertices.size() * 3);
+		for (int i = 0; i < (int)srcMesh->m_Vertices.size(); ++i) {
+			const PVector3& v = srcMesh->m_Vertices[i].pos;
+			feature.push_back(v[0]);
+			feature.push_back(v[1]);
+			feature.push_back(v[2]);
+		}
+		delete srcMesh;
+	}
+	std::lock_guard<std::mutex> lock_(m_TemplateFeaturesMutex);
+	TemplateFeaturePtr& pCached = m_TemplateFeatures[iter->first];
+	pCached = pFeature;
+	return pCached;
+}
+
+CAutoRigger::ModelTemplateMap::const_iterator CAutoRigger::FindBestMatch2(Mesh* targetMesh, const ModelTemplateMap& templateMap)
 {
 	// match the most close model template to the target model
 	// we take the minmum matchness as the best match candidate
-	double matchness = std::numeric_limits<double>::max();
+	std::vector<ModelTemplateMap::const_iterator> templates;
+	std::vector<TemplateFeaturePtr> features;
+	for (ModelTemplateMap::const_iterator iter = templateMap.begin(); iter != templateMap.end(); ++iter) {
+		templates.push_back(iter);
+		features.push_back(GetTemplateFeature(iter));
+	}
+	const int nTemplateCount = (int)templates.size();
+	if (nTemplateCount == 0)
+		return templateMap.end();
+
 	TreeType* tarDistField = ConstructDistanceField(*targetMesh);
-	ModelTemplateMap::iterator bestMatch = m_ModelTemplates->end();
-	ModelTemplateMap::iterator iter = m_ModelTemplates->begin();
-	for (; iter != m_ModelTemplates->end(); ++iter) {
-		while (!iter->second->IsLoaded()) {
-			std::this_thread::sleep_for(std::chrono::milliseconds(25));
-		}
-		// constructing source model feature	
-		CParaXModel* source = iter->second->GetModel();
-		Mesh* srcMesh = RigHelper::ExtractParaXMesh(source, true);
-		srcMesh->normalizeBoundingBox();
 
-		double curDisSum = 0.0;
-		for (int i = 0; i < (int)srcMesh->m_Vertices.size(); ++i) {
-			PVector3 v = srcMesh->m_Vertices[i].pos;
-			double dis = tarDistField->locate(v)->evaluate(v);
-			curDisSum += std::abs(dis);
+	// templates are evaluated in parallel. The distance field is read only, so it is shared by all workers. 
+	// a template is abandoned as soon as its partial sum exceeds the best complete sum, 
+	// and all workers stop once a template's average distance is below m_fMatchThreshold.
+	std::vector<double> results(nTemplateCount, -1.0);
+	std::atomic<int> nNextTemplate(0);
+	std::atomic_bool bFoundGoodMatch(false);
+	std::mutex bestMutex;
+	double fBestDisSum = std::numeric_limits<double>::max();
+	const double fThreshold = m_fMatchThreshold;
+
+	auto worker = [&]() {
+		int nIndex;
+		while (!bFoundGoodMatch && (nIndex = nNextTemplate++) < nTemplateCount) {
+			const std::vector<double>& feature = *(features[nIndex]);
+			const int nVertices = (int)feature.size() / 3;
+			double fBound;
+			{
+				std::lock_guard<std::mutex> lock_(bestMutex);
+				fBound = fBestDisSum;
+			}
+			double curDisSum = 0.0;
+			bool bAbandoned = false;
+			for (int i = 0; i < nVertices; ++i) {
+				PVector3 v(feature[i * 3], feature[i * 3 + 1], feature[i * 3 + 2]);
+				double dis = tarDistField->locate(v)->evaluate(v);
+				curDisSum += std::abs(dis);
+				if ((i & 63) == 63) {
+					if (curDisSum > fBound) {
+						std::lock_guard<std::mutex> lock_(bestMutex);
+						fBound = fBestDisSum;
+						if (curDisSum > fBound) {
+							bAbandoned = true;
+							break;
+						}
+					}
+					if (bFoundGoodMatch) {
+						bAbandoned = true;
+						break;
+					}
+				}
+			}
+			if (bAbandoned)
+				continue;
+			results[nIndex] = curDisSum;
+			{
+				std::lock_guard<std::mutex> lock_(bestMutex);
+				if (fBestDisSum > curDisSum)
+					fBestDisSum = curDisSum;
+			}
+			if (fThreshold > 0.0 && nVertices > 0 && (curDisSum / nVertices) <= fThreshold)
+				bFoundGoodMatch = true;
 		}
-		//curDisSum /= srcMesh->m_Vertices.size();
+	};
+
+	int nWorkerCount = (std::min)((int)std::thread::hardware_concurrency(), nTemplateCount);
+	std::vector<std::thread> workers;
+	for (int i = 1; i < nWorkerCount; ++i)
+		workers.push_back(std::thread(worker));
+	worker();
+	for (auto& thread : workers)
+		thread.join();
+	delete tarDistField;
 
-		if (matchness > curDisSum) {
-			matchness = curDisSum;
-			bestMatch = iter;
+	// the first template with the minimum distance wins, the same as sequential matching. 
+	ModelTemplateMap::const_iterator bestMatch = templateMap.end();
+	double matchness = std::numeric_limits<double>::max();
+	for (int i = 0; i < nTemplateCount; ++i) {
+		if (results[i] >= 0.0 && matchness > results[i]) {
+			matchness = results[i];
+			bestMatch = templates[i];
 		}
-		
-		delete srcMesh;
 	}
-	delete tarDistField;
-	
 	return bestMatch;
-	
 }
 
-void CAutoRigger::AutoRigThreadFunc()
+void CAutoRigger::AutoRigBatchThreadFunc(RigJobList jobs, ModelTemplateMap templates)
 {
-	m_bIsRunnging = true;
-	if (m_pTargetModel == nullptr || m_ModelTemplates->empty()) {
+	// template features are cached by the first job, so that the following jobs only pay for the target model. 
+	for (auto& job : jobs) {
+		RigTargetModel(job.first, job.second, templates);
+	}
+	m_bIsRunnging = false;
+}
+
+void CAutoRigger::RigTargetModel(ParaXEntity* pTargetModel, const std::string& sOutputFilePath, const ModelTemplateMap& templates)
+{
+	if (pTargetModel == nullptr || templates.empty()) {
 		On_AddRiggedFile(0, NULL, "empty model templates");
-		m_bIsRunnging = false;
 		return;
 	}
 
-	while (!m_pTargetModel->IsLoaded()) {
+	while (!pTargetModel->IsLoaded()) {
 		std::this_thread::sleep_for(std::chrono::milliseconds(25));
 	}
 
-	Mesh* targetMesh = RigHelper::ExtractParaXMesh(m_pTargetModel->GetModel());
+	Mesh* targetMesh = RigHelper::ExtractParaXMesh(pTargetModel->GetModel());
 	if (targetMesh == nullptr) {
 		OUTPUT_LOG("Target bmax model yields a bad mesh. Use default model...\n");
-		this->BindTargetModelDefault();
-		this->On_AddRiggedFile(1, m_OutputFilePath.c_str(), "default");
-		m_bIsRunnging = false;
+		this->BindTargetModelDefault(pTargetModel, sOutputFilePath, templates);
+		this->On_AddRiggedFile(1, sOutputFilePath.c_str(), "default");
 		return;
 	}
 
 	// auto rigging using the matched source model bones for the target model
-	ModelTemplateMap::iterator bestMatch = this->FindBestMatch2(targetMesh);
-	if (bestMatch != m_ModelTemplates->end()) 
+	ModelTemplateMap::const_iterator bestMatch = this->FindBestMatch2(targetMesh, templates);
+	if (bestMatch != templates.end()) 
 	{
 		// prepare mesh
 		Mesh newMesh = PrepareMesh(*targetMesh);
 		if (newMesh.m_Vertices.empty()) {
 			OUTPUT_LOG("Target mesh: failed to pass connection test. Use default model...\n");
-			this->BindTargetModelDefault();
-			this->On_AddRiggedFile(1, m_OutputFilePath.c_str(), "default");
-			m_bIsRunnging = false;
+			this->BindTargetModelDefault(pTargetModel, sOutputFilePath, templates);
+			this->On_AddRiggedFile(1, sOutputFilePath.c_str(), "default");
 			return;
 		}
 		// prepare skeleton
@@ -931,9 +1085,8 @@ void CAutoRigger::AutoRigThreadFunc()
 		Skeleton* given = RigHelper::ExtractParaXSkeleton(bestMatch->second->GetModel(), srcMesh->m_ToAdd, srcMesh->m_Scale);
 		if (given == nullptr) {
 			OUTPUT_LOG("Failed to extract template parax model skeleton, %s.\n", bestMatch->second->GetAttributeClassName());
-			this->BindTargetModelDefault();
-			this->On_AddRiggedFile(1, m_OutputFilePath.c_str(), "default");
-			m_bIsRunnging = false;
+			this->BindTargetModelDefault(pTargetModel, sOutputFilePath, templates);
+			this->On_AddRiggedFile(1, sOutputFilePath.c_str(), "default");
 			return;
 		}
 		
@@ -960,9 +1113,8 @@ void CAutoRigger::AutoRigThreadFunc()
 		if (embeddingIndices.size() == 0) { // failure
 			delete distanceField;
 			OUTPUT_LOG("Failed to embed given skeleton to target model.\n");
-			this->BindTargetModelDefault();
-			this->On_AddRiggedFile(1, m_OutputFilePath.c_str(), "default");
-			m_bIsRunnging = false;
+			this->BindTargetModelDefault(pTargetModel, sOutputFilePath, templates);
+			this->On_AddRiggedFile(1, sOutputFilePath.c_str(), "default");
 			return;
 		}
 
@@ -972,7 +1124,7 @@ void CAutoRigger::AutoRigThreadFunc()
 		VisTester<TreeType>* tester = new VisTester<TreeType>(distanceField);
 		
 		CParaXModel* skeletonModel = bestMatch->second->GetModel();
-		CParaXModel* targetModel = m_pTargetModel->GetModel();
+		CParaXModel* targetModel = pTargetModel->GetModel();
 		RigHelper::RefineEmbedding2(targetModel, targetMesh, rigger.embedding);
 		
 #pragma region RIGGERING
@@ -1288,10 +1440,10 @@ void CAutoRigger::AutoRigThreadFunc()
 			targetModel->bones[i].pivot = (targetModel->bones[i].pivot - offset) / (float)newMesh.m_Scale;
 		}
 
-		targetModel->SaveToDisk(m_OutputFilePath.c_str());
+		targetModel->SaveToDisk(sOutputFilePath.c_str());
 #pragma endregion
 
-		this->On_AddRiggedFile(1, m_OutputFilePath.c_str(), bestMatch->second->GetKey().c_str());
+		this->On_AddRiggedFile(1, sOutputFilePath.c_str(), bestMatch->second->GetKey().c_str());
 
 #ifdef OUTPUT_DEBUG_FILE
 		{
@@ -1317,23 +1469,27 @@ void CAutoRigger::AutoRigThreadFunc()
 		delete tester;
 		delete distanceField;
 	}else{
-		this->BindTargetModelDefault();
-		this->On_AddRiggedFile(1, m_OutputFilePath.c_str(), "No match.");
+		this->BindTargetModelDefault(pTargetModel, sOutputFilePath, templates);
+		this->On_AddRiggedFile(1, sOutputFilePath.c_str(), "No match.");
 	}
-	m_bIsRunnging = false;
 }
 
-void CAutoRigger::BindTargetModelDefault()
+void CAutoRigger::BindTargetModelDefault(ParaXEntity* pTargetModel, const std::string& sOutputFilePath, const ModelTemplateMap& templates)
 {
 	std::string defaultModelName = "character/AutoAnims/Q_chong.x";
-	while (!m_pTargetModel->IsLoaded()) {
+	ModelTemplateMap::const_iterator itDefault = templates.find(defaultModelName);
+	if (itDefault == templates.end() || itDefault->second == nullptr) {
+		OUTPUT_LOG("error: AutoRigger default model template %s is not added\n", defaultModelName.c_str());
+		return;
+	}
+	while (!pTargetModel->IsLoaded()) {
 		std::this_thread::sleep_for(std::chrono::milliseconds(25));
 	}
-	while (!(*m_ModelTemplates)[defaultModelName]->IsLoaded()) {
+	while (!itDefault->second->IsLoaded()) {
 		std::this_thread::sleep_for(std::chrono::milliseconds(25));
 	}
-	CParaXModel* skeletonModel = (*m_ModelTemplates)[defaultModelName]->GetModel();
-	CParaXModel* targetModel = m_pTargetModel->GetModel();
+	CParaXModel* skeletonModel = itDefault->second->GetModel();
+	CParaXModel* targetModel = pTargetModel->GetModel();
 
 	// header settings
 	targetModel->m_header.type = skeletonModel->m_header.type;
@@ -1396,5 +1552,5 @@ void CAutoRigger::BindTargetModelDefault()
 		targetModel->m_origVertices[i].weights[0] = 255;
 	}
 
-	targetModel->SaveToDisk(m_OutputFilePath.c_str());
+	targetModel->SaveToDisk(sOutputFilePath.c_str());
 }
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include "ParaEngine.h"
 #include "BaseObject.h"
 #include <thread>
+#include <atomic>
+#include <mutex>
+#include <memory>
 
 class Mesh;
 
@@ -24,8 +27,16 @@ namespace ParaEngine
 		void RemoveModelTemplate(const char* fileName);
 		void SetTargetModel(const char* fileName);
 		void SetOutputFilePath(const char* filePath);
-		void SetThreshold();
+		/** a template is accepted without evaluating the remaining templates, if the average distance of its vertices
+		* to the target model surface is below this value. 0 (default) means always choose the best match among all templates. */
+		void SetThreshold(float fThreshold);
+		float GetThreshold();
 		void AutoRigModel();
+		/** rig many target models in one background job. template features are computed only once for all targets.
+		* On_AddRiggedFile is called once for each target.
+		* @param sFileList: semicolon separated list of "targetfile,outputfile", such as "a.bmax,a.x;b.bmax,b.x"
+		*/
+		void AutoRigModels(const char* sFileList);
 		void Clear();
 
 		/* callback on scripting side.
@@ -41,6 +52,9 @@ namespace ParaEngine
 		ATTRIBUTE_METHOD1(CAutoRigger, SetTargetModel_s, const char*) { cls->SetTargetModel(p1); return S_OK; }
 		ATTRIBUTE_METHOD1(CAutoRigger, SetOutputFilePath_s, const char*) { cls->SetOutputFilePath(p1); return S_OK; }
 		ATTRIBUTE_METHOD(CAutoRigger, AutoRigModel_s) { cls->AutoRigModel(); return S_OK; }
+		ATTRIBUTE_METHOD1(CAutoRigger, AutoRigModels_s, const char*) { cls->AutoRigModels(p1); return S_OK; }
+		ATTRIBUTE_METHOD1(CAutoRigger, SetThreshold_s, float) { cls->SetThreshold(p1); return S_OK; }
+		ATTRIBUTE_METHOD1(CAutoRigger, GetThreshold_s, float*) { *p1 = cls->GetThreshold(); return S_OK; }
 
 		DEFINE_SCRIPT_EVENT(CAutoRigger, AddRiggedFile);
 		
@@ -48,11 +62,22 @@ namespace ParaEngine
 
 	private:
 		typedef std::map<std::string, ParaXEntity*> ModelTemplateMap;
-		ModelTemplateMap::iterator FindBestMatch(Mesh* targetMesh);
-		ModelTemplateMap::iterator FindBestMatch2(Mesh* targetModel);
-		void AutoRigThreadFunc();
+		/** list of target model and output file path */
+		typedef std::vector<std::pair<ParaXEntity*, std::string> > RigJobList;
+		ModelTemplateMap::const_iterator FindBestMatch(Mesh* targetMesh, const ModelTemplateMap& templates);
+		ModelTemplateMap::const_iterator FindBestMatch2(Mesh* targetModel, const ModelTemplateMap& templates);
+		typedef std::shared_ptr<const std::vector<double> > TemplateFeaturePtr;
+		/** get the cached normalized vertices (x,y,z array) of the given template. it waits for the template to be loaded. 
+		* the returned feature stays valid even if the template is removed by another thread. */
+		TemplateFeaturePtr GetTemplateFeature(ModelTemplateMap::const_iterator iter);
+		/** start the worker thread. the job list and the template snapshot are owned by the worker, 
+		* so that the main thread can change templates, target and output path while it is running. */
+		void StartRigJobs(const RigJobList& jobs);
+		void AutoRigBatchThreadFunc(RigJobList jobs, ModelTemplateMap templates);
+		/** rig pTargetModel with the given templates and save to sOutputFilePath */
+		void RigTargetModel(ParaXEntity* pTargetModel, const std::string& sOutputFilePath, const ModelTemplateMap& templates);
 		/** bind the target model to the default template which simply has one bone when the system failed to match the target with any given templates. */
-		void BindTargetModelDefault();
+		void BindTargetModelDefault(ParaXEntity* pTargetModel, const std::string& sOutputFilePath, const ModelTemplateMap& templates);
 
 		ModelTemplateMap* m_ModelTemplates;
 		ParaXEntity* m_pTargetModel;
@@ -60,5 +85,10 @@ namespace ParaEngine
 		std::thread m_workerThread;
 
 		std::atomic_bool m_bIsRunnging;
+		float m_fMatchThreshold;
+		/** template file name to cached normalized template vertices. 
+		* It is filled by worker threads and cleared by the main thread, so it is guarded by m_TemplateFeaturesMutex. */
+		std::map<std::string, TemplateFeaturePtr> m_TemplateFeatures;
+		std::mutex m_TemplateFeaturesMutex;
 	};
 }
\ No newline at end of file
@@ -56,13 +56,9 @@ void ParaEngine::BMaxFrameNode::SetIndex(int nIndex)
 
 BMaxFrameNode* BMaxFrameNode::GetParent()
 {
-	auto iter = m_pParser->m_nodes.find(m_nParentIndex);
-	if (m_nParentIndex >= 0 && iter != m_pParser->m_nodes.end())
-	{
-		auto pParent = iter->second;
-		if (pParent)
-			return pParent->ToBoneNode();
-	}
+	BMaxNode* pParent = m_pParser->m_nodes.GetByIndex(m_nParentIndex);
+	if (pParent)
+		return pParent->ToBoneNode();
 	return NULL;
 }
 
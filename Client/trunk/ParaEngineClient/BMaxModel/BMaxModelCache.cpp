@@ -0,0 +1,125 @@
+//-----------------------------------------------------------------------------
+// Class:	BMaxModelCache
+// Authors:	LiXizhi
+// Emails:	LiXizhi@yeah.net
+// Company: ParaEngine
+// Date:	2026.10.18
+// Desc: binary disk cache of compiled bmax models.
+//-----------------------------------------------------------------------------
+#include "ParaEngine.h"
+#include "util/MD5.h"
+#include "IO/FileUtils.h"
+#include "ParaXModel/ParaXModel.h"
+#include "ParaXModel/XFileCharModelParser.h"
+#include "ParaXModel/XFileCharModelExporter.h"
+#include "BlockEngine/BlockWorldClient.h"
+#include "BMaxModelCache.h"
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/filesystem.hpp>
+#include <atomic>
+
+using namespace ParaEngine;
+
+BMaxModelCache::BMaxModelCache()
+	: m_sCacheDir("temp/cache/bmax/"), m_bEnabled(true)
+{
+}
+
+BMaxModelCache& BMaxModelCache::GetInstance()
+{
+	static BMaxModelCache s_instance;
+	return s_instance;
+}
+
+std::string BMaxModelCache::GetCacheDir()
+{
+	ParaEngine::Lock lock_(m_mutex);
+	return m_sCacheDir;
+}
+
+void BMaxModelCache::SetCacheDir(const char* sDir)
+{
+	ParaEngine::Lock lock_(m_mutex);
+	m_sCacheDir = sDir ? sDir : "";
+	if (!m_sCacheDir.empty() && m_sCacheDir[m_sCacheDir.size() - 1] != '/' && m_sCacheDir[m_sCacheDir.size() - 1] != '\\')
+		m_sCacheDir += "/";
+}
+
+uint32 BMaxModelCache::GetTemplateTableHash()
+{
+	BlockWorldClient* pBlockWorld = BlockWorldClient::GetInstance();
+	return pBlockWorld ? pBlockWorld->GetTemplateTableHash() : 0;
+}
+
+std::string BMaxModelCache::GetCacheFilename(const char* pBuffer, int32 nSize, bool bMergeCoplanerBlockFace)
+{
+	ParaEngine::MD5 md5_hash;
+	md5_hash.feed((const unsigned char*)pBuffer, nSize);
+
+	char sSuffix[48];
+	snprintf(sSuffix, sizeof(sSuffix), "_%d_%08x_v%d.x", bMergeCoplanerBlockFace ? 1 : 0, GetTemplateTableHash(), BMAX_CACHE_VERSION);
+
+	std::string sFilename = CFileUtils::GetWritableFullPathForFilename(GetCacheDir());
+	sFilename += md5_hash.hex();
+	sFilename += sSuffix;
+	return sFilename;
+}
+
+std::string BMaxModelCache::GetLODCacheFilename(const std::string& sCacheFile, int nLOD)
+{
+	char sSuffix[16];
+	snprintf(sSuffix, sizeof(sSuffix), "_lod%d.x", nLOD);
+	// replace the ".x" extension
+	return sCacheFile.substr(0, sCacheFile.size() - 2) + sSuffix;
+}
+
+CParaXModel* BMaxModelCache::LoadModel(const std::string& sCacheFile)
+{
+	if (!m_bEnabled || !CFileUtils::FileExistRaw(sCacheFile.c_str()))
+		return NULL;
+	CParaXModel* pMesh = NULL;
+	try
+	{
+		boost::iostreams::mapped_file_source file(sCacheFile);
+		if (file.is_open() && file.size() > 0)
+		{
+			XFileCharModelParser parser(file.data(), (int32)file.size());
+			pMesh = parser.ParseParaXModel();
+		}
+	}
+	catch (...)
+	{
+		pMesh = NULL;
+	}
+	if (pMesh == 0 || !pMesh->IsValid())
+	{
+		OUTPUT_LOG("warning: invalid bmax cache file %s is removed\n", sCacheFile.c_str());
+		SAFE_DELETE(pMesh);
+		CFileUtils::DeleteFile(sCacheFile.c_str());
+		return NULL;
+	}
+	pMesh->SetBmaxModel();
+	return pMesh;
+}
+
+bool BMaxModelCache::SaveModel(const std::string& sCacheFile, CParaXModel* pMesh)
+{
+	if (!m_bEnabled || pMesh == 0)
+		return false;
+	static std::atomic<int> s_nTempFileId(0);
+
+	if (!CFileUtils::MakeDirectoryFromFilePath(sCacheFile.c_str()))
+		return false;
+	char sSuffix[32];
+	snprintf(sSuffix, sizeof(sSuffix), ".%d.tmp", ++s_nTempFileId);
+	std::string sTempFile = sCacheFile + sSuffix;
+	if (XFileCharModelExporter::Export(sTempFile, pMesh))
+	{
+		boost::system::error_code err_code;
+		boost::filesystem::rename(boost::filesystem::path(sTempFile), boost::filesystem::path(sCacheFile), err_code);
+		if (err_code.value() == 0)
+			return true;
+	}
+	CFileUtils::DeleteFile(sTempFile.c_str());
+	return false;
+}
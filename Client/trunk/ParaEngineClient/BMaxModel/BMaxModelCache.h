@@ -0,0 +1,61 @@
+#pragma once
+#include "util/mutex.h"
+#include <string>
+#include <atomic>
+
+namespace ParaEngine
+{
+	class CParaXModel;
+
+	/** version of the cached mesh data. increase it whenever BMaxParser output changes, so that old cache files are ignored. */
+#define BMAX_CACHE_VERSION		2
+
+	/**
+	* Disk cache of compiled bmax models.
+	* Parsing a bmax file (xml decoding, coplaner face merging, bone weighting and LOD) takes hundreds of milliseconds for big models.
+	* The finished mesh and its generated LODs are saved in binary ParaX format to the cache directory, keyed by the md5 of
+	* the source bmax data, the parser options, a hash of the block template table and BMAX_CACHE_VERSION.
+	* Cache files are loaded by memory mapping.
+	* Models that reference other model files are never cached, since the referenced files may change independently.
+	*
+	* [thread safe]: it is used by the asset loader threads.
+	*/
+	class BMaxModelCache
+	{
+	public:
+		BMaxModelCache();
+		static BMaxModelCache& GetInstance();
+
+		bool IsEnabled() const { return m_bEnabled; }
+		void SetEnabled(bool bEnabled) { m_bEnabled = bEnabled; }
+
+		/** directory of cache files. relative path is relative to the writable path. default to "temp/cache/bmax/" */
+		std::string GetCacheDir();
+		void SetCacheDir(const char* sDir);
+
+		/** get the cache file name of the given bmax source data.
+		* @param bMergeCoplanerBlockFace: parser option that affects the mesh. */
+		std::string GetCacheFilename(const char* pBuffer, int32 nSize, bool bMergeCoplanerBlockFace);
+
+		/** cache file name of a generated LOD mesh.
+		* @param sCacheFile: file name returned by GetCacheFilename
+		* @param nLOD: 1 for the first generated LOD. */
+		static std::string GetLODCacheFilename(const std::string& sCacheFile, int nLOD);
+
+		/** load mesh from the cache file. return NULL if there is no valid cache file. */
+		CParaXModel* LoadModel(const std::string& sCacheFile);
+
+		/** save mesh to the cache file. It writes to a temporary file and then renames it,
+		* so that other threads or processes never see a partial file. */
+		bool SaveModel(const std::string& sCacheFile, CParaXModel* pMesh);
+
+	private:
+		/** hash of the block template table. It is maintained by the main thread, so loader threads never touch the template table. */
+		uint32 GetTemplateTableHash();
+
+	private:
+		ParaEngine::mutex m_mutex;
+		std::string m_sCacheDir;
+		std::atomic<bool> m_bEnabled;
+	};
+}
@@ -0,0 +1,70 @@
+//-----------------------------------------------------------------------------
+// Class:	BMaxNodeGrid
+// Authors:	LiXizhi
+// Emails:	LiXizhi@yeah.net
+// Company: ParaEngine
+// Date:	2026.10.18
+// Desc: dense voxel grid of bmax nodes with sparse fallback
+//-----------------------------------------------------------------------------
+#include "ParaEngine.h"
+#include "BMaxNodeGrid.h"
+
+using namespace ParaEngine;
+
+/** dense region is always used below this number of cells (4MB of pointers on 32 bits) */
+#define BMAX_DENSE_GRID_MIN_CELLS	(1<<20)
+/** above BMAX_DENSE_GRID_MIN_CELLS, dense region is only used if no more than this number of cells per node */
+#define BMAX_DENSE_GRID_CELLS_PER_NODE	32
+/** max cells of the dense region, regardless of node count */
+#define BMAX_DENSE_GRID_MAX_CELLS	(1<<24)
+
+BMaxNodeGrid::BMaxNodeGrid()
+	: m_nWidth(0), m_nHeight(0), m_nDepth(0)
+{
+}
+
+void BMaxNodeGrid::clear()
+{
+	m_nodes.clear();
+	m_grid.clear();
+	m_sparse.clear();
+	m_nWidth = m_nHeight = m_nDepth = 0;
+}
+
+void BMaxNodeGrid::Reset(int width, int height, int depth, int nNodeCountHint)
+{
+	clear();
+	if (width <= 0 || height <= 0 || depth <= 0 || width > 0xffff || height > 0xffff || depth > 0xffff)
+		return;
+	int64 nCells = (int64)width * height * depth;
+	if (nCells > BMAX_DENSE_GRID_MAX_CELLS || (nCells > BMAX_DENSE_GRID_MIN_CELLS && nCells > (int64)nNodeCountHint * BMAX_DENSE_GRID_CELLS_PER_NODE))
+		return;
+	m_grid.resize((size_t)nCells, NULL);
+	m_nWidth = width;
+	m_nHeight = height;
+	m_nDepth = depth;
+	m_nodes.reserve(nNodeCountHint);
+}
+
+bool BMaxNodeGrid::Insert(BMaxNodePtr& node)
+{
+	uint16 x = (uint16)node->x;
+	uint16 y = (uint16)node->y;
+	uint16 z = (uint16)node->z;
+	if (x < m_nWidth && y < m_nHeight && z < m_nDepth)
+	{
+		BMaxNode*& cell = m_grid[x + (z + y * m_nDepth) * m_nWidth];
+		if (cell != NULL)
+			return false;
+		cell = node.get();
+	}
+	else
+	{
+		BMaxNode*& cell = m_sparse[(uint64)x + ((uint64)z << 16) + ((uint64)y << 32)];
+		if (cell != NULL)
+			return false;
+		cell = node.get();
+	}
+	m_nodes.push_back(node);
+	return true;
+}
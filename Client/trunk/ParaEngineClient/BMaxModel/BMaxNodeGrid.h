@@ -0,0 +1,67 @@
+#pragma once
+#include "BMaxNode.h"
+#include <vector>
+#include <unordered_map>
+
+namespace ParaEngine
+{
+	/** node container of BMaxParser.
+	* Nodes inside the dense region are stored in a flat voxel array, so that neighbour lookups
+	* during face merging and bone weighting are a single array read instead of a hash lookup.
+	* Nodes outside the dense region (or all nodes if the region is too sparse) fall back to a hash map.
+	* Iteration is over the node list in insertion order, which makes output independent of hashing.
+	*/
+	class BMaxNodeGrid
+	{
+	public:
+		typedef std::vector<BMaxNodePtr> NodeList;
+		typedef NodeList::iterator iterator;
+
+		BMaxNodeGrid();
+
+		/** remove all nodes and the dense region. */
+		void clear();
+
+		/** remove all nodes and allocate a dense region of [0,width)*[0,height)*[0,depth).
+		* if the region has too many empty cells compared to nNodeCountHint, no dense region is allocated.
+		*/
+		void Reset(int width, int height, int depth, int nNodeCountHint);
+
+		inline BMaxNode* Get(uint16 x, uint16 y, uint16 z) const
+		{
+			if (x < m_nWidth && y < m_nHeight && z < m_nDepth)
+				return m_grid[x + (z + y * m_nDepth) * m_nWidth];
+			else if (!m_sparse.empty())
+			{
+				auto iter = m_sparse.find((uint64)x + ((uint64)z << 16) + ((uint64)y << 32));
+				return (iter != m_sparse.end()) ? iter->second : NULL;
+			}
+			return NULL;
+		}
+
+		/** @param index: same as BMaxNode::GetIndex(). */
+		inline BMaxNode* GetByIndex(int64 index) const
+		{
+			if (index < 0)
+				return NULL;
+			return Get((uint16)(index & 0xffff), (uint16)((index >> 32) & 0xffff), (uint16)((index >> 16) & 0xffff));
+		}
+
+		/** return false if there is already a node at the same position, in which case the node is not added. */
+		bool Insert(BMaxNodePtr& node);
+
+		iterator begin() { return m_nodes.begin(); }
+		iterator end() { return m_nodes.end(); }
+		size_t size() const { return m_nodes.size(); }
+		bool empty() const { return m_nodes.empty(); }
+
+	private:
+		NodeList m_nodes;
+		/** weak references to m_nodes. */
+		std::vector<BMaxNode*> m_grid;
+		std::unordered_map<uint64, BMaxNode*> m_sparse;
+		int m_nWidth;
+		int m_nHeight;
+		int m_nDepth;
+	};
+}
@@ -305,7 +305,7 @@ namespace ParaEngine
 		m_blockModels.clear();
 		for (auto& item : m_nodes)
 		{
-			BMaxNode* node = item.second.get();
+			BMaxNode* node = item.get();
 			if (node != NULL)
 			{
 				if (node->template_id == TransparentBlockId)
@@ -396,10 +396,7 @@ namespace ParaEngine
 	int64 BMaxParser::InsertNode(BMaxNodePtr& nodePtr)
 	{
 		auto index = nodePtr->GetIndex();
-		if (GetNode(nodePtr->x, nodePtr->y, nodePtr->z) == NULL)
-		{
-			m_nodes[index] = nodePtr;
-		}
+		m_nodes.Insert(nodePtr);
 		return index;
 	}
 	void BMaxParser::ParseHead(BMaxXMLDocument& doc)
@@ -476,7 +473,7 @@ namespace ParaEngine
 		m_rectangles.clear();
 		for (auto& item : m_nodes)
 		{
-			BMaxNode *node = item.second.get();
+			BMaxNode *node = item.get();
 			if (node->GetBlockModel() && node->isSolid() && !(node->GetBlockModel()->IsUniformLighting()))
 			{
 				for (int i = 0; i < 6; i++)
@@ -508,7 +505,7 @@ namespace ParaEngine
 		m_rectangles.clear();
 		for (auto& item : m_nodes)
 		{
-			BMaxNode *node = item.second.get();
+			BMaxNode *node = item.get();
 			if (node->GetBlockModel())
 			{
 				for (int i = 0; i < 6; i++)
@@ -790,7 +787,11 @@ namespace ParaEngine
 		int offset_y = (int)vMin.y;
 		int offset_z = (int)vMin.z;
 
-		m_nodes.clear();
+		// nodes are offset to the min corner, so the aabb is exactly the dense grid
+		if (!nodes.empty())
+			m_nodes.Reset((int)m_blockAABB.GetWidth() + 1, (int)m_blockAABB.GetHeight() + 1, (int)m_blockAABB.GetDepth() + 1, (int)nodes.size());
+		else
+			m_nodes.clear();
 		for (auto node : nodes)
 		{
 			node->x -= offset_x;
@@ -1012,7 +1013,7 @@ namespace ParaEngine
 		{
 			for (auto& item : m_nodes)
 			{
-				BMaxNode* node = item.second.get();
+				BMaxNode* node = item.get();
 				if (!node->isSolid() && node->GetParaXModel() == 0)
 				{
 					// for stairs, slabs, buttons, etc
@@ -1669,7 +1670,7 @@ namespace ParaEngine
 		// pass 3: from remaining blocks, calculate blocks which are connected to other binded blocks, but with different colors to those blocks.
 		for (auto& item : m_nodes)
 		{
-			CalculateBoneWeightFromNeighbours(item.second.get());
+			CalculateBoneWeightFromNeighbours(item.get());
 		}
 	}
 
@@ -4,6 +4,7 @@
 #include "BMaxFrameNode.h"
 #include "ParaXModel/ParaXModel.h"
 #include "Rectangle.h"
+#include "BMaxNodeGrid.h"
 
 #include <unordered_map>
 
@@ -52,6 +53,9 @@ namespace ParaEngine
 		void SetMergeCoplanerBlockFace(bool val);
 
 		void Load(const char* pBuffer, int32 nSize);
+
+		/** whether the model references other model files, such as *.x or *.bmax. It is only valid after Load(). */
+		bool HasRefModels() const { return !m_refModels.empty(); }
 	protected:
 		/** check if the given filename belongs to one of its parent's filename*/
 		bool IsFileNameRecursiveLoaded(const std::string& filename);
@@ -86,14 +90,11 @@ namespace ParaEngine
 
 		inline BMaxNode* GetNode(uint16 x, uint16 y, uint16 z)
 		{
-			uint64 index = GetNodeIndex(x, y, z);
-			auto iter = m_nodes.find(index);
-			return (iter != m_nodes.end()) ? iter->second.get() : NULL;
+			return m_nodes.Get(x, y, z);
 		}
 		inline BMaxNode* GetNodeByIndex(int64 index)
 		{
-			auto iter = m_nodes.find(index);
-			return (iter != m_nodes.end()) ? iter->second.get() : NULL;
+			return m_nodes.GetByIndex(index);
 		}
 		/** return node index*/
 		int64 InsertNode(BMaxNodePtr& nodePtr);
@@ -164,8 +165,8 @@ namespace ParaEngine
 		BMaxParser* m_pParent;
 		std::string m_filename;
 		std::vector<BlockModel*> m_blockModels;
-		std::unordered_map<uint64, BMaxNodePtr> m_nodes;
-		//std::map<uint64, BMaxNodePtr> m_nodes;
+		/** all nodes, in a dense voxel grid whose origin is the min corner of m_blockAABB */
+		BMaxNodeGrid m_nodes;
 		std::map<std::string, ref_ptr<CParaXModel> > m_refModels;
 		/*std::vector<RectanglePtr>m_originRectangles;
 		std::map<uint16, vector<RectanglePtr>>m_lodRectangles;*/
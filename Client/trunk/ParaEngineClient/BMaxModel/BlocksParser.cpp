@@ -220,7 +220,7 @@ namespace ParaEngine
 	{
 		for (auto& item : m_nodes)
 		{
-			BMaxNode* node = item.second.get();
+			BMaxNode* node = item.get();
 			if (node != NULL)
 			{
 				BlockModel* tessellatedModel = new BlockModel();
@@ -256,7 +256,7 @@ namespace ParaEngine
 		blockRectangles.clear();
 		for (auto& item : m_nodes)
 		{
-			BMaxNode *node = item.second.get();
+			BMaxNode *node = item.get();
 			auto block_template = BlockWorldClient::GetInstance()->GetBlockTemplate(node->template_id);
 			if (block_template != nullptr)
 				blockTextures[node->template_id] = block_template->GetTexture0(node->block_data);
@@ -12,15 +12,20 @@
 #include "BlockChunk.h"
 
 #define INVALID_BLOCK_INDEX		0xffff
+/** max number of block changes kept per chunk for delta sync */
+#define MAX_CHUNK_CHANGE_LOG	256
 
 namespace ParaEngine
 {
 	int BlockChunk::s_total_chunks = 0;
+	std::atomic<uint32> BlockChunk::s_nLastVersion(0);
 
 	BlockChunk::BlockChunk(uint16_t nPackedChunkId, BlockRegion* pRegion) : 
 		m_blockIndices(BlockConfig::g_chunkBlockCount, -1), m_nDirty(1), m_emptyBlockSlotIndex(INVALID_BLOCK_INDEX),
 		m_ownerBlockRegion(pRegion), m_packedChunkID(nPackedChunkId), m_isBoundaryChunk(0)
 	{
+		// changes before the chunk is created are unknown
+		m_nVersion = m_nChangeLogStartVersion = NextVersion();
 		// m_blocks.reserve(4096);
 		SetLightingInitialized(false);
 		UnpackChunkIndex(m_packedChunkID,m_chunkId_rs.x,m_chunkId_rs.y,m_chunkId_rs.z);
@@ -61,6 +66,45 @@ namespace ParaEngine
 		SetLightingInitialized(false);
 		m_emptyBlockSlotIndex = INVALID_BLOCK_INDEX;
 		std::fill(m_lightmapArray.begin(),m_lightmapArray.end(),LightData());
+		m_changeLog.clear();
+		m_nVersion = m_nChangeLogStartVersion = NextVersion();
+	}
+
+	uint32 BlockChunk::NextVersion()
+	{
+		return ++s_nLastVersion;
+	}
+
+	uint32 BlockChunk::GetLastVersion()
+	{
+		return s_nLastVersion;
+	}
+
+	void BlockChunk::MarkBlockModified(uint16_t nBlockIndex)
+	{
+		if (m_changeLog.size() >= MAX_CHUNK_CHANGE_LOG)
+		{
+			// drop the older half
+			int nDropCount = MAX_CHUNK_CHANGE_LOG / 2;
+			m_nChangeLogStartVersion = m_changeLog[nDropCount - 1].m_nVersion;
+			m_changeLog.erase(m_changeLog.begin(), m_changeLog.begin() + nDropCount);
+		}
+		m_nVersion = NextVersion();
+		m_changeLog.push_back(BlockChangeRecord(m_nVersion, nBlockIndex));
+	}
+
+	bool BlockChunk::GetChangedBlocks(uint32 nVersion, std::vector<uint16_t>& blockIndices)
+	{
+		blockIndices.clear();
+		if (nVersion < m_nChangeLogStartVersion || nVersion > s_nLastVersion)
+			return false;
+		for (int i = (int)m_changeLog.size() - 1; i >= 0 && m_changeLog[i].m_nVersion > nVersion; --i)
+		{
+			blockIndices.push_back(m_changeLog[i].m_nBlockIndex);
+		}
+		std::sort(blockIndices.begin(), blockIndices.end());
+		blockIndices.erase(std::unique(blockIndices.begin(), blockIndices.end()), blockIndices.end());
+		return true;
 	}
 
 	void BlockChunk::ClearAllLight()
@@ -798,7 +842,7 @@ namespace ParaEngine
 
 	int BlockChunk::GetTotalBytes()
 	{
-		return (sizeof(BlockChunk) + (sizeof(LightData) + sizeof(int16))*(16 * 16 * 16)) + sizeof(Block) * GetBlockCount() + sizeof(uint16) * m_lightBlockIndices.size();
+		return (sizeof(BlockChunk) + (sizeof(LightData) + sizeof(int16))*(16 * 16 * 16)) + sizeof(Block) * GetBlockCount() + sizeof(uint16) * m_lightBlockIndices.size() + sizeof(BlockChangeRecord) * m_changeLog.capacity();
 	}
 	
 	void LightData::SetBrightness( uint8_t value,bool isSunLight )
@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <set>
+#include <atomic>
 #include "BlockTemplate.h"
 
 namespace ParaEngine
@@ -134,6 +135,14 @@ namespace ParaEngine
 		uint8 m_value;
 	};
 
+	/** one block change in the change log of a chunk */
+	struct BlockChangeRecord
+	{
+		BlockChangeRecord(uint32 nVersion, uint16 nBlockIndex) :m_nVersion(nVersion), m_nBlockIndex(nBlockIndex){}
+		uint32 m_nVersion;
+		uint16 m_nBlockIndex;
+	};
+
 	/** Chunk is a 16*16*16 inside a region */
 	class BlockChunk
 	{
@@ -156,6 +165,9 @@ namespace ParaEngine
 
 		/** total number of chunks */
 		static int s_total_chunks;
+		/** last modification version issued to any chunk. versions are never reused in the process.
+		* atomic, since chunks are also created on the region loading thread. */
+		static std::atomic<uint32> s_nLastVersion;
 	protected:
 		// blocks pool that grows automatically as new blocks are added, removed. 
 		std::vector<Block> m_blocks;
@@ -164,6 +176,12 @@ namespace ParaEngine
 		uint16 m_emptyBlockSlotIndex;
 		BlockRegion*  m_ownerBlockRegion;
 		int16_t m_packedChunkID;
+		/** version of the last block change in this chunk */
+		uint32 m_nVersion;
+		/** changes of versions in (m_nChangeLogStartVersion, m_nVersion] are all in m_changeLog. */
+		uint32 m_nChangeLogStartVersion;
+		/** recent block changes in version order. oldest ones are dropped when it is full. */
+		std::vector<BlockChangeRecord> m_changeLog;
 
 		inline bool IsBoundaryChunk() const { return m_isBoundaryChunk>0; }
 		void SetBoundaryChunk(bool val) { m_isBoundaryChunk = val ? 1:0; }
@@ -179,6 +197,26 @@ namespace ParaEngine
 
 		static int GetTotalChunksInMemory();
 
+		/** issue a new modification version. */
+		static uint32 NextVersion();
+		/** the last modification version issued to any chunk */
+		static uint32 GetLastVersion();
+
+		/** version of the last block change in this chunk. */
+		inline uint32 GetVersion() const { return m_nVersion; }
+
+		/** record a block change, so that it can be sent as delta to clients that have older versions. 
+		* it is called by the region whenever the block template or data is changed at run time, but not at load time. 
+		*/
+		void MarkBlockModified(uint16_t nBlockIndex);
+
+		/** get blocks that are changed after the given version.
+		* @param nVersion: version that the caller is known to be synced with.
+		* @param blockIndices: [out] sorted unique block indices changed after nVersion.
+		* @return false if the change log does not cover that version, in which case the whole chunk should be sent instead.
+		*/
+		bool GetChangedBlocks(uint32 nVersion, std::vector<uint16_t>& blockIndices);
+
 		// reserve blocks
 		void ReserveBlocks(int nCount);
 
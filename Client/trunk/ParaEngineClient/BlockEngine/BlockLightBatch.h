@@ -0,0 +1,83 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+
+namespace ParaEngine
+{
+	/**
+	* light dirtiness of all blocks changed by one CBlockWorld::SetBlocks() batch.
+	* Each changed block is relit at most once, no matter how many times it is changed in the batch, and chunk columns
+	* with many changed blocks are relit as a whole column, in which case their blocks are not relit one by one.
+	* The block setter must not mark light dirty by itself, see BlockRegion::SetBlockTemplateByIndex(bUpdateLight=false).
+	* It only depends on the standard library, so that it can be tested on its own.
+	*/
+	class BlockLightBatch
+	{
+	public:
+		/** @param nColumnRelightCount: columns with at least so many changed blocks are relit as a whole column. */
+		BlockLightBatch(int nColumnRelightCount) : m_nColumnRelightCount(nColumnRelightCount){};
+
+		/** add a changed block in world space.
+		* @param bSunLight: whether sun light also needs to be updated. */
+		void AddBlock(uint16_t x, uint16_t y, uint16_t z, bool bSunLight)
+		{
+			uint64_t nKey = ((uint64_t)x << 32) | ((uint64_t)y << 16) | z;
+			auto it = m_blockIndex.find(nKey);
+			if (it != m_blockIndex.end())
+			{
+				m_blocks[it->second].m_bSunLight |= bSunLight;
+				return;
+			}
+			m_blockIndex[nKey] = (int)m_blocks.size();
+			LightBlock block = { x, y, z, bSunLight };
+			m_blocks.push_back(block);
+			m_columns[GetColumnKey(x, z)]++;
+		}
+
+		/** number of distinct changed blocks */
+		int GetBlockCount() const { return (int)m_blocks.size(); }
+
+		/** call onColumn(chunkX_ws, chunkZ_ws) for each column that is relit as a whole,
+		* and onBlock(x, y, z, bSunLight) for each remaining block.
+		* @return number of onBlock calls. */
+		template <class ColumnCallback, class BlockCallback>
+		int Flush(ColumnCallback onColumn, BlockCallback onBlock) const
+		{
+			for (auto& column : m_columns)
+			{
+				if (column.second >= m_nColumnRelightCount)
+					onColumn((uint16_t)(column.first >> 16), (uint16_t)(column.first & 0xffff));
+			}
+			int nCount = 0;
+			for (auto& block : m_blocks)
+			{
+				auto it = m_columns.find(GetColumnKey(block.x, block.z));
+				if (it->second < m_nColumnRelightCount)
+				{
+					onBlock(block.x, block.y, block.z, block.m_bSunLight);
+					++nCount;
+				}
+			}
+			return nCount;
+		}
+
+	private:
+		struct LightBlock
+		{
+			uint16_t x, y, z;
+			bool m_bSunLight;
+		};
+		/** packed chunk column of a block, a chunk is 16 blocks wide */
+		static inline uint32_t GetColumnKey(uint16_t x, uint16_t z)
+		{
+			return ((uint32_t)(x >> 4) << 16) | (z >> 4);
+		}
+
+		int m_nColumnRelightCount;
+		std::vector<LightBlock> m_blocks;
+		std::unordered_map<uint64_t, int> m_blockIndex;
+		/** packed chunk column to number of changed blocks in it */
+		std::unordered_map<uint32_t, int> m_columns;
+	};
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+#include <algorithm>
+
+namespace ParaEngine
+{
+	/** 3D DDA helpers of CBlockWorld::Pick. They only depend on plain arrays, so that they can be tested on their own. */
+	namespace BlockRayCast
+	{
+		/** move the 3D DDA state of a ray to the first block outside the given empty cell, without visiting blocks inside it.
+		* @param curBlockId, errDist: [in|out] current block and distance to the next block boundary in each axis.
+		* @param cellMin, cellMax: the empty cell [cellMin, cellMax) that contains curBlockId.
+		* @param side: [out] 0 for x, 2 for z, 4 for y, depending on which face of the cell the ray leaves.
+		* @return distance traveled along the ray when it leaves the cell.
+		*/
+		inline float SkipEmptyCell(int32_t curBlockId[3], const int32_t blockStep[3], float errDist[3], const float delta[3], const int32_t cellMin[3], const int32_t cellMax[3], int32_t& side)
+		{
+			// number of block boundaries inside the cell, and the distance at which the ray crosses the cell face in each axis.
+			int32_t nSteps[3];
+			float exitDist[3];
+			for (int i = 0; i < 3; ++i)
+			{
+				if (delta[i] != 0)
+				{
+					nSteps[i] = (blockStep[i] > 0) ? (cellMax[i] - 1 - curBlockId[i]) : (curBlockId[i] - cellMin[i]);
+					exitDist[i] = errDist[i] + delta[i] * nSteps[i];
+				}
+				else
+				{
+					nSteps[i] = 0;
+					exitDist[i] = errDist[i];
+				}
+			}
+			// same order as the 3D DDA loop when distances are equal
+			int nAxis;
+			if (exitDist[0] < exitDist[1])
+				nAxis = (exitDist[0] < exitDist[2]) ? 0 : 2;
+			else
+				nAxis = (exitDist[1] < exitDist[2]) ? 1 : 2;
+			float distTraveled = exitDist[nAxis];
+
+			for (int i = 0; i < 3; ++i)
+			{
+				if (i == nAxis)
+				{
+					curBlockId[i] += blockStep[i] * (nSteps[i] + 1);
+					errDist[i] = exitDist[i] + delta[i];
+				}
+				else if (delta[i] != 0 && errDist[i] < distTraveled)
+				{
+					// block boundaries crossed in other axis before leaving the cell
+					int32_t nCount = (int32_t)ceilf((distTraveled - errDist[i]) / delta[i]);
+					nCount = (std::min)((std::max)(nCount, 0), nSteps[i]);
+					curBlockId[i] += blockStep[i] * nCount;
+					errDist[i] += delta[i] * nCount;
+				}
+			}
+			side = (nAxis == 0) ? 0 : ((nAxis == 1) ? 4 : 2);
+			return distTraveled;
+		}
+	}
+}
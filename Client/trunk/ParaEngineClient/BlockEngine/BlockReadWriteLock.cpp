@@ -7,6 +7,7 @@
 //-----------------------------------------------------------------------------
 #include "ParaEngine.h"
 #include "os_calls.h"
+#include "util/ParaTime.h"
 #include "BlockReadWriteLock.h"
 
 using namespace ParaEngine;
@@ -32,15 +33,17 @@ void ParaEngine::BlockReadWriteLock::BeginRead()
 			return;
 		}
 			
-
+		int64 nWaitStartTime = CTraceProfiler::IsEnabled() ? GetTimeUS() : 0;
 		while (true) {
 			// wait notification. 
 			m_reader_signal.wait(Lock_);
 			// check again if we can read
 			// we will favor writer. when read must wait until all writers are released. 
 			if (StartReadFromWaitingReader())
-				return;
+				break;
 		}
+		if (nWaitStartTime != 0)
+			CTraceProfiler::GetInstance().AddEvent("BlockLock.ReadWait", "lock", nWaitStartTime, GetTimeUS() - nWaitStartTime);
 	}
 }
 
@@ -86,6 +89,7 @@ void ParaEngine::BlockReadWriteLock::BeginWrite(size_t nWriterId /*= 0*/)
 	// check write access     
 	if (!StartWriteFromNewWriter(nWriterId))
 	{
+		int64 nWaitStartTime = CTraceProfiler::IsEnabled() ? GetTimeUS() : 0;
 		while (true)
 		{
 			m_writer_signal.wait(Lock_);
@@ -94,6 +98,8 @@ void ParaEngine::BlockReadWriteLock::BeginWrite(size_t nWriterId /*= 0*/)
 				break;
 			}
 		}
+		if (nWaitStartTime != 0)
+			CTraceProfiler::GetInstance().AddEvent("BlockLock.WriteWait", "lock", nWaitStartTime, GetTimeUS() - nWaitStartTime);
 	}
 	m_writelock_recursive_depth = 1;
 }
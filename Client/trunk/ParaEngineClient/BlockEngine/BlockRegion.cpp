@@ -34,6 +34,7 @@ namespace ParaEngine
 	{
 		m_regionX = regionX;
 		m_regionZ = regionZ;
+		m_nVersionBase = BlockChunk::NextVersion();
 
 		m_minChunkId_ws.x = m_regionX * BlockConfig::g_regionChunkDimX;
 		m_minChunkId_ws.y = 0;
@@ -62,6 +63,8 @@ namespace ParaEngine
 		// m_biomes.resize(BlockConfig::g_regionBlockDimX * BlockConfig::g_regionBlockDimZ, 0);
 
 		m_chunkTimestamp.resize(BlockConfig::g_regionChunkDimX * BlockConfig::g_regionChunkDimZ, 0);
+		m_chunkColumnMask.resize(BlockConfig::g_regionChunkDimX * BlockConfig::g_regionChunkDimZ, 0);
+		m_nChunkCount = 0;
 	}
 
 	int BlockRegion::GetChunksCount()
@@ -89,6 +92,8 @@ namespace ParaEngine
 		{
 			pChunk = new BlockChunk(chunkID, this);
 			m_chunks[chunkID] = pChunk;
+			m_chunkColumnMask[pChunk->m_chunkId_rs.x + pChunk->m_chunkId_rs.z * BlockConfig::g_regionChunkDimX] |= (1 << pChunk->m_chunkId_rs.y);
+			++m_nChunkCount;
 		}
 		return pChunk;
 	}
@@ -196,7 +201,7 @@ namespace ParaEngine
 		}
 	}
 
-	void BlockRegion::SetBlockTemplateByIndex(uint16_t blockX_rs, uint16_t blockY_rs, uint16_t blockZ_rs, BlockTemplate* pTemplate)
+	void BlockRegion::SetBlockTemplateByIndex(uint16_t blockX_rs, uint16_t blockY_rs, uint16_t blockZ_rs, BlockTemplate* pTemplate, bool bUpdateLight)
 	{
 		if (IsLocked())
 			return;
@@ -221,6 +226,7 @@ namespace ParaEngine
 		{
 			if (SetBlockToAir(packedChunkId_rs, blockId_rs))
 			{
+				m_chunks[packedChunkId_rs]->MarkBlockModified(CalcPackedBlockID(blockId_rs));
 				//if(!bLightSuspended)
 				{
 					SetModified();
@@ -231,8 +237,11 @@ namespace ParaEngine
 					blockId_rs.x += m_minBlockId_ws.x;
 					blockId_rs.z += m_minBlockId_ws.z;
 
-					m_pBlockWorld->SetLightBlockDirty(blockId_rs, false);
-					m_pBlockWorld->SetLightBlockDirty(blockId_rs, true);
+					if (bUpdateLight)
+					{
+						m_pBlockWorld->SetLightBlockDirty(blockId_rs, false);
+						m_pBlockWorld->SetLightBlockDirty(blockId_rs, true);
+					}
 					m_pBlockWorld->DeselectBlock(blockId_rs.x, blockId_rs.y, blockId_rs.z);
 				}
 			}
@@ -253,6 +262,7 @@ namespace ParaEngine
 					bool curIsLight = pTemplate->IsMatchAttribute(BlockTemplate::batt_light);
 
 					pChunk->SetBlock(nBlockIndex, pTemplate, 0);
+					pChunk->MarkBlockModified(nBlockIndex);
 					SetModified();
 					SetChunkDirty(packedChunkId_rs, true);
 					CheckNeighborChunkDirty(blockId_rs);
@@ -271,7 +281,7 @@ namespace ParaEngine
 					blockId_rs.x += m_minBlockId_ws.x;
 					blockId_rs.z += m_minBlockId_ws.z;
 
-					if (!bLightSuspended)
+					if (!bLightSuspended && bUpdateLight)
 					{
 						if (curIsLight)
 						{
@@ -451,6 +461,9 @@ namespace ParaEngine
 			if (pChunk)
 			{
 				uint16 nBlockIndex = CalcPackedBlockID(x, y, z);
+				Block* pBlock = pChunk->GetBlock(nBlockIndex);
+				if (pBlock && pBlock->GetUserData() != data)
+					pChunk->MarkBlockModified(nBlockIndex);
 				pChunk->SetBlockData(nBlockIndex, data);
 				SetModified();
 				BlockTemplate* pTemplate = pChunk->GetBlockTemplate(nBlockIndex);
@@ -920,28 +933,28 @@ namespace ParaEngine
 
 	void BlockRegion::SaveToFile()
 	{
-		if (IsLocked())
-			return;
-		Scoped_WriteLock<BlockReadWriteLock> lock_(m_pBlockWorld->GetReadWriteLock());
+		std::string data;
+		std::string fileName;
+		{
+			Scoped_WriteLock<BlockReadWriteLock> lock_(m_pBlockWorld->GetReadWriteLock());
+			if (!SaveToBuffer(data))
+				return;
+			fileName = m_pBlockWorld->GetWorldInfo().GetBlockRegionFileName(m_regionX, m_regionZ, true);
+		}
+		if (WriteRegionFile(fileName, data))
+			GetBlockWorld()->OnSaveBlockRegion(m_regionX, m_regionZ);
+	}
 
-		if (!IsModified())
-			return;
+	bool BlockRegion::SaveToBuffer(std::string& output)
+	{
+		if (IsLocked() || !IsModified())
+			return false;
 
 		SetModified(false);
 
-		std::string fileName = m_pBlockWorld->GetWorldInfo().GetBlockRegionFileName(m_regionX, m_regionZ, true);
-		CParaFile cfile, memFile;
-
-		if (cfile.CreateNewFile(fileName.c_str(), true) && memFile.OpenFile("<memory>", false))
+		CParaFile memFile;
+		if (memFile.OpenFile("<memory>", false))
 		{
-			//'b'<<24 + 'l'<<16 + 'o'<<8 + 'c' + 1;
-			uint32_t fileTypeId = 0x626c6f63 + 1;
-			cfile.WriteDWORD(fileTypeId);
-
-			//version 1.00
-			uint16_t version = 0x0100;
-			cfile.WriteWORD(version);
-
 			uint32_t regionId = (m_regionX << 16) + m_regionZ;
 			memFile.WriteDWORD(regionId);
 
@@ -1157,71 +1170,74 @@ namespace ParaEngine
 				}
 			}
 			auto pStringBuilder = static_cast<StringBuilder*>(memFile.GetHandlePtr());
+			output.assign(pStringBuilder->str(), pStringBuilder->size());
+			memFile.close();
+			return true;
+		}
+		return false;
+	}
 
-			// save compressed data
-			do
-			{
-				auto uncompressedSize = pStringBuilder->size();
+	bool BlockRegion::WriteRegionFile(const std::string& fileName, const std::string& data)
+	{
+		// write to a temp file first, so that a crash during save never leaves a half written region file.
+		std::string tempFileName = fileName + ".tmp";
+		CParaFile cfile;
+		if (!cfile.CreateNewFile(tempFileName.c_str(), true))
+			return false;
 
-				// 
-				if (uncompressedSize > 1024)
-				{
-					char* compressedData = new char[uncompressedSize];
-					size_t compressedSize = 0;
+		//'b'<<24 + 'l'<<16 + 'o'<<8 + 'c' + 1;
+		uint32_t fileTypeId = 0x626c6f63 + 1;
+		cfile.WriteDWORD(fileTypeId);
 
-					z_stream stream;
-					stream.next_in = (Bytef*)pStringBuilder->str();
-					stream.avail_in = (uInt)uncompressedSize;
+		//version 1.00
+		uint16_t version = 0x0100;
+		cfile.WriteWORD(version);
 
-					stream.next_out = (Bytef*)compressedData;
-					stream.avail_out = (uInt)uncompressedSize;
+		// save compressed data
+		auto uncompressedSize = data.size();
+		bool bCompressed = false;
+		if (uncompressedSize > 1024)
+		{
+			char* compressedData = new char[uncompressedSize];
 
-					stream.zalloc = (alloc_func)0;
-					stream.zfree = (free_func)0;
-					stream.opaque = (voidpf)0;
+			z_stream stream;
+			stream.next_in = (Bytef*)data.c_str();
+			stream.avail_in = (uInt)uncompressedSize;
 
-					int err = deflateInit(&stream, Z_DEFAULT_COMPRESSION);
-					if (err != Z_OK)
-					{
-						OUTPUT_LOG("could not compress data");
-						delete[] compressedData;
-						break;
-					}
+			stream.next_out = (Bytef*)compressedData;
+			stream.avail_out = (uInt)uncompressedSize;
 
-					err = deflate(&stream, Z_FINISH);
-					if (err != Z_STREAM_END)
-					{
-						deflateEnd(&stream);
-
-						OUTPUT_LOG("could not compress data");
-						delete[] compressedData;
-						break;
-					}
-					compressedSize = stream.total_out;
-					deflateEnd(&stream);
+			stream.zalloc = (alloc_func)0;
+			stream.zfree = (free_func)0;
+			stream.opaque = (voidpf)0;
 
+			int err = deflateInit(&stream, Z_DEFAULT_COMPRESSION);
+			if (err == Z_OK)
+			{
+				err = deflate(&stream, Z_FINISH);
+				if (err == Z_STREAM_END)
+				{
+					size_t compressedSize = stream.total_out;
 					cfile.WriteDWORD(uncompressedSize); // uncompressedSize
 					cfile.WriteDWORD(compressedSize); // compressedSize;
 					cfile.write(compressedData, compressedSize);
-
-					delete[] compressedData;
+					bCompressed = true;
 				}
-				else // so small, write uncompressed data
-				{
-					cfile.WriteDWORD(uncompressedSize); // uncompressedSize
-					cfile.WriteDWORD(0); // compressedSize;
-					cfile.write(pStringBuilder->str(), pStringBuilder->size());
-				}
-
-
-			} while (false);
-
-
-			cfile.close();
-			memFile.close();
-
-			GetBlockWorld()->OnSaveBlockRegion(m_regionX, m_regionZ);
+				deflateEnd(&stream);
+			}
+			if (!bCompressed)
+				OUTPUT_LOG("could not compress data");
+			delete[] compressedData;
+		}
+		if (!bCompressed)
+		{
+			// so small or not compressible, write uncompressed data
+			cfile.WriteDWORD(uncompressedSize); // uncompressedSize
+			cfile.WriteDWORD(0); // compressedSize;
+			cfile.write(data.c_str(), data.size());
 		}
+		cfile.close();
+		return CParaFile::MoveFile(tempFileName.c_str(), fileName.c_str());
 	}
 
 	void BlockRegion::ParserFile(CParaFile* pFile)
@@ -1548,6 +1564,9 @@ namespace ParaEngine
 		{
 			SAFE_DELETE(m_chunks[i]);
 		}
+		m_nVersionBase = BlockChunk::NextVersion();
+		std::fill(m_chunkColumnMask.begin(), m_chunkColumnMask.end(), 0);
+		m_nChunkCount = 0;
 		std::fill(m_blockHeightMap.begin(), m_blockHeightMap.end(), ChunkMaxHeight(0, 0));
 
 		std::fill(m_biomes.begin(), m_biomes.end(), 0);
@@ -1607,6 +1626,58 @@ namespace ParaEngine
 		return m_pBlockWorld;
 	}
 
+	/** write block count, followed by same integer encoded block ids and block data of all 4096 blocks in a vertical section. */
+	static void WriteMapChunkSection(StringBuilder& outputStream, BlockChunk* pChunk)
+	{
+		int32 nBlockCount = 0;
+		int nBlockCountIndex = outputStream.size();
+		outputStream.appendBinary((uint32)nBlockCount);
+		CSameIntegerEncoder<uint16_t> blockIdEncoder(&outputStream);
+		CSameIntegerEncoder<uint32_t> blockDataEncoder(&outputStream);
+		if (pChunk)
+		{
+			uint32_t nCount = pChunk->m_blockIndices.size();
+			for (uint32_t i = 0; i < nCount; i++)
+			{
+				int32_t blockIdx = pChunk->m_blockIndices[i];
+				if (blockIdx >= 0)
+				{
+					Block& curBlock = pChunk->GetBlockByIndex(blockIdx);
+					blockIdEncoder.Append(curBlock.GetTemplateId());
+					nBlockCount++;
+				}
+				else
+				{
+					blockIdEncoder.Append(0);
+				}
+			}
+			blockIdEncoder.Finalize();
+
+			for (uint32_t i = 0; i < nCount; i++)
+			{
+				int32_t blockIdx = pChunk->m_blockIndices[i];
+				if (blockIdx >= 0)
+				{
+					Block& curBlock = pChunk->GetBlockByIndex(blockIdx);
+					blockDataEncoder.Append(curBlock.GetUserData());
+				}
+				else
+				{
+					blockDataEncoder.Append(0);
+				}
+			}
+			blockDataEncoder.Finalize();
+		}
+		else
+		{
+			blockIdEncoder.Append(0, 4096);
+			blockIdEncoder.Finalize();
+			blockDataEncoder.Append(0, 4096);
+			blockDataEncoder.Finalize();
+		}
+		outputStream.WriteAt(nBlockCountIndex, nBlockCount);
+	}
+
 	const std::string& BlockRegion::GetMapChunkData(uint32_t chunkX_ws, uint32_t chunkZ_ws, bool bIncludeInit, uint32_t verticalSectionFilter)
 	{
 		uint16_t chunkX_rs = chunkX_ws & 0x1f;
@@ -1620,71 +1691,269 @@ namespace ParaEngine
 		int nChunkSizeLocation = outputStream.size();
 		outputStream.appendBinary((uint32)nChunkSize);
 
-		CSameIntegerEncoder<uint16_t> blockIdEncoder(&outputStream);
-		CSameIntegerEncoder<uint32_t> blockDataEncoder(&outputStream);
 		for (uint16_t y = 0; y < 16; y++)
 		{
 			if ((verticalSectionFilter & (1 << y)) != 0)
 			{
 				outputStream.appendBinary((uint32)y);
-				int32 nBlockCount = 0;
-				int nBlockCountIndex = outputStream.size();
-				outputStream.appendBinary((uint32)nBlockCount);
-				uint16_t startBlockIdY_ws = y << 4;
 				uint16_t packedChunkId_rs = PackChunkIndex(chunkX_rs, y, chunkZ_rs);
-				BlockChunk * pChunk = m_chunks[packedChunkId_rs];
-				if (pChunk)
+				WriteMapChunkSection(outputStream, m_chunks[packedChunkId_rs]);
+			}
+		}
+		outputStream.WriteAt(nChunkSizeLocation, outputStream.length() - nChunkSizeLocation - 4);
+		static std::string g_str;
+		g_str.assign(outputStream.c_str(), outputStream.length());
+		return g_str;
+	}
+
+	uint32 BlockRegion::GetMapChunkVersion(uint32_t chunkX, uint32_t chunkZ)
+	{
+		uint16_t chunkX_rs = chunkX & 0x1f;
+		uint16_t chunkZ_rs = chunkZ & 0x1f;
+		uint32 nVersion = m_nVersionBase;
+		for (uint16_t y = 0; y < 16; y++)
+		{
+			BlockChunk* pChunk = m_chunks[PackChunkIndex(chunkX_rs, y, chunkZ_rs)];
+			if (pChunk && pChunk->GetVersion() > nVersion)
+				nVersion = pChunk->GetVersion();
+		}
+		return nVersion;
+	}
+
+	const std::string& BlockRegion::GetMapChunkDelta(uint32_t chunkX, uint32_t chunkZ, uint32 nLastVersion, uint32_t verticalSectionFilter)
+	{
+		uint16_t chunkX_rs = chunkX & 0x1f;
+		uint16_t chunkZ_rs = chunkZ & 0x1f;
+
+		static StringBuilder outputStream;
+		static std::vector<uint16_t> sBlockIndices;
+		outputStream.clear();
+		// append version format
+		outputStream.append("chunkD1");
+		uint32_t nChunkSize = 0;
+		int nChunkSizeLocation = outputStream.size();
+		outputStream.appendBinary((uint32)nChunkSize);
+
+		// a version from the future, such as before server restart, can not be trusted.
+		bool bIsVersionValid = nLastVersion >= m_nVersionBase && nLastVersion <= BlockChunk::GetLastVersion();
+		for (uint16_t y = 0; y < 16; y++)
+		{
+			if ((verticalSectionFilter & (1 << y)) != 0)
+			{
+				BlockChunk* pChunk = m_chunks[PackChunkIndex(chunkX_rs, y, chunkZ_rs)];
+				if (bIsVersionValid && (pChunk == NULL || nLastVersion >= pChunk->GetVersion()))
 				{
-					blockIdEncoder.Reset();
-					uint32_t nCount = pChunk->m_blockIndices.size();
-					for (uint32_t i = 0; i < nCount; i++)
+					// not changed
+					continue;
+				}
+				outputStream.appendBinary((uint32)y);
+				if (bIsVersionValid && pChunk->GetChangedBlocks(nLastVersion, sBlockIndices))
+				{
+					outputStream.appendBinary((uint32)sBlockIndices.size());
+					for (uint16_t nBlockIndex : sBlockIndices)
 					{
-						int32_t blockIdx = pChunk->m_blockIndices[i];
-						if (blockIdx >= 0)
-						{
-							Block& curBlock = pChunk->GetBlockByIndex(blockIdx);
-							blockIdEncoder.Append(curBlock.GetTemplateId());
-							nBlockCount++;
-						}
-						else
-						{
-							blockIdEncoder.Append(0);
-						}
+						Block* pBlock = pChunk->GetBlock(nBlockIndex);
+						outputStream.appendBinary((uint16)nBlockIndex);
+						outputStream.appendBinary((uint16)(pBlock ? pBlock->GetTemplateId() : 0));
+						outputStream.appendBinary((uint32)(pBlock ? pBlock->GetUserData() : 0));
 					}
-					blockIdEncoder.Finalize();
+				}
+				else
+				{
+					// the whole section
+					outputStream.appendBinary((uint32)0xffffffff);
+					WriteMapChunkSection(outputStream, pChunk);
+				}
+			}
+		}
+		outputStream.WriteAt(nChunkSizeLocation, outputStream.length() - nChunkSizeLocation - 4);
+		static std::string g_str;
+		g_str.assign(outputStream.c_str(), outputStream.length());
+		return g_str;
+	}
 
-					blockDataEncoder.Reset();
-					for (uint32_t i = 0; i < nCount; i++)
+	void BlockRegion::ApplyMapChunkDelta(uint32_t chunkX, uint32_t chunkZ, const std::string& chunkData, const luabind::adl::object& output)
+	{
+		uint16_t chunkX_rs = chunkX & 0x1f;
+		uint16_t chunkZ_rs = chunkZ & 0x1f;
+
+		CParaFile file((char*)(chunkData.c_str()), chunkData.size(), false);
+		char sVersion[8];
+		file.read(sVersion, 7);
+		sVersion[7] = '\0';
+		if (strcmp(sVersion, "chunkD1") != 0)
+		{
+			OUTPUT_LOG("error: ApplyMapChunkDelta got unknown format.\n");
+			return;
+		}
+		static std::vector<uint16_t> sBlockId(4096);
+		static std::vector<uint32_t> sBlockData(4096);
+
+		lua_State* L = output.interpreter();
+		luabind::adl::object removeQueue = luabind::newtable(L);
+		output["remove"] = removeQueue;
+		luabind::adl::object addQueue = luabind::newtable(L);
+		output["add"] = addQueue;
+		luabind::adl::object addDataQueue = luabind::newtable(L);
+		output["addData"] = addDataQueue;
+		luabind::adl::object modDataQueue = luabind::newtable(L);
+		output["modData"] = modDataQueue;
+
+		// skip chunk size
+		file.ReadDWORD();
+		while (!file.isEof())
+		{
+			uint32_t chunkY_rs = (uint32_t)file.ReadDWORD();
+			if (chunkY_rs >= 16)
+				break;
+			uint32_t nChangeCount = (uint32_t)file.ReadDWORD();
+			// chunks are only created for the first non-air block, so that empty sections do not allocate chunks.
+			uint16_t nPackedChunkId = PackChunkIndex(chunkX_rs, chunkY_rs, chunkZ_rs);
+			BlockChunk * pChunk = GetChunk(nPackedChunkId, false);
+			if (nChangeCount == 0xffffffff)
+			{
+				// the whole section
+				uint32_t nBlockCount = (uint32_t)file.ReadDWORD();
+				sBlockId.clear();
+				sBlockData.clear();
+				CSameIntegerDecoder<uint16_t>::DecodeSameIntegerOfCount(file, sBlockId, 4096);
+				CSameIntegerDecoder<uint32_t>::DecodeSameIntegerOfCount(file, sBlockData, 4096);
+				if ((pChunk || nBlockCount > 0) && sBlockId.size() == 4096 && sBlockData.size() == 4096)
+				{
+					for (uint32_t i = 0; i < 4096; i++)
 					{
-						int32_t blockIdx = pChunk->m_blockIndices[i];
-						if (blockIdx >= 0)
+						if (pChunk == NULL && sBlockId[i] != 0)
+							pChunk = GetChunk(nPackedChunkId, true);
+						if (pChunk)
+							ApplyMapChunkBlock(pChunk, chunkY_rs, i, sBlockId[i], sBlockData[i], removeQueue, addQueue, addDataQueue, modDataQueue);
+					}
+				}
+			}
+			else
+			{
+				for (uint32_t i = 0; i < nChangeCount && !file.isEof(); i++)
+				{
+					uint16_t nBlockIndex = file.ReadWORD();
+					uint16_t blockId = file.ReadWORD();
+					uint32_t blockData = (uint32_t)file.ReadDWORD();
+					if (pChunk == NULL && blockId != 0)
+						pChunk = GetChunk(nPackedChunkId, true);
+					if (pChunk && nBlockIndex < 4096)
+						ApplyMapChunkBlock(pChunk, chunkY_rs, nBlockIndex, blockId, blockData, removeQueue, addQueue, addDataQueue, modDataQueue);
+				}
+			}
+		}
+	}
+
+	bool BlockRegion::ApplyMapChunkBlock(BlockChunk* pChunk, uint16_t chunkY_rs, uint16_t i, uint16_t blockId, uint32_t blockData,
+		luabind::adl::object& removeQueue, luabind::adl::object& addQueue, luabind::adl::object& addDataQueue, luabind::adl::object& modDataQueue)
+	{
+		bool bModified = false;
+		uint16_t chunkX_ws = (pChunk->m_chunkId_rs.x << 4);
+		uint16_t chunkY_ws = (chunkY_rs << 4);
+		uint16_t chunkZ_ws = (pChunk->m_chunkId_rs.z << 4);
+		int32_t blockIdx = pChunk->m_blockIndices[i];
+		if (blockId == 0)
+		{
+			if (blockIdx >= 0)
+			{
+				// delete old block
+				Block& curBlock = pChunk->GetBlockByIndex(blockIdx);
+				if (curBlock.GetTemplate() && curBlock.GetTemplate()->IsMatchAttribute(BlockTemplate::batt_onload))
+				{
+					removeQueue[i * 16 + chunkY_rs] = curBlock.GetTemplateId();
+				}
+
+				uint16_t blockX, blockY, blockZ;
+				UnpackBlockIndex(i, blockX, blockY, blockZ);
+				uint16_t regionBlockX = chunkX_ws + blockX;
+				uint16_t regionBlockY = chunkY_ws + blockY;
+				uint16_t regionBlockZ = chunkZ_ws + blockZ;
+				SetBlockTemplateByIndex(regionBlockX, regionBlockY, regionBlockZ, NULL);
+				bModified = true;
+			}
+		}
+		else
+		{
+			if (blockIdx >= 0)
+			{
+				Block& curBlock = pChunk->GetBlockByIndex(blockIdx);
+				bool bSameBlockId = curBlock.GetTemplateId() == blockId;
+				bool bSameBlockData = curBlock.GetUserData() == blockData;
+				if (!bSameBlockId || !bSameBlockData)
+				{
+					bModified = true;
+					BlockTemplate* pTemplate = GetBlockWorld()->GetBlockTemplate(blockId);
+					if (pTemplate)
+					{
+						uint16_t blockX, blockY, blockZ;
+						UnpackBlockIndex(i, blockX, blockY, blockZ);
+						uint16_t regionBlockX = chunkX_ws + blockX;
+						uint16_t regionBlockY = chunkY_ws + blockY;
+						uint16_t regionBlockZ = chunkZ_ws + blockZ;
+
+						if (!bSameBlockId)
 						{
-							Block& curBlock = pChunk->GetBlockByIndex(blockIdx);
-							blockDataEncoder.Append(curBlock.GetUserData());
+							if (curBlock.GetTemplate())
+							{
+								if (curBlock.GetTemplate()->IsMatchAttribute(BlockTemplate::batt_onload))
+								{
+									removeQueue[i * 16 + chunkY_rs] = curBlock.GetTemplateId();
+									if (pTemplate->IsMatchAttribute(BlockTemplate::batt_onload))
+									{
+										addQueue[i * 16 + chunkY_rs] = blockId;
+										if (blockData != 0)
+											addDataQueue[i * 16 + chunkY_rs] = blockData;
+									}
+								}
+							}
+							else
+							{
+								OUTPUT_LOG("fatal error: apply chunk to invalid index\n");
+							}
+							SetBlockTemplateByIndex(regionBlockX, regionBlockY, regionBlockZ, pTemplate);
+							SetBlockUserDataByIndex(regionBlockX, regionBlockY, regionBlockZ, blockData);
 						}
 						else
 						{
-							blockDataEncoder.Append(0);
+							if (!bSameBlockData)
+							{
+								modDataQueue[i * 16 + chunkY_rs] = blockData;
+								SetBlockUserDataByIndex(regionBlockX, regionBlockY, regionBlockZ, blockData);
+							}
 						}
 					}
-					blockDataEncoder.Finalize();
 				}
-				else
+			}
+			else
+			{
+				// create the new block at given index
+				BlockTemplate* pTemplate = GetBlockWorld()->GetBlockTemplate(blockId);
+				if (pTemplate)
 				{
-					blockIdEncoder.Reset();
-					blockIdEncoder.Append(0, 4096);
-					blockIdEncoder.Finalize();
-					blockDataEncoder.Reset();
-					blockDataEncoder.Append(0, 4096);
-					blockDataEncoder.Finalize();
+					bModified = true;
+					if (pTemplate->IsMatchAttribute(BlockTemplate::batt_onload))
+					{
+						addQueue[i * 16 + chunkY_rs] = blockId;
+						if (blockData != 0)
+						{
+							addDataQueue[i * 16 + chunkY_rs] = blockData;
+						}
+					}
+					uint16_t blockX, blockY, blockZ;
+					UnpackBlockIndex(i, blockX, blockY, blockZ);
+					uint16_t regionBlockX = chunkX_ws + blockX;
+					uint16_t regionBlockY = chunkY_ws + blockY;
+					uint16_t regionBlockZ = chunkZ_ws + blockZ;
+					SetBlockTemplateByIndex(regionBlockX, regionBlockY, regionBlockZ, pTemplate);
+					if (blockData != 0)
+					{
+						SetBlockUserDataByIndex(regionBlockX, regionBlockY, regionBlockZ, blockData);
+					}
 				}
-				outputStream.WriteAt(nBlockCountIndex, nBlockCount);
 			}
 		}
-		outputStream.WriteAt(nChunkSizeLocation, outputStream.length() - nChunkSizeLocation - 4);
-		static std::string g_str;
-		g_str.assign(outputStream.c_str(), outputStream.length());
-		return g_str;
+		return bModified;
 	}
 
 	void BlockRegion::ApplyMapChunkData(uint32_t chunkX, uint32_t chunkZ, uint32_t verticalSectionFilter, const std::string& chunkData, const luabind::adl::object& output)
@@ -1764,112 +2033,10 @@ namespace ParaEngine
 						else if (pChunk)
 						{
 							uint32_t nCount = pChunk->m_blockIndices.size();
-							uint16_t chunkX_ws = (chunkX_rs << 4);
-							uint16_t chunkY_ws = (chunkY_rs << 4);
-							uint16_t chunkZ_ws = (chunkZ_rs << 4);
 							for (uint32_t i = 0; i < nCount; i++)
 							{
-								int32_t blockIdx = pChunk->m_blockIndices[i];
-								if (sBlockId[i] == 0)
-								{
-									if (blockIdx >= 0)
-									{
-										// delete old block
-										Block& curBlock = pChunk->GetBlockByIndex(blockIdx);
-										if (curBlock.GetTemplate() && curBlock.GetTemplate()->IsMatchAttribute(BlockTemplate::batt_onload))
-										{
-											removeQueue[i * 16 + chunkY_rs] = curBlock.GetTemplateId();
-										}
-
-										uint16_t blockX, blockY, blockZ;
-										UnpackBlockIndex(i, blockX, blockY, blockZ);
-										uint16_t regionBlockX = chunkX_ws + blockX;
-										uint16_t regionBlockY = chunkY_ws + blockY;
-										uint16_t regionBlockZ = chunkZ_ws + blockZ;
-										SetBlockTemplateByIndex(regionBlockX, regionBlockY, regionBlockZ, NULL);
-										nModifiedCount++;
-									}
-								}
-								else
-								{
-									if (blockIdx >= 0)
-									{
-										Block& curBlock = pChunk->GetBlockByIndex(blockIdx);
-										bool bSameBlockId = curBlock.GetTemplateId() == sBlockId[i];
-										bool bSameBlockData = curBlock.GetUserData() == sBlockData[i];
-										if (!bSameBlockId || !bSameBlockData)
-										{
-											nModifiedCount++;
-											BlockTemplate* pTemplate = GetBlockWorld()->GetBlockTemplate(sBlockId[i]);
-											if (pTemplate)
-											{
-												uint16_t blockX, blockY, blockZ;
-												UnpackBlockIndex(i, blockX, blockY, blockZ);
-												uint16_t regionBlockX = chunkX_ws + blockX;
-												uint16_t regionBlockY = chunkY_ws + blockY;
-												uint16_t regionBlockZ = chunkZ_ws + blockZ;
-
-												if (!bSameBlockId)
-												{
-													if (curBlock.GetTemplate())
-													{
-														if (curBlock.GetTemplate()->IsMatchAttribute(BlockTemplate::batt_onload))
-														{
-															removeQueue[i * 16 + chunkY_rs] = curBlock.GetTemplateId();
-															if (pTemplate->IsMatchAttribute(BlockTemplate::batt_onload))
-															{
-																addQueue[i * 16 + chunkY_rs] = sBlockId[i];
-																if (sBlockData[i] != 0)
-																	addDataQueue[i * 16 + chunkY_rs] = sBlockData[i];
-															}
-														}
-													}
-													else
-													{
-														OUTPUT_LOG("fatal error: apply chunk to invalid index\n");
-													}
-													SetBlockTemplateByIndex(regionBlockX, regionBlockY, regionBlockZ, pTemplate);
-													SetBlockUserDataByIndex(regionBlockX, regionBlockY, regionBlockZ, sBlockData[i]);
-												}
-												else
-												{
-													if (!bSameBlockData)
-													{
-														modDataQueue[i * 16 + chunkY_rs] = sBlockData[i];
-														SetBlockUserDataByIndex(regionBlockX, regionBlockY, regionBlockZ, sBlockData[i]);
-													}
-												}
-											}
-										}
-									}
-									else
-									{
-										// create the new block at given index
-										BlockTemplate* pTemplate = GetBlockWorld()->GetBlockTemplate(sBlockId[i]);
-										if (pTemplate)
-										{
-											nModifiedCount++;
-											if (pTemplate->IsMatchAttribute(BlockTemplate::batt_onload))
-											{
-												addQueue[i * 16 + chunkY_rs] = sBlockId[i];
-												if (sBlockData[i] != 0)
-												{
-													addDataQueue[i * 16 + chunkY_rs] = sBlockData[i];
-												}
-											}
-											uint16_t blockX, blockY, blockZ;
-											UnpackBlockIndex(i, blockX, blockY, blockZ);
-											uint16_t regionBlockX = chunkX_ws + blockX;
-											uint16_t regionBlockY = chunkY_ws + blockY;
-											uint16_t regionBlockZ = chunkZ_ws + blockZ;
-											SetBlockTemplateByIndex(regionBlockX, regionBlockY, regionBlockZ, pTemplate);
-											if (sBlockData[i] != 0)
-											{
-												SetBlockUserDataByIndex(regionBlockX, regionBlockY, regionBlockZ, sBlockData[i]);
-											}
-										}
-									}
-								}
+								if (ApplyMapChunkBlock(pChunk, chunkY_rs, i, sBlockId[i], sBlockData[i], removeQueue, addQueue, addDataQueue, modDataQueue))
+									nModifiedCount++;
 							}
 						}
 						else
@@ -60,8 +60,9 @@ namespace ParaEngine
 		/**
 		@param x,z:  range in [0,512), y range in [0,256)
 		@param bNeedUpdate: during loading from file, bNeedUpdate is false.
+		@param bUpdateLight: if false, light is not marked dirty, and the caller is responsible for it. see CBlockWorld::SetBlocks()
 		*/
-		void SetBlockTemplateByIndex(uint16_t x_rs, uint16_t y_rs, uint16_t z_rs, BlockTemplate* pTemplate);
+		void SetBlockTemplateByIndex(uint16_t x_rs, uint16_t y_rs, uint16_t z_rs, BlockTemplate* pTemplate, bool bUpdateLight = true);
 
 		void RefreshBlockTemplateByIndex(uint16_t x_rs, uint16_t y_rs, uint16_t z_rs, BlockTemplate* pTemplate);
 
@@ -105,6 +106,15 @@ namespace ParaEngine
 
 		void SaveToFile();
 
+		/** serialize the region to uncompressed bytes, which is a snapshot that can be compressed and written by WriteRegionFile() in any thread.
+		* the caller should hold the writer lock of the block world. the region is marked unmodified.
+		* @return false if the region is locked or not modified. */
+		bool SaveToBuffer(std::string& output);
+
+		/** compress the output of SaveToBuffer() and write it to a temp file, which is then renamed to fileName.
+		* It does not touch any region or world data, so it is safe to call from worker threads. */
+		static bool WriteRegionFile(const std::string& fileName, const std::string& data);
+
 		void Load();
 
 		// called every frame move 
@@ -129,6 +139,18 @@ namespace ParaEngine
 
 		void ApplyMapChunkData(uint32_t chunkX, uint32_t chunkZ, uint32_t verticalSectionFilter, const std::string& chunkData, const luabind::adl::object& output);
 
+		/** modification version of the chunk column. Pass it to GetMapChunkDelta() next time to get changes after this call. */
+		uint32 GetMapChunkVersion(uint32_t chunkX, uint32_t chunkZ);
+
+		/** get only the blocks changed after nLastVersion in the given chunk column.
+		* Vertical sections that are not changed are skipped. Sections whose changes are no longer tracked are sent in full.
+		* @param nLastVersion: GetMapChunkVersion() at the time the receiver was last synced. 0 to send all sections in full.
+		*/
+		const std::string& GetMapChunkDelta(uint32_t chunkX, uint32_t chunkZ, uint32 nLastVersion, uint32_t verticalSectionFilter = 0xffff);
+
+		/** apply the output of GetMapChunkDelta(). output has the same remove, add, addData, modData queues as ApplyMapChunkData(). */
+		void ApplyMapChunkDelta(uint32_t chunkX, uint32_t chunkZ, const std::string& chunkData, const luabind::adl::object& output);
+
 		// call this function when this chunk is modified
 		void SetChunkDirty(uint16_t packedChunkID, bool isDirty);
 		// this function is only called when neighbor block on the adjacent boundary to this chunk is dirty. 
@@ -143,6 +165,18 @@ namespace ParaEngine
 
 		Block* GetBlock(uint16_t chunkId, Uint16x3& blockID_r);
 
+		/** bit y is set if the chunk at height y exists in the chunk column. Chunks that do not exist are empty, which ray casting can skip as a whole. */
+		inline uint16 GetChunkColumnMask(uint16_t chunkX_rs, uint16_t chunkZ_rs)
+		{
+			return m_chunkColumnMask[chunkX_rs + chunkZ_rs * BlockConfig::g_regionChunkDimX];
+		}
+
+		/** whether there is no chunk in this region. */
+		inline bool IsEmpty()
+		{
+			return m_nChunkCount == 0;
+		}
+
 		BlockChunk* GetChunk(uint16_t packedChunkID, bool createIfNotExist);
 
 		/** whether modified. */
@@ -187,6 +221,10 @@ namespace ParaEngine
 
 		void UpdateBlockHeightMap(Uint16x3& blockId_rs, bool isRemove, bool isTransparent);
 
+		/** set block of a received chunk, and add onload blocks to the given queues. return true if modified. */
+		bool ApplyMapChunkBlock(BlockChunk* pChunk, uint16_t chunkY_rs, uint16_t nBlockIndex, uint16_t blockId, uint32_t blockData,
+			luabind::adl::object& removeQueue, luabind::adl::object& addQueue, luabind::adl::object& addDataQueue, luabind::adl::object& modDataQueue);
+
 		void Cleanup();
 
 		CBlockWorld* GetBlockWorld();
@@ -219,6 +257,11 @@ namespace ParaEngine
 		/** 0 means not available, 1 means loaded before*/
 		std::vector<byte> m_chunkTimestamp;
 
+		/** 32*32 chunk columns, see GetChunkColumnMask() */
+		std::vector<uint16> m_chunkColumnMask;
+		/** number of chunks created */
+		uint32 m_nChunkCount;
+
 		/** 512*512 biomes values*/
 		std::vector<byte> m_biomes;
 
@@ -232,6 +275,9 @@ namespace ParaEngine
 		/** whether block is modified or not */
 		bool m_bIsModified;
 
+		/** version when chunks are created or deleted as a whole. Chunks that do not exist are empty since this version. */
+		uint32 m_nVersionBase;
+
 		Int16x3 m_minChunkId_ws;
 		Int16x3 m_maxChunkId_ws;
 
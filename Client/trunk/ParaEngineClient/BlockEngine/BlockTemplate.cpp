@@ -15,11 +15,19 @@
 #include "SceneObject.h"
 #include "util/regularexpression.h"
 #include "StringHelper.h"
+#include <atomic>
 
 namespace ParaEngine
 {
 	const uint16_t BlockTemplate::g_maxRenderPriority = 0xf;
 
+	static std::atomic<uint32> s_nTemplateChangeCount(0);
+
+	uint32 BlockTemplate::GetChangeCount()
+	{
+		return s_nTemplateChangeCount;
+	}
+
 	BlockTemplate::BlockTemplate(uint16_t id, uint32_t attFlag, uint16_t category_id) :m_id(id), m_attFlag(attFlag), m_category_id(category_id), m_fPhysicalHeight(1.f), m_nTileSize(1),
 		m_pNormalMap(nullptr), m_renderPriority(0), m_lightScatterStep(1), m_lightOpacity(1), m_pBlockModelFilter(NULL), m_bIsShadowCaster(true), m_associated_blockid(0),
 		m_bProvidePower(false), m_nLightValue(0xf), m_fSpeedReductionPercent(1.f), m_renderPass(BlockRenderPass_Opaque), m_dwMapColor(Color::White), m_UnderWaterColor(0)
@@ -34,6 +42,7 @@ namespace ParaEngine
 
 	void BlockTemplate::Init(uint32_t attFlag, uint16_t category_id)
 	{
+		++s_nTemplateChangeCount;
 		m_attFlag = attFlag;
 		m_category_id = category_id;
 
@@ -174,6 +183,7 @@ namespace ParaEngine
 			if (nIndex < (int)m_textures0.size())
 				m_textures0[nIndex] = nullptr;
 		}
+		++s_nTemplateChangeCount;
 	}
 
 	void BlockTemplate::SetTexture1(const char* texName)
@@ -188,6 +198,27 @@ namespace ParaEngine
 			m_secondTexName.clear();
 			m_textures1[0] = nullptr;
 		}
+		++s_nTemplateChangeCount;
+	}
+
+	uint32 BlockTemplate::HashTextures(uint32 nHash)
+	{
+		for (int i = 0; i < 2; ++i)
+		{
+			std::vector<TextureEntity*>& textures = (i == 0) ? m_textures0 : m_textures1;
+			for (TextureEntity* pTexture : textures)
+			{
+				if (pTexture)
+				{
+					const std::string& sKey = pTexture->GetKey();
+					for (size_t k = 0; k < sKey.size(); ++k)
+						nHash = (nHash ^ (unsigned char)sKey[k]) * 16777619u;
+				}
+				// separator, so that a missing texture changes the hash
+				nHash = (nHash ^ 0xff) * 16777619u;
+			}
+		}
+		return nHash;
 	}
 
 	void BlockTemplate::SetNormalMap(const char* texName)
@@ -500,6 +531,7 @@ namespace ParaEngine
 			m_attFlag |= dwAtt;
 		else
 			m_attFlag &= (~dwAtt);
+		++s_nTemplateChangeCount;
 	}
 
 	float BlockTemplate::GetSpeedReductionPercent() const
@@ -539,6 +571,7 @@ namespace ParaEngine
 	void BlockTemplate::SetMapColor(Color val)
 	{
 		m_dwMapColor = val;
+		++s_nTemplateChangeCount;
 	}
 
 	Color BlockTemplate::GetMapColor() const
@@ -53,6 +53,13 @@ namespace ParaEngine
 
 		void Init(uint32_t attFlag, uint16_t category_id);
 
+		/** increased whenever a template is created or its attributes, map color or textures change.
+		* the block world uses it to tell when to rehash the template table. */
+		static uint32 GetChangeCount();
+
+		/** FNV-1a hash of the texture file names, chained from nHash. */
+		uint32 HashTextures(uint32 nHash);
+
 		inline uint16_t GetID() const
 		{
 			return m_id;
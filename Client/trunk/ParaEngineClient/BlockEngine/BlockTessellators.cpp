@@ -18,7 +18,7 @@
 using namespace ParaEngine;
 
 ParaEngine::BlockTessellatorBase::BlockTessellatorBase(CBlockWorld* pWorld)
-	: m_pWorld(pWorld), m_pCurBlockTemplate(0), m_pCurBlockModel(0), m_blockId_ws(0, 0, 0), m_nBlockData(0), m_pChunk(0), m_blockId_cs(0, 0, 0)
+	: m_pWorld(pWorld), m_pCurBlockTemplate(0), m_pCurBlockModel(0), m_blockId_ws(0, 0, 0), m_nBlockData(0), m_pChunk(0), m_blockId_cs(0, 0, 0), m_pCacheChunk(0)
 {
 	memset(neighborBlocks, 0, sizeof(neighborBlocks));
 }
@@ -31,6 +31,23 @@ void ParaEngine::BlockTessellatorBase::SetWorld(CBlockWorld* pWorld)
 	}
 }
 
+void ParaEngine::BlockTessellatorBase::BeginNeighborCache(BlockChunk* pChunk)
+{
+	m_pCacheChunk = pChunk;
+	m_neighborCache.Clear();
+}
+
+void ParaEngine::BlockTessellatorBase::ClearNeighborCache()
+{
+	if (m_pCacheChunk)
+		m_neighborCache.Clear();
+}
+
+void ParaEngine::BlockTessellatorBase::EndNeighborCache()
+{
+	m_pCacheChunk = NULL;
+}
+
 int32 ParaEngine::BlockTessellatorBase::TessellateBlock(BlockChunk* pChunk, uint16 packedBlockId, BlockRenderMethod dwShaderID, BlockVertexCompressed** pOutputData)
 {
 	return 0;
@@ -93,6 +110,45 @@ bool ParaEngine::BlockTessellatorBase::UpdateCurrentBlock(BlockChunk* pChunk, ui
 
 void ParaEngine::BlockTessellatorBase::FetchNearbyBlockInfo(BlockChunk* pChunk, const Uint16x3& blockId_cs, int nNearbyBlockCount, int nNearbyLightCount)
 {
+	if (pChunk == m_pCacheChunk && pChunk != 0)
+	{
+		// same result as below, except that each cell of the padded chunk is only fetched once.
+		CBlockWorld* pWorld = m_pWorld;
+		const Uint16x3& minBlockId_ws = pChunk->m_minBlockId_ws;
+		auto fetchBlock = [pChunk, pWorld, &minBlockId_ws](int x, int y, int z) -> Block* {
+			uint16_t y_ws = minBlockId_ws.y + y;
+			if (x >= 0 && x < 16 && y >= 0 && y < 16 && z >= 0 && z < 16)
+				return pChunk->GetBlock(PackBlockId(x, y, z));
+			else if (y_ws < BlockConfig::g_regionBlockDimY)
+				return pWorld->GetBlock(minBlockId_ws.x + x, y_ws, minBlockId_ws.z + z);
+			return NULL;
+		};
+		const Int16x3* neighborOfsTable = BlockCommon::NeighborOfsTable;
+		for (int i = 1; i < nNearbyBlockCount; ++i)
+		{
+			neighborBlocks[i] = m_neighborCache.GetBlock(blockId_cs.x + neighborOfsTable[i].x, blockId_cs.y + neighborOfsTable[i].y, blockId_cs.z + neighborOfsTable[i].z, fetchBlock);
+		}
+		if (!m_pCurBlockModel->IsUsingSelfLighting())
+		{
+			nNearbyLightCount = nNearbyLightCount < 0 ? nNearbyBlockCount : nNearbyLightCount;
+			auto fetchLight = [pWorld, &minBlockId_ws](int x, int y, int z, uint8_t* pLight) {
+				// light type 2 returns block light followed by sun light
+				Uint16x3 blockId_ws(minBlockId_ws.x + x, minBlockId_ws.y + y, minBlockId_ws.z + z);
+				pWorld->GetBlockBrightness(blockId_ws, pLight, 1, 2);
+			};
+			// gather block and sun light to the same layout as light type 3, and then combine them in one flat loop.
+			uint8_t* blockLight = blockBrightness + nNearbyLightCount;
+			uint8_t* sunLight = blockBrightness + nNearbyLightCount * 2;
+			for (int i = 0; i < nNearbyLightCount; ++i)
+			{
+				const uint8_t* pLight = m_neighborCache.GetLight(blockId_cs.x + neighborOfsTable[i].x, blockId_cs.y + neighborOfsTable[i].y, blockId_cs.z + neighborOfsTable[i].z, fetchLight);
+				blockLight[i] = pLight[0];
+				sunLight[i] = pLight[1];
+			}
+			PaddedChunkCache<Block*>::CombineBrightness(blockLight, sunLight, nNearbyLightCount, m_pWorld->GetSunIntensity(), blockBrightness);
+		}
+		return;
+	}
 	//neighbor block info: excluding the first (center) block, since it has already been fetched. 
 	if (nNearbyBlockCount > 1)
 	{
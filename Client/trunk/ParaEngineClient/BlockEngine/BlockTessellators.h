@@ -1,5 +1,6 @@
 #pragma once
 #include "BlockCommon.h"
+#include "PaddedChunkCache.h"
 
 namespace ParaEngine
 {
@@ -15,6 +16,16 @@ namespace ParaEngine
 
 		virtual void SetWorld(CBlockWorld* pWorld);
 
+		/** enable the padded 18*18*18 neighbor cache of block pointers and light values for all blocks in the given chunk.
+		* Each cell is fetched from the world at most once, instead of up to 27 times (once per neighboring block).
+		* Cached block pointers are only valid while the caller holds the read lock, so call ClearNeighborCache() whenever the lock is released.
+		*/
+		void BeginNeighborCache(BlockChunk* pChunk);
+		/** invalidate all cached cells, but keep using the cache for the same chunk. */
+		void ClearNeighborCache();
+		/** stop using the neighbor cache */
+		void EndNeighborCache();
+
 		int32_t GetAvgVertexLight(int32_t v1, int32_t v2, int32_t v3, int32_t v4);
 
 		/** not used. old algorithm for GetAvgVertexLight */
@@ -66,6 +77,10 @@ namespace ParaEngine
 		BlockChunk* m_pChunk;
 		// chunk space coordinate. 
 		Uint16x3 m_blockId_cs;
+
+		/** chunk whose neighbor cache is in use, NULL if cache is disabled. */
+		BlockChunk* m_pCacheChunk;
+		PaddedChunkCache<Block*> m_neighborCache;
 	};
 
 	/** custom model tessellation like button, stairs, etc.  */
@@ -20,18 +20,76 @@
 #include "BlockLightGridBase.h"
 #include "TextureEntity.h"
 #include "BlockWorld.h"
+#include "BlockRayCast.h"
 #include "SceneObject.h"
 #include "BipedObject.h"
+#include "BlockLightBatch.h"
+#include <unordered_map>
 
 using namespace ParaEngine;
 
 /** default render distance in blocks */
 #define DEFAULT_RENDER_BLOCK_DISTANCE	96
+/** chunk columns with at least so many changed blocks in a SetBlocks batch are relit as a whole column, instead of block by block. */
+#define BLOCK_BATCH_COLUMN_RELIGHT_COUNT	512
 
 namespace ParaEngine
 {
 	float CBlockWorld::g_verticalOffset = 0;
 
+	/** snapshot of a modified region taken by SaveToFileAsync */
+	struct BlockRegionSaveTask
+	{
+		int m_nRegionIndex;
+		uint16_t m_regionX;
+		uint16_t m_regionZ;
+		std::string m_fileName;
+		std::string m_data;
+	};
+
+#ifdef PARAENGINE_CLIENT
+	/** copy xml and raw files from the last save directory to the game save directory.
+	* SaveToFile and the background thread of SaveToFileAsync may copy at the same time, so copies are serialized. */
+	static void CopyBlockGameSaveFiles(const std::string& lastSaveDir, const std::string& gameSaveDir)
+	{
+		static std::mutex s_copyMutex;
+		std::lock_guard<std::mutex> lock_(s_copyMutex);
+		HANDLE hFind = INVALID_HANDLE_VALUE;
+		WIN32_FIND_DATA ffd;
+
+		std::string searchPath = lastSaveDir;
+		searchPath.append("*");
+		hFind = FindFirstFile(searchPath.c_str(), &ffd);
+		if (hFind == INVALID_HANDLE_VALUE)
+			return;
+
+		std::string current;
+		std::string src;
+		do
+		{
+			if (!(ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+			{
+				current.clear();
+				current.assign(ffd.cFileName);
+
+				int32_t size = current.size();
+				if ((current[size - 3] == 'x' && current[size - 2] == 'm' && current[size - 1] == 'l')
+					|| current[size - 3] == 'r' && current[size - 2] == 'a' && current[size - 1] == 'w')
+				{
+					current.clear();
+					current.append(gameSaveDir);
+					current.append(ffd.cFileName);
+
+					src.clear();
+					src.append(lastSaveDir);
+					src.append(ffd.cFileName);
+					CParaFile::CopyFile(src.c_str(), current.c_str(), true);
+				}
+			}
+		} while (FindNextFile(hFind, &ffd) != 0);
+	}
+#endif
+
 	inline int64_t GetBlockSparseIndex(int64_t bx, int64_t by, int64_t bz)
 	{
 		return by * 30000 * 30000 + bx * 30000 + bz;
@@ -42,7 +100,7 @@ CBlockWorld::CBlockWorld()
 	:m_curChunkIdW(-1), m_activeChunkDim(0), m_lastChunkIdW(-1), m_lastChunkIdW_RegionCache(-1), m_lastViewCheckIdW(0), m_dwBlockRenderMethod(BLOCK_RENDER_FAST_SHADER), m_sunIntensity(1), m_isVisibleChunkDirty(true), m_curRegionIdX(0), m_curRegionIdZ(0),
 m_pLightGrid(new CBlockLightGridBase(this)), m_bReadOnlyWorld(false), m_bIsRemote(false), m_bIsServerWorld(false), m_bCubeModePicking(false), m_isInWorld(false), m_bSaveLightMap(false), 
 m_bUseAsyncLoadWorld(true), m_bRenderBlocks(true), m_group_by_chunk_before_texture(false), m_is_linear_torch_brightness(false), m_maxCacheRegionCount(0),
-m_minWorldPos(0, 0, 0), m_maxWorldPos(0xffff, 0xffff, 0xffff), m_minRegionX(0), m_minRegionZ(0), m_maxRegionX(63), m_maxRegionZ(63)
+m_minWorldPos(0, 0, 0), m_maxWorldPos(0xffff, 0xffff, 0xffff), m_minRegionX(0), m_minRegionZ(0), m_maxRegionX(63), m_maxRegionZ(63), m_bIsSaving(false), m_nTemplateTableHash(0), m_nTemplateHashChangeCount(0)
 {
 	// 256 blocks, so that it never wraps
 	m_activeChunkDimY = 16; 
@@ -95,6 +153,7 @@ m_minWorldPos(0, 0, 0), m_maxWorldPos(0xffff, 0xffff, 0xffff), m_minRegionX(0),
 
 CBlockWorld::~CBlockWorld()
 {
+	WaitForSaveComplete();
 	m_isInWorld = false;
 	SAFE_DELETE(m_pLightGrid);
 	ClearAllBlockTemplates();
@@ -134,57 +193,145 @@ void ParaEngine::CBlockWorld::EnterWorld(const string& sWorldDir, float x, float
 void CBlockWorld::SaveToFile(bool saveToTemp)
 {
 	// SaveBlockTemplateData();
-
 	for (std::map<int, BlockRegion*>::iterator iter = m_regionCache.begin(); iter != m_regionCache.end(); iter++)
 	{
+		// only an older snapshot of the same region, which is still written in background, needs to be waited for. 
+		if (iter->second->IsModified())
+			WaitForRegionSaved(iter->first);
 		iter->second->SaveToFile();
 	}
 #ifdef PARAENGINE_CLIENT
 	if (!saveToTemp)
 	{
-		HANDLE hFind = INVALID_HANDLE_VALUE;
-		WIN32_FIND_DATA ffd;
-
-		std::string lastSaveDir = m_worldInfo.GetBlockGameSaveDir(true);
-		lastSaveDir.append("*");
-		hFind = FindFirstFile(lastSaveDir.c_str(), &ffd);
-		if (hFind == INVALID_HANDLE_VALUE)
-			return;
+		CopyBlockGameSaveFiles(m_worldInfo.GetBlockGameSaveDir(true), m_worldInfo.GetBlockGameSaveDir(false));
+	}
+#endif
+}
 
-		std::string gameSaveDir = m_worldInfo.GetBlockGameSaveDir(false);
-		lastSaveDir = m_worldInfo.GetBlockGameSaveDir(true);
+void CBlockWorld::SaveToFileAsync(bool saveToTemp)
+{
+	WaitForSaveComplete();
 
-		std::string current;
-		std::string src;
-		do
+	// the snapshot is the uncompressed bytes of each modified region, which is cheap compared to compression and disk IO.
+	auto tasks = std::make_shared< std::vector<BlockRegionSaveTask> >();
+	{
+		Scoped_WriteLock<BlockReadWriteLock> Lock_(GetReadWriteLock());
+		for (auto& iter : m_regionCache)
 		{
-			if (!(ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+			BlockRegion* pRegion = iter.second;
+			BlockRegionSaveTask task;
+			if (pRegion->SaveToBuffer(task.m_data))
 			{
-				ffd.cFileName;
-				current.clear();
-				current.assign(ffd.cFileName);
+				task.m_nRegionIndex = iter.first;
+				task.m_regionX = pRegion->GetRegionX();
+				task.m_regionZ = pRegion->GetRegionZ();
+				task.m_fileName = m_worldInfo.GetBlockRegionFileName(task.m_regionX, task.m_regionZ, true);
+				tasks->push_back(std::move(task));
+			}
+		}
+		std::lock_guard<std::mutex> lock_(m_saveMutex);
+		for (auto& task : *tasks)
+			m_savingRegions.insert(task.m_nRegionIndex);
+	}
 
-				int32_t size = current.size();
-				if ((current[size - 3] == 'x' && current[size - 2] == 'm' && current[size - 1] == 'l')
-					|| current[size - 3] == 'r' && current[size - 2] == 'a' && current[size - 1] == 'w')
+	std::string lastSaveDir, gameSaveDir;
+	if (!saveToTemp)
+	{
+		lastSaveDir = m_worldInfo.GetBlockGameSaveDir(true);
+		gameSaveDir = m_worldInfo.GetBlockGameSaveDir(false);
+	}
+
+	m_bIsSaving = true;
+	// worker threads never touch the world, except for m_savingRegions and m_saveCallbacks under m_saveMutex. 
+	m_save_thread = std::thread([this, tasks, lastSaveDir, gameSaveDir, saveToTemp]() mutable {
+		int nTaskCount = (int)tasks->size();
+		std::atomic<int> nNextTask(0);
+		std::atomic<int> nFailedCount(0);
+		auto worker = [&]() {
+			int i;
+			while ((i = nNextTask++) < nTaskCount)
+			{
+				BlockRegionSaveTask& task = (*tasks)[i];
+				bool bSaved = BlockRegion::WriteRegionFile(task.m_fileName, task.m_data);
+				if (!bSaved)
 				{
-					current.clear();
-					current.append(gameSaveDir);
-					current.append(ffd.cFileName);
-
-					src.clear();
-					src.append(lastSaveDir);
-					src.append(ffd.cFileName);
-					CParaFile::CopyFile(src.c_str(), current.c_str(), true);
+					OUTPUT_LOG("warning: failed to save block region file %s\n", task.m_fileName.c_str());
+					++nFailedCount;
 				}
+				// free the snapshot as soon as possible
+				std::string().swap(task.m_data);
+				{
+					std::lock_guard<std::mutex> lock_(m_saveMutex);
+					m_savingRegions.erase(task.m_nRegionIndex);
+					if (bSaved)
+					{
+						char sMsg[100];
+						snprintf(sMsg, 100, "msg={x=%d,y=%d,type=\"raw\"};", task.m_regionX, task.m_regionZ);
+						m_saveCallbacks.push_back(std::make_pair((int)Type_SaveRegionCallbackScript, std::string(sMsg)));
+					}
+				}
+				m_saveCondition.notify_all();
 			}
-		} while (FindNextFile(hFind, &ffd) != 0);
-	}
+		};
+		int nThreadCount = (std::min)((int)std::thread::hardware_concurrency(), nTaskCount);
+		std::vector<std::thread> workers;
+		for (int i = 1; i < nThreadCount; ++i)
+			workers.push_back(std::thread(worker));
+		worker();
+		for (auto& thread : workers)
+			thread.join();
+#ifdef PARAENGINE_CLIENT
+		if (!saveToTemp)
+			CopyBlockGameSaveFiles(lastSaveDir, gameSaveDir);
 #endif
+		{
+			char sMsg[100];
+			snprintf(sMsg, 100, "msg={count=%d,failed=%d,temp=%s,type=\"saveworld\"};", nTaskCount, (int)nFailedCount, saveToTemp ? "true" : "false");
+			std::lock_guard<std::mutex> lock_(m_saveMutex);
+			m_saveCallbacks.push_back(std::make_pair((int)Type_SaveWorldCallbackScript, std::string(sMsg)));
+		}
+		m_bIsSaving = false;
+	});
+}
+
+void CBlockWorld::WaitForSaveComplete()
+{
+	if (m_save_thread.joinable())
+		m_save_thread.join();
+}
+
+void CBlockWorld::WaitForRegionSaved(int nRegionIndex)
+{
+	std::unique_lock<std::mutex> lock_(m_saveMutex);
+	m_saveCondition.wait(lock_, [this, nRegionIndex]() { return m_savingRegions.find(nRegionIndex) == m_savingRegions.end(); });
+}
+
+void CBlockWorld::ActivateSaveCallbacks()
+{
+	std::vector< std::pair<int, std::string> > callbacks;
+	{
+		std::lock_guard<std::mutex> lock_(m_saveMutex);
+		if (m_saveCallbacks.empty())
+			return;
+		callbacks.swap(m_saveCallbacks);
+	}
+	for (auto& callback : callbacks)
+	{
+		ScriptCallback* pCallback = GetScriptCallback(callback.first);
+		if (pCallback)
+			pCallback->ActivateLocalNow(callback.second + pCallback->GetCode());
+	}
+}
+
+bool CBlockWorld::IsSaving()
+{
+	return m_bIsSaving;
 }
 
 void ParaEngine::CBlockWorld::LeaveWorld()
 {
+	WaitForSaveComplete();
+	ActivateSaveCallbacks();
 	Scoped_WriteLock<BlockReadWriteLock> Lock_(GetReadWriteLock());
 
 	m_curRegionIdX = 0;
@@ -418,7 +565,11 @@ void CBlockWorld::UnloadRegion(BlockRegion* pRegion, bool bAutoSave)
 		if (m_pRegions[pRegion->GetPackedRegionIndex()] == pRegion)
 		{
 			if (!IsRemote() && bAutoSave && !IsReadOnly() && pRegion->IsModified())
+			{
+				// an older snapshot of this region may still be written in background
+				WaitForRegionSaved(pRegion->GetPackedRegionIndex());
 				pRegion->SaveToFile();
+			}
 			OnUnLoadBlockRegion(pRegion->GetRegionX(), pRegion->GetRegionZ());
 			Scoped_WriteLock<BlockReadWriteLock> Lock_(GetReadWriteLock());
 			m_pRegions[pRegion->GetPackedRegionIndex()] = NULL;
@@ -767,6 +918,30 @@ BlockTemplate* CBlockWorld::GetBlockTemplate(uint16_t id)
 	}
 }
 
+uint32 CBlockWorld::GetTemplateTableHash()
+{
+	return m_nTemplateTableHash.load(std::memory_order_acquire);
+}
+
+void CBlockWorld::UpdateTemplateTableHash()
+{
+	uint32 nChangeCount = BlockTemplate::GetChangeCount();
+	if (m_nTemplateHashChangeCount == nChangeCount && m_nTemplateTableHash != 0)
+		return;
+	m_nTemplateHashChangeCount = nChangeCount;
+	// FNV-1a
+	uint32 nHash = 2166136261u;
+	for (auto it = m_blockTemplates.begin(); it != m_blockTemplates.end(); ++it)
+	{
+		uint32 values[3] = { it->first, it->second->GetAttFlag(), (uint32)it->second->GetMapColor() };
+		const unsigned char* p = (const unsigned char*)values;
+		for (int i = 0; i < (int)sizeof(values); ++i)
+			nHash = (nHash ^ p[i]) * 16777619u;
+		nHash = it->second->HashTextures(nHash);
+	}
+	m_nTemplateTableHash.store(nHash, std::memory_order_release);
+}
+
 BlockTemplate* CBlockWorld::RegisterTemplate(uint16_t id, uint32_t attFlag, uint16_t category_id)
 {
 	if (GetBlockTemplate(id))
@@ -945,6 +1120,92 @@ uint32_t ParaEngine::CBlockWorld::GetBlockData(uint16_t x, uint16_t y, uint16_t
 	return 0;
 }
 
+int ParaEngine::CBlockWorld::SetBlocks(const BlockRecord* pRecords, int nCount, int nFlags)
+{
+	if (pRecords == 0 || nCount <= 0)
+		return 0;
+	Scoped_WriteLock<BlockReadWriteLock> Lock_(GetReadWriteLock());
+
+	// light dirtiness is collected and applied after the batch, if the caller has not suspended light update already.
+	bool bDeferLight = !IsLightUpdateSuspended();
+	if (bDeferLight)
+		SuspendLightUpdate();
+	BlockLightBatch lightBatch(BLOCK_BATCH_COLUMN_RELIGHT_COUNT);
+
+	int nChanged = 0;
+	bool bSetData = (nFlags & BLOCK_RECORD_DATA) != 0;
+	for (int i = 0; i < nCount; ++i)
+	{
+		const BlockRecord& record = pRecords[i];
+		if (record.y >= BlockConfig::g_regionBlockDimY)
+			continue;
+		uint16_t lx, ly, lz;
+		BlockRegion* pRegion = GetRegion(record.x, record.y, record.z, lx, ly, lz);
+		// locked regions silently ignore writes, so they are not counted as changed.
+		if (pRegion == 0 || pRegion->IsLocked())
+			continue;
+		if (nFlags & BLOCK_RECORD_ID)
+		{
+			uint16_t nPrevId = pRegion->GetBlockTemplateIdByIndex(lx, ly, lz);
+			if (nPrevId != record.id)
+			{
+				BlockTemplate* pTemplate = (record.id > 0) ? GetBlockTemplate(record.id) : NULL;
+				// light of the whole batch is updated below, so that removed blocks are not relit twice. 
+				pRegion->SetBlockTemplateByIndex(lx, ly, lz, pTemplate, !bDeferLight);
+				++nChanged;
+				if (bDeferLight)
+				{
+					// same rule as BlockRegion::SetBlockTemplateByIndex
+					BlockTemplate* pPrevTemplate = (nPrevId > 0) ? GetBlockTemplate(nPrevId) : NULL;
+					bool bSunLight = (pTemplate == 0) || (!pTemplate->IsMatchAttribute(BlockTemplate::batt_light) &&
+						!(pPrevTemplate && pPrevTemplate->IsMatchAttribute(BlockTemplate::batt_solid) && pTemplate->IsMatchAttribute(BlockTemplate::batt_solid)));
+					lightBatch.AddBlock(record.x, record.y, record.z, bSunLight);
+				}
+			}
+		}
+		if (bSetData && record.id > 0)
+			pRegion->SetBlockUserDataByIndex(lx, ly, lz, record.data);
+	}
+	m_isVisibleChunkDirty = true;
+
+	if (bDeferLight)
+	{
+		ResumeLightUpdate();
+		lightBatch.Flush([this](uint16_t chunkX_ws, uint16_t chunkZ_ws) {
+			GetLightGrid().AddDirtyColumn(chunkX_ws, chunkZ_ws);
+		}, [this](uint16_t x, uint16_t y, uint16_t z, bool bSunLight) {
+			Uint16x3 blockId_ws(x, y, z);
+			SetLightBlockDirty(blockId_ws, false);
+			if (bSunLight)
+				SetLightBlockDirty(blockId_ws, true);
+		});
+	}
+	return nChanged;
+}
+
+void ParaEngine::CBlockWorld::GetBlocks(BlockRecord* pRecords, int nCount)
+{
+	if (pRecords == 0 || nCount <= 0)
+		return;
+	Scoped_ReadLock<BlockReadWriteLock> Lock_(GetReadWriteLock());
+	for (int i = 0; i < nCount; ++i)
+	{
+		BlockRecord& record = pRecords[i];
+		uint16_t lx, ly, lz;
+		BlockRegion* pRegion = GetRegion(record.x, record.y, record.z, lx, ly, lz);
+		if (pRegion)
+		{
+			record.id = pRegion->GetBlockTemplateIdByIndex(lx, ly, lz);
+			record.data = (record.id > 0) ? pRegion->GetBlockUserDataByIndex(lx, ly, lz) : 0;
+		}
+		else
+		{
+			record.id = 0;
+			record.data = 0;
+		}
+	}
+}
+
 void ParaEngine::CBlockWorld::LoadBlockAsync(uint16_t x, uint16_t y, uint16_t z, uint16_t blockId, uint32_t userData)
 {
 	uint16_t lx, ly, lz;
@@ -1364,10 +1625,39 @@ bool CBlockWorld::Pick(const Vector3& rayOrig, const Vector3& dir, float length,
 {
 	if (!m_isInWorld)
 		return false;
+	if (RayCast(rayOrig, dir, length, result, filter))
+	{
+		m_selectBlockIdW.x = result.BlockX;
+		m_selectBlockIdW.y = result.BlockY;
+		m_selectBlockIdW.z = result.BlockZ;
+		return true;
+	}
+	return false;
+}
+
+int CBlockWorld::PickBatch(const Vector3* pRayOrig, const Vector3* pDir, const float* pLength, int nCount, PickResult* pResults, uint32_t filter)
+{
+	if (!m_isInWorld || nCount <= 0)
+		return 0;
+	Scoped_ReadLock<BlockReadWriteLock> Lock_(GetReadWriteLock());
+	int nHitCount = 0;
+	for (int i = 0; i < nCount; ++i)
+	{
+		if (RayCast(pRayOrig[i], pDir[i], pLength[i], pResults[i], filter))
+			++nHitCount;
+		else
+			pResults[i].Distance = -1.f;
+	}
+	return nHitCount;
+}
+
+bool CBlockWorld::RayCast(const Vector3& rayOrig, const Vector3& dir, float length, PickResult& result, uint32_t filter)
+{
 	//////////////////////////////////////////////////////////////
 	//
 	// use 3D DDA algorithm to find hit block more detail see 
 	// http://www.flipcode.com/archives/Raytracing_Topics_Techniques-Part_4_Spatial_Subdivisions.shtml
+	// empty regions, chunk columns and chunks are skipped in one step. 
 	//
 	//////////////////////////////////////////////////////////////
 
@@ -1424,7 +1714,7 @@ bool CBlockWorld::Pick(const Vector3& rayOrig, const Vector3& dir, float length,
 	// distance we can travel along the ray before hitting a block boundary, in either of the three axis.
 	Vector3 errDist;
 	// the delta distance to travel in the three axis, before we move to next block. This is a constant;
-	Vector3 delta;
+	Vector3 delta(0, 0, 0);
 
 	float maxRayDist = 100000;
 	if (dir.x != 0)
@@ -1457,12 +1747,16 @@ bool CBlockWorld::Pick(const Vector3& rayOrig, const Vector3& dir, float length,
 	int16_t curRegionX = -1;
 	int16_t curRegionZ = -1;
 	BlockRegion* curRegion = NULL;
-	int32_t side;
+	int32_t side = 0;
+	float distTraveled = 0;
+	// false if the current block is entered by skipping an empty cell
+	bool bStepToNextBlock = true;
 	while (true)
 	{
 		//find the smallest value of traveledDist and going alone that direction
-		float distTraveled = 0;
-		if (errDist.x < errDist.y)
+		if (!bStepToNextBlock)
+			bStepToNextBlock = true;
+		else if (errDist.x < errDist.y)
 		{
 			if (errDist.x < errDist.z)
 			{
@@ -1509,6 +1803,56 @@ bool CBlockWorld::Pick(const Vector3& rayOrig, const Vector3& dir, float length,
 		if (curRegion == NULL || curBlockIdX < 0 || curBlockIdY < 0 || curBlockIdZ < 0)
 			return false;
 
+		if (curBlockIdY < BlockConfig::g_regionBlockDimY)
+		{
+			// find the largest empty cell that contains the current block
+			int32_t cellMin[3], cellMax[3];
+			int32_t nCellSize = 0;
+			uint16_t chunkX_rs = (curBlockIdX & 0x1ff) >> 4;
+			uint16_t chunkZ_rs = (curBlockIdZ & 0x1ff) >> 4;
+			if (curRegion->IsEmpty())
+			{
+				nCellSize = BlockConfig::g_regionBlockDimX;
+				cellMin[1] = 0;
+				cellMax[1] = BlockConfig::g_regionBlockDimY;
+			}
+			else
+			{
+				uint16_t nColumnMask = curRegion->GetChunkColumnMask(chunkX_rs, chunkZ_rs);
+				if (nColumnMask == 0)
+				{
+					nCellSize = BlockConfig::g_chunkBlockDim;
+					cellMin[1] = 0;
+					cellMax[1] = BlockConfig::g_regionBlockDimY;
+				}
+				else if ((nColumnMask & (1 << (curBlockIdY >> 4))) == 0)
+				{
+					nCellSize = BlockConfig::g_chunkBlockDim;
+					cellMin[1] = curBlockIdY & ~0xf;
+					cellMax[1] = cellMin[1] + BlockConfig::g_chunkBlockDim;
+				}
+			}
+			if (nCellSize > 0)
+			{
+				cellMin[0] = curBlockIdX & ~(nCellSize - 1);
+				cellMax[0] = cellMin[0] + nCellSize;
+				cellMin[2] = curBlockIdZ & ~(nCellSize - 1);
+				cellMax[2] = cellMin[2] + nCellSize;
+
+				int32_t curBlockId[3] = { curBlockIdX, curBlockIdY, curBlockIdZ };
+				const int32_t blockStep[3] = { blockStepX, blockStepY, blockStepZ };
+				float errDists[3] = { errDist.x, errDist.y, errDist.z };
+				const float deltas[3] = { delta.x, delta.y, delta.z };
+				distTraveled = BlockRayCast::SkipEmptyCell(curBlockId, blockStep, errDists, deltas, cellMin, cellMax, side);
+				curBlockIdX = curBlockId[0]; curBlockIdY = curBlockId[1]; curBlockIdZ = curBlockId[2];
+				errDist.x = errDists[0]; errDist.y = errDists[1]; errDist.z = errDists[2];
+				if (distTraveled > length)
+					return false;
+				bStepToNextBlock = false;
+				continue;
+			}
+		}
+
 		Block* pBlock = curRegion->GetBlock(curBlockIdX & 0x1ff, curBlockIdY & 0xff, curBlockIdZ & 0x1ff);
 		BlockTemplate* pBlockTemplate = NULL;
 		if (pBlock != 0 && (pBlockTemplate = pBlock->GetTemplate()) != 0 && ((pBlockTemplate->GetAttFlag() & filter) > 0))
@@ -1545,10 +1889,6 @@ bool CBlockWorld::Pick(const Vector3& rayOrig, const Vector3& dir, float length,
 
 			if (rayLength >= 0)
 			{
-				m_selectBlockIdW.x = curBlockIdX;
-				m_selectBlockIdW.y = curBlockIdY;
-				m_selectBlockIdW.z = curBlockIdZ;
-
 				float collsionX = rayOrig.x + rayLength * dir.x;
 				float collsionY = rayOrig.y + rayLength * dir.y;
 				float collsionZ = rayOrig.z + rayLength * dir.z;
@@ -1637,6 +1977,7 @@ void CBlockWorld::SetTemplateTexture(uint16_t id, const char* textureName)
 		}
 #endif
 		pTemplate->SetTexture0(textureName);
+		UpdateTemplateTableHash();
 	}
 }
 
@@ -2275,6 +2616,9 @@ void ParaEngine::CBlockWorld::SetUseAsyncLoadWorld(bool val)
 
 void ParaEngine::CBlockWorld::OnFrameMove()
 {
+	UpdateTemplateTableHash();
+	ActivateSaveCallbacks();
+
 	for (auto& iter : m_regionCache)
 	{
 		iter.second->OnFrameMove();
@@ -2496,6 +2840,8 @@ int ParaEngine::CBlockWorld::InstallFields(CAttributeClass* pClass, bool bOverri
 	pClass->AddField("OnLoadBlockRegion", FieldType_String, (void*)SetLoadBlockRegion_s, (void*)GetLoadBlockRegion_s, CAttributeField::GetSimpleSchemaOfScript(), "", bOverride);
 	pClass->AddField("OnUnLoadBlockRegion", FieldType_String, (void*)SetUnLoadBlockRegion_s, (void*)GetUnLoadBlockRegion_s, CAttributeField::GetSimpleSchemaOfScript(), "", bOverride);
 	pClass->AddField("OnSaveRegionCallbackScript", FieldType_String, (void*)SetSaveRegionCallbackScript_s, (void*)GetSaveRegionCallbackScript_s, NULL, NULL, bOverride);
+	pClass->AddField("OnSaveWorldCallbackScript", FieldType_String, (void*)SetSaveWorldCallbackScript_s, (void*)GetSaveWorldCallbackScript_s, NULL, NULL, bOverride);
+	pClass->AddField("IsSaving", FieldType_Bool, (void*)0, (void*)IsSaving_s, NULL, NULL, bOverride);
 
 	pClass->AddField("LightCalculationStep", FieldType_Int, (void*)SetLightCalculationStep_s, (void*)GetLightCalculationStep_s, NULL, NULL, bOverride);
 	pClass->AddField("RenderBlocks", FieldType_Bool, (void*)SetRenderBlocks_s, (void*)IsRenderBlocks_s, NULL, NULL, bOverride);
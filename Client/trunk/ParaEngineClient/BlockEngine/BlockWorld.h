@@ -9,6 +9,11 @@
 #include <stdint.h>
 #endif
 #include <bitset>
+#include <thread>
+#include <atomic>
+#include <set>
+#include <mutex>
+#include <condition_variable>
 #include "IObjectScriptingInterface.h"
 #include "IAttributeFields.h"
 
@@ -30,6 +35,19 @@ namespace ParaEngine
 	struct BlockHeightValue;
 	struct ChunkMaxHeight;
 
+	/** one record of CBlockWorld::SetBlocks/GetBlocks. It is 12 bytes without padding, so that scripts can pass an array of them as a packed binary string. */
+	struct BlockRecord
+	{
+		uint16_t x;
+		uint16_t y;
+		uint16_t z;
+		uint16_t id;
+		uint32_t data;
+	};
+	/** nFlags of CBlockWorld::SetBlocks */
+#define BLOCK_RECORD_ID		1
+#define BLOCK_RECORD_DATA	2
+
 
 	/** base class for an instance of block world */
 	class CBlockWorld : public IAttributeFields, IObjectScriptingInterface
@@ -119,6 +137,8 @@ namespace ParaEngine
 
 		ATTRIBUTE_METHOD1(CBlockWorld, UseLinearTorchBrightness_s, bool)	{ cls->GenerateLightBrightnessTable(p1); return S_OK; }
 
+		ATTRIBUTE_METHOD1(CBlockWorld, IsSaving_s, bool*)		{ *p1 = cls->IsSaving(); return S_OK; }
+
 		
 	public:
 		/** script call back type */
@@ -128,12 +148,15 @@ namespace ParaEngine
 			Type_GeneratorScript,
 			Type_SaveRegionCallbackScript,
 			Type_BeforeLoadBlockRegion,
+			Type_SaveWorldCallbackScript,
 		};
 		DEFINE_SCRIPT_EVENT(CBlockWorld, BeforeLoadBlockRegion);
 		DEFINE_SCRIPT_EVENT(CBlockWorld, LoadBlockRegion);
 		DEFINE_SCRIPT_EVENT(CBlockWorld, UnLoadBlockRegion);
 		/** NPL script to be called when a given region is flushed to disk*/
 		DEFINE_SCRIPT_EVENT(CBlockWorld, SaveRegionCallbackScript);
+		/** NPL script to be called when SaveToFileAsync has flushed all regions to disk*/
+		DEFINE_SCRIPT_EVENT(CBlockWorld, SaveWorldCallbackScript);
 
 		// when there is no block terrain to load from , this function will be used to generate new terrains. 
 		DEFINE_SCRIPT_EVENT(CBlockWorld, GeneratorScript);
@@ -146,6 +169,8 @@ namespace ParaEngine
 		int OnUnLoadBlockRegion(int x, int y);
 		/** called when block region has just saved. it will invoke the scripting interface if any. */
 		int OnSaveBlockRegion(int x, int y);
+		/** activate callbacks of regions and worlds saved by SaveToFileAsync, in the order they are saved. */
+		void ActivateSaveCallbacks();
 	public:
 		/** get light grid */
 		CBlockLightGridBase& GetLightGrid();
@@ -265,6 +290,23 @@ namespace ParaEngine
 
 		void SaveToFile(bool saveToTemp);
 
+		/** same as SaveToFile, except that only a snapshot of modified regions is taken under the writer lock,
+		* which is then compressed and written by worker threads in background, one region per thread.
+		* Like SaveToFile, SaveRegionCallbackScript and SaveWorldCallbackScript are activated with ActivateLocalNow in the main thread,
+		* but only in the next OnFrameMove() after the regions are written. The world callback gets msg={count, failed, temp}.
+		* If a previous save is still in progress, this function waits for it before taking the snapshot. */
+		void SaveToFileAsync(bool saveToTemp);
+
+		/** block until the background save started by SaveToFileAsync is finished. */
+		void WaitForSaveComplete();
+
+		/** block until the background save has written the given region, if it is still pending. 
+		* @param nRegionIndex: packed region index, see BlockRegion::GetPackedRegionIndex() */
+		void WaitForRegionSaved(int nRegionIndex);
+
+		/** whether a background save is in progress */
+		bool IsSaving();
+
 		/** return world info*/
 		CWorldInfo& GetWorldInfo();
 
@@ -283,12 +325,27 @@ namespace ParaEngine
 		uint32_t SetBlockData(uint16_t x, uint16_t y, uint16_t z, uint32_t nBlockData);
 		uint32_t GetBlockData(uint16_t x, uint16_t y, uint16_t z);
 
+		/** set many blocks in one call. The writer lock is acquired only once, and light of the changed blocks is marked dirty
+		* once after the whole batch instead of once per block. Chunk columns with many changed blocks are relit as a whole.
+		* @param nFlags: bitwise of BLOCK_RECORD_ID and BLOCK_RECORD_DATA. data is ignored for records whose id is 0.
+		* @return number of blocks whose template is changed. Records in unloaded or locked regions are skipped and not counted. */
+		int SetBlocks(const BlockRecord* pRecords, int nCount, int nFlags = BLOCK_RECORD_ID | BLOCK_RECORD_DATA);
+		/** fill in id and data of each record by its x,y,z. Blocks in unloaded regions are 0. */
+		void GetBlocks(BlockRecord* pRecords, int nCount);
+
 		void LoadBlockAsync(uint16_t x, uint16_t y, uint16_t z, uint16_t blockId, uint32_t userData);
 
 		//do *not* hold a permanent reference of return value,underlying memory address may change
 		//@param id: template id;
 		BlockTemplate* GetBlockTemplate(uint16_t id);
 
+		/** hash of id, attributes, map color and textures of all registered templates. BMax model cache keys depend on it.
+		* [thread safe]: it only reads a value that the main thread recomputes in UpdateTemplateTableHash(). */
+		uint32 GetTemplateTableHash();
+
+		/** recompute the template table hash if any template has changed since last call. only call this from the main thread. */
+		void UpdateTemplateTableHash();
+
 		//do *not* hold a permanent reference of return value,underlying memory address may change
 		//@param x,y,z: world space block id
 		BlockTemplate* GetBlockTemplate(uint16_t x, uint16_t y, uint16_t z);
@@ -401,9 +458,16 @@ namespace ParaEngine
 		bool IsCubeModePicking();
 		void SetCubeModePicking(bool bIsCubeModePicking);
 
-		/** picking in block world */
+		/** picking in block world. the hit block is also selected. */
 		bool Pick(const Vector3& rayOrig, const Vector3& dir, float length, PickResult& result, uint32_t filter = 0xffffffff);
 
+		/** cast many rays under one read lock, such as line of sight checks for many NPCs. It does not change the selected block.
+		* @param pRayOrig, pDir, pLength: arrays of nCount rays.
+		* @param pResults: [out] array of nCount results. Distance is -1 if the ray hits nothing.
+		* @return the number of rays that hit a block.
+		*/
+		int PickBatch(const Vector3* pRayOrig, const Vector3* pDir, const float* pLength, int nCount, PickResult* pResults, uint32_t filter = 0xffffffff);
+
 		/** find a block in the side direction that matched filter from block(x,y,z)
 		* this function can be used to check for free space upward or download
 		* @param side: 4 is top.  5 is bottom.
@@ -549,6 +613,9 @@ namespace ParaEngine
 		/** removed given region from memory. */
 		void UnloadRegion(BlockRegion* pRegion, bool bAutoSave = true);
 
+		/** same as Pick(), except that it does not select the hit block. */
+		bool RayCast(const Vector3& rayOrig, const Vector3& dir, float length, PickResult& result, uint32_t filter);
+
 		/**
 		* @params : world chunk coordinates
 		*/
@@ -672,9 +739,24 @@ namespace ParaEngine
 		BlockRegionPtr* m_pRegions;
 		std::map<int, BlockRegion*> m_regionCache;
 
+		/** background thread of SaveToFileAsync */
+		std::thread m_save_thread;
+		std::atomic<bool> m_bIsSaving;
+		/** guards m_savingRegions and m_saveCallbacks, which are shared with the background save thread */
+		std::mutex m_saveMutex;
+		std::condition_variable m_saveCondition;
+		/** packed index of regions whose snapshot is not written yet */
+		std::set<int> m_savingRegions;
+		/** callback type and msg of regions or worlds saved in background, which are activated in the main thread by OnFrameMove() */
+		std::vector< std::pair<int, std::string> > m_saveCallbacks;
+
 		//Block templates
 		std::map<uint16_t, BlockTemplate*> m_blockTemplates;
 		std::vector<BlockTemplate*> m_blockTemplatesArray;
+		/** hash of m_blockTemplates, written by the main thread and read by asset loader threads. */
+		std::atomic<uint32> m_nTemplateTableHash;
+		/** BlockTemplate::GetChangeCount() when m_nTemplateTableHash was computed. */
+		uint32 m_nTemplateHashChangeCount;
 
 		//save old data to revert
 		struct BlockTemplateVisibleData
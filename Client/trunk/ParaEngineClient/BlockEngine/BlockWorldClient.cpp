@@ -2644,6 +2644,10 @@ namespace ParaEngine
 
 		// OUTPUT_LOG("---------------cx %d, cz %d\n", chunkX, chunkZ);
 
+		m_cullingBoxes.clear();
+		m_cullingChunks.clear();
+		m_cullingViewDists.clear();
+
 		for (uint16 y = startIdx.y; y <= endIdx.y; y++)
 		{
 			uint16 x = (uint16)(chunkX);
@@ -2655,12 +2659,7 @@ namespace ParaEngine
 				vMin -= renderOrig;
 				Vector3 vMax = vMin + vChunkSize;
 
-				CShapeAABB box;
-				box.SetMinMax(vMin, vMax);
-				if (frustum->TestBox(&box) && chunk.IsNearbyChunksLoaded())
-				{
-					AddToVisibleChunk(chunk, 0, nRenderFrameCount);
-				}
+				AddCullingCandidate(chunk, 0, vMin, vMax);
 			}
 		}
 
@@ -2688,12 +2687,7 @@ namespace ParaEngine
 							vMin -= renderOrig;
 							Vector3 vMax = vMin + vChunkSize;
 
-							CShapeAABB box;
-							box.SetMinMax(vMin, vMax);
-							if (frustum->TestBox(&box) && chunk.IsNearbyChunksLoaded())
-							{
-								AddToVisibleChunk(chunk, length, nRenderFrameCount);
-							}
+							AddCullingCandidate(chunk, length, vMin, vMax);
 						}
 					}
 				}
@@ -2718,20 +2712,34 @@ namespace ParaEngine
 					vMin -= renderOrig;
 					Vector3 vMax = vMin + vChunkSize;
 
-					CShapeAABB box;
-					box.SetMinMax(vMin, vMax);
-					if (frustum->TestBox(&box) && chunk.IsNearbyChunksLoaded())
-					{
-						AddToVisibleChunk(chunk, chunkViewSize, nRenderFrameCount);
-					}
+					AddCullingCandidate(chunk, chunkViewSize, vMin, vMax);
 				}
 			}
 		}
 
+		// test all candidates against the frustum in a batch, and add visible ones in the same spiral order.
+		int nCandidateCount = (int)m_cullingChunks.size();
+		m_cullingVisibleMask.resize((nCandidateCount + 31) / 32 + 1);
+		if (frustum->TestBoxes(m_cullingBoxes, &m_cullingVisibleMask[0]) > 0)
+		{
+			for (int i = 0; i < nCandidateCount; ++i)
+			{
+				if ((m_cullingVisibleMask[i >> 5] & (1u << (i & 31))) && m_cullingChunks[i]->IsNearbyChunksLoaded())
+					AddToVisibleChunk(*m_cullingChunks[i], m_cullingViewDists[i], nRenderFrameCount);
+			}
+		}
+
 		if (!bIsShadowPass)
 			m_isVisibleChunkDirty = false;
 	}
 
+	void BlockWorldClient::AddCullingCandidate(RenderableChunk &chunk, int nViewDist, const Vector3& vMin, const Vector3& vMax)
+	{
+		m_cullingBoxes.push_back(vMin, vMax);
+		m_cullingChunks.push_back(&chunk);
+		m_cullingViewDists.push_back(nViewDist);
+	}
+
 
 	void BlockWorldClient::AddToVisibleChunk(RenderableChunk &chunk, int nViewDist, int nRenderFrameCount)
 	{
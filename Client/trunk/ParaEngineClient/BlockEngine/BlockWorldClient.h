@@ -1,6 +1,7 @@
 #pragma once
 #include "BlockWorld.h"
 #include "effect_file.h"
+#include "ShapeFrustum.h"
 
 namespace ParaEngine
 {
@@ -298,6 +299,8 @@ namespace ParaEngine
 		bool HasSunlightShadowMap();
 
 		void AddToVisibleChunk(RenderableChunk &chunk, int nViewDist, int nRenderFrameCount);
+		/** add a chunk to be tested against the frustum in a batch by UpdateVisibleChunks() */
+		void AddCullingCandidate(RenderableChunk &chunk, int nViewDist, const Vector3& vMin, const Vector3& vMax);
 		int ClearActiveChunksToMemLimit(bool bIsShadowPass = false);
 
 		void ClearVisibleChunksToByteLimit(bool bIsShadowPass);
@@ -325,6 +328,11 @@ namespace ParaEngine
 		std::vector<BlockRenderTask*> m_alphaBlendRenderTasks;
 		std::vector<BlockRenderTask*> m_reflectedWaterRenderTasks;
 
+		/** chunks in view range to be frustum culled in a batch, in the order of view distance. */
+		CShapeAABBArray m_cullingBoxes;
+		std::vector<RenderableChunk*> m_cullingChunks;
+		std::vector<int> m_cullingViewDists;
+		std::vector<uint32> m_cullingVisibleMask;
 
 		std::vector<float> m_selectBlockInstData;
 		int32_t m_maxSelectBlockPerBatch;
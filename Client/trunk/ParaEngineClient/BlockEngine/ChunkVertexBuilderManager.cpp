@@ -21,11 +21,14 @@ using namespace ParaEngine;
 // define to output log for debugging. 
 // #define PRINT_CHUNK_LOG
 
+/** default number of chunk build threads is the number of cores minus main and light threads, but no more than this. */
+#define MAX_DEFAULT_CHUNK_BUILD_THREADS		4
+
 ParaEngine::ChunkVertexBuilderManager::ChunkVertexBuilderManager()
 	:m_nMaxPendingChunks(4), m_nMaxUploadingChunks(4), m_bChunkThreadStarted(false),
 	m_nMaxChunksToUploadPerTick(8), m_nMaxBytesToUploadPerTick(4*1024*1024), m_pBlockWorld(nullptr)
 {
-
+	m_nBuildThreadCount = (std::max)(1, (std::min)((int)std::thread::hardware_concurrency() - 2, MAX_DEFAULT_CHUNK_BUILD_THREADS));
 }
 
 ParaEngine::ChunkVertexBuilderManager::~ChunkVertexBuilderManager()
@@ -41,7 +44,9 @@ ChunkVertexBuilderManager& ParaEngine::ChunkVertexBuilderManager::GetInstance()
 bool ParaEngine::ChunkVertexBuilderManager::AddChunk(RenderableChunk* pChunk)
 {
 	std::unique_lock<std::mutex> Lock_(m_mutex);
-	if ((int)m_pendingChunks.size() >= m_nMaxPendingChunks || (int)m_pendingUploadChunks.size() >= m_nMaxUploadingChunks)
+	// keep every build thread busy
+	int nMinQueueSize = m_bChunkThreadStarted ? (int)m_chunk_build_threads.size() * 2 : 0;
+	if ((int)m_pendingChunks.size() >= (std::max)(m_nMaxPendingChunks, nMinQueueSize) || (int)m_pendingUploadChunks.size() >= (std::max)(m_nMaxUploadingChunks, nMinQueueSize))
 		return false;
 	if (pChunk && !pChunk->IsBuildingBuffer())
 	{
@@ -88,22 +93,25 @@ void ParaEngine::ChunkVertexBuilderManager::Cleanup()
 		m_pendingUploadChunks.clear();
 		m_pendingChunks.clear();
 	}
-	if (m_pBlockWorld && m_bChunkThreadStarted && m_chunk_build_thread.joinable())
+	if (m_pBlockWorld && m_bChunkThreadStarted && !m_chunk_build_threads.empty())
 	{
 		if (!m_pBlockWorld->GetReadWriteLock().HasWriterLock())
 		{
 			m_bChunkThreadStarted = false;
-			m_chunk_request_signal.notify_one();
-			m_chunk_build_thread.join();
+			m_chunk_request_signal.notify_all();
+			for (auto& thread : m_chunk_build_threads)
+				thread.join();
 		}
 		else
 		{
 			PE_ASSERT(m_pBlockWorld->GetReadWriteLock().IsCurrentThreadHasWriterLock());
 			Scoped_WriterUnlock<> unlock_(m_pBlockWorld->GetReadWriteLock());
 			m_bChunkThreadStarted = false;
-			m_chunk_request_signal.notify_one();
-			m_chunk_build_thread.join();
+			m_chunk_request_signal.notify_all();
+			for (auto& thread : m_chunk_build_threads)
+				thread.join();
 		}
+		m_chunk_build_threads.clear();
 	}
 }
 
@@ -228,10 +236,22 @@ void ParaEngine::ChunkVertexBuilderManager::StartChunkBuildThread(CBlockWorld* p
 		Cleanup();
 		m_pBlockWorld = pBlockWorld;
 		m_bChunkThreadStarted = true;
-		m_chunk_build_thread = std::thread(std::bind(&ChunkVertexBuilderManager::ChunkBuildThreadProc, this));
+		for (int i = 0; i < m_nBuildThreadCount; ++i)
+			m_chunk_build_threads.push_back(std::thread(std::bind(&ChunkVertexBuilderManager::ChunkBuildThreadProc, this)));
 	}
 }
 
+bool ParaEngine::ChunkVertexBuilderManager::HasChunkToBuild()
+{
+	std::lock_guard<std::mutex> Lock_(m_mutex);
+	for (RenderableChunk* pChunk : m_pendingChunks)
+	{
+		if (pChunk && pChunk->GetChunkBuildState() == RenderableChunk::ChunkBuild_RequestRebuild)
+			return true;
+	}
+	return false;
+}
+
 
 int ParaEngine::ChunkVertexBuilderManager::ProcessOneChunk(Scoped_ReadLock<BlockReadWriteLock>& ReadWriteLock_)
 {
@@ -250,8 +270,9 @@ int ParaEngine::ChunkVertexBuilderManager::ProcessOneChunk(Scoped_ReadLock<Block
 					itCur = m_pendingChunks.erase(itCur);
 					continue;
 				}
-				else if (pChunkToBuild == NULL)
+				else if (pChunkToBuild == NULL && pChunk->GetChunkBuildState() == RenderableChunk::ChunkBuild_RequestRebuild)
 				{
+					// chunks that are being rebuilt by other build threads are skipped
 					pChunk->SetChunkBuildState(RenderableChunk::ChunkBuild_Rebuilding);
 					pChunkToBuild = pChunk;
 				}
@@ -289,12 +310,12 @@ void ParaEngine::ChunkVertexBuilderManager::ChunkBuildThreadProc()
 	{
 		if (ProcessOneChunk(lock_) == 0)
 		{
-			if (m_pendingChunks.empty())
+			if (!HasChunkToBuild())
 			{
 				lock_.unlock();
 				{
 					std::unique_lock<std::mutex> QueueLock_(m_queueMutex);
-					if (m_pendingChunks.empty())
+					if (m_bChunkThreadStarted && !HasChunkToBuild())
 					{
 						m_chunk_request_signal.wait(QueueLock_);
 					}
@@ -331,6 +352,16 @@ void ParaEngine::ChunkVertexBuilderManager::SetMaxBytesToUploadPerTick(int val)
 	m_nMaxBytesToUploadPerTick = val;
 }
 
+int ParaEngine::ChunkVertexBuilderManager::GetBuildThreadCount() const
+{
+	return m_nBuildThreadCount;
+}
+
+void ParaEngine::ChunkVertexBuilderManager::SetBuildThreadCount(int val)
+{
+	m_nBuildThreadCount = (std::max)(val, 1);
+}
+
 
 int ParaEngine::ChunkVertexBuilderManager::InstallFields(CAttributeClass* pClass, bool bOverride)
 {
@@ -339,6 +370,7 @@ int ParaEngine::ChunkVertexBuilderManager::InstallFields(CAttributeClass* pClass
 	pClass->AddField("MaxChunksToUploadPerTick", FieldType_Int, (void*)SetMaxChunksToUploadPerTick_s, (void*)GetMaxChunksToUploadPerTick_s, NULL, NULL, bOverride);
 	pClass->AddField("MaxBytesToUploadPerTick", FieldType_Int, (void*)SetMaxBytesToUploadPerTick_s, (void*)GetMaxBytesToUploadPerTick_s, NULL, NULL, bOverride);
 	pClass->AddField("PendingChunksCount", FieldType_Int, (void*)0, (void*)GetPendingChunksCount_s, NULL, NULL, bOverride);
+	pClass->AddField("BuildThreadCount", FieldType_Int, (void*)SetBuildThreadCount_s, (void*)GetBuildThreadCount_s, NULL, NULL, bOverride);
 
 	return S_OK;
 }
@@ -11,7 +11,10 @@ namespace ParaEngine
 	class CBlockWorld;
 	class BlockWorldClient;
 
-	/** for filling chunk vertex in a different thread. this is usually the lighting thread. */
+	/** for filling chunk vertex in worker threads. Each worker builds a different chunk while sharing the read lock of the block world.
+	* Workers still tessellate under that read lock: neighbor blocks and light are cached per chunk (see PaddedChunkCache),
+	* but block templates and models are read from the world, so there is no detached lock-free snapshot yet.
+	*/
 	class ChunkVertexBuilderManager : public IAttributeFields
 	{
 	public:
@@ -29,6 +32,9 @@ namespace ParaEngine
 
 		ATTRIBUTE_METHOD1(ChunkVertexBuilderManager, GetPendingChunksCount_s, int*)		{ *p1 = cls->GetPendingChunksCount(); return S_OK; }
 
+		ATTRIBUTE_METHOD1(ChunkVertexBuilderManager, GetBuildThreadCount_s, int*)		{ *p1 = cls->GetBuildThreadCount(); return S_OK; }
+		ATTRIBUTE_METHOD1(ChunkVertexBuilderManager, SetBuildThreadCount_s, int)	{ cls->SetBuildThreadCount(p1); return S_OK; }
+
 	public:
 		static ChunkVertexBuilderManager& GetInstance();
 
@@ -57,8 +63,14 @@ namespace ParaEngine
 		int GetMaxBytesToUploadPerTick() const;
 		void SetMaxBytesToUploadPerTick(int val);
 
+		/** number of chunk build threads. It takes effect the next time the build threads are started, such as when entering a world. */
+		int GetBuildThreadCount() const;
+		void SetBuildThreadCount(int val);
+
 	protected:
 		void ChunkBuildThreadProc();
+		/** whether there is any pending chunk that is not being built by another thread. */
+		bool HasChunkToBuild();
 	protected:
 		// weak references, no need to release them.
 		// chunks that need to be rebuild. 
@@ -67,7 +79,7 @@ namespace ParaEngine
 		std::vector<RenderableChunk*> m_pendingUploadChunks;
 		std::mutex m_mutex;
 		std::mutex m_queueMutex;
-		std::thread m_chunk_build_thread;
+		std::vector<std::thread> m_chunk_build_threads;
 		std::condition_variable m_chunk_request_signal;
 		bool m_bChunkThreadStarted;
 		CBlockWorld* m_pBlockWorld;
@@ -75,6 +87,7 @@ namespace ParaEngine
 		int m_nMaxUploadingChunks;
 		int m_nMaxChunksToUploadPerTick;
 		int m_nMaxBytesToUploadPerTick;
+		int m_nBuildThreadCount;
 		
 		friend class CBlockWorld;
 		friend class BlockWorldClient;
@@ -0,0 +1,94 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+namespace ParaEngine
+{
+	/** size of the padded neighbor cache along each axis: a chunk plus one block on each side */
+#define NEIGHBOR_CACHE_DIM		18
+
+	/**
+	* lazily filled cache of block pointers and block/sun light of a 16*16*16 chunk plus a one block border, which is used by
+	* BlockTessellatorBase::FetchNearbyBlockInfo(), so that each cell is fetched from the world at most once per chunk build.
+	* How a cell is fetched is given by the caller, so that it only depends on the standard library and can be tested on its own.
+	*
+	* It is not a detached snapshot: cells are fetched on demand while the chunk builder holds the world read lock,
+	* and cached block pointers are only valid until that lock is released, see Clear().
+	* @param BlockPtr: type of cached block, such as Block*.
+	*/
+	template <class BlockPtr>
+	class PaddedChunkCache
+	{
+	public:
+		PaddedChunkCache(){};
+
+		/** index of chunk space coordinate x,y,z in [-1,16] */
+		static inline int GetIndex(int x, int y, int z)
+		{
+			return ((y + 1) * NEIGHBOR_CACHE_DIM + (z + 1)) * NEIGHBOR_CACHE_DIM + (x + 1);
+		}
+
+		/** invalidate all cells, allocating them on first use. */
+		void Clear()
+		{
+			const int nCellCount = NEIGHBOR_CACHE_DIM * NEIGHBOR_CACHE_DIM * NEIGHBOR_CACHE_DIM;
+			if ((int)m_flags.size() != nCellCount)
+			{
+				m_blocks.resize(nCellCount);
+				m_lights.resize(nCellCount * 2);
+				m_flags.resize(nCellCount);
+			}
+			memset(&(m_flags[0]), 0, m_flags.size());
+		}
+
+		/** @param fetchBlock: BlockPtr fetchBlock(x, y, z) in chunk space, called only if the cell is not fetched yet. */
+		template <class FetchBlock>
+		inline BlockPtr GetBlock(int x, int y, int z, FetchBlock& fetchBlock)
+		{
+			int nIndex = GetIndex(x, y, z);
+			if ((m_flags[nIndex] & 1) == 0)
+			{
+				m_flags[nIndex] |= 1;
+				m_blocks[nIndex] = fetchBlock(x, y, z);
+			}
+			return m_blocks[nIndex];
+		}
+
+		/** @param fetchLight: void fetchLight(x, y, z, uint8_t* pLight) that writes block light and sun light to pLight[0] and pLight[1].
+		* @return block light and sun light of the cell */
+		template <class FetchLight>
+		inline const uint8_t* GetLight(int x, int y, int z, FetchLight& fetchLight)
+		{
+			int nIndex = GetIndex(x, y, z);
+			uint8_t* pLight = &(m_lights[nIndex * 2]);
+			if ((m_flags[nIndex] & 2) == 0)
+			{
+				m_flags[nIndex] |= 2;
+				pLight[0] = pLight[1] = 0;
+				fetchLight(x, y, z, pLight);
+			}
+			return pLight;
+		}
+
+		/** brightness[i] = max(blockLight[i], (uint8)(sunLight[i] * fSunIntensity)) for i in [0, nCount).
+		* the arrays are contiguous and the loop has no branches, so that compilers can vectorize it.
+		* It is the same as CBlockWorld::GetBlockBrightness() with light type 3. */
+		static void CombineBrightness(const uint8_t* blockLight, const uint8_t* sunLight, int nCount, float fSunIntensity, uint8_t* brightness)
+		{
+			for (int i = 0; i < nCount; ++i)
+			{
+				uint8_t nSunLight = (uint8_t)(sunLight[i] * fSunIntensity);
+				uint8_t nBlockLight = blockLight[i];
+				brightness[i] = nBlockLight > nSunLight ? nBlockLight : nSunLight;
+			}
+		}
+
+	private:
+		std::vector<BlockPtr> m_blocks;
+		/** block light and sun light of each cell */
+		std::vector<uint8_t> m_lights;
+		/** bit 1: block is fetched, bit 2: light is fetched */
+		std::vector<uint8_t> m_flags;
+	};
+}
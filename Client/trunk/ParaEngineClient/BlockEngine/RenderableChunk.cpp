@@ -23,6 +23,16 @@ namespace ParaEngine
 {
 	int RenderableChunk::s_nTotalRenderableChunks = 0;
 
+	/** enable the neighbor cache of a tessellator during the scope */
+	class NeighborCacheScope
+	{
+	public:
+		NeighborCacheScope(BlockTessellatorBase& tessellator, BlockChunk* pChunk) : m_tessellator(tessellator) { m_tessellator.BeginNeighborCache(pChunk); }
+		~NeighborCacheScope() { m_tessellator.EndNeighborCache(); }
+	private:
+		BlockTessellatorBase& m_tessellator;
+	};
+
 	RenderableChunk::RenderableChunk()
 		:m_pWorld(NULL), m_chunkBuildState(ChunkBuild_empty), m_nDelayedRebuildTick(0), m_nChunkViewDistance(0), m_nViewIndex(0), m_nRenderFrameCount(0), m_nLastVertexBufferBytes(0), m_dwShaderID(-1), m_bIsMainRenderer(true), m_bIsDirtyByBlockChange(true)
 	{
@@ -662,6 +672,7 @@ namespace ParaEngine
 	nCpuYieldCount++;\
 	Lock_->unlock(); \
 	Lock_->lock(); \
+	tessellator.ClearNeighborCache();\
 	if(!m_pWorld->IsInBlockWorld() || m_isDirty)\
 		return;\
 }
@@ -691,6 +702,9 @@ namespace ParaEngine
 			return;
 		}
 		int nCpuYieldCount = 0;
+		BlockGeneralTessellator& tessellator = GetBlockTessellator();
+		// neighbor blocks and light of this chunk are fetched only once during tessellation
+		NeighborCacheScope neighborCache_(tessellator, pChunk);
 		//------------------------------------------------------------------------
 		//fill instance group
 		ResetInstanceGroups();
@@ -718,7 +732,6 @@ namespace ParaEngine
 		const int32 maxFaceCountPerBatch = BlockConfig::g_maxFaceCountPerBatch;
 		//-------------------------------------------------------------
 		//3.fill buffer
-		BlockGeneralTessellator& tessellator = GetBlockTessellator();
 		int32 nFreeFaceCountInVertexBuffer = Math::Min(maxFaceCountPerBatch, m_totalFaceCount - nFaceCountCompleted);
 		int32 nMemoryBufferIndex = 0;
 		ParaVertexBuffer memoryBuffer = RequestMemoryBuffer(nFreeFaceCountInVertexBuffer, &nMemoryBufferIndex);
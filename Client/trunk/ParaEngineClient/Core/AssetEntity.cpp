@@ -25,18 +25,22 @@ using namespace ParaEngine;
 static string g_sUrlAssetServer = DEFAULT_ASSET_SERVER_URL;
 
 
-AssetEntity::AssetEntity() :m_bIsValid(true), m_bIsInitialized(false), m_bIsLocked(false), m_assetState(ASSET_STATE_NORMAL)
+AssetEntity::AssetEntity() :m_bIsValid(true), m_bIsInitialized(false), m_bIsLocked(false), m_assetState(ASSET_STATE_NORMAL),
+	m_pLRUList(NULL), m_pLRUPrev(NULL), m_pLRUNext(NULL), m_nLastAccessTick(0)
 {
 
 }
 
-AssetEntity::AssetEntity(const AssetKey& key) : m_bIsValid(true), m_bIsInitialized(false), m_bIsLocked(false), m_key(key), m_assetState(ASSET_STATE_NORMAL)
+AssetEntity::AssetEntity(const AssetKey& key) : m_bIsValid(true), m_bIsInitialized(false), m_bIsLocked(false), m_key(key), m_assetState(ASSET_STATE_NORMAL),
+	m_pLRUList(NULL), m_pLRUPrev(NULL), m_pLRUNext(NULL), m_nLastAccessTick(0)
 {
 
 }
 
 AssetEntity::~AssetEntity()
 {
+	if (m_pLRUList)
+		m_pLRUList->Remove(this);
 
 }
 
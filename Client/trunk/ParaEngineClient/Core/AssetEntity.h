@@ -12,6 +12,29 @@ namespace ParaEngine
 	*/
 	typedef std::string AssetKey;
 
+	struct AssetEntity;
+
+	/**
+	* intrusive list of the entities of an asset manager, most recently used first.
+	* Touching an entity moves it to the front in constant time, so that the asset manager can unload
+	* least recently used entities when its memory budget is exceeded. 
+	*/
+	struct AssetLRUList
+	{
+	public:
+		AssetLRUList() :m_pHead(NULL), m_pTail(NULL), m_nTick(0){};
+
+		/** add the entity to the front, or move it there if it is already in the list. */
+		inline void MoveToFront(AssetEntity* pEntity);
+		/** remove the entity from the list */
+		inline void Remove(AssetEntity* pEntity);
+
+		AssetEntity* m_pHead;
+		AssetEntity* m_pTail;
+		/** current access tick. It is increased each time the asset manager checks its memory budget. */
+		uint32 m_nTick;
+	};
+
 	/**
 	* Base class for managed asset entity in ParaEngine.
 	* We allow each entity to have one name shortcut of string type,
@@ -202,6 +225,7 @@ namespace ParaEngine
 		* automatically, during resource pointer retrieval function.
 		* E.g. During each frame render routine, call this function if the asset is used.*/
 		void LoadAsset(){
+			Touch();
 			if(!m_bIsInitialized)
 			{
 				InitDeviceObjects();
@@ -248,6 +272,16 @@ namespace ParaEngine
 
 		/** Get AABB bounding box of the asset object. if the asset contains an OOB, it will return true. */
 		virtual bool GetBoundingBox(Vector3* pMin, Vector3* pMax) { return false; };
+
+		/** estimated bytes of loaded data of this asset. It is used by the memory budget of the asset manager. 
+		* 0 (default) if unknown, in which case the asset is never unloaded by the budget. */
+		virtual int64 GetMemoryBytes() { return 0; };
+
+		/** mark as most recently used in its asset manager. It is called automatically in LoadAsset(). */
+		inline void Touch(){
+			if (m_pLRUList)
+				m_pLRUList->MoveToFront(this);
+		}
 	public:
 		/** this is the unique key object. */
 		AssetKey m_key;
@@ -258,6 +292,13 @@ namespace ParaEngine
 		/** whether this is a valid resource object. */
 		bool		m_bIsValid;
 
+		/** the LRU list of the asset manager that this entity belongs to. NULL if not managed. */
+		AssetLRUList* m_pLRUList;
+		AssetEntity* m_pLRUPrev;
+		AssetEntity* m_pLRUNext;
+		/** AssetLRUList::m_nTick when this entity is last touched */
+		uint32 m_nLastAccessTick;
+
 	private:
 		/** asset state: whether asset is being sync or not*/
 		AssetState m_assetState;
@@ -270,6 +311,45 @@ namespace ParaEngine
 		*/
 		string m_localfilename;
 	};
+
+	inline void AssetLRUList::MoveToFront(AssetEntity* pEntity)
+	{
+		pEntity->m_nLastAccessTick = m_nTick;
+		if (m_pHead == pEntity)
+			return;
+		// unlink if it is already in the list
+		if (pEntity->m_pLRUPrev)
+			pEntity->m_pLRUPrev->m_pLRUNext = pEntity->m_pLRUNext;
+		if (pEntity->m_pLRUNext)
+			pEntity->m_pLRUNext->m_pLRUPrev = pEntity->m_pLRUPrev;
+		else if (m_pTail == pEntity)
+			m_pTail = pEntity->m_pLRUPrev;
+
+		pEntity->m_pLRUPrev = NULL;
+		pEntity->m_pLRUNext = m_pHead;
+		if (m_pHead)
+			m_pHead->m_pLRUPrev = pEntity;
+		m_pHead = pEntity;
+		if (m_pTail == NULL)
+			m_pTail = pEntity;
+		pEntity->m_pLRUList = this;
+	}
+
+	inline void AssetLRUList::Remove(AssetEntity* pEntity)
+	{
+		if (pEntity->m_pLRUList != this)
+			return;
+		if (pEntity->m_pLRUPrev)
+			pEntity->m_pLRUPrev->m_pLRUNext = pEntity->m_pLRUNext;
+		else
+			m_pHead = pEntity->m_pLRUNext;
+		if (pEntity->m_pLRUNext)
+			pEntity->m_pLRUNext->m_pLRUPrev = pEntity->m_pLRUPrev;
+		else
+			m_pTail = pEntity->m_pLRUPrev;
+		pEntity->m_pLRUPrev = pEntity->m_pLRUNext = NULL;
+		pEntity->m_pLRUList = NULL;
+	}
 }
 
 #include "AssetManager.h"
\ No newline at end of file
@@ -18,6 +18,7 @@ namespace ParaEngine
 		typedef std::map<AssetKey, ETYPE*> AssetItemsSet_t;
 
 		AssetManager()
+			:m_nMemoryBudget(0), m_nResidentBytes(0)
 		{
 			static_assert(std::is_convertible<IDTYPE*, AssetEntity*>::value, "Invalid Type for AssetManager!");
 			// since asset manager is kind of singleton pattern, we will always set reference count to 1 during creation. 
@@ -76,6 +77,7 @@ namespace ParaEngine
 					OUTPUT_LOG("warning: asset <%s> exits with ref %d\n", pAsset->m_key.c_str(), pAsset->GetRefCount()-1);
 				}
 #endif
+				m_lru.Remove(itCurCP->second);
 				// normally, it should have 0 reference count at this place. And a delete this operation is performed. 
 				itCurCP->second->Release();
 
@@ -89,6 +91,7 @@ namespace ParaEngine
 			m_names.clear();
 
 			m_lowercase_item_maps.clear();
+			m_nResidentBytes = 0;
 		}
 
 		/**
@@ -149,6 +152,7 @@ namespace ParaEngine
 			{
 				OUTPUT_LOG("warning: you are deleting an entity %s whose has unreleased external references\n", entity->GetKey().c_str());
 			}
+			m_lru.Remove(entity);
 			// unload anyway.
 			entity->UnloadAsset();
 			// normally, it should have 0 reference count at this place. And a delete this operation is performed. 
@@ -252,6 +256,7 @@ namespace ParaEngine
 				}
 				m_items[key] = pEntity;
 				pEntity->addref();
+				m_lru.MoveToFront(pEntity);
 
 				// add a lower cased map
 				std::string sNameLowered;
@@ -290,6 +295,7 @@ namespace ParaEngine
 						m_names[name] = pEntity;
 					}
 				}
+				pEntity->Touch();
 				/// return false if the object already exists
 				return pair<IDTYPE*, bool>((IDTYPE*)pEntity, false);
 			}
@@ -303,6 +309,7 @@ namespace ParaEngine
 				}
 				m_items[key] = pEntity;
 				pEntity->addref();
+				m_lru.MoveToFront(pEntity);
 
 				// add a lower cased map
 				std::string sNameLowered;
@@ -347,6 +354,44 @@ namespace ParaEngine
 			}
 		}
 
+		/** max bytes of loaded entities. 0 (default) for unlimited. */
+		void SetMemoryBudget(int64 nBytes) { m_nMemoryBudget = nBytes; }
+		int64 GetMemoryBudget() const { return m_nMemoryBudget; }
+
+		/** bytes of loaded entities that are kept by the last CheckMemoryBudget() */
+		int64 GetResidentBytes() const { return m_nResidentBytes; }
+
+		/** walk loaded entities from the most recently used one, and unload the rest once the memory budget is used up. 
+		* Only entities without external references are unloaded, and those touched since the last check are always kept. 
+		* Unloaded entities stay in the manager, and are lazily loaded again when used.
+		* @return the number of entities unloaded. 
+		*/
+		int CheckMemoryBudget()
+		{
+			uint32 nLastTick = m_lru.m_nTick++;
+			int64 nBytes = 0;
+			int nCount = 0;
+			for (AssetEntity* pEntity = m_lru.m_pHead; pEntity != 0; )
+			{
+				AssetEntity* pNext = pEntity->m_pLRUNext;
+				if (pEntity->IsInitialized())
+				{
+					int64 nEntityBytes = pEntity->GetMemoryBytes();
+					if (m_nMemoryBudget > 0 && nEntityBytes > 0 && (nBytes + nEntityBytes) > m_nMemoryBudget
+						&& pEntity->GetRefCount() <= 1 && !pEntity->IsLocked() && pEntity->m_nLastAccessTick != nLastTick)
+					{
+						pEntity->UnloadAsset();
+						++nCount;
+					}
+					else
+						nBytes += nEntityBytes;
+				}
+				pEntity = pNext;
+			}
+			m_nResidentBytes = nBytes;
+			return nCount;
+		}
+
 		/**
 		* check if the entity exist, if so call Refresh().  
 		* @param sEntityName: the asset entity key
@@ -436,5 +481,10 @@ namespace ParaEngine
 		* mapping from lower cased AssetKey to asset entity. 
 		*/
 		AssetItemsNameMap_t m_lowercase_item_maps;
+		/** all managed entities, most recently used first */
+		AssetLRUList m_lru;
+		/** max bytes of loaded entities. 0 for unlimited */
+		int64 m_nMemoryBudget;
+		int64 m_nResidentBytes;
 	};
 }
\ No newline at end of file
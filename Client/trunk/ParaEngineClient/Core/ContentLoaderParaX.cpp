@@ -14,6 +14,7 @@
 #include "ParaXModel/ParaXModel.h"
 #include "ParaXModel/FBXParser.h"
 #include "BMaxModel/BMaxParser.h"
+#include "BMaxModel/BMaxModelCache.h"
 #include "ParaXSerializer.h"
 #include "ParaMeshXMLFile.h"
 #include "AsyncLoader.h"
@@ -303,12 +304,29 @@ HRESULT ParaEngine::CParaXProcessor::CopyToResource()
 				{
 					// block max model. 
 					BMaxParser p;
+					bool bMergeCoplanerBlockFace = true;
 					ParaXEntity* pParaEntity = dynamic_cast<ParaXEntity*>(m_asset.get());
 					if (pParaEntity != nullptr) {
-						p.SetMergeCoplanerBlockFace(pParaEntity->GetMergeCoplanerBlockFace());
+						bMergeCoplanerBlockFace = pParaEntity->GetMergeCoplanerBlockFace();
+						p.SetMergeCoplanerBlockFace(bMergeCoplanerBlockFace);
+					}
+					// try the compiled binary cache first
+					BMaxModelCache& cache = BMaxModelCache::GetInstance();
+					std::string sCacheFile;
+					bool bParserLoaded = false;
+					if (cache.IsEnabled())
+					{
+						sCacheFile = cache.GetCacheFilename(myFile.getBuffer(), (int32)myFile.getSize(), bMergeCoplanerBlockFace);
+						iCur->m_pParaXMesh = cache.LoadModel(sCacheFile);
+					}
+					if (iCur->m_pParaXMesh == 0)
+					{
+						p.Load(myFile.getBuffer(), myFile.getSize());
+						bParserLoaded = true;
+						iCur->m_pParaXMesh = p.ParseParaXModel();
+						if (iCur->m_pParaXMesh && !sCacheFile.empty() && !p.HasRefModels())
+							cache.SaveModel(sCacheFile, iCur->m_pParaXMesh.get());
 					}
-					p.Load(myFile.getBuffer(), myFile.getSize());
-					iCur->m_pParaXMesh = p.ParseParaXModel();
 					auto pParaXMesh = iCur->m_pParaXMesh;
 
 #ifdef ENABLE_BMAX_AUTO_LOD
@@ -349,7 +367,24 @@ HRESULT ParaEngine::CParaXProcessor::CopyToResource()
 							if ((int)pParaXMesh->GetPolyCount() >= nLodsMaxTriangleCounts[i].nMaxTriangleCount)
 							{
 								MeshLOD lod;
-								lod.m_pParaXMesh = p.ParseParaXModel((std::min)(nLodsMaxTriangleCounts[i].nMaxTriangleCount, (int)(pParaXMesh->GetPolyCount() / 2) - 4));
+								// generated LODs are cached too, so that the parser is only loaded when some LOD is missing.
+								std::string sLODCacheFile;
+								if (!sCacheFile.empty())
+								{
+									sLODCacheFile = BMaxModelCache::GetLODCacheFilename(sCacheFile, i + 1);
+									lod.m_pParaXMesh = cache.LoadModel(sLODCacheFile);
+								}
+								if (lod.m_pParaXMesh == 0)
+								{
+									if (!bParserLoaded)
+									{
+										p.Load(myFile.getBuffer(), myFile.getSize());
+										bParserLoaded = true;
+									}
+									lod.m_pParaXMesh = p.ParseParaXModel((std::min)(nLodsMaxTriangleCounts[i].nMaxTriangleCount, (int)(pParaXMesh->GetPolyCount() / 2) - 4));
+									if (lod.m_pParaXMesh && !sLODCacheFile.empty() && !p.HasRefModels())
+										cache.SaveModel(sLODCacheFile, lod.m_pParaXMesh.get());
+								}
 								lod.m_fromDepthSquared = Math::Sqr(nLodsMaxTriangleCounts[i].fMaxDistance);
 								if (lod.m_pParaXMesh)
 								{
@@ -71,7 +71,11 @@ namespace NPL
 		NPL_ConnectionDisconnected,
 		NPL_ConnectionAborted,
 		NPL_Command,
-		NPL_WrongProtocol
+		NPL_WrongProtocol,
+		/** bytes queued for sending on a connection is above the high watermark */
+		NPL_QueueHighWatermark,
+		/** bytes queued for sending on a connection drops below the low watermark */
+		NPL_QueueLowWatermark,
 	};
 
 	/**
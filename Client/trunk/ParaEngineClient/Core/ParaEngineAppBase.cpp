@@ -33,6 +33,7 @@
 #include "AISimulator.h"
 #include "AsyncLoader.h"
 #include "FileManager.h"
+#include "ParaWorldAsset.h"
 #include "Archive.h"
 #include "ParaEngineAppBase.h"
 #include "NPLPackageConfig.h"
@@ -114,6 +115,8 @@ void ParaEngine::CParaEngineAppBase::DestroySingletons()
 void ParaEngine::CParaEngineAppBase::OnFrameEnded()
 {
 	CObjectAutoReleasePool::GetInstance()->clear();
+	if (CGlobals::GetAssetManager())
+		CGlobals::GetAssetManager()->CheckMemoryBudget();
 }
 
 bool ParaEngine::CParaEngineAppBase::InitCommandLineParams()
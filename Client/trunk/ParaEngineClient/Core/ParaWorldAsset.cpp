@@ -40,6 +40,7 @@
 #include "FileManager.h"
 #include "AsyncLoader.h"
 #include "BufferPicking.h"
+#include "util/ParaTime.h"
 #include "ParaWorldAsset.h"
 #include "memdebug.h"
 
@@ -53,6 +54,9 @@
 /** @def define this false to disable async loading for textures by default*/
 #define IS_ASYNC_LOAD	true
 
+/** @def min interval in milliseconds between two memory budget checks */
+#define MEMORY_BUDGET_CHECK_INTERVAL	1000
+
 using namespace ParaEngine;
 
 CParaWorldAsset* g_singleton_asset_manager;
@@ -65,7 +69,7 @@ CParaWorldAsset* CParaWorldAsset::GetSingleton()
 * CParaWorldAsset class implementation.
 **/
 CParaWorldAsset::CParaWorldAsset(void)
-	: m_bAsyncLoading(IS_ASYNC_LOAD)
+	: m_bAsyncLoading(IS_ASYNC_LOAD), m_nLastBudgetCheckTime(0)
 {
 	g_singleton_asset_manager = this;
 	//////////////////////////////////////////////////////////////////////////
@@ -840,6 +844,30 @@ void CParaWorldAsset::GarbageCollectAll()
 	GetTextureManager().GarbageCollectAll();
 }
 
+void CParaWorldAsset::CheckMemoryBudget()
+{
+	int64 nTime = GetTimeMS();
+	if ((nTime - m_nLastBudgetCheckTime) < MEMORY_BUDGET_CHECK_INTERVAL)
+		return;
+	m_nLastBudgetCheckTime = nTime;
+	if (GetParaXManager().GetMemoryBudget() > 0)
+	{
+		int nCount = GetParaXManager().CheckMemoryBudget();
+		if (nCount > 0)
+			OUTPUT_LOG("%d parax models are unloaded by memory budget, %d KB resident\n", nCount, (int)(GetParaXManager().GetResidentBytes() / 1024));
+	}
+}
+
+int ParaEngine::CParaWorldAsset::GetParaXMemoryBudget()
+{
+	return (int)(GetParaXManager().GetMemoryBudget() / (1024 * 1024));
+}
+
+void ParaEngine::CParaWorldAsset::SetParaXMemoryBudget(int nMB)
+{
+	GetParaXManager().SetMemoryBudget((int64)nMB * 1024 * 1024);
+}
+
 bool CParaWorldAsset::UnloadAssetByKeyName(const string& keyname)
 {
 	string sFileExt = CParaFile::GetFileExtension(keyname);
@@ -1218,5 +1246,7 @@ int ParaEngine::CParaWorldAsset::InstallFields(CAttributeClass* pClass, bool bOv
 	pClass->AddField("EnableAssetManifest", FieldType_Bool, (void*)EnableAssetManifest_s, (void*)IsAssetManifestEnabled_s, NULL, NULL, bOverride);
 	pClass->AddField("UseLocalFileFirst", FieldType_Bool, (void*)SetUseLocalFileFirst_s, (void*)IsUseLocalFileFirst_s, NULL, NULL, bOverride);
 	pClass->AddField("DeleteTempDiskTextures", FieldType_void, (void*)DeleteTempDiskTextures_s, (void*)0, NULL, NULL, bOverride);
+	pClass->AddField("ParaXMemoryBudget", FieldType_Int, (void*)SetParaXMemoryBudget_s, (void*)GetParaXMemoryBudget_s, NULL, NULL, bOverride);
+	pClass->AddField("ParaXResidentKB", FieldType_Int, (void*)0, (void*)GetParaXResidentKB_s, NULL, NULL, bOverride);
 	return S_OK;
 }
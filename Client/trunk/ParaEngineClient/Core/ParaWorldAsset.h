@@ -69,6 +69,10 @@ namespace ParaEngine
 		ATTRIBUTE_METHOD1(CParaWorldAsset, SetUseLocalFileFirst_s, bool)	{ cls->SetUseLocalFileFirst(p1); return S_OK; }
 
 		ATTRIBUTE_METHOD(CParaWorldAsset, DeleteTempDiskTextures_s)	{ cls->DeleteTempDiskTextures(); return S_OK; }
+
+		ATTRIBUTE_METHOD1(CParaWorldAsset, GetParaXMemoryBudget_s, int*)	{ *p1 = cls->GetParaXMemoryBudget(); return S_OK; }
+		ATTRIBUTE_METHOD1(CParaWorldAsset, SetParaXMemoryBudget_s, int)	{ cls->SetParaXMemoryBudget(p1); return S_OK; }
+		ATTRIBUTE_METHOD1(CParaWorldAsset, GetParaXResidentKB_s, int*)	{ *p1 = (int)(cls->GetParaXManager().GetResidentBytes() / 1024); return S_OK; }
 	public:
 		static CParaWorldAsset* GetSingleton();
 
@@ -183,6 +187,15 @@ namespace ParaEngine
 		/** Garbage Collect(free resources of) all unused entity.*/
 		void GarbageCollectAll();
 
+		/** unload least recently used and unreferenced assets of managers which are over their memory budget. 
+		* it is called once per frame, but only does the check at most once per second. 
+		*/
+		void CheckMemoryBudget();
+
+		/** memory budget in MB of parax models, including bmax and xml models. 0 (default) for unlimited. */
+		int GetParaXMemoryBudget();
+		void SetParaXMemoryBudget(int nMB);
+
 		void	Cleanup();
 
 		HRESULT InitDeviceObjects();	// device independent
@@ -259,6 +272,8 @@ namespace ParaEngine
 		EffectManager							m_EffectsManager;
 		DynamicVertexBufferManager				m_DynamicVBManager;
 		bool m_bAsyncLoading;
+		/** time in milliseconds of the last CheckMemoryBudget() */
+		int64 m_nLastBudgetCheckTime;
 
 #ifdef USE_DIRECTX_RENDERER
 		/// dynamic buffer for MDX
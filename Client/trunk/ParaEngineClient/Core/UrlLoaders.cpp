@@ -12,6 +12,7 @@
 #include "NPLRuntime.h"
 #include "UrlLoaders.h"
 #include "AsyncLoader.h"
+#include "util/MD5.h"
 
 #ifdef PARAENGINE_CLIENT
 #include "memdebug.h"
@@ -98,7 +99,8 @@ ParaEngine::CUrlProcessor::CUrlProcessor()
 	:m_pFormPost(0), m_pHttpHeaders(0), m_nTimeOutTime(DEFAULT_TIME_OUT), m_nStartTime(0), m_responseCode(0), m_nLastProgressTime(0),
 	m_pFormLast(0), m_pUserData(0), m_returnCode(CURLE_OK), m_type(URL_REQUEST_HTTP_AUTO),
 	m_nPriority(0), m_nStatus(URL_REQUEST_UNSTARTED), m_pfuncCallBack(0), m_nBytesReceived(0), m_pUploadContext(NULL),
-	m_nTotalBytes(0), m_nUserDataType(0), m_pFile(NULL), m_pThreadLocalData(NULL), m_bForbidReuse(false), m_bEnableProgressUpdate(true), m_bIsSyncCallbackMode(false)
+	m_nTotalBytes(0), m_nUserDataType(0), m_pFile(NULL), m_pThreadLocalData(NULL), m_bForbidReuse(false), m_bEnableProgressUpdate(true), m_bIsSyncCallbackMode(false),
+	m_nResumeFrom(0), m_pStreamMD5(NULL)
 {
 }
 
@@ -106,7 +108,8 @@ ParaEngine::CUrlProcessor::CUrlProcessor(const string& url, const string& npl_ca
 	:m_pFormPost(0), m_pHttpHeaders(0), m_nTimeOutTime(DEFAULT_TIME_OUT), m_nStartTime(0), m_responseCode(0), m_nLastProgressTime(0),
 	m_pFormLast(0), m_pUserData(0), m_returnCode(CURLE_OK), m_type(URL_REQUEST_HTTP_AUTO),
 	m_nPriority(0), m_nStatus(URL_REQUEST_UNSTARTED), m_pfuncCallBack(0), m_nBytesReceived(0), m_pUploadContext(NULL),
-	m_nTotalBytes(0), m_nUserDataType(0), m_pFile(NULL), m_pThreadLocalData(NULL), m_bEnableProgressUpdate(true), m_bIsSyncCallbackMode(false)
+	m_nTotalBytes(0), m_nUserDataType(0), m_pFile(NULL), m_pThreadLocalData(NULL), m_bEnableProgressUpdate(true), m_bIsSyncCallbackMode(false),
+	m_nResumeFrom(0), m_pStreamMD5(NULL)
 {
 	m_url = url;
 	SetScriptCallback(npl_callback.c_str());
@@ -261,6 +264,16 @@ void ParaEngine::CUrlProcessor::SetSaveToFile(const char* filename)
 		m_sSaveToFileName = filename;
 }
 
+void ParaEngine::CUrlProcessor::SetResumeFrom(int nOffset)
+{
+	m_nResumeFrom = nOffset;
+}
+
+void ParaEngine::CUrlProcessor::SetStreamMD5(MD5* pMD5)
+{
+	m_pStreamMD5 = pMD5;
+}
+
 void ParaEngine::CUrlProcessor::SetUrl(const char* url)
 {
 	if (url)
@@ -390,6 +403,12 @@ void ParaEngine::CUrlProcessor::SetCurlEasyOpt(CURL* handle)
 	/* Pass a long. Set to 1 to make the next transfer explicitly close the connection when done. Normally, libcurl keeps all connections alive when done with one transfer in case a succeeding one follows that can re-use them. */
 	curl_easy_setopt(handle, CURLOPT_FORBID_REUSE, m_bForbidReuse ? 1 : 0);
 
+	if (m_nResumeFrom > 0 && !m_sSaveToFileName.empty())
+		curl_easy_setopt(handle, CURLOPT_RESUME_FROM, (long)m_nResumeFrom);
+	/* the body of a streamed download is hashed and appended to a partial file, which must never include an error page. */
+	if (m_pStreamMD5)
+		curl_easy_setopt(handle, CURLOPT_FAILONERROR, 1);
+
 	/* do not verify host */
 	curl_easy_setopt(handle, CURLOPT_SSL_VERIFYHOST, 0);
 	curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 0);
@@ -488,13 +507,30 @@ size_t ParaEngine::CUrlProcessor::write_data_callback(void *buffer, size_t size,
 			if (m_pFile == 0)
 			{
 				m_pFile = new CParaFile();
-				if (!m_pFile->CreateNewFile(m_sSaveToFileName.c_str(), true))
+				if (m_nResumeFrom > 0)
+				{
+					// append to the partially downloaded file. the range request only continues the file if it has exactly m_nResumeFrom bytes.
+					if (!m_pFile->OpenFileForAppend(m_sSaveToFileName.c_str()))
+					{
+						OUTPUT_LOG("warning: Failed open file %s to resume download\n", m_sSaveToFileName.c_str());
+						return 0;
+					}
+					if ((int)m_pFile->getPos() != m_nResumeFrom)
+					{
+						OUTPUT_LOG("warning: partial file %s has %d bytes, but download is resumed from %d\n", m_sSaveToFileName.c_str(), (int)m_pFile->getPos(), m_nResumeFrom);
+						m_pFile->close();
+						return 0;
+					}
+				}
+				else if (!m_pFile->CreateNewFile(m_sSaveToFileName.c_str(), true))
 				{
 					OUTPUT_LOG("warning: Failed create new file %s\n", m_sSaveToFileName.c_str());
 				}
 			}
 			m_pFile->write((const char*)buffer, (int)nByteCount);
 		}
+		if (m_pStreamMD5)
+			m_pStreamMD5->feed((const unsigned char*)buffer, nByteCount);
 		// just for testing: remove this, dump to debug. 
 		// ParaEngine::CLogger::GetSingleton().Write((const char*)buffer, (int)nByteCount);
 	}
@@ -14,6 +14,7 @@ namespace ParaEngine
 {
 	class CUrlProcessor;
 	class IProcessorWorkerData;
+	class MD5;
 
 	/**
 	* CTextureLoader implementation of IDataLoader
@@ -142,6 +143,14 @@ namespace ParaEngine
 		* if we specify a file to save to. the callback script will no longer contain the response body. 
 		*/
 		void SetSaveToFile(const char* filename);
+		/** resume download from the given byte offset. It only works with SetSaveToFile(), in which case
+		* received data is appended to the existing file instead of overwriting it.
+		* the server must support range requests, otherwise curl returns CURLE_RANGE_ERROR. */
+		void SetResumeFrom(int nOffset);
+		/** if not NULL, response body is fed to the given md5 hash as it is received, so that the caller does not need to keep the whole file in memory to verify it.
+		* it also sets CURLOPT_FAILONERROR, so that http error responses are not received as body.
+		* the hash object is not owned and must be valid until the request is completed. */
+		void SetStreamMD5(MD5* pMD5);
 		
 		/** append http headers*/
 		void AppendHTTPHeader(const char* text);
@@ -259,6 +268,10 @@ namespace ParaEngine
 		string m_sSaveToFileName;
 		/** the file to which to save the content to. usually we only save to memory. */
 		CParaFile* m_pFile;
+		/** byte offset to resume the download from. default to 0 */
+		int m_nResumeFrom;
+		/** optional hash that is fed with response body as it is received. */
+		MD5* m_pStreamMD5;
 
 		/** default to 0. if 0, the request will not SAFE_DELETE the user data. the caller is responsible for the task.
 		* if it is 1, the destructor will try to SAFE_DELETE(m_pAssetData)
@@ -17,6 +17,8 @@
 #include "util/StringHelper.h"
 #include "ParaWorldAsset.h"
 #include "util/regularexpression.h"
+#include <thread>
+#include <atomic>
 
 /** we will load these files as assets manifest file. such as "assets_manifest*.txt" */
 #define ASSETS_MANIFEST_FILE_PATTERN		"assets_manifest*.txt"
@@ -29,6 +31,12 @@ using namespace ParaEngine;
 /** how many times we will try to download a given asset file. */
 #define MAX_DOWNLOAD_RETRY_COUNT	1
 
+/** default number of files to download at the same time in CAssetManifest::SyncFiles() */
+#define DEFAULT_MAX_SYNC_CONCURRENCY	8
+
+/** bytes to read at a time when hashing a partially downloaded file */
+#define PARTIAL_FILE_READ_BUFFER_SIZE	65536
+
 /** make a string valid file name, by converting to lower case and replace \\ with / */
 void MakeValidFileName(string& inout)
 {
@@ -151,17 +159,61 @@ bool AssetFileEntry::CheckSyncFile()
 	}
 }
 
-bool AssetFileEntry::SyncFile()
+bool AssetFileEntry::SyncFile(bool bUseAsyncLoader)
 {
-	string url = GetAbsoluteUrl();
-
 	// download the file here. 
 	while (!HasReachedMaxRetryCount())
 	{
 		AddDownloadCount();
-		CAsyncLoader* pAsyncLoader = &(CAsyncLoader::GetSingleton());
-		if (pAsyncLoader->interruption_requested())
+		if (CAsyncLoader::GetSingleton().interruption_requested())
 			return false;
+		if (DownloadFile(bUseAsyncLoader))
+			return true;
+	}
+	m_nStatus = AssetFileStatus_Failed;
+	return false;
+}
+
+std::string AssetFileEntry::GetPartialFileName()
+{
+	return GetFullFilePath() + ".part";
+}
+
+/** feed the partially downloaded file to md5 hash. 
+* @return the number of bytes to resume from. If the file is larger than expected, it is deleted and 0 is returned. */
+static int FeedPartialFile(const std::string& sPartFile, int nExpectedSize, ParaEngine::MD5& md5_hash)
+{
+	FILE* file = fopen(sPartFile.c_str(), "rb");
+	if (file == NULL)
+		return 0;
+	int nSize = 0;
+	std::vector<unsigned char> buffer(PARTIAL_FILE_READ_BUFFER_SIZE);
+	size_t nBytesRead;
+	while ((nBytesRead = fread(&buffer[0], 1, buffer.size(), file)) > 0)
+	{
+		md5_hash.feed(&buffer[0], (int)nBytesRead);
+		nSize += (int)nBytesRead;
+	}
+	fclose(file);
+	if (nSize > nExpectedSize)
+	{
+		md5_hash.reset();
+		CFileUtils::DeleteFile(sPartFile.c_str());
+		nSize = 0;
+	}
+	return nSize;
+}
+
+bool AssetFileEntry::DownloadFile(bool bUseAsyncLoader)
+{
+	CAsyncLoader* pAsyncLoader = &(CAsyncLoader::GetSingleton());
+	string url = GetAbsoluteUrl();
+	string sPartFile = GetPartialFileName();
+
+	ParaEngine::MD5 md5_hash;
+	int nSize = FeedPartialFile(sPartFile, m_nFileSize, md5_hash);
+	if (nSize < m_nFileSize)
+	{
 		string sTmp = string("AssetFile Sync Started:") + url + "\n";
 		pAsyncLoader->log(sTmp);
 		CUrlLoader loader;
@@ -169,39 +221,85 @@ bool AssetFileEntry::SyncFile()
 
 		loader.SetUrl(url.c_str());
 		processor.SetUrl(url.c_str());
-		if (pAsyncLoader->RunWorkItem(&loader, &processor, NULL, NULL) != S_OK)
+		processor.SetSaveToFile(sPartFile.c_str());
+		processor.SetResumeFrom(nSize);
+		processor.SetStreamMD5(&md5_hash);
+		HRESULT hr;
+		if (bUseAsyncLoader)
+			hr = pAsyncLoader->RunWorkItem(&loader, &processor, NULL, NULL);
+		else
+			hr = processor.Process(NULL, 0);
+		// close the partial file, so that its size on disk can be checked.
+		processor.CleanUp();
+		// file:// url has no response code
+		bool bSucceed = (hr == S_OK) && processor.m_returnCode == CURLE_OK &&
+			(processor.m_responseCode == 200 || processor.m_responseCode == 206 || (processor.m_responseCode == 0 && url.compare(0, 5, "file:") == 0));
+		if (!bSucceed)
 		{
+			// start over next time, if the server does not support range request, or if the partial file may contain an error page.
+			if (processor.m_returnCode == CURLE_RANGE_ERROR || processor.m_returnCode == CURLE_HTTP_RETURNED_ERROR || processor.m_returnCode == CURLE_WRITE_ERROR ||
+				(processor.m_responseCode != 0 && processor.m_responseCode != 200 && processor.m_responseCode != 206))
+				CFileUtils::DeleteFile(sPartFile.c_str());
 			string sTmp = string("AssetFile Sync Failed:") + url + "\n";
 			pAsyncLoader->log(sTmp);
 			return false;
 		}
+		nSize += processor.GetBytesReceived();
+	}
+
+	// the md5 and size are computed from the streamed bytes, so make sure that the file on disk has all of them.
+	if (!CheckMD5AndSize(md5_hash.hex(), nSize) || CFileUtils::GetFileSize(sPartFile.c_str()) != nSize)
+	{
+		string sTmp = string("Asset md5 check Failed:") + m_url + "\n";
+		pAsyncLoader->log(sTmp);
+		CFileUtils::DeleteFile(sPartFile.c_str());
+		m_nStatus = AssetFileStatus_Unknown;
+		return false;
+	}
+	if (SavePartialFileToDisk())
+	{
+		string sTmp = string("AssetFile Sync Completed:") + url + "\n";
+		pAsyncLoader->log(sTmp);
+		return true;
+	}
+	else
+	{
+		string sTmp = string("AssetFile Sync Failed cannot save to disk:") + url + "\n";
+		pAsyncLoader->log(sTmp);
+		return false;
+	}
+}
+
+bool AssetFileEntry::SavePartialFileToDisk()
+{
+	string sPartFile = GetPartialFileName();
+	bool bSucceed = false;
+	if (m_bIsZipFile)
+	{
+		CParaFile file;
+		if (file.OpenFile(sPartFile.c_str(), true, NULL, false, FILE_ON_DISK) && file.getSize() > 0)
+		{
+			bSucceed = SaveToDisk(file.getBuffer(), (int)file.getSize(), false);
+			file.close();
+		}
+		if (bSucceed)
+			CFileUtils::DeleteFile(sPartFile.c_str());
+	}
+	else
+	{
+		if (CParaFile::MoveFile(sPartFile.c_str(), GetLocalFileName().c_str()))
+		{
+			m_nStatus = AssetFileStatus_Downloaded;
+			bSucceed = true;
+		}
 		else
 		{
-			// save to disk
-			if (processor.m_responseCode == 200 && processor.GetData().size() > 0)
-			{
-				if (SaveToDisk(&(processor.GetData()[0]), (int)(processor.GetData().size())))
-				{
-					string sTmp = string("AssetFile Sync Completed:") + url + "\n";
-					pAsyncLoader->log(sTmp);
-					// open the file now. 
-					return true;
-				}
-				else
-				{
-					string sTmp = string("AssetFile Sync Failed cannot save to disk:") + url + "\n";
-					pAsyncLoader->log(sTmp);
-				}
-			}
-			else
-			{
-				string sTmp = string("AssetFile Sync Failed http code!=200:") + url + "\n";
-				pAsyncLoader->log(sTmp);
-			}
+			string sTmp = string("Failed To MoveFile:") + m_url + "\n";
+			CAsyncLoader::GetSingleton().log(sTmp);
+			m_nStatus = AssetFileStatus_Unknown;
 		}
 	}
-	m_nStatus = AssetFileStatus_Failed;
-	return false;
+	return bSucceed;
 }
 
 namespace ParaEngine
@@ -483,6 +581,13 @@ void AssetFileEntry::SignalComplete(int nResult)
 }
 
 bool AssetFileEntry::CheckMD5AndSize(const char* buffer, int nSize)
+{
+	ParaEngine::MD5 md5_hash;
+	md5_hash.feed((const unsigned char*)buffer, nSize);
+	return CheckMD5AndSize(md5_hash.hex(), nSize);
+}
+
+bool AssetFileEntry::CheckMD5AndSize(const std::string& sMD5Hex, int nSize)
 {
 	// compare the file size first. 
 	char sSize[64];
@@ -505,11 +610,7 @@ bool AssetFileEntry::CheckMD5AndSize(const char* buffer, int nSize)
 	nCount = nFileNameCount - nFrom - nCount;
 	string md5_str = m_localFileName.substr(nFrom, nCount);
 
-	ParaEngine::MD5 md5_hash;
-	md5_hash.feed((const unsigned char*)buffer, nSize);
-	string sMD5String = md5_hash.hex();
-
-	return (stricmp(md5_str.c_str(), sMD5String.c_str()) == 0);
+	return (stricmp(md5_str.c_str(), sMD5Hex.c_str()) == 0);
 }
 
 std::string AssetFileEntry::GetFullFilePath()
@@ -617,7 +718,7 @@ AssetFileEntry::AssetFileTypeEnum AssetFileEntry::SetFileType(const std::string&
 //
 //////////////////////////////////////////////////////////////////////////
 CAssetManifest::CAssetManifest(void)
-	:m_bEnableManifest(true), m_bUseLocalFileFirst(false)
+	:m_bEnableManifest(true), m_bUseLocalFileFirst(false), m_nMaxSyncConcurrency(DEFAULT_MAX_SYNC_CONCURRENCY)
 {
 	LoadManifest();
 }
@@ -674,6 +775,64 @@ int CAssetManifest::CheckSyncFile(const char* filename)
 }
 
 
+int CAssetManifest::GetMaxSyncConcurrency() const
+{
+	return m_nMaxSyncConcurrency;
+}
+
+void CAssetManifest::SetMaxSyncConcurrency(int nCount)
+{
+	m_nMaxSyncConcurrency = (std::max)(nCount, 1);
+}
+
+int CAssetManifest::SyncFiles(const std::vector<AssetFileEntry*>& files, int nMaxConcurrency)
+{
+	int nCount = (int)files.size();
+	if (nMaxConcurrency <= 0)
+		nMaxConcurrency = m_nMaxSyncConcurrency;
+	int nThreadCount = (std::min)(nMaxConcurrency, nCount);
+
+	std::atomic<int> nNextIndex(0);
+	std::atomic<int> nSucceedCount(0);
+	auto worker = [&]()
+	{
+		int i;
+		while ((i = nNextIndex++) < nCount)
+		{
+			if (CAsyncLoader::GetSingleton().interruption_requested())
+				break;
+			AssetFileEntry* pEntry = files[i];
+			if (pEntry->DoesFileExist() || pEntry->SyncFile(false))
+				++nSucceedCount;
+		}
+	};
+	if (nThreadCount <= 1)
+		worker();
+	else
+	{
+		std::vector<std::thread> workers;
+		for (int i = 0; i < nThreadCount; ++i)
+			workers.push_back(std::thread(worker));
+		for (auto& thread : workers)
+			thread.join();
+	}
+	OUTPUT_LOG("CAssetManifest synced %d/%d files with %d threads\n", (int)nSucceedCount, nCount, nThreadCount);
+	return nSucceedCount;
+}
+
+int CAssetManifest::SyncAllFiles()
+{
+	std::vector<AssetFileEntry*> files;
+	files.reserve(m_files.size());
+	for (auto& item : m_files)
+	{
+		// skip files that are being downloaded asynchronously. 
+		if (!item.second->IsDownloading())
+			files.push_back(item.second);
+	}
+	return SyncFiles(files);
+}
+
 void CAssetManifest::PrepareCacheFolders()
 {
 	if (!CParaFile::CreateDirectory("temp/cache/"))
@@ -1090,5 +1249,7 @@ int CAssetManifest::InstallFields(CAttributeClass* pClass, bool bOverride)
 	pClass->AddField("LoadManifestFile", FieldType_String, (void*)LoadManifestFile_s, (void*)0, NULL, NULL, bOverride);
 	pClass->AddField("Enabled", FieldType_Bool, (void*)SetEnabled_s, (void*)IsEnabled_s, NULL, NULL, bOverride);
 	pClass->AddField("UseLocalFileFirst", FieldType_Bool, (void*)SetUseLocalFileFirst_s, (void*)IsUseLocalFileFirst_s, NULL, NULL, bOverride);
+	pClass->AddField("MaxSyncConcurrency", FieldType_Int, (void*)SetMaxSyncConcurrency_s, (void*)GetMaxSyncConcurrency_s, NULL, NULL, bOverride);
+	pClass->AddField("SyncAllFilesBlocking", FieldType_void, (void*)SyncAllFiles_s, NULL, NULL, NULL, bOverride);
 	return S_OK;
 }
\ No newline at end of file
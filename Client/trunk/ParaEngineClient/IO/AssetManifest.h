@@ -89,8 +89,20 @@ namespace ParaEngine
 		* it may retry download if download failed such as md5 mismatch. If this function is called and failed multiple times, and
 		* HasReachedMaxRetryCount() is true, the function will do nothing and return false.
 		* Please use DoesFileExist() to check if file exit before calling sync file to avoid redownload the file.
+		* @param bUseAsyncLoader: see DownloadFile()
 		* @return true if file is downloaded and up to date. */
-		bool SyncFile();
+		bool SyncFile(bool bUseAsyncLoader = true);
+
+		/** download the file once. Data is streamed to GetPartialFileName() and md5 is verified as it is received,
+		* so that the file is never kept in memory as a whole (except for unzipping .z files).
+		* If a previous download was interrupted, it resumes from the partial file.
+		* @param bUseAsyncLoader: if true, the request runs via CAsyncLoader::RunWorkItem, which shares a single curl handle and serializes requests.
+		*	if false, it runs on the calling thread with its own curl handle, so that many files can be downloaded in parallel.
+		* @return true if file is downloaded and verified. */
+		bool DownloadFile(bool bUseAsyncLoader = true);
+
+		/** the file that an unfinished download is saved to. */
+		std::string GetPartialFileName();
 
 		/** similar to SyncFile(), except that this function will return immediately and does not redownload or call AddDownloadCount. And use callback.
 		* @param pFuncCallback: the call back function to use. if none is specified, it will pick a default one to use according to pRequestData->m_nAssetType;
@@ -153,10 +165,15 @@ namespace ParaEngine
 
 		/** check whether the MD5 of the input buffer matches. */
 		bool CheckMD5AndSize(const char* buffer, int nSize);
+		/** check whether the given hex md5 string and file size matches. */
+		bool CheckMD5AndSize(const std::string& sMD5Hex, int nSize);
 
 		/** save a give buffer to local file. */
 		bool SaveToDisk(const char* buffer, int nSize, bool bCheckMD5 = true);
 
+		/** move a verified partial file to the local file, unzipping it if needed. */
+		bool SavePartialFileToDisk();
+
 		/** get the compressed file size of the asset entry. */
 		int GetFileSize() { return m_nFileSize; }
 
@@ -265,6 +282,10 @@ namespace ParaEngine
 		ATTRIBUTE_METHOD1(CAssetManifest, IsUseLocalFileFirst_s, bool*) { *p1 = cls->IsUseLocalFileFirst(); return S_OK; }
 		ATTRIBUTE_METHOD1(CAssetManifest, SetUseLocalFileFirst_s, bool) { cls->SetUseLocalFileFirst(p1); return S_OK; }
 
+		ATTRIBUTE_METHOD1(CAssetManifest, GetMaxSyncConcurrency_s, int*) { *p1 = cls->GetMaxSyncConcurrency(); return S_OK; }
+		ATTRIBUTE_METHOD1(CAssetManifest, SetMaxSyncConcurrency_s, int) { cls->SetMaxSyncConcurrency(p1); return S_OK; }
+		ATTRIBUTE_METHOD(CAssetManifest, SyncAllFiles_s) { cls->SyncAllFiles(); return S_OK; }
+
 	public:
 		/** get the global singleton object */
 		static CAssetManifest& GetSingleton();
@@ -292,6 +313,23 @@ namespace ParaEngine
 		if asset file failed, it return -1 */
 		int CheckSyncFile(const char* filename);
 
+		/** sync all given files that are not up to date, downloading up to nMaxConcurrency files at the same time.
+		* this function is synchronous. Each file is downloaded with AssetFileEntry::SyncFile(false) on a worker thread,
+		* so files must not be synced by other threads at the same time.
+		* @param nMaxConcurrency: if 0 or negative, GetMaxSyncConcurrency() is used.
+		* @return number of files that are up to date after the call.
+		*/
+		int SyncFiles(const std::vector<AssetFileEntry*>& files, int nMaxConcurrency = 0);
+
+		/** sync all files in the manifest that are not up to date. this is usually used to patch everything on cold start.
+		* It blocks the calling thread until all files are downloaded or failed, so it is exposed as the "SyncAllFilesBlocking" attribute.
+		* @return number of files that are up to date after the call. */
+		int SyncAllFiles();
+
+		/** max number of files to download at the same time in SyncFiles(). default to 8 */
+		int GetMaxSyncConcurrency() const;
+		void SetMaxSyncConcurrency(int nCount);
+
 		/** get a asset file entry based on file name.
 		* the actually file entity may be replaced by CFileReplaceMap::GetSingleton()
 		* [thread-safe]: it is thread safe only after manifest file and replace file map are loaded.
@@ -338,5 +376,7 @@ namespace ParaEngine
 		bool m_bEnableManifest;
 		/** if true, GetFile() will return null, if a local disk or zip file is found even there is an entry in the assetmanifest. */
 		bool m_bUseLocalFileFirst;
+		/** max number of files to download at the same time in SyncFiles() */
+		int m_nMaxSyncConcurrency;
 	};
 }
@@ -561,6 +561,7 @@ int CAsyncLoader::FileIOThreadProc_HandleRequest(ResourceRequest_ptr& ResourceRe
 
 		if (!ResourceRequest->m_bError)
 		{
+			TRACE_SCOPE_DETAIL("IO.Load", "io", ResourceRequest->m_pDataLoader->GetFileName(), -1);
 			// Load the data
 			hr = ResourceRequest->m_pDataLoader->Load();
 
@@ -643,6 +644,7 @@ int CAsyncLoader::FileIOThreadProc()
 	HRESULT hr = S_OK;
 
 	ASSETS_LOG(Log_All, "CAsyncLoader IO Thread started");
+	CTraceProfiler::GetInstance().SetThreadName("AsyncLoader IO");
 
 	int nRes = 0;
 	while(nRes != -1)
@@ -689,6 +691,7 @@ int CAsyncLoader::ProcessingThreadProc(ProcessorWorkerThread* pThreadData)
 			break;
 		}
 		ASSETS_LOG(Log_All, "Async Processing Thread %s(%d) Started\n", ThreadType, nQueueID);
+		CTraceProfiler::GetInstance().SetThreadName(ThreadType);
 	}
 
 	int nRes = 0;
@@ -707,6 +710,7 @@ int CAsyncLoader::ProcessingThreadProc(ProcessorWorkerThread* pThreadData)
 		// Decompress the data
 		if( !ResourceRequest->m_bError )
 		{
+			TRACE_SCOPE_DETAIL("IO.Process", "io", ResourceRequest->m_pDataLoader->GetFileName(), -1);
 			void* pData = NULL;
 			int cDataSize = 0;
 			hr = ResourceRequest->m_pDataLoader->Decompress( &pData, &cDataSize );
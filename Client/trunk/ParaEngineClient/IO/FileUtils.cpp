@@ -967,6 +967,27 @@ ParaEngine::FileHandle ParaEngine::CFileUtils::OpenFile(const char* filename, bo
 #endif
 }
 
+ParaEngine::FileHandle ParaEngine::CFileUtils::OpenFileForAppend(const char* filename)
+{
+#if defined(USE_COCOS_FILE_API) || defined(USE_BOOST_FILE_API)
+	// "r+b" does not truncate, unlike "w+b", and fails if the file does not exist.
+	FILE* pFile = fopen(GetFullPathForFilename(filename).c_str(), "r+b");
+	if (pFile)
+		fseek(pFile, 0, SEEK_END);
+	FileHandle fileHandle;
+	fileHandle.m_pFile = pFile;
+	return fileHandle;
+#else
+	HANDLE hFile = ::CreateFile(filename, GENERIC_WRITE, FILE_SHARE_WRITE, NULL, OPEN_EXISTING, NULL, NULL);
+	if (hFile != INVALID_HANDLE_VALUE)
+	{
+		::SetFilePointer(hFile, 0, NULL, FILE_END);
+		return FileHandle(hFile);
+	}
+	return FileHandle();
+#endif
+}
+
 bool ParaEngine::CFileUtils::SetFilePointer(FileHandle& fileHandle, int lDistanceToMove, int dwMoveMethod)
 {
 	if (fileHandle.IsValid())
@@ -167,6 +167,10 @@ namespace ParaEngine
 
 		/** open file and return the file handle. default input is create a file for shared writing. */
 		static FileHandle OpenFile(const char* sFilePath, bool bRead = false, bool bWrite=true);
+
+		/** open an existing disk file for writing without truncating it, with the file pointer at the end of file. 
+		* the returned handle is invalid if the file does not exist. */
+		static FileHandle OpenFileForAppend(const char* sFilePath);
 		
 		/**
 		* The SetFilePointer function moves the file pointer of an open file.
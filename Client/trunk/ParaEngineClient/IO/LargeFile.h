@@ -0,0 +1,36 @@
+#pragma once
+#include <stdio.h>
+#include <stdint.h>
+#if !defined(_WIN32)
+#include <sys/types.h>
+#endif
+
+namespace ParaEngine
+{
+	/** fseek and ftell with 64 bits offsets, since long is only 32 bits on windows and 32 bits platforms. 
+	* on posix platforms, off_t is 64 bits when _FILE_OFFSET_BITS is 64, which is the default on 64 bits platforms. */
+	namespace LargeFile
+	{
+		/** same as fseek. @return 0 if succeed. */
+		inline int Seek(FILE* pFile, int64_t nOffset, int nOrigin)
+		{
+#if defined(_WIN32)
+			return _fseeki64(pFile, nOffset, nOrigin);
+#else
+			if (sizeof(off_t) < sizeof(int64_t) && nOffset != (int64_t)(off_t)nOffset)
+				return -1;
+			return fseeko(pFile, (off_t)nOffset, nOrigin);
+#endif
+		}
+
+		/** same as ftell. @return -1 if failed. */
+		inline int64_t Tell(FILE* pFile)
+		{
+#if defined(_WIN32)
+			return _ftelli64(pFile);
+#else
+			return (int64_t)ftello(pFile);
+#endif
+		}
+	}
+}
@@ -367,6 +367,19 @@ bool CParaFile::CreateDirectory(const char* filename)
 	return CFileUtils::MakeDirectoryFromFilePath(sFile.c_str());
 }
 
+bool CParaFile::OpenFileForAppend(const char* filename)
+{
+	close();
+	m_filename = filename;
+	/// write-only file
+	m_eof = true;
+	FileHandle fileHandle = CFileUtils::OpenFileForAppend(filename);
+	m_bDiskFileOpened = fileHandle.IsValid();
+	if (m_bDiskFileOpened)
+		m_handle = fileHandle;
+	return m_bDiskFileOpened;
+}
+
 bool CParaFile::CreateNewFile(const char* filename, bool bAutoMakeFilePath)
 {
 	string sFile;
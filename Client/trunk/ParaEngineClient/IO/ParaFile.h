@@ -312,6 +312,10 @@ namespace ParaEngine
 		/** mostly used for reading from an archive file handle */
 		PE_CORE_DECL bool OpenFile(CArchive* pArchive, const char* filename, bool bUseCompressed = false);
 
+		/** open an existing disk file for writing at its end. Unlike OpenFile(filename, false), the file is never truncated. 
+		* @return false if the file does not exist or can not be opened. */
+		PE_CORE_DECL bool OpenFileForAppend(const char* filename);
+
 		/** get file attributes like file type, where the file is found, absolute path, modification time, size, etc.
 		@param ParaFileInfo: file info.
 		*/
@@ -18,6 +18,10 @@
 #include "IO/FileUtils.h"
 #include "util/StringHelper.h"
 #include "util/regularexpression.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 
 /**@def define this macro to compile with ZLIB. */
 #define COMPILE_WITH_ZLIB
@@ -34,6 +38,11 @@
 #define PKG_FILE_VERSION	1
 #define PKG_FILE_VERSION2	2
 
+/** entry data is copied to the pkg file in batches of about this size */
+#define PKG_WRITE_BATCH_SIZE	(4*1024*1024)
+/** max number of batches read ahead of the pkg writer */
+#define PKG_WRITE_MAX_PENDING_BATCHES	4
+
 /** @def define this macro to cache read all header information to memory from the central directory. 
 this will reduce disk IO counts. However, there does not seem to be a performance penalty even with 20000+ IO read.
 so there is no need to use it. */
@@ -494,27 +503,7 @@ bool CZipArchive::GeneratePkgFile2(const char* filename)
 
 
 	// write data
-	{
-		vector<byte> cData;
-
-		for (i = 0; i<nEntryNum; ++i)
-		{
-			if (m_FileList[i].m_pEntry == nullptr)
-				continue;
-
-			SZipFileEntry& entry = *(m_FileList[i].m_pEntry);
-			if (cData.size()<entry.CompressedSize)
-				cData.resize(entry.CompressedSize);
-			if (entry.CompressedSize>0)
-			{
-				m_pFile->seek(entry.fileDataPosition);
-				m_pFile->read(&(cData[0]), entry.CompressedSize);
-				file.write(&(cData[0]), entry.CompressedSize);
-			}
-		}
-		cData.clear();
-	}
-
+	WritePkgData(file);
 	return true;
 }
 
@@ -577,27 +566,67 @@ bool CZipArchive::GeneratePkgFile( const char* filename )
 		dataPos+=entry.CompressedSize;
 	}
 	// write data
-	{
-		vector<byte> cData;
+	WritePkgData(file);
+	return true;
+}
 
-		for (i=0;i<nEntryNum;++i)
+void CZipArchive::WritePkgData(CParaFile& file)
+{
+	// a reader thread copies the compressed data of consecutive entries into batches, while this thread writes earlier batches.
+	// the caller holds m_mutex, so the reader thread is the only user of m_pFile.
+	std::mutex batchMutex;
+	std::condition_variable batchSignal;
+	std::deque< vector<byte> > batches;
+	bool bReadDone = false;
+
+	std::thread reader([&]() {
+		vector<byte> cData;
+		auto pushBatch = [&]() {
+			std::unique_lock<std::mutex> lock_(batchMutex);
+			batchSignal.wait(lock_, [&]() { return batches.size() < PKG_WRITE_MAX_PENDING_BATCHES; });
+			batches.push_back(std::move(cData));
+			cData.clear();
+			batchSignal.notify_all();
+		};
+		int nEntryNum = (int)(m_FileList.size());
+		for (int i = 0; i < nEntryNum; ++i)
 		{
 			if (m_FileList[i].m_pEntry == nullptr)
 				continue;
 
 			SZipFileEntry& entry = *(m_FileList[i].m_pEntry);
-			if(cData.size()<entry.CompressedSize)
-				cData.resize(entry.CompressedSize);
-			if(entry.CompressedSize>0)
+			if (entry.CompressedSize > 0)
 			{
+				size_t nOffset = cData.size();
+				cData.resize(nOffset + entry.CompressedSize);
 				m_pFile->seek(entry.fileDataPosition);
-				m_pFile->read(&(cData[0]), entry.CompressedSize);
-				file.write(&(cData[0]), entry.CompressedSize);
+				m_pFile->read(&(cData[nOffset]), entry.CompressedSize);
+				if (cData.size() >= PKG_WRITE_BATCH_SIZE)
+					pushBatch();
 			}
 		}
-		cData.clear();
+		if (!cData.empty())
+			pushBatch();
+		std::lock_guard<std::mutex> lock_(batchMutex);
+		bReadDone = true;
+		batchSignal.notify_all();
+	});
+
+	for (;;)
+	{
+		vector<byte> cData;
+		{
+			std::unique_lock<std::mutex> lock_(batchMutex);
+			batchSignal.wait(lock_, [&]() { return bReadDone || !batches.empty(); });
+			if (batches.empty())
+				break;
+			cData = std::move(batches.front());
+			batches.pop_front();
+			batchSignal.notify_all();
+		}
+		file.write(&(cData[0]), (int)cData.size());
 	}
-	return true;
+	reader.join();
 }
 
 bool CZipArchive::_ReadEntries_pkg()
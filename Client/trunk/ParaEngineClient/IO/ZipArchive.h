@@ -427,6 +427,8 @@ namespace ParaEngine
 		bool OpenPkgFile(const string& filename);
 
 		void ReBuild();
+		/** copy the compressed data of all entries to a pkg file in entry order, reading ahead on a separate thread. */
+		void WritePkgData(CParaFile& file);
 		/**
 		* search the last occurrence of a integer signature in the range [endLocation-minimumBlockSize-maximumVariableData, endLocation-minimumBlockSize]
 		* -1 is returned if not found.
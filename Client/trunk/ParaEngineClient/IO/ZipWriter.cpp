@@ -13,8 +13,18 @@
 #include "ZipArchive.h"
 #include "NPLCodec.h"
 #include <boost/filesystem.hpp>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 #include "zlib.h"
 
+/** entries bigger than this are split into blocks that are deflated independently on worker threads, like pigz does. */
+#define ZIP_WRITER_BLOCK_SIZE	(1024*1024)
+/** the tail of the previous block is used as the deflate dictionary of the next block, so that splitting costs almost no compression ratio. */
+#define ZIP_WRITER_DICT_SIZE	32768
+/** max number of loaded but not yet written bytes. no more entries are loaded until the writer catches up. */
+#define ZIP_WRITER_MAX_PENDING_BYTES	(256*1024*1024)
 
 using namespace ParaEngine;
 
@@ -79,11 +89,62 @@ namespace ParaEngine
 		}
 	}
 
+	/** a slice of an entry's input that is deflated independently. all but the last block end with a sync flush,
+	* so that the concatenated output of all blocks is a single valid raw deflate stream. */
+	struct ZipDeflateBlock
+	{
+		ZipDeflateBlock() : m_pSrc(NULL), m_nSize(0), m_nDictSize(0), m_bLast(true), m_crc(0), m_bSucceed(false) {}
+
+		void Deflate(int compressionlevel)
+		{
+			m_crc = (uint32_t)crc32(0, (const Bytef*)m_pSrc, (uInt)m_nSize);
+
+			z_stream zs;
+			memset(&zs, 0, sizeof(z_stream));
+			if (deflateInit2(&zs, compressionlevel, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+			{
+				OUTPUT_LOG("warning: CZipWriter deflateInit failed while compressing.\n");
+				return;
+			}
+			if (m_nDictSize > 0)
+				deflateSetDictionary(&zs, (const Bytef*)(m_pSrc - m_nDictSize), (uInt)m_nDictSize);
+
+			zs.next_in = (Bytef*)m_pSrc;
+			zs.avail_in = (uInt)m_nSize;
+			const int nFlush = m_bLast ? Z_FINISH : Z_SYNC_FLUSH;
+			m_output.resize(deflateBound(&zs, (uLong)m_nSize) + 16);
+			int ret;
+			for (;;)
+			{
+				zs.next_out = (Bytef*)&m_output[zs.total_out];
+				zs.avail_out = (uInt)(m_output.size() - zs.total_out);
+				ret = deflate(&zs, nFlush);
+				if (ret == Z_STREAM_END || ret == Z_STREAM_ERROR || (nFlush == Z_SYNC_FLUSH && zs.avail_out != 0))
+					break;
+				m_output.resize(m_output.size() * 2);
+			}
+			m_output.resize(zs.total_out);
+			deflateEnd(&zs);
+			m_bSucceed = m_bLast ? (ret == Z_STREAM_END) : (ret != Z_STREAM_ERROR);
+			if (!m_bSucceed)
+				OUTPUT_LOG("warning: CZipWriter failed to deflate a block.\n");
+		}
+	public:
+		const char* m_pSrc;
+		size_t m_nSize;
+		/** the dictionary is the m_nDictSize bytes right before m_pSrc */
+		size_t m_nDictSize;
+		bool m_bLast;
+		std::string m_output;
+		uint32_t m_crc;
+		bool m_bSucceed;
+	};
+
 	/** a single file in zip archive to be written to disk */
 	class ZipArchiveEntry : public CRefCounted 
 	{
 	public:
-		ZipArchiveEntry() : m_offsetOfCompressedData(0), m_offsetOfSerializedLocalFileHeader(0), m_pFile(nullptr)
+		ZipArchiveEntry() : m_offsetOfCompressedData(0), m_offsetOfSerializedLocalFileHeader(0), m_pFile(nullptr), m_pData(NULL), m_nDataSize(0), m_nPendingBlocks(0)
 		{
 			memset(&m_localFileHeader, 0, sizeof(SZIPFileHeader));
 			m_localFileHeader.Sig = ZIP_CONST_LOCALHEADERSIG;
@@ -121,81 +182,87 @@ namespace ParaEngine
 			m_pFile = pFile;
 		}
 
-		void SerializeLocalFileHeader(CParaFile& file) 
+		/** read the input data and split it into deflate blocks. it is called in entry order on the writer thread.
+		* @return number of input bytes kept in memory until Serialize() is called. */
+		size_t LoadData()
+		{
+			if (IsDirectory())
+				return 0;
+			if (m_pFile)
+			{
+				m_pData = (const char*)m_pFile->getBuffer();
+				m_nDataSize = m_pFile->getSize();
+				m_localFileHeader.LastModFileDate = m_localFileHeader.LastModFileTime = 0;
+			}
+			else
+			{
+				m_pInput.reset(new CMemReadFile(m_filename.c_str()));
+				if (!m_pInput->isOpen())
+				{
+					OUTPUT_LOG("warning: failed to add file: %s to zip archive\n", m_filename.c_str());
+					m_pInput.reset();
+					return 0;
+				}
+				m_pData = (const char*)m_pInput->getBuffer();
+				m_nDataSize = m_pInput->getSize();
+				GetFileTime(m_filename, &m_localFileHeader.LastModFileDate, &m_localFileHeader.LastModFileTime);
+			}
+			int nBlockCount = (int)((m_nDataSize + ZIP_WRITER_BLOCK_SIZE - 1) / ZIP_WRITER_BLOCK_SIZE);
+			m_blocks.resize((std::max)(nBlockCount, 1));
+			for (int i = 0; i < (int)m_blocks.size(); ++i)
+			{
+				ZipDeflateBlock& block = m_blocks[i];
+				size_t nFrom = (size_t)i * ZIP_WRITER_BLOCK_SIZE;
+				block.m_pSrc = m_pData + nFrom;
+				block.m_nSize = (std::min)(m_nDataSize - nFrom, (size_t)ZIP_WRITER_BLOCK_SIZE);
+				block.m_nDictSize = (std::min)(nFrom, (size_t)ZIP_WRITER_DICT_SIZE);
+				block.m_bLast = (i == (int)m_blocks.size() - 1);
+			}
+			m_nPendingBlocks = (int)m_blocks.size();
+			return m_nDataSize;
+		}
+
+		/** local file header followed by the deflated blocks in order. All blocks must have been deflated.
+		* input data is released afterwards. */
+		void Serialize(CParaFile& file)
 		{
-			// save offset of stream here
 			m_offsetOfSerializedLocalFileHeader = file.getPos();
+			if (!m_blocks.empty())
+			{
+				bool bCompressed = true;
+				uint32_t crc = 0;
+				size_t nCompressedSize = 0;
+				for (size_t i = 0; i < m_blocks.size(); ++i)
+				{
+					ZipDeflateBlock& block = m_blocks[i];
+					bCompressed = bCompressed && block.m_bSucceed;
+					crc = (i == 0) ? block.m_crc : (uint32_t)crc32_combine(crc, block.m_crc, (z_off_t)block.m_nSize);
+					nCompressedSize += block.m_output.size();
+				}
+				m_localFileHeader.CompressionMethod = bCompressed ? 8 : 0; // 8 for zip, 0 for no compression.
+				m_localFileHeader.DataDescriptor.UncompressedSize = (uint32_t)m_nDataSize;
+				m_localFileHeader.DataDescriptor.CompressedSize = (uint32_t)(bCompressed ? nCompressedSize : m_nDataSize);
+				m_localFileHeader.DataDescriptor.CRC32 = crc;
+			}
 
-			m_localFileHeader.DataDescriptor.CompressedSize = 0;
-			m_localFileHeader.DataDescriptor.UncompressedSize = 0;
-			m_localFileHeader.DataDescriptor.CRC32 = 0;
-			
-			// serialize header
 			file.write(&m_localFileHeader, sizeof(SZIPFileHeader));
 			file.WriteString(m_destFilename);
-
 			m_offsetOfCompressedData = file.getPos();
-			// serialize body of compressed file
-			if (!IsDirectory()) 
+			if (m_localFileHeader.CompressionMethod == 8)
 			{
-				if (m_pFile)
-				{
-					{
-						std::string output;
-						output.reserve(m_pFile->getSize());
-						if (CZipWriter::Compress(output, (const char*)m_pFile->getBuffer(), m_pFile->getSize()) == 1)
-						{
-							m_localFileHeader.CompressionMethod = 8; // 8 for zip, 0 for no compression.
-							m_localFileHeader.DataDescriptor.UncompressedSize = m_pFile->getSize();
-							m_localFileHeader.DataDescriptor.CompressedSize = output.size();
-
-							m_localFileHeader.LastModFileDate = m_localFileHeader.LastModFileTime = 0;
-
-							uint32_t crc = 0;
-							m_localFileHeader.DataDescriptor.CRC32 = crc32(crc, (const Bytef*)m_pFile->getBuffer(), m_pFile->getSize());
-							file.WriteString(output);
-
-							// actualize local file header
-							auto currentPos = file.getPos();
-							file.seek(m_offsetOfSerializedLocalFileHeader);
-							file.write(&m_localFileHeader, sizeof(SZIPFileHeader));
-							file.seek(currentPos);
-						}
-					}
-				}
-				else
-				{
-					CMemReadFile input(m_filename.c_str());
-					if (input.isOpen())
-					{
-						std::string output;
-						output.reserve(input.getSize());
-						if (CZipWriter::Compress(output, (const char*)input.getBuffer(), input.getSize()) == 1)
-						{
-							m_localFileHeader.CompressionMethod = 8; // 8 for zip, 0 for no compression.
-							m_localFileHeader.DataDescriptor.UncompressedSize = input.getSize();
-							m_localFileHeader.DataDescriptor.CompressedSize = output.size();
-
-							GetFileTime(m_filename, &m_localFileHeader.LastModFileDate, &m_localFileHeader.LastModFileTime);
-
-							uint32_t crc = 0;
-							m_localFileHeader.DataDescriptor.CRC32 = crc32(crc, input.getBuffer(), input.getSize());
-							file.WriteString(output);
-
-							// actualize local file header
-							auto currentPos = file.getPos();
-							file.seek(m_offsetOfSerializedLocalFileHeader);
-							file.write(&m_localFileHeader, sizeof(SZIPFileHeader));
-							file.seek(currentPos);
-						}
-					}
-					else
-					{
-						OUTPUT_LOG("warning: failed to add file: %s to zip archive\n", m_filename.c_str());
-					}
-				}
+				for (auto& block : m_blocks)
+					file.WriteString(block.m_output);
+			}
+			else if (!m_blocks.empty())
+			{
+				OUTPUT_LOG("warning: failed to compress file: %s, it is stored without compression\n", m_filename.c_str());
+				file.write(m_pData, (int)m_nDataSize);
 			}
+			m_blocks.clear();
+			m_pInput.reset();
+			m_pData = NULL;
 		};
+
 		void SerializeCentralDirectoryFileHeader(CParaFile& file)
 		{
 			ZIP_CentralDirectory _centralDirectoryFileHeader;
@@ -224,6 +291,14 @@ namespace ParaEngine
 		std::string m_destFilename;
 		std::string m_filename;
 		CParaFile* m_pFile;
+
+		/** input data of a loaded entry, which is either owned by m_pFile or m_pInput */
+		std::unique_ptr<CMemReadFile> m_pInput;
+		const char* m_pData;
+		size_t m_nDataSize;
+		std::vector<ZipDeflateBlock> m_blocks;
+		/** number of blocks not yet deflated. guarded by the writer's job mutex. */
+		int m_nPendingBlocks;
 	};
 }
 
@@ -281,6 +356,7 @@ int CZipWriter::Compress(std::string& outstring, const char* src, int nSrcSize,
 
 
 CZipWriter::CZipWriter()
+	:m_nThreadCount(0)
 {
 
 }
@@ -430,6 +506,108 @@ void ParaEngine::CZipWriter::removeAllEntries()
 	m_entries.clear();
 }
 
+void ParaEngine::CZipWriter::SetThreadCount(int nCount)
+{
+	m_nThreadCount = nCount;
+}
+
+int ParaEngine::CZipWriter::GetThreadCount()
+{
+	return m_nThreadCount;
+}
+
+void ParaEngine::CZipWriter::WriteEntries(CParaFile& file)
+{
+	const int nEntryCount = (int)m_entries.size();
+	int nThreadCount = (m_nThreadCount > 0) ? m_nThreadCount : (int)std::thread::hardware_concurrency();
+	nThreadCount = (std::max)(nThreadCount, 1);
+
+	std::mutex jobMutex;
+	std::condition_variable jobSignal;
+	std::condition_variable doneSignal;
+	std::deque<std::pair<ZipArchiveEntry*, int> > jobs;
+	bool bStopped = false;
+
+	// workers only deflate; all file IO stays on this thread, which loads entries ahead and writes finished ones in order.
+	auto worker = [&]() {
+		for (;;)
+		{
+			std::pair<ZipArchiveEntry*, int> job;
+			{
+				std::unique_lock<std::mutex> lock_(jobMutex);
+				jobSignal.wait(lock_, [&]() { return bStopped || !jobs.empty(); });
+				if (jobs.empty())
+					return;
+				job = jobs.front();
+				jobs.pop_front();
+			}
+			job.first->m_blocks[job.second].Deflate(-1);
+			{
+				std::lock_guard<std::mutex> lock_(jobMutex);
+				--job.first->m_nPendingBlocks;
+			}
+			doneSignal.notify_all();
+		}
+	};
+	std::vector<std::thread> workers;
+	if (nThreadCount > 1)
+	{
+		for (int i = 0; i < nThreadCount; ++i)
+			workers.push_back(std::thread(worker));
+	}
+
+	int nNextLoad = 0;
+	int nNextWrite = 0;
+	size_t nPendingBytes = 0;
+	while (nNextWrite < nEntryCount)
+	{
+		ZipArchiveEntry* pHead = m_entries[nNextWrite];
+		bool bHeadReady = false;
+		if (nNextWrite < nNextLoad)
+		{
+			std::lock_guard<std::mutex> lock_(jobMutex);
+			bHeadReady = (pHead->m_nPendingBlocks == 0);
+		}
+		if (!bHeadReady && nNextLoad < nEntryCount && (nNextLoad == nNextWrite || nPendingBytes < ZIP_WRITER_MAX_PENDING_BYTES))
+		{
+			ZipArchiveEntry* pEntry = m_entries[nNextLoad++];
+			nPendingBytes += pEntry->LoadData();
+			if (workers.empty())
+			{
+				for (auto& block : pEntry->m_blocks)
+					block.Deflate(-1);
+				pEntry->m_nPendingBlocks = 0;
+			}
+			else if (!pEntry->m_blocks.empty())
+			{
+				{
+					std::lock_guard<std::mutex> lock_(jobMutex);
+					for (int i = 0; i < (int)pEntry->m_blocks.size(); ++i)
+						jobs.push_back(std::make_pair(pEntry, i));
+				}
+				jobSignal.notify_all();
+			}
+			continue;
+		}
+		if (!bHeadReady)
+		{
+			std::unique_lock<std::mutex> lock_(jobMutex);
+			doneSignal.wait(lock_, [&]() { return pHead->m_nPendingBlocks == 0; });
+		}
+		nPendingBytes -= pHead->m_nDataSize;
+		pHead->Serialize(file);
+		++nNextWrite;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock_(jobMutex);
+		bStopped = true;
+	}
+	jobSignal.notify_all();
+	for (auto& thread : workers)
+		thread.join();
+}
+
 int ParaEngine::CZipWriter::SaveAndClose()
 {
 	CParaFile file;
@@ -442,10 +620,7 @@ int ParaEngine::CZipWriter::SaveAndClose()
 
 		auto startPosition = file.getPos();
 
-		for (auto* entry : m_entries)
-		{
-			entry->SerializeLocalFileHeader(file);
-		}
+		WriteEntries(file);
 
 		auto offsetOfStartOfCDFH = file.getPos() - startPosition;
 		for (auto* entry : m_entries)
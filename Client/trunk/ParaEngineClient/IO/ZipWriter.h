@@ -23,6 +23,12 @@ namespace ParaEngine
 	* writer->ZipAdd("znsimple.bmp", "c:\\simple.bmp");
 	* writer->ZipAdd("znsimple.txt", "c:\\simple.txt");
 	* writer->close();
+	*
+	* Entries are deflated on a pool of worker threads when the zip is closed, and entries bigger than 1MB are split into
+	* blocks that are deflated independently (pigz style). Output is still written in entry order by the calling thread,
+	* while workers compress the entries ahead of it, so the entry order and file layout do not depend on the number of threads.
+	* The archive is a valid zip readable by any unzip tool, but the compressed data of entries bigger than 1MB is not
+	* byte identical to single threaded deflate, since each block is flushed on its own.
 	*/
 	class CZipWriter : public IAttributeFields
 	{
@@ -88,13 +94,20 @@ namespace ParaEngine
 		/** compress without zip header*/
 		static int Compress(std::string& outstring, const char* src, int nSrcSize, int compressionlevel = -1);
 
+		/** number of deflate worker threads used when closing the zip file. 0 (default) means the number of cores. 1 to compress on the calling thread. */
+		void SetThreadCount(int nCount);
+		int GetThreadCount();
+
 	protected:
 		int SaveAndClose();
+		/** deflate all entries on worker threads and write their local headers and data in order. */
+		void WriteEntries(CParaFile& file);
 		void removeAllEntries();
 
 	protected:
 		std::vector<ZipArchiveEntry*>  m_entries;
 		std::string m_filename;
 		std::string m_password;
+		int m_nThreadCount;
 	};
 }
@@ -0,0 +1,563 @@
+//-----------------------------------------------------------------------------
+// Class:	CNPLByteBuffer
+// Authors:	LiXizhi
+// Emails:	LiXizhi@yeah.net
+// Company: ParaEngine
+// Date:	2026.10.18
+// Desc: mutable byte buffer userdata with views, typed reads/writes and varint helpers.
+//-----------------------------------------------------------------------------
+#include "ParaEngine.h"
+#include "NPLByteBuffer.h"
+#include <memory>
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+extern "C"
+{
+#include "lua.h"
+#include "lauxlib.h"
+}
+
+using namespace NPL;
+
+/** name of the metatable in the lua registry */
+#define BYTEBUFFER_META	"NPL.ByteBuffer"
+
+namespace NPL
+{
+	/** userdata of a buffer or a view. views share m_pData with the buffer they are created from. */
+	struct NPLByteBufferUserData
+	{
+		std::shared_ptr<std::vector<char> > m_pData;
+		/** start of a view in m_pData. always 0 for buffers */
+		size_t m_nOffset;
+		/** size of a view. buffers always use the full size of m_pData */
+		size_t m_nSize;
+		/** read/write cursor relative to m_nOffset */
+		size_t m_nPos;
+		bool m_bView;
+		bool m_bBigEndian;
+
+		char* GetData() { return m_pData->empty() ? NULL : (&(*m_pData)[0] + m_nOffset); }
+
+		/** views are clamped, in case the buffer is shrunk after the view is created. */
+		size_t GetSize()
+		{
+			if (!m_bView)
+				return m_pData->size();
+			return (m_nOffset >= m_pData->size()) ? 0 : (std::min)(m_nSize, m_pData->size() - m_nOffset);
+		}
+	};
+
+	static NPLByteBufferUserData* ToByteBuffer(lua_State* L, int nIndex)
+	{
+		void* p = lua_touserdata(L, nIndex);
+		if (p == NULL || !lua_getmetatable(L, nIndex))
+			return NULL;
+		luaL_getmetatable(L, BYTEBUFFER_META);
+		bool bIsBuffer = lua_rawequal(L, -1, -2) != 0;
+		lua_pop(L, 2);
+		return bIsBuffer ? (NPLByteBufferUserData*)p : NULL;
+	}
+
+	static NPLByteBufferUserData* CheckByteBuffer(lua_State* L, int nIndex)
+	{
+		return (NPLByteBufferUserData*)luaL_checkudata(L, nIndex, BYTEBUFFER_META);
+	}
+
+	static NPLByteBufferUserData* NewByteBuffer(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = (NPLByteBufferUserData*)lua_newuserdata(L, sizeof(NPLByteBufferUserData));
+		new (pBuf) NPLByteBufferUserData();
+		pBuf->m_nOffset = pBuf->m_nSize = pBuf->m_nPos = 0;
+		pBuf->m_bView = pBuf->m_bBigEndian = false;
+		luaL_getmetatable(L, BYTEBUFFER_META);
+		lua_setmetatable(L, -2);
+		return pBuf;
+	}
+
+	/** offset, size or count argument at nArg. Negative, fractional and out of range numbers raise an argument error. */
+	static size_t CheckSizeArg(lua_State* L, int nArg)
+	{
+		lua_Number value = luaL_checknumber(L, nArg);
+		if (!(value >= 0) || value != floor(value) || value >= (lua_Number)(std::numeric_limits<size_t>::max)())
+			luaL_argerror(L, nArg, "non-negative integer expected");
+		return (size_t)value;
+	}
+
+	/** same as CheckSizeArg, except that nDefault is returned if the argument is not a number. */
+	static size_t OptSizeArg(lua_State* L, int nArg, size_t nDefault)
+	{
+		return lua_isnumber(L, nArg) ? CheckSizeArg(L, nArg) : nDefault;
+	}
+
+	/** whether [nPos, nPos+nBytes) is outside [0, nSize), without overflowing. */
+	static inline bool IsOutOfRange(size_t nPos, size_t nBytes, size_t nSize)
+	{
+		return nPos > nSize || nBytes > nSize - nPos;
+	}
+
+	/** return writable memory for nBytes at nPos of the buffer. Buffers grow as needed, while views raise an error. */
+	static char* PrepareWrite(lua_State* L, NPLByteBufferUserData* pBuf, size_t nPos, size_t nBytes)
+	{
+		if (IsOutOfRange(nPos, nBytes, pBuf->GetSize()))
+		{
+			if (pBuf->m_bView)
+				luaL_error(L, "ByteBuffer: write out of range of the view");
+			if (nBytes > (pBuf->m_pData->max_size)() - nPos)
+				luaL_error(L, "ByteBuffer: buffer too large");
+			pBuf->m_pData->resize(nPos + nBytes);
+		}
+		return pBuf->GetData() + nPos;
+	}
+
+	static const char* PrepareRead(lua_State* L, NPLByteBufferUserData* pBuf, size_t nPos, size_t nBytes)
+	{
+		if (IsOutOfRange(nPos, nBytes, pBuf->GetSize()))
+			luaL_error(L, "ByteBuffer: read out of range");
+		return pBuf->GetData() + nPos;
+	}
+
+	/** optional endian parameter at nIndex, which defaults to the buffer's setting */
+	static bool IsBigEndian(lua_State* L, int nIndex, NPLByteBufferUserData* pBuf)
+	{
+		return lua_isboolean(L, nIndex) ? (lua_toboolean(L, nIndex) != 0) : pBuf->m_bBigEndian;
+	}
+
+	static inline bool IsNativeBigEndian()
+	{
+		const uint16_t nOne = 1;
+		return *(const char*)&nOne == 0;
+	}
+
+	template <typename T>
+	static inline void ConvertEndian(T& value, bool bBigEndian)
+	{
+		if (sizeof(T) > 1 && bBigEndian != IsNativeBigEndian())
+		{
+			char* p = (char*)&value;
+			std::reverse(p, p + sizeof(T));
+		}
+	}
+
+	/** negative numbers are converted through int64, so that -1 can be written as UInt32. */
+	template <typename T>
+	static inline T NumberTo(lua_Number value) { return (value < 0) ? (T)(int64_t)value : (T)(uint64_t)value; }
+	template <>
+	inline float NumberTo<float>(lua_Number value) { return (float)value; }
+	template <>
+	inline double NumberTo<double>(lua_Number value) { return (double)value; }
+
+	/** buf:ReadXXX([bBigEndian]) read at cursor */
+	template <typename T>
+	static int ByteBuffer_Read(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		T value;
+		memcpy(&value, PrepareRead(L, pBuf, pBuf->m_nPos, sizeof(T)), sizeof(T));
+		pBuf->m_nPos += sizeof(T);
+		ConvertEndian(value, IsBigEndian(L, 2, pBuf));
+		lua_pushnumber(L, (lua_Number)value);
+		return 1;
+	}
+
+	/** buf:WriteXXX(value, [bBigEndian]) write at cursor */
+	template <typename T>
+	static int ByteBuffer_Write(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		T value = NumberTo<T>(luaL_checknumber(L, 2));
+		ConvertEndian(value, IsBigEndian(L, 3, pBuf));
+		memcpy(PrepareWrite(L, pBuf, pBuf->m_nPos, sizeof(T)), &value, sizeof(T));
+		pBuf->m_nPos += sizeof(T);
+		return 0;
+	}
+
+	/** buf:GetXXX(offset, [bBigEndian]) read at offset without moving the cursor */
+	template <typename T>
+	static int ByteBuffer_Get(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		size_t nPos = CheckSizeArg(L, 2);
+		T value;
+		memcpy(&value, PrepareRead(L, pBuf, nPos, sizeof(T)), sizeof(T));
+		ConvertEndian(value, IsBigEndian(L, 3, pBuf));
+		lua_pushnumber(L, (lua_Number)value);
+		return 1;
+	}
+
+	/** buf:SetXXX(offset, value, [bBigEndian]) write at offset without moving the cursor */
+	template <typename T>
+	static int ByteBuffer_Set(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		size_t nPos = CheckSizeArg(L, 2);
+		T value = NumberTo<T>(luaL_checknumber(L, 3));
+		ConvertEndian(value, IsBigEndian(L, 4, pBuf));
+		memcpy(PrepareWrite(L, pBuf, nPos, sizeof(T)), &value, sizeof(T));
+		return 0;
+	}
+
+	static void WriteVarInt(lua_State* L, NPLByteBufferUserData* pBuf, uint64_t value)
+	{
+		char buf[10];
+		int nSize = 0;
+		while (value >= 0x80)
+		{
+			buf[nSize++] = (char)(value | 0x80);
+			value >>= 7;
+		}
+		buf[nSize++] = (char)value;
+		memcpy(PrepareWrite(L, pBuf, pBuf->m_nPos, nSize), buf, nSize);
+		pBuf->m_nPos += nSize;
+	}
+
+	static uint64_t ReadVarInt(lua_State* L, NPLByteBufferUserData* pBuf)
+	{
+		uint64_t value = 0;
+		size_t nSize = pBuf->GetSize();
+		const unsigned char* pData = (const unsigned char*)pBuf->GetData();
+		for (int nShift = 0; nShift < 64; nShift += 7)
+		{
+			if (pBuf->m_nPos >= nSize)
+				luaL_error(L, "ByteBuffer: read out of range");
+			unsigned char c = pData[pBuf->m_nPos++];
+			value |= (uint64_t)(c & 0x7f) << nShift;
+			if ((c & 0x80) == 0)
+				return value;
+		}
+		luaL_error(L, "ByteBuffer: malformed varint");
+		return 0;
+	}
+
+	/** protobuf style unsigned varint */
+	static int ByteBuffer_WriteVarInt(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		WriteVarInt(L, pBuf, NumberTo<uint64_t>(luaL_checknumber(L, 2)));
+		return 0;
+	}
+
+	static int ByteBuffer_ReadVarInt(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		lua_pushnumber(L, (lua_Number)ReadVarInt(L, pBuf));
+		return 1;
+	}
+
+	/** zigzag encoded signed varint */
+	static int ByteBuffer_WriteSVarInt(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		int64_t value = (int64_t)luaL_checknumber(L, 2);
+		WriteVarInt(L, pBuf, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+		return 0;
+	}
+
+	static int ByteBuffer_ReadSVarInt(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		uint64_t value = ReadVarInt(L, pBuf);
+		lua_pushnumber(L, (lua_Number)(int64_t)((value >> 1) ^ (~(value & 1) + 1)));
+		return 1;
+	}
+
+	/** buf:WriteString(str_or_buffer) write raw bytes at cursor */
+	static int ByteBuffer_WriteString(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		int nSize = 0;
+		const char* pData = CNPLByteBuffer::GetData(L, 2, &nSize);
+		size_t nLen = (size_t)nSize;
+		if (pData == NULL)
+			pData = luaL_checklstring(L, 2, &nLen);
+		if (nLen > 0)
+		{
+			// the source may be a view of this buffer, which moves when the buffer grows, so locate it by offset after the write is prepared.
+			// nothing is allocated here, since PrepareWrite may raise a lua error.
+			NPLByteBufferUserData* pSrc = ToByteBuffer(L, 2);
+			bool bSameData = (pSrc != NULL && pSrc->m_pData == pBuf->m_pData);
+			char* pDest = PrepareWrite(L, pBuf, pBuf->m_nPos, nLen);
+			if (bSameData)
+				memmove(pDest, &(*pSrc->m_pData)[0] + pSrc->m_nOffset, nLen);
+			else
+				memcpy(pDest, pData, nLen);
+			pBuf->m_nPos += nLen;
+		}
+		return 0;
+	}
+
+	/** buf:ReadString(nCount) read nCount bytes at cursor as a lua string. nCount defaults to the rest of buffer. */
+	static int ByteBuffer_ReadString(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		size_t nSize = pBuf->GetSize();
+		size_t nCount = OptSizeArg(L, 2, (pBuf->m_nPos < nSize) ? (nSize - pBuf->m_nPos) : 0);
+		const char* pData = PrepareRead(L, pBuf, pBuf->m_nPos, nCount);
+		lua_pushlstring(L, pData, nCount);
+		pBuf->m_nPos += nCount;
+		return 1;
+	}
+
+	/** buf:ToString([offset, [size]]) copy bytes to a lua string without moving the cursor */
+	static int ByteBuffer_ToString(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		size_t nSize = pBuf->GetSize();
+		size_t nFrom = lua_isnoneornil(L, 2) ? 0 : CheckSizeArg(L, 2);
+		size_t nCount = OptSizeArg(L, 3, (nFrom < nSize) ? (nSize - nFrom) : 0);
+		lua_pushlstring(L, PrepareRead(L, pBuf, nFrom, nCount), nCount);
+		return 1;
+	}
+
+	/** buf:View([offset, [size]]) a view that shares memory with this buffer. The view's cursor starts at 0. */
+	static int ByteBuffer_View(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		size_t nSize = pBuf->GetSize();
+		size_t nFrom = lua_isnoneornil(L, 2) ? 0 : CheckSizeArg(L, 2);
+		size_t nCount = OptSizeArg(L, 3, (nFrom < nSize) ? (nSize - nFrom) : 0);
+		PrepareRead(L, pBuf, nFrom, nCount);
+		NPLByteBufferUserData* pView = NewByteBuffer(L);
+		pView->m_pData = pBuf->m_pData;
+		pView->m_nOffset = pBuf->m_nOffset + nFrom;
+		pView->m_nSize = nCount;
+		pView->m_bView = true;
+		pView->m_bBigEndian = pBuf->m_bBigEndian;
+		return 1;
+	}
+
+	static int ByteBuffer_Size(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		lua_pushnumber(L, (lua_Number)pBuf->GetSize());
+		return 1;
+	}
+
+	/** buf:Resize(nSize) new bytes are 0. views can not be resized. */
+	static int ByteBuffer_Resize(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		if (pBuf->m_bView)
+			return luaL_error(L, "ByteBuffer: view can not be resized");
+		size_t nSize = CheckSizeArg(L, 2);
+		pBuf->m_pData->resize(nSize);
+		if (pBuf->m_nPos > nSize)
+			pBuf->m_nPos = nSize;
+		return 0;
+	}
+
+	static int ByteBuffer_Reserve(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		pBuf->m_pData->reserve(CheckSizeArg(L, 2));
+		return 0;
+	}
+
+	/** buf:Clear() set size and cursor to 0, but keep the memory for reuse. */
+	static int ByteBuffer_Clear(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		if (pBuf->m_bView)
+			return luaL_error(L, "ByteBuffer: view can not be resized");
+		pBuf->m_pData->clear();
+		pBuf->m_nPos = 0;
+		return 0;
+	}
+
+	static int ByteBuffer_Seek(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		size_t nPos = CheckSizeArg(L, 2);
+		if (nPos > pBuf->GetSize())
+			return luaL_error(L, "ByteBuffer: seek out of range");
+		pBuf->m_nPos = nPos;
+		return 0;
+	}
+
+	static int ByteBuffer_Tell(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		lua_pushnumber(L, (lua_Number)pBuf->m_nPos);
+		return 1;
+	}
+
+	/** number of bytes after the cursor */
+	static int ByteBuffer_Remaining(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		size_t nSize = pBuf->GetSize();
+		lua_pushnumber(L, (lua_Number)((pBuf->m_nPos < nSize) ? (nSize - pBuf->m_nPos) : 0));
+		return 1;
+	}
+
+	static int ByteBuffer_SetBigEndian(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		pBuf->m_bBigEndian = lua_toboolean(L, 2) != 0;
+		return 0;
+	}
+
+	static int ByteBuffer_IsBigEndian(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = CheckByteBuffer(L, 1);
+		lua_pushboolean(L, pBuf->m_bBigEndian ? 1 : 0);
+		return 1;
+	}
+
+	static int ByteBuffer_GC(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = (NPLByteBufferUserData*)lua_touserdata(L, 1);
+		if (pBuf)
+			pBuf->~NPLByteBufferUserData();
+		return 0;
+	}
+
+	/** ByteBuffer.new([nSize_or_string]) */
+	static int ByteBuffer_New(lua_State* L)
+	{
+		NPLByteBufferUserData* pBuf = NewByteBuffer(L);
+		pBuf->m_pData.reset(new std::vector<char>());
+		if (lua_type(L, 1) == LUA_TNUMBER)
+		{
+			pBuf->m_pData->resize(CheckSizeArg(L, 1));
+		}
+		else
+		{
+			int nSize = 0;
+			const char* pData = CNPLByteBuffer::GetData(L, 1, &nSize);
+			size_t nLen = (size_t)nSize;
+			if (pData == NULL && lua_type(L, 1) == LUA_TSTRING)
+				pData = lua_tolstring(L, 1, &nLen);
+			if (pData != NULL && nLen > 0)
+				pBuf->m_pData->assign(pData, pData + nLen);
+		}
+		return 1;
+	}
+
+	static int ByteBuffer_IsBuffer(lua_State* L)
+	{
+		lua_pushboolean(L, ToByteBuffer(L, 1) != NULL ? 1 : 0);
+		return 1;
+	}
+
+	static const struct luaL_reg s_bytebuffer_funcs[] = {
+		{ "new", ByteBuffer_New },
+		{ "isbuffer", ByteBuffer_IsBuffer },
+		{ NULL, NULL }
+	};
+
+	static const struct luaL_reg s_bytebuffer_methods[] = {
+		{ "__gc", ByteBuffer_GC },
+		{ "__len", ByteBuffer_Size },
+		{ "__tostring", ByteBuffer_ToString },
+		{ "Size", ByteBuffer_Size },
+		{ "Resize", ByteBuffer_Resize },
+		{ "Reserve", ByteBuffer_Reserve },
+		{ "Clear", ByteBuffer_Clear },
+		{ "Seek", ByteBuffer_Seek },
+		{ "Tell", ByteBuffer_Tell },
+		{ "Remaining", ByteBuffer_Remaining },
+		{ "SetBigEndian", ByteBuffer_SetBigEndian },
+		{ "IsBigEndian", ByteBuffer_IsBigEndian },
+		{ "View", ByteBuffer_View },
+		{ "ToString", ByteBuffer_ToString },
+		{ "ReadString", ByteBuffer_ReadString },
+		{ "WriteString", ByteBuffer_WriteString },
+		{ "ReadVarInt", ByteBuffer_ReadVarInt },
+		{ "WriteVarInt", ByteBuffer_WriteVarInt },
+		{ "ReadSVarInt", ByteBuffer_ReadSVarInt },
+		{ "WriteSVarInt", ByteBuffer_WriteSVarInt },
+		{ "ReadInt8", ByteBuffer_Read<int8_t> },
+		{ "ReadUInt8", ByteBuffer_Read<uint8_t> },
+		{ "ReadInt16", ByteBuffer_Read<int16_t> },
+		{ "ReadUInt16", ByteBuffer_Read<uint16_t> },
+		{ "ReadInt32", ByteBuffer_Read<int32_t> },
+		{ "ReadUInt32", ByteBuffer_Read<uint32_t> },
+		{ "ReadInt64", ByteBuffer_Read<int64_t> },
+		{ "ReadUInt64", ByteBuffer_Read<uint64_t> },
+		{ "ReadFloat", ByteBuffer_Read<float> },
+		{ "ReadDouble", ByteBuffer_Read<double> },
+		{ "WriteInt8", ByteBuffer_Write<int8_t> },
+		{ "WriteUInt8", ByteBuffer_Write<uint8_t> },
+		{ "WriteInt16", ByteBuffer_Write<int16_t> },
+		{ "WriteUInt16", ByteBuffer_Write<uint16_t> },
+		{ "WriteInt32", ByteBuffer_Write<int32_t> },
+		{ "WriteUInt32", ByteBuffer_Write<uint32_t> },
+		{ "WriteInt64", ByteBuffer_Write<int64_t> },
+		{ "WriteUInt64", ByteBuffer_Write<uint64_t> },
+		{ "WriteFloat", ByteBuffer_Write<float> },
+		{ "WriteDouble", ByteBuffer_Write<double> },
+		{ "GetInt8", ByteBuffer_Get<int8_t> },
+		{ "GetUInt8", ByteBuffer_Get<uint8_t> },
+		{ "GetInt16", ByteBuffer_Get<int16_t> },
+		{ "GetUInt16", ByteBuffer_Get<uint16_t> },
+		{ "GetInt32", ByteBuffer_Get<int32_t> },
+		{ "GetUInt32", ByteBuffer_Get<uint32_t> },
+		{ "GetInt64", ByteBuffer_Get<int64_t> },
+		{ "GetUInt64", ByteBuffer_Get<uint64_t> },
+		{ "GetFloat", ByteBuffer_Get<float> },
+		{ "GetDouble", ByteBuffer_Get<double> },
+		{ "SetInt8", ByteBuffer_Set<int8_t> },
+		{ "SetUInt8", ByteBuffer_Set<uint8_t> },
+		{ "SetInt16", ByteBuffer_Set<int16_t> },
+		{ "SetUInt16", ByteBuffer_Set<uint16_t> },
+		{ "SetInt32", ByteBuffer_Set<int32_t> },
+		{ "SetUInt32", ByteBuffer_Set<uint32_t> },
+		{ "SetInt64", ByteBuffer_Set<int64_t> },
+		{ "SetUInt64", ByteBuffer_Set<uint64_t> },
+		{ "SetFloat", ByteBuffer_Set<float> },
+		{ "SetDouble", ByteBuffer_Set<double> },
+		{ NULL, NULL }
+	};
+
+	/** create the metatable if it does not exist yet. */
+	static void RegisterMetaTable(lua_State* L)
+	{
+		if (luaL_newmetatable(L, BYTEBUFFER_META))
+		{
+			lua_pushvalue(L, -1);
+			lua_setfield(L, -2, "__index");
+			luaL_register(L, NULL, s_bytebuffer_methods);
+		}
+		lua_pop(L, 1);
+	}
+}
+
+int CNPLByteBuffer::luaopen_bytebuffer(lua_State* L)
+{
+	RegisterMetaTable(L);
+	luaL_register(L, "ByteBuffer", s_bytebuffer_funcs);
+	return 1;
+}
+
+const char* CNPLByteBuffer::GetData(lua_State* L, int nIndex, int* pSize)
+{
+	NPLByteBufferUserData* pBuf = ToByteBuffer(L, nIndex);
+	if (pBuf == NULL)
+		return NULL;
+	if (pSize)
+		*pSize = (int)pBuf->GetSize();
+	// never return NULL for an empty buffer, so that callers can tell it from a non-buffer value.
+	const char* pData = pBuf->GetData();
+	return pData ? pData : "";
+}
+
+bool CNPLByteBuffer::SetData(lua_State* L, int nIndex, const char* pData, int nSize)
+{
+	NPLByteBufferUserData* pBuf = ToByteBuffer(L, nIndex);
+	if (pBuf == NULL || pBuf->m_bView)
+		return false;
+	pBuf->m_pData->assign(pData, pData + nSize);
+	pBuf->m_nPos = 0;
+	return true;
+}
+
+char* CNPLByteBuffer::PushNewBuffer(lua_State* L, int nSize)
+{
+	RegisterMetaTable(L);
+	NPLByteBufferUserData* pBuf = NewByteBuffer(L);
+	pBuf->m_pData.reset(new std::vector<char>(nSize > 0 ? nSize : 0));
+	return pBuf->GetData();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+struct lua_State;
+
+namespace NPL
+{
+	/**
+	* mutable byte buffer userdata for binary payloads in NPL scripts.
+	* Unlike lua strings, it can be modified in place, so building or parsing a binary packet does not
+	* intern a new string for every step. Views share memory with the buffer they are created from.
+	*
+	* All offsets are 0 based byte offsets. Integers are little endian unless big endian is set on the buffer
+	* or passed as the last parameter of a typed read/write. 64 bits integers are lua numbers, so only 53 bits are exact.
+	* e.g.
+	*	luaopen_bytebuffer();
+	*	local buf = ByteBuffer.new();
+	*	buf:WriteUInt16(1); buf:WriteVarInt(300); buf:WriteString("hello");
+	*	buf:Seek(0); local cmd, len = buf:ReadUInt16(), buf:ReadVarInt();
+	*	local body = buf:View(buf:Tell());
+	*	NPL.activate("(gl)script/test.lua", {data = buf});
+	*	ParaIO.open("temp/a.bin", "w"):WriteBuffer(buf);
+	*	NPL.Compress({method="gzip", content=buf, result=ByteBuffer.new()});
+	*
+	* Native functions that read lua strings with NPLHelper::LuaObjectToString(input, &nSize) accept byte buffers as well.
+	*/
+	class CNPLByteBuffer
+	{
+	public:
+		/** register the byte buffer metatable and the global "ByteBuffer" table. return the table. */
+		static int luaopen_bytebuffer(lua_State* L);
+
+		/** if the value at nIndex is a byte buffer or view, return its data and set pSize. otherwise return NULL.
+		* the data is valid as long as the buffer is not resized or collected. */
+		static const char* GetData(lua_State* L, int nIndex, int* pSize);
+
+		/** replace the content of the byte buffer at nIndex. the buffer is resized and its cursor is set to 0.
+		* @return false if the value is not a resizable byte buffer (views can not be resized). */
+		static bool SetData(lua_State* L, int nIndex, const char* pData, int nSize);
+
+		/** push a new byte buffer of nSize bytes to the stack, and return its data for writing. */
+		static char* PushNewBuffer(lua_State* L, int nSize);
+	};
+}
@@ -0,0 +1,352 @@
+//-----------------------------------------------------------------------------
+// Class:	CNPLBytecodeCache
+// Authors:	LiXizhi
+// Emails:	LiXizhi@yeah.net
+// Company: ParaEngine
+// Date:	2026.10.18
+// Desc: process wide lua bytecode cache shared by all NPL runtime states.
+//-----------------------------------------------------------------------------
+#include "ParaEngine.h"
+#include "util/ParaTime.h"
+#include "FileSystemWatcher.h"
+#include "NPLBytecodeCache.h"
+
+extern "C"
+{
+#include "lua.h"
+#include "lauxlib.h"
+}
+
+using namespace NPL;
+using namespace ParaEngine;
+
+/** default max total bytes of bytecode kept in memory */
+#define BYTECODE_CACHE_DEFAULT_MAX_BYTES	(64*1024*1024)
+/** header of a disk cache file, followed by file version, build stamp, source hash, compile time, bytecode size and bytecode checksum */
+#define BYTECODE_CACHE_FILE_MAGIC	"NPLB"
+/** increase it whenever the disk cache file layout changes */
+#define BYTECODE_CACHE_FILE_VERSION	2
+/** name of the file system watcher used for invalidation */
+#define BYTECODE_CACHE_WATCHER_NAME	"npl_bytecode_cache"
+
+namespace NPL
+{
+	static int WriteBytecode(lua_State* L, const void* p, size_t nSize, void* pUserData)
+	{
+		((std::string*)pUserData)->append((const char*)p, nSize);
+		return 0;
+	}
+
+#if !defined(PARAENGINE_MOBILE)
+	/** drop entries of changed files. */
+	struct BytecodeCache_FileCallback
+	{
+		void operator()(const ParaEngine::CFileSystemWatcher::DirMonitorEvent& event)
+		{
+			CNPLBytecodeCache::GetInstance().Invalidate(event.path.generic_string());
+		}
+	};
+#endif
+}
+
+CNPLBytecodeCache::CNPLBytecodeCache()
+	:m_bEnabled(true), m_nMaxMemoryBytes(BYTECODE_CACHE_DEFAULT_MAX_BYTES), m_nMemoryBytes(0), m_bWatcherCallbackAdded(false), m_nUseTick(0),
+	m_nHitCount(0), m_nMissCount(0), m_nCompileTime(0), m_nSavedTime(0)
+{
+}
+
+CNPLBytecodeCache::~CNPLBytecodeCache()
+{
+}
+
+CNPLBytecodeCache& CNPLBytecodeCache::GetInstance()
+{
+	static CNPLBytecodeCache s_instance;
+	return s_instance;
+}
+
+uint64 CNPLBytecodeCache::HashSource(const char* pCode, int nSize)
+{
+	// FNV-1a, with the size mixed in.
+	uint64 nHash = 14695981039346656037ULL ^ (uint64)nSize;
+	for (int i = 0; i < nSize; ++i)
+	{
+		nHash ^= (unsigned char)pCode[i];
+		nHash *= 1099511628211ULL;
+	}
+	return nHash;
+}
+
+int CNPLBytecodeCache::LoadBuffer(lua_State* L, const char* pCode, int nSize, const std::string& sFilename)
+{
+	if (!m_bEnabled)
+		return luaL_loadbuffer(L, pCode, nSize, sFilename.c_str());
+
+	uint64 nSourceHash = HashSource(pCode, nSize);
+	NPLBytecodeEntry entry;
+	bool bFound = false;
+	std::string sDiskCacheDir;
+	{
+		ParaEngine::Lock lock_(m_mutex);
+		sDiskCacheDir = m_sDiskCacheDir;
+		auto it = m_entries.find(sFilename);
+		if (it != m_entries.end() && it->second.m_nSourceHash == nSourceHash)
+		{
+			it->second.m_nLastUseTick = ++m_nUseTick;
+			// copy out, so that other states are not blocked while this one loads the bytecode.
+			entry = it->second;
+			bFound = true;
+		}
+	}
+	if (!bFound && !sDiskCacheDir.empty() && ReadFromDisk(sDiskCacheDir, sFilename, nSourceHash, GetBuildStamp(L), entry))
+	{
+		AddEntry(sFilename, entry);
+		bFound = true;
+	}
+
+	if (bFound)
+	{
+		int64 nStartTime = GetTimeUS();
+		if (luaL_loadbuffer(L, entry.m_bytecode.c_str(), entry.m_bytecode.size(), sFilename.c_str()) == 0)
+		{
+			int64 nLoadTime = GetTimeUS() - nStartTime;
+			ParaEngine::Lock lock_(m_mutex);
+			++m_nHitCount;
+			m_nSavedTime += (std::max)(entry.m_nCompileTime - nLoadTime, (int64)0);
+			return 0;
+		}
+		// bytecode from a different lua build, etc. fall back to source.
+		lua_pop(L, 1);
+		Invalidate(sFilename);
+	}
+
+	int64 nStartTime = GetTimeUS();
+	int nResult = luaL_loadbuffer(L, pCode, nSize, sFilename.c_str());
+	if (nResult == 0)
+	{
+		entry.m_nSourceHash = nSourceHash;
+		entry.m_nCompileTime = GetTimeUS() - nStartTime;
+		entry.m_bytecode.clear();
+		if (lua_dump(L, WriteBytecode, &entry.m_bytecode) == 0 && !entry.m_bytecode.empty())
+		{
+			AddEntry(sFilename, entry);
+			if (!sDiskCacheDir.empty())
+				WriteToDisk(sDiskCacheDir, sFilename, GetBuildStamp(L), entry);
+		}
+		ParaEngine::Lock lock_(m_mutex);
+		++m_nMissCount;
+		m_nCompileTime += entry.m_nCompileTime;
+	}
+	return nResult;
+}
+
+void CNPLBytecodeCache::AddEntry(const std::string& sFilename, const NPLBytecodeEntry& entry)
+{
+	ParaEngine::Lock lock_(m_mutex);
+	auto it = m_entries.find(sFilename);
+	if (it != m_entries.end())
+	{
+		m_nMemoryBytes -= it->second.m_bytecode.size();
+		m_entries.erase(it);
+	}
+	if ((int64)entry.m_bytecode.size() > (int64)m_nMaxMemoryBytes)
+		return;
+	while (!m_entries.empty() && (m_nMemoryBytes + (int64)entry.m_bytecode.size()) > (int64)m_nMaxMemoryBytes)
+		EvictEntry();
+	NPLBytecodeEntry& newEntry = m_entries[sFilename];
+	newEntry = entry;
+	newEntry.m_nLastUseTick = ++m_nUseTick;
+	m_nMemoryBytes += entry.m_bytecode.size();
+}
+
+void CNPLBytecodeCache::EvictEntry()
+{
+	auto itOldest = m_entries.begin();
+	for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+	{
+		if (it->second.m_nLastUseTick < itOldest->second.m_nLastUseTick)
+			itOldest = it;
+	}
+	if (itOldest != m_entries.end())
+	{
+		m_nMemoryBytes -= itOldest->second.m_bytecode.size();
+		m_entries.erase(itOldest);
+	}
+}
+
+void CNPLBytecodeCache::SetEnabled(bool bEnable)
+{
+	m_bEnabled = bEnable;
+}
+
+bool CNPLBytecodeCache::IsEnabled()
+{
+	return m_bEnabled;
+}
+
+void CNPLBytecodeCache::SetMaxMemoryBytes(int nBytes)
+{
+	m_nMaxMemoryBytes = nBytes;
+}
+
+int CNPLBytecodeCache::GetMaxMemoryBytes()
+{
+	return m_nMaxMemoryBytes;
+}
+
+void CNPLBytecodeCache::SetDiskCacheDir(const std::string& sDir)
+{
+	ParaEngine::Lock lock_(m_mutex);
+	m_sDiskCacheDir = sDir;
+	if (!m_sDiskCacheDir.empty())
+	{
+		char lastChar = m_sDiskCacheDir[m_sDiskCacheDir.size() - 1];
+		if (lastChar != '/' && lastChar != '\\')
+			m_sDiskCacheDir += "/";
+		CParaFile::CreateDirectory(m_sDiskCacheDir.c_str());
+	}
+}
+
+const std::string& CNPLBytecodeCache::GetDiskCacheDir()
+{
+	ParaEngine::Lock lock_(m_mutex);
+	m_sDiskCacheDirOutput = m_sDiskCacheDir;
+	return m_sDiskCacheDirOutput;
+}
+
+const std::string& CNPLBytecodeCache::GetBuildStamp(lua_State* L)
+{
+	ParaEngine::Lock lock_(m_mutex);
+	if (m_sBuildStamp.empty())
+	{
+		// the header of dumped bytecode has the bytecode format version of luajit, or the version and type sizes of lua.
+		std::string bytecode;
+		if (luaL_loadbuffer(L, "", 0, "=stamp") == 0)
+			lua_dump(L, WriteBytecode, &bytecode);
+		lua_pop(L, 1);
+		char sStamp[128];
+		int nLength = snprintf(sStamp, sizeof(sStamp), "%s ptr%d ", LUA_RELEASE, (int)sizeof(void*));
+		m_sBuildStamp.assign(sStamp, nLength);
+		m_sBuildStamp.append(bytecode, 0, (std::min)(bytecode.size(), (size_t)12));
+	}
+	return m_sBuildStamp;
+}
+
+std::string CNPLBytecodeCache::GetDiskCachePath(const std::string& sDiskCacheDir, const std::string& sFilename)
+{
+	char sName[40];
+	snprintf(sName, sizeof(sName), "%016llx.luac", (unsigned long long)HashSource(sFilename.c_str(), (int)sFilename.size()));
+	return sDiskCacheDir + sName;
+}
+
+bool CNPLBytecodeCache::ReadFromDisk(const std::string& sDiskCacheDir, const std::string& sFilename, uint64 nSourceHash, const std::string& sBuildStamp, NPLBytecodeEntry& entry)
+{
+	FILE* file = fopen(GetDiskCachePath(sDiskCacheDir, sFilename).c_str(), "rb");
+	if (file == NULL)
+		return false;
+	bool bSucceed = false;
+	char magic[4];
+	uint32 nVersion = 0, nStampSize = 0, nSize = 0;
+	uint64 nChecksum = 0;
+	std::string sStamp;
+	if (fread(magic, 1, 4, file) == 4 && memcmp(magic, BYTECODE_CACHE_FILE_MAGIC, 4) == 0 &&
+		fread(&nVersion, sizeof(nVersion), 1, file) == 1 && nVersion == BYTECODE_CACHE_FILE_VERSION &&
+		fread(&nStampSize, sizeof(nStampSize), 1, file) == 1 && nStampSize == (uint32)sBuildStamp.size())
+	{
+		sStamp.resize(nStampSize);
+		if (fread(&sStamp[0], 1, nStampSize, file) == nStampSize && sStamp == sBuildStamp &&
+			fread(&entry.m_nSourceHash, sizeof(entry.m_nSourceHash), 1, file) == 1 && entry.m_nSourceHash == nSourceHash &&
+			fread(&entry.m_nCompileTime, sizeof(entry.m_nCompileTime), 1, file) == 1 &&
+			fread(&nSize, sizeof(nSize), 1, file) == 1 && nSize > 0 &&
+			fread(&nChecksum, sizeof(nChecksum), 1, file) == 1)
+		{
+			entry.m_bytecode.resize(nSize);
+			bSucceed = fread(&entry.m_bytecode[0], 1, nSize, file) == nSize
+				&& HashSource(entry.m_bytecode.c_str(), (int)nSize) == nChecksum;
+		}
+	}
+	fclose(file);
+	return bSucceed;
+}
+
+void CNPLBytecodeCache::WriteToDisk(const std::string& sDiskCacheDir, const std::string& sFilename, const std::string& sBuildStamp, const NPLBytecodeEntry& entry)
+{
+	FILE* file = fopen(GetDiskCachePath(sDiskCacheDir, sFilename).c_str(), "wb");
+	if (file == NULL)
+	{
+		OUTPUT_LOG("warning: can not write bytecode cache for %s\n", sFilename.c_str());
+		return;
+	}
+	uint32 nVersion = BYTECODE_CACHE_FILE_VERSION;
+	uint32 nStampSize = (uint32)sBuildStamp.size();
+	uint32 nSize = (uint32)entry.m_bytecode.size();
+	uint64 nChecksum = HashSource(entry.m_bytecode.c_str(), (int)nSize);
+	fwrite(BYTECODE_CACHE_FILE_MAGIC, 1, 4, file);
+	fwrite(&nVersion, sizeof(nVersion), 1, file);
+	fwrite(&nStampSize, sizeof(nStampSize), 1, file);
+	fwrite(sBuildStamp.c_str(), 1, nStampSize, file);
+	fwrite(&entry.m_nSourceHash, sizeof(entry.m_nSourceHash), 1, file);
+	fwrite(&entry.m_nCompileTime, sizeof(entry.m_nCompileTime), 1, file);
+	fwrite(&nSize, sizeof(nSize), 1, file);
+	fwrite(&nChecksum, sizeof(nChecksum), 1, file);
+	fwrite(entry.m_bytecode.c_str(), 1, nSize, file);
+	fclose(file);
+}
+
+void CNPLBytecodeCache::WatchDirectory(const std::string& sDir)
+{
+#if !defined(PARAENGINE_MOBILE)
+	CFileSystemWatcherPtr pWatcher = CFileSystemWatcherService::GetInstance()->GetDirWatcher(BYTECODE_CACHE_WATCHER_NAME);
+	bool bAddCallback = false;
+	{
+		ParaEngine::Lock lock_(m_mutex);
+		bAddCallback = !m_bWatcherCallbackAdded;
+		m_bWatcherCallbackAdded = true;
+	}
+	// the callback locks m_mutex, so it is added without holding the lock.
+	if (bAddCallback)
+		pWatcher->AddEventCallback(BytecodeCache_FileCallback());
+	pWatcher->add_directory(sDir);
+#endif
+}
+
+void CNPLBytecodeCache::Invalidate(const std::string& sFilename)
+{
+	ParaEngine::Lock lock_(m_mutex);
+	auto it = m_entries.find(sFilename);
+	if (it == m_entries.end())
+	{
+		// watcher events have full disk paths, while entries are keyed by script path.
+		for (it = m_entries.begin(); it != m_entries.end(); ++it)
+		{
+			const std::string& sKey = it->first;
+			if (sKey.size() < sFilename.size() && sFilename.compare(sFilename.size() - sKey.size(), sKey.size(), sKey) == 0
+				&& (sFilename[sFilename.size() - sKey.size() - 1] == '/' || sFilename[sFilename.size() - sKey.size() - 1] == '\\'))
+				break;
+		}
+	}
+	if (it != m_entries.end())
+	{
+		m_nMemoryBytes -= it->second.m_bytecode.size();
+		m_entries.erase(it);
+	}
+}
+
+void CNPLBytecodeCache::Clear()
+{
+	ParaEngine::Lock lock_(m_mutex);
+	m_entries.clear();
+	m_nMemoryBytes = 0;
+	m_nHitCount = m_nMissCount = m_nCompileTime = m_nSavedTime = 0;
+}
+
+const std::string& CNPLBytecodeCache::GetStats()
+{
+	ParaEngine::Lock lock_(m_mutex);
+	char sStats[256];
+	snprintf(sStats, sizeof(sStats), "hits=%lld misses=%lld entries=%d bytes=%lld compile_ms=%lld saved_ms=%lld",
+		(long long)m_nHitCount, (long long)m_nMissCount, (int)m_entries.size(), (long long)m_nMemoryBytes,
+		(long long)(m_nCompileTime / 1000), (long long)(m_nSavedTime / 1000));
+	m_sStats = sStats;
+	return m_sStats;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "util/mutex.h"
+#include <map>
+#include <string>
+
+struct lua_State;
+
+namespace NPL
+{
+	/** compiled bytecode of a single script file */
+	struct NPLBytecodeEntry
+	{
+		/** hash of the source code that the bytecode is compiled from */
+		uint64 m_nSourceHash;
+		/** time in microseconds it took to compile from source */
+		int64 m_nCompileTime;
+		/** value of the cache's use counter when it is last loaded. the least recently used entry is evicted first. */
+		int64 m_nLastUseTick;
+		std::string m_bytecode;
+	};
+
+	/**
+	* Process wide cache of compiled lua bytecode, shared by all NPL runtime states.
+	* Entries are keyed by script file path, and only used when the hash of the source code matches,
+	* so that a modified file is always compiled again even without any invalidation.
+	* Optionally, bytecode is also persisted to a disk directory, so that it survives restart.
+	* Disk cache files have a header with the lua build stamp and a checksum of the bytecode, and are ignored if either does not match.
+	* Directories can be watched with the file system watcher, so that entries of changed files are dropped early.
+	*
+	* Only plain lua chunks use the cache. *.npl files are compiled by the NPL meta compiler in script.
+	*
+	* It can be configured via NPL runtime attributes, such as
+	*	NPL.GetAttributeObject():SetField("BytecodeCacheDir", "temp/bytecode/");
+	*	NPL.GetAttributeObject():GetField("BytecodeCacheStats", "");
+	*/
+	class CNPLBytecodeCache
+	{
+	public:
+		CNPLBytecodeCache();
+		~CNPLBytecodeCache();
+		static CNPLBytecodeCache& GetInstance();
+
+		/** same as luaL_loadbuffer(L, pCode, nSize, sFilename), except that the bytecode cache is used when enabled.
+		* @return 0 if succeed, in which case the compiled function is on the top of the stack. otherwise the error message is on top.
+		*/
+		int LoadBuffer(lua_State* L, const char* pCode, int nSize, const std::string& sFilename);
+
+		/** enabled by default */
+		void SetEnabled(bool bEnable);
+		bool IsEnabled();
+
+		/** max total bytes of bytecode in memory. least recently used files are evicted when the budget is used up. */
+		void SetMaxMemoryBytes(int nBytes);
+		int GetMaxMemoryBytes();
+
+		/** directory to persist bytecode to. empty string (default) to disable disk cache. */
+		void SetDiskCacheDir(const std::string& sDir);
+		/** the returned string is valid until the next call. */
+		const std::string& GetDiskCacheDir();
+
+		/** drop cached bytecode of files under the given disk directory whenever they are changed. */
+		void WatchDirectory(const std::string& sDir);
+
+		/** remove a file from memory cache */
+		void Invalidate(const std::string& sFilename);
+		/** remove all files from memory cache, and reset stats */
+		void Clear();
+
+		/** such as "hits=10 misses=2 entries=2 bytes=1024 compile_ms=3 saved_ms=12" */
+		const std::string& GetStats();
+
+	protected:
+		static uint64 HashSource(const char* pCode, int nSize);
+		/** lua version and the header of dumped bytecode, which changes with the bytecode format of the lua/luajit build. */
+		const std::string& GetBuildStamp(lua_State* L);
+		static std::string GetDiskCachePath(const std::string& sDiskCacheDir, const std::string& sFilename);
+		bool ReadFromDisk(const std::string& sDiskCacheDir, const std::string& sFilename, uint64 nSourceHash, const std::string& sBuildStamp, NPLBytecodeEntry& entry);
+		void WriteToDisk(const std::string& sDiskCacheDir, const std::string& sFilename, const std::string& sBuildStamp, const NPLBytecodeEntry& entry);
+		void AddEntry(const std::string& sFilename, const NPLBytecodeEntry& entry);
+		/** remove the least recently used entry. m_mutex must be locked. */
+		void EvictEntry();
+
+	private:
+		ParaEngine::mutex m_mutex;
+		std::map<std::string, NPLBytecodeEntry> m_entries;
+		bool m_bEnabled;
+		int m_nMaxMemoryBytes;
+		int64 m_nMemoryBytes;
+		std::string m_sDiskCacheDir;
+		std::string m_sDiskCacheDirOutput;
+		std::string m_sBuildStamp;
+		bool m_bWatcherCallbackAdded;
+		int64 m_nUseTick;
+
+		int64 m_nHitCount;
+		int64 m_nMissCount;
+		/** total time in microseconds spent in compiling from source */
+		int64 m_nCompileTime;
+		/** total compile time in microseconds of hits, minus the time to load their bytecode */
+		int64 m_nSavedTime;
+		std::string m_sStats;
+	};
+}
@@ -19,6 +19,11 @@
 #include "WebSocket/WebSocketFrame.h"
 #include "json/json.h"
 #include "NPLHelper.h"
+#include "ParaFile.h"
+#include "LargeFile.h"
+#if (PARA_TARGET_PLATFORM == PARA_PLATFORM_LINUX)
+#include <sys/sendfile.h>
+#endif
 /** @def if not defined, we expect all remote NPL runtime's public file list mapping to be identical
 if defined, different NPL runtime can have different local map and file id map are established dynamically.
 */
@@ -27,6 +32,8 @@ if defined, different NPL runtime can have different local map and file id map a
 /** @def the default maximum output message queue size. this is usually set to very big, such as 1024.
 the send message function will fail (service not available), if the queue is full */
 #define DEFAULT_NPL_OUTPUT_QUEUE_SIZE		1024
+/** chunk size when streaming files without sendfile */
+#define NPL_FILE_CHUNK_SIZE		65536
 
 /** when the message size is bigger than this number of bytes, we will use m_nCompressionLevel for compression.
 For message smaller than the threshold, we will not compress even m_nCompressionLevel is not 0.
@@ -41,7 +48,7 @@ NPL::CNPLConnection::CNPLConnection(boost::asio::io_service& io_service, CNPLCon
 	m_queueOutput(DEFAULT_NPL_OUTPUT_QUEUE_SIZE), m_state(ConnectionDisconnected),
 	m_bDebugConnection(false), m_nCompressionLevel(0), m_nCompressionThreshold(NPL_AUTO_COMPRESSION_THRESHOLD),
 	m_bKeepAlive(false), m_bEnableIdleTimeout(true), m_nSendCount(0), m_nFinishedCount(0), m_bCloseAfterSend(false), m_nIdleTimeoutMS(0), m_nLastActiveTime(0), m_nStopReason(0), m_bNoDelay(false),
-	m_protocolType(NPL)
+	m_protocolType(NPL), m_nQueuedBytes(0), m_nWritingBytes(0), m_nDroppedCount(0), m_nDroppedBytes(0), m_bAboveHighWatermark(false)
 {
 	m_queueOutput.SetUseEvent(false);
 	// init common fields for input message. 
@@ -478,6 +485,15 @@ void NPL::CNPLConnection::handle_write(const boost::system::error_code& e)
 
 		m_nFinishedCount++;
 
+		// the front message is sent. 
+		int64 nQueuedBytes = (m_nQueuedBytes -= m_nWritingBytes);
+		m_nWritingBytes = 0;
+		bool bAboveHighWatermark = true;
+		if (nQueuedBytes < (int64)m_msg_dispatcher.GetMaxQueuedBytes() / 4 && m_bAboveHighWatermark.compare_exchange_strong(bAboveHighWatermark, false))
+		{
+			m_msg_dispatcher.PostNetworkEvent(NPL_QueueLowWatermark, GetNID().c_str(), "low_watermark");
+		}
+
 		// Initiate graceful connection closure.
 		//boost::system::error_code ignored_ec;
 		//m_socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored_ec);
@@ -485,10 +501,7 @@ void NPL::CNPLConnection::handle_write(const boost::system::error_code& e)
 		NPLMsgOut_ptr* msg = NULL;
 		if (m_queueOutput.try_next(&msg) && msg != NULL)
 		{
-			boost::asio::async_write(m_socket,
-				boost::asio::buffer((*msg)->GetBuffer().c_str(), (*msg)->GetBuffer().size()),
-				boost::bind(&CNPLConnection::handle_write, shared_from_this(),
-					boost::asio::placeholders::error));
+			start_write(msg->get());
 		}
 		else
 		{
@@ -599,6 +612,12 @@ void NPL::CNPLConnection::connect()
 }
 
 void NPL::CNPLConnection::GetStatistics(int &totalIn, int &totalOut)
+{
+	totalIn = (int)m_totalBytesIn;
+	totalOut = (int)m_totalBytesOut;
+}
+
+void NPL::CNPLConnection::GetStatistics64(int64 &totalIn, int64 &totalOut)
 {
 	totalIn = m_totalBytesIn;
 	totalOut = m_totalBytesOut;
@@ -653,6 +672,8 @@ NPL::NPLReturnCode NPL::CNPLConnection::SendMessage(const NPLFileName& file_name
 	else
 	{
 		// for NPL message 
+		if (m_msg_dispatcher.GetSlowConsumerPolicy() == SlowConsumer_Coalesce)
+			msg_out->m_sKey = file_name.sRelativePath;
 		writer.AddFirstLine(file_name, file_id);
 		//writer.AddHeaderPair(name,value);
 		//writer.AddHeaderPair(name2,value2);
@@ -699,10 +720,36 @@ NPL::NPLReturnCode NPL::CNPLConnection::SendMessage(NPLMsgOut_ptr& msg)
 	}
 
 	int nLength = (int)msg->GetBuffer().size();
+	// read before pushing, since the io thread decreases it while sending
+	int64 nFileSize = msg->m_nFileSize;
+
+	int nMaxQueuedBytes = m_msg_dispatcher.GetMaxQueuedBytes();
+	// reserve before pushing, since the io thread may send it immediately
+	int64 nQueuedBytes = 0;
+	if (m_queueOutput.full() || !TryReserveQueuedBytes(nLength, nMaxQueuedBytes, nQueuedBytes))
+	{
+		if (!MakeRoomForMessage(msg, nMaxQueuedBytes) || !TryReserveQueuedBytes(nLength, nMaxQueuedBytes, nQueuedBytes))
+		{
+			m_nDroppedCount++;
+			m_nDroppedBytes += nLength;
+			if (GetLogLevel() > 0) {
+				OUTPUT_LOG("NPL SendMessage error because the output msg queue is full. The connection nid is %s, queued bytes %d \n", GetNID().c_str(), (int)m_nQueuedBytes);
+			}
+			return NPL_QueueIsFull;
+		}
+	}
 	NPLMsgOut_ptr * pFront = NULL;
 	m_nSendCount++;
 	RingBuffer_Type::BufferStatus bufStatus = m_queueOutput.try_push_get_front(msg, &pFront);
 
+	bool bAboveHighWatermark = false;
+	// only the producer that flips the flag posts the event, so that concurrent senders never post it twice.
+	if (bufStatus != RingBuffer_Type::BufferOverFlow && nMaxQueuedBytes > 0 && nQueuedBytes > (int64)nMaxQueuedBytes / 4 * 3
+		&& m_bAboveHighWatermark.compare_exchange_strong(bAboveHighWatermark, true))
+	{
+		m_msg_dispatcher.PostNetworkEvent(NPL_QueueHighWatermark, GetNID().c_str(), "high_watermark");
+	}
+
 	if (bufStatus == RingBuffer_Type::BufferFirst)
 	{
 		if (m_bDebugConnection)
@@ -722,14 +769,14 @@ NPL::NPLReturnCode NPL::CNPLConnection::SendMessage(NPLMsgOut_ptr& msg)
 		// LXZ: very tricky code to ensure thread-safety to the buffer.
 		// only start the sending task when the buffer is empty, otherwise we will wait for previous send task. 
 		// i.e. inside handle_write handler. 
-		boost::asio::async_write(m_socket,
-			boost::asio::buffer((*pFront)->GetBuffer().c_str(), (*pFront)->GetBuffer().size()),
-			boost::bind(&CNPLConnection::handle_write, shared_from_this(),
-				boost::asio::placeholders::error));
+		start_write(pFront->get());
 	}
 	else if (bufStatus == RingBuffer_Type::BufferOverFlow)
 	{
 		m_nSendCount--;
+		m_nQueuedBytes -= nLength;
+		m_nDroppedCount++;
+		m_nDroppedBytes += nLength;
 		if (GetLogLevel() > 0) {
 			OUTPUT_LOG("NPL SendMessage error because the output msg queue is full. The connection nid is %s \n", GetNID().c_str());
 		}
@@ -737,10 +784,210 @@ NPL::NPLReturnCode NPL::CNPLConnection::SendMessage(NPLMsgOut_ptr& msg)
 		return NPL_QueueIsFull;
 	}
 
-	m_totalBytesOut += nLength;
+	m_totalBytesOut += nLength + nFileSize;
 	return NPL_OK;
 }
 
+bool NPL::CNPLConnection::TryReserveQueuedBytes(int nLength, int nMaxQueuedBytes, int64& nQueuedBytes)
+{
+	// other producer threads and the io thread may change it concurrently, so the limit test and the add must be one atomic step. 
+	int64 nOldBytes = m_nQueuedBytes.load();
+	do
+	{
+		// a message is always admitted into an empty queue, so that a single message bigger than the limit can still be sent. 
+		if (nMaxQueuedBytes > 0 && nOldBytes > 0 && (nOldBytes + nLength) > nMaxQueuedBytes)
+			return false;
+	} while (!m_nQueuedBytes.compare_exchange_weak(nOldBytes, nOldBytes + nLength));
+	nQueuedBytes = nOldBytes + nLength;
+	return true;
+}
+
+bool NPL::CNPLConnection::MakeRoomForMessage(NPLMsgOut_ptr& msg, int nMaxQueuedBytes)
+{
+	int nPolicy = m_msg_dispatcher.GetSlowConsumerPolicy();
+	int64 nLength = (int64)msg->GetBuffer().size();
+	if (nPolicy == SlowConsumer_DropOldest || nPolicy == SlowConsumer_Coalesce)
+	{
+		if (nPolicy == SlowConsumer_Coalesce && msg->m_sKey.empty())
+			return false;
+		// the front message is being sent, so only messages after it can be removed. 
+		int64 nFreedBytes = 0;
+		int nFreedCount = 0;
+		int64 nQueuedBytes = m_nQueuedBytes;
+		int nQueuedCount = (int)m_queueOutput.size();
+		int nCapacity = (int)m_queueOutput.capacity();
+		const std::string& sKey = msg->m_sKey;
+		int nCount = m_queueOutput.erase_if(1, [&](NPLMsgOut_ptr& item) {
+			if (nPolicy == SlowConsumer_DropOldest)
+			{
+				bool bFits = (nMaxQueuedBytes <= 0 || (nQueuedBytes - nFreedBytes) == 0 || (nQueuedBytes - nFreedBytes + nLength) <= nMaxQueuedBytes) && (nQueuedCount - nFreedCount) < nCapacity;
+				if (bFits)
+					return false;
+			}
+			else if (item->m_sKey != sKey)
+			{
+				return false;
+			}
+			nFreedBytes += (int64)item->GetBuffer().size();
+			++nFreedCount;
+			return true;
+		});
+		if (nCount > 0)
+		{
+			m_nQueuedBytes -= nFreedBytes;
+			m_nSendCount -= nCount;
+			m_nDroppedCount += nCount;
+			m_nDroppedBytes += nFreedBytes;
+		}
+		return !m_queueOutput.full();
+	}
+	else if (nPolicy == SlowConsumer_Disconnect)
+	{
+		if (GetLogLevel() > 0) {
+			OUTPUT_LOG("NPL connection %s is closed because it is a slow consumer with %d queued bytes\n", GetNID().c_str(), (int)m_nQueuedBytes);
+		}
+		m_connection_manager.stop(shared_from_this(), 0);
+	}
+	return false;
+}
+
+NPL::NPLReturnCode NPL::CNPLConnection::SendFile(const char* sHeader, int nHeaderSize, const char* filename, int64 nOffset /*= 0*/, int64 nSize /*= -1*/)
+{
+	if (filename == 0)
+		return NPL_FailedToLoadFile;
+	if (nOffset < 0)
+		nOffset = 0;
+
+	NPLMsgOut_ptr msg_out(new NPLMsgOut());
+	if (sHeader)
+		msg_out->GetBuffer().append(sHeader, (nHeaderSize >= 0) ? nHeaderSize : strlen(sHeader));
+
+	std::string sDiskFilePath;
+	int32 dwFoundPlace = ParaEngine::CParaFile::DoesFileExist2(filename, ParaEngine::FILE_ON_DISK | ParaEngine::FILE_ON_ZIP_ARCHIVE, &sDiskFilePath);
+	if (dwFoundPlace == ParaEngine::FILE_ON_DISK)
+	{
+		// disk files are streamed by the io thread, see handle_write_file
+		FILE* pFile = fopen(sDiskFilePath.empty() ? filename : sDiskFilePath.c_str(), "rb");
+		if (pFile == 0)
+			return NPL_FailedToLoadFile;
+		// 64 bits file offsets, so that files larger than 2GB can be sent. 
+		int64 nFileSize = (ParaEngine::LargeFile::Seek(pFile, 0, SEEK_END) == 0) ? ParaEngine::LargeFile::Tell(pFile) : -1;
+		if (nFileSize < 0)
+		{
+			fclose(pFile);
+			return NPL_FailedToLoadFile;
+		}
+		msg_out->m_pFile = pFile;
+		msg_out->m_nFileOffset = (std::min)(nOffset, nFileSize);
+		msg_out->m_nFileSize = nFileSize - msg_out->m_nFileOffset;
+		if (nSize >= 0 && nSize < msg_out->m_nFileSize)
+			msg_out->m_nFileSize = nSize;
+	}
+	else if (dwFoundPlace != 0)
+	{
+		// files in zip archives are decompressed to memory anyway
+		ParaEngine::CParaFile file;
+		if (!file.OpenFile(filename, true, NULL, false, ParaEngine::FILE_ON_ZIP_ARCHIVE))
+			return NPL_FailedToLoadFile;
+		int64 nFileSize = (int64)file.getSize();
+		nOffset = (std::min)(nOffset, nFileSize);
+		if (nSize < 0 || nSize > nFileSize - nOffset)
+			nSize = nFileSize - nOffset;
+		if (nSize > 0)
+			msg_out->GetBuffer().append(file.getBuffer() + nOffset, (size_t)nSize);
+	}
+	else
+	{
+		return NPL_FailedToLoadFile;
+	}
+	return SendMessage(msg_out);
+}
+
+void NPL::CNPLConnection::start_write(NPLMsgOut* pMsg)
+{
+	m_nWritingBytes = (int)pMsg->GetBuffer().size();
+	if (pMsg->HasFile())
+	{
+		boost::asio::async_write(m_socket,
+			boost::asio::buffer(pMsg->GetBuffer().c_str(), pMsg->GetBuffer().size()),
+			boost::bind(&CNPLConnection::handle_write_file, shared_from_this(),
+				boost::asio::placeholders::error, pMsg));
+	}
+	else
+	{
+		boost::asio::async_write(m_socket,
+			boost::asio::buffer(pMsg->GetBuffer().c_str(), pMsg->GetBuffer().size()),
+			boost::bind(&CNPLConnection::handle_write, shared_from_this(),
+				boost::asio::placeholders::error));
+	}
+}
+
+void NPL::CNPLConnection::handle_write_file(const boost::system::error_code& e, NPLMsgOut* pMsg)
+{
+	// pMsg is kept alive by the output queue until handle_write moves to the next message. 
+	if (e || pMsg->m_nFileSize <= 0)
+	{
+		handle_write(e);
+		return;
+	}
+#if (PARA_TARGET_PLATFORM == PARA_PLATFORM_LINUX)
+	// copy from page cache to the socket in kernel. when the socket buffer is full, wait until it is writable again. 
+	if (!m_socket.native_non_blocking())
+	{
+		boost::system::error_code ec;
+		m_socket.native_non_blocking(true, ec);
+	}
+	int nFileHandle = fileno(pMsg->m_pFile);
+	while (pMsg->m_nFileSize > 0)
+	{
+		off_t nOffset = (off_t)pMsg->m_nFileOffset;
+		ssize_t nSent = ::sendfile(m_socket.native_handle(), nFileHandle, &nOffset, (size_t)(std::min)(pMsg->m_nFileSize, (int64)0x40000000));
+		if (nSent > 0)
+		{
+			pMsg->m_nFileOffset += nSent;
+			pMsg->m_nFileSize -= nSent;
+		}
+		else if (nSent < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		else if (nSent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		{
+			m_socket.async_write_some(boost::asio::null_buffers(),
+				boost::bind(&CNPLConnection::handle_write_file, shared_from_this(),
+					boost::asio::placeholders::error, pMsg));
+			return;
+		}
+		else
+		{
+			// the file is truncated or the socket is broken. the response can not be completed, so close the connection. 
+			handle_write((nSent == 0) ? boost::system::error_code(boost::asio::error::eof) : boost::system::error_code(errno, boost::system::system_category()));
+			return;
+		}
+	}
+	handle_write(e);
+#else
+	// read the file range in chunks to a reused buffer
+	if (m_file_chunk.empty())
+		m_file_chunk.resize(NPL_FILE_CHUNK_SIZE);
+	size_t nSize = (size_t)(std::min)(pMsg->m_nFileSize, (int64)m_file_chunk.size());
+	size_t nRead = 0;
+	if (ParaEngine::LargeFile::Seek(pMsg->m_pFile, pMsg->m_nFileOffset, SEEK_SET) == 0)
+		nRead = fread(&(m_file_chunk[0]), 1, nSize, pMsg->m_pFile);
+	if (nRead == 0)
+	{
+		handle_write(boost::system::error_code(boost::asio::error::eof));
+		return;
+	}
+	pMsg->m_nFileOffset += nRead;
+	pMsg->m_nFileSize -= nRead;
+	boost::asio::async_write(m_socket,
+		boost::asio::buffer(&(m_file_chunk[0]), nRead),
+		boost::bind(&CNPLConnection::handle_write_file, shared_from_this(),
+			boost::asio::placeholders::error, pMsg));
+#endif
+}
+
 void NPL::CNPLConnection::handleConnect()
 {
 	m_msg_dispatcher.PostNetworkEvent(NPL_ConnectionEstablished, GetNID().c_str());
@@ -13,6 +13,7 @@
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/enable_shared_from_this.hpp>
+#include <atomic>
 
 namespace NPL
 {
@@ -38,6 +39,18 @@ namespace NPL
 			WEBSOCKET = 1,
 			TCP_CUSTOM = 2, // any custom protocol, like google protocol buffer
 		};
+		/** what to do when a new message does not fit in the output queue, because the remote side reads too slowly. */
+		enum SlowConsumerPolicy
+		{
+			/** the new message is dropped and SendMessage returns NPL_QueueIsFull. */
+			SlowConsumer_DropNewest = 0,
+			/** oldest queued messages are dropped to make room for the new one. */
+			SlowConsumer_DropOldest = 1,
+			/** queued NPL messages to the same remote file are replaced by the new one. */
+			SlowConsumer_Coalesce = 2,
+			/** the connection is closed. */
+			SlowConsumer_Disconnect = 3,
+		};
 		friend class CNPLDispatcher;
 		typedef concurrent_ptr_queue<NPLMsgOut_ptr, dummy_condition_variable> RingBuffer_Type;
 		typedef std::map<std::string, int>	StringMap_Type;
@@ -101,6 +114,19 @@ namespace NPL
 		*/
 		NPLReturnCode SendMessage(NPLMsgOut_ptr& msg);
 
+		/**
+		* send a raw header followed by a range of a file, such as a static file http response. 
+		* Disk files are streamed by the io thread with sendfile on linux, or in small chunks on other platforms, 
+		* so the file is never loaded to memory, and the caller returns immediately. Files in zip archives are read to memory. 
+		* It keeps the order of other messages in the output queue. 
+		* @param sHeader: raw header, such as "HTTP/1.1 200 OK\r\nContent-Length: 100\r\n\r\n". it can be NULL.
+		* @param nHeaderSize: if -1, strlen(sHeader) is used. 
+		* @param nOffset: file offset of the first byte to send
+		* @param nSize: number of bytes to send. if -1, it is until the end of file. 
+		* @return NPL_FailedToLoadFile if file is not found, and nothing is sent. 
+		*/
+		NPLReturnCode SendFile(const char* sHeader, int nHeaderSize, const char* filename, int64 nOffset = 0, int64 nSize = -1);
+
 		/** set the NPL runtime address that this connection connects to. */
 		void SetNPLRuntimeAddress(NPLRuntimeAddress_ptr runtime_address);
 	
@@ -109,6 +135,18 @@ namespace NPL
 		* Function is not thread-safe, it is for debugging anyway. 
 		*/
 		virtual void GetStatistics( int &totalIn, int &totalOut );
+		/** same as GetStatistics, but without truncating to 32 bits. */
+		void GetStatistics64(int64 &totalIn, int64 &totalOut);
+
+		/** number of bytes in the output queue that are not sent yet. file ranges of SendFile are not counted, since they are not in memory. 
+		* [thread safe] */
+		int64 GetQueuedBytes() const { return m_nQueuedBytes; }
+		/** number of messages in the output queue. [thread safe] */
+		int GetQueuedCount() const { return (int)m_queueOutput.size(); }
+		/** number of messages dropped because the output queue is full. [thread safe] */
+		int GetDroppedCount() const { return m_nDroppedCount; }
+		/** number of bytes dropped because the output queue is full. [thread safe] */
+		int64 GetDroppedBytes() const { return m_nDroppedBytes; }
 	
 		/**
 		* Returns the current connection state.
@@ -277,6 +315,21 @@ namespace NPL
 		/// Handle completion of a write operation.
 		void handle_write(const boost::system::error_code& e);
 
+		/** start writing a message at the front of the output queue. handle_write is called when the whole message is written. */
+		void start_write(NPLMsgOut* pMsg);
+
+		/// Handle completion of writing the header of a message with a file range, and send the file range.
+		void handle_write_file(const boost::system::error_code& e, NPLMsgOut* pMsg);
+
+		/** atomically add nLength to m_nQueuedBytes if it fits in nMaxQueuedBytes or the queue is empty. 
+		* @param nQueuedBytes: [out] queued bytes after the reservation. 
+		* @return false if the message does not fit. */
+		bool TryReserveQueuedBytes(int nLength, int nMaxQueuedBytes, int64& nQueuedBytes);
+
+		/** apply the slow consumer policy when msg does not fit in the output queue. 
+		* @return true if the policy has freed what it can and the caller should try to reserve the message again. */
+		bool MakeRoomForMessage(NPLMsgOut_ptr& msg, int nMaxQueuedBytes);
+
 		/// handle disconnection of this object
 		void handle_stop();
 
@@ -317,6 +370,19 @@ namespace NPL
 		/** the output message queue. a queue that is filled by SendMessage() function */
 		RingBuffer_Type m_queueOutput;
 
+		/** buffer for sending file ranges in chunks, only used when sendfile is not available. */
+		std::vector<char> m_file_chunk;
+
+		/** number of bytes in the output queue, including the message being sent. */
+		std::atomic<int64> m_nQueuedBytes;
+		/** bytes of the message being sent, which is removed from m_nQueuedBytes when it is sent. only used by the io thread. */
+		int m_nWritingBytes;
+		/** number of dropped messages and bytes, because of slow consumer */
+		std::atomic<int> m_nDroppedCount;
+		std::atomic<int64> m_nDroppedBytes;
+		/** whether the high watermark event is posted and the low watermark event is not. */
+		std::atomic<bool> m_bAboveHighWatermark;
+
 		/** the NPL connection state*/
 		NPLConnectionState m_state;
 
@@ -327,9 +393,9 @@ namespace NPL
 		StringMap_Type m_filename_id_map;
 
 		/// for statistics, number of bytes received
-		uint32 m_totalBytesIn;
-		/// for statistics, number of bytes sent
-		uint32 m_totalBytesOut;
+		int64 m_totalBytesIn;
+		/// for statistics, number of bytes sent, including file ranges of SendFile which may be larger than 4GB. 
+		int64 m_totalBytesOut;
 		
 		/** default to false, if true, it will dump all send and received data to output. */
 		bool m_bDebugConnection;
@@ -0,0 +1,82 @@
+//-----------------------------------------------------------------------------
+// Class:	CNPLConnectionMap
+// Authors:	LiXizhi
+// Emails:	LiXizhi@yeah.net
+// Company: ParaEngine
+// Date:	2026.10.18
+// Desc: sharded hash table from NID to NPL connection
+//-----------------------------------------------------------------------------
+#include "ParaEngine.h"
+#include "NPLConnectionMap.h"
+
+using namespace NPL;
+
+CNPLConnectionMap::CNPLConnectionMap()
+{
+}
+
+CNPLConnectionMap::~CNPLConnectionMap()
+{
+}
+
+CNPLConnectionMap::Shard& CNPLConnectionMap::GetShard(const std::string& sNID)
+{
+	// mix the high bits in, since std::hash may be identity like for short strings on some platforms.
+	size_t nHash = std::hash<std::string>()(sNID);
+	nHash ^= (nHash >> 16);
+	return m_shards[nHash & (NPL_CONNECTION_MAP_SHARD_COUNT - 1)];
+}
+
+NPLConnection_ptr CNPLConnectionMap::Find(const std::string& sNID)
+{
+	Shard& shard = GetShard(sNID);
+	ParaEngine::Lock lock_(shard.m_mutex);
+	auto iter = shard.m_connections.find(sNID);
+	if (iter != shard.m_connections.end())
+		return iter->second;
+	return NPLConnection_ptr();
+}
+
+NPLConnection_ptr CNPLConnectionMap::Set(const std::string& sNID, NPLConnection_ptr pConnection)
+{
+	Shard& shard = GetShard(sNID);
+	ParaEngine::Lock lock_(shard.m_mutex);
+	NPLConnection_ptr& pValue = shard.m_connections[sNID];
+	NPLConnection_ptr pPrevConnection = pValue;
+	pValue = pConnection;
+	return pPrevConnection;
+}
+
+NPLConnection_ptr CNPLConnectionMap::Remove(const std::string& sNID, const CNPLConnection* pConnection)
+{
+	Shard& shard = GetShard(sNID);
+	ParaEngine::Lock lock_(shard.m_mutex);
+	auto iter = shard.m_connections.find(sNID);
+	if (iter != shard.m_connections.end() && (pConnection == NULL || iter->second.get() == pConnection))
+	{
+		NPLConnection_ptr pRemoved = iter->second;
+		shard.m_connections.erase(iter);
+		return pRemoved;
+	}
+	return NPLConnection_ptr();
+}
+
+void CNPLConnectionMap::Clear()
+{
+	for (int i = 0; i < NPL_CONNECTION_MAP_SHARD_COUNT; ++i)
+	{
+		ParaEngine::Lock lock_(m_shards[i].m_mutex);
+		m_shards[i].m_connections.clear();
+	}
+}
+
+int CNPLConnectionMap::GetCount()
+{
+	int nCount = 0;
+	for (int i = 0; i < NPL_CONNECTION_MAP_SHARD_COUNT; ++i)
+	{
+		ParaEngine::Lock lock_(m_shards[i].m_mutex);
+		nCount += (int)m_shards[i].m_connections.size();
+	}
+	return nCount;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "util/mutex.h"
+#include <unordered_map>
+#include <string>
+
+/** @def number of shards in a connection map. must be power of 2 */
+#define NPL_CONNECTION_MAP_SHARD_COUNT	16
+
+namespace NPL
+{
+	/**
+	* A thread safe hash table from NID to NPL connection, which is split into shards that are locked separately.
+	* The hash of a NID selects its shard, so that a lookup does a single string compare on average,
+	* and threads resolving different NIDs rarely contend for the same lock.
+	*
+	* Each function is atomic on its own. Callers that need several calls to be atomic, such as renaming, should hold their own lock.
+	*/
+	class CNPLConnectionMap
+	{
+	public:
+		CNPLConnectionMap();
+		~CNPLConnectionMap();
+
+		/** return the connection of the given NID. it may be null. */
+		NPLConnection_ptr Find(const std::string& sNID);
+
+		/** add or replace the connection of the given NID.
+		* @return the previous connection if any.
+		*/
+		NPLConnection_ptr Set(const std::string& sNID, NPLConnection_ptr pConnection);
+
+		/** remove the given NID.
+		* @param pConnection: if not NULL, it is only removed if the current connection of sNID is pConnection.
+		* @return the removed connection if any.
+		*/
+		NPLConnection_ptr Remove(const std::string& sNID, const CNPLConnection* pConnection = NULL);
+
+		/** remove all connections */
+		void Clear();
+
+		/** total number of connections in all shards */
+		int GetCount();
+
+	private:
+		struct Shard
+		{
+			ParaEngine::mutex m_mutex;
+			std::unordered_map<std::string, NPLConnection_ptr> m_connections;
+		};
+		Shard& GetShard(const std::string& sNID);
+
+		Shard m_shards[NPL_CONNECTION_MAP_SHARD_COUNT];
+	};
+}
@@ -14,9 +14,12 @@
 #include "NPLHelper.h"
 #include "EventsCenter.h"
 
+/** default max number of bytes queued for sending per connection */
+#define DEFAULT_NPL_MAX_QUEUED_BYTES		(64*1024*1024)
+
 NPL::CNPLDispatcher::CNPLDispatcher(CNPLNetServer* pServer)
 : m_pServer(pServer), m_bUseCompressionIncomingConnection(false), m_bUseCompressionOutgoingConnection(false),
-m_nCompressionLevel(-1), m_nCompressionThreshold(204800)
+m_nCompressionLevel(-1), m_nCompressionThreshold(204800), m_nMaxQueuedBytes(DEFAULT_NPL_MAX_QUEUED_BYTES), m_nSlowConsumerPolicy(CNPLConnection::SlowConsumer_DropNewest)
 {
 	PE_ASSERT(m_pServer!=0);
 }
@@ -66,25 +69,40 @@ int NPL::CNPLDispatcher::GetCompressionThreshold()
 	return m_nCompressionThreshold;
 }
 
-NPL::NPLConnection_ptr NPL::CNPLDispatcher::CreateGetNPLConnectionByNID( const string& sNID )
+void NPL::CNPLDispatcher::SetMaxQueuedBytes(int nMaxBytes)
 {
-	ParaEngine::Lock lock_(m_mutex);
+	m_nMaxQueuedBytes = (nMaxBytes > 0) ? nMaxBytes : 0;
+}
+
+int NPL::CNPLDispatcher::GetMaxQueuedBytes()
+{
+	return m_nMaxQueuedBytes;
+}
+
+void NPL::CNPLDispatcher::SetSlowConsumerPolicy(int nPolicy)
+{
+	m_nSlowConsumerPolicy = nPolicy;
+}
+
+int NPL::CNPLDispatcher::GetSlowConsumerPolicy()
+{
+	return m_nSlowConsumerPolicy;
+}
 
+NPL::NPLConnection_ptr NPL::CNPLDispatcher::CreateGetNPLConnectionByNID( const string& sNID )
+{
 	// find in connected pool 
-	ActiveConnectionMap_Type::iterator iter = m_active_connection_map.find(sNID);
-	if(iter!=m_active_connection_map.end())
-	{
-		return iter->second;
-	}
+	NPLConnection_ptr pConnection = m_active_connection_map.Find(sNID);
+	if (pConnection)
+		return pConnection;
 
 	// find in pending pool 
-	iter = m_pending_connection_map.find(sNID);
-	if(iter!=m_pending_connection_map.end())
-	{
-		return iter->second;
-	}
+	pConnection = m_pending_connection_map.Find(sNID);
+	if (pConnection)
+		return pConnection;
 
 	// see if we have address for sNID. If so, we will actively establish a new connection to it. 
+	ParaEngine::Lock lock_(m_mutex);
 	ServerAddressMap_Type::iterator iter1 = m_server_address_map.find(sNID);
 	if( iter1 != m_server_address_map.end())
 	{
@@ -103,32 +121,21 @@ NPL::NPLConnection_ptr NPL::CNPLDispatcher::CreateConnection(NPLRuntimeAddress_p
 		ParaEngine::Lock lock_(m_mutex);
 
 		// find in connected pool 
-		ActiveConnectionMap_Type::iterator iter = m_active_connection_map.find(pAddress->GetNID());
-		if(iter!=m_active_connection_map.end())
-		{
-			return iter->second;
-		}
+		NPLConnection_ptr pExisting = m_active_connection_map.Find(pAddress->GetNID());
+		if (pExisting)
+			return pExisting;
 		// find in pending pool 
-		iter = m_pending_connection_map.find(pAddress->GetNID());
-		if(iter!=m_pending_connection_map.end())
-		{
-			return iter->second;
-		}
-		m_pending_connection_map[pAddress->GetNID()] = pConnection;
+		pExisting = m_pending_connection_map.Find(pAddress->GetNID());
+		if (pExisting)
+			return pExisting;
+		m_pending_connection_map.Set(pAddress->GetNID(), pConnection);
 	}
 	return pConnection;
 }
 
 NPL::NPLConnection_ptr NPL::CNPLDispatcher::GetNPLConnectionByNID( const string& sNID )
 {
-	ParaEngine::Lock lock_(m_mutex);
-	ActiveConnectionMap_Type::iterator iter = m_active_connection_map.find(sNID);
-	if(iter!=m_active_connection_map.end())
-	{
-		return iter->second;
-	}
-	else
-		return NPLConnection_ptr();
+	return m_active_connection_map.Find(sNID);
 }
 
 void NPL::CNPLDispatcher::AddNPLConnection(const string& sNID, NPL::NPLConnection_ptr pConnection)
@@ -138,23 +145,15 @@ void NPL::CNPLDispatcher::AddNPLConnection(const string& sNID, NPL::NPLConnectio
 	if(pConnection->IsConnected())
 	{
 		// add to active connection map
-		ActiveConnectionMap_Type::iterator iter = m_active_connection_map.find(sNID);
-		if(iter!=m_active_connection_map.end())
+		NPLConnection_ptr pPrevConnection = m_active_connection_map.Set(sNID, pConnection);
+		if (pPrevConnection && pPrevConnection != pConnection)
 		{
-			if(iter->second != pConnection)
-			{
-				// this should rarely happen. 
-				iter->second->stop();
-			}
+			// this should rarely happen. 
+			pPrevConnection->stop();
 		}
-		m_active_connection_map[sNID] = pConnection;
 
 		// erase from pending connection map
-		iter = m_pending_connection_map.find(sNID);
-		if(iter!=m_pending_connection_map.end())
-		{
-			m_pending_connection_map.erase(iter);
-		}
+		m_pending_connection_map.Remove(sNID);
 	}
 }
 
@@ -167,19 +166,10 @@ bool NPL::CNPLDispatcher::RemoveNPLConnection( NPLConnection_ptr pConnection )
 	if(!nid.empty())
 	{
 		// remove both 
-		ActiveConnectionMap_Type::iterator iter = m_active_connection_map.find(nid);
-		if(iter!=m_active_connection_map.end() && (iter->second == pConnection))
-		{
-			m_active_connection_map.erase(iter);
+		if (m_active_connection_map.Remove(nid, pConnection.get()))
 			bFound = true;
-		}
-
-		iter = m_pending_connection_map.find(nid);
-		if(iter!=m_pending_connection_map.end() && (iter->second == pConnection))
-		{
-			m_pending_connection_map.erase(iter);
+		if (m_pending_connection_map.Remove(nid, pConnection.get()))
 			bFound = true;
-		}
 	}
 	return bFound;
 }
@@ -188,7 +178,7 @@ void NPL::CNPLDispatcher::Cleanup()
 {
 	ParaEngine::Lock lock_(m_mutex);
 
-	m_active_connection_map.clear();
+	m_active_connection_map.Clear();
 	m_server_address_map.clear();
 }
 
@@ -417,68 +407,20 @@ NPL::NPLReturnCode NPL::CNPLDispatcher::DispatchMsg( NPLMsgIn& msg )
 			int nHTTPCode = -10;
 			if(CheckPubFile(filename, nHTTPCode))
 			{
-				// we need to check the input
+				// the request is delivered as a structured message, so that the body is neither escaped nor compiled. 
+				// headers and body are swapped out of the connection's input message, which is reset after dispatching. 
 				NPLMessage_ptr msg_(new NPLMessage());
 				msg_->m_filename = filename;
-
-				int nSize = (int)(msg.m_code.size());
-				msg_->m_code.reserve(nSize+36);
-				msg_->m_code.append("msg={");
-
-				// add url or the "OK", "Error" string in response's first line
-				msg_->m_code.append("url=");
-				NPLHelper::EncodeStringInQuotation(msg_->m_code, msg_->m_code.size(), msg.m_filename);
-				msg_->m_code.append(",");
-				
-				// add method: GET, POST,  HTTP/1.1, etc. 
-				msg_->m_code.append("method=");
-				NPLHelper::EncodeStringInQuotation(msg_->m_code, msg_->m_code.size(), msg.method);
-				msg_->m_code.append(",");
-
-				// rcode
-				msg_->m_code.append("rcode=");
-				msg_->m_code.append(msg.m_n_filename);
-				msg_->m_code.append(",");
-
-				// add headers
-				int nCount = (int)msg.headers.size();
-				for (int i=0;i <nCount; ++i)
-				{
-					msg_->m_code.append("[");
-					NPLHelper::EncodeStringInQuotation(msg_->m_code, msg_->m_code.size(), msg.headers[i].name);
-					msg_->m_code.append("]=");
-					NPLHelper::EncodeStringInQuotation(msg_->m_code, msg_->m_code.size(), msg.headers[i].value);
-					msg_->m_code.append(",");
-				}
-
-				// add body
-				if (NPLHelper::CanEncodeStringInDoubleBrackets(msg.m_code.c_str(), (int)msg.m_code.size()))
-				{
-					msg_->m_code.append("body=[[");
-					msg_->m_code.append(msg.m_code);
-					msg_->m_code.append("]],");
-				}
-				else
-				{
-					msg_->m_code.append("body=");
-					NPLHelper::EncodeStringInQuotation(msg_->m_code, msg_->m_code.size(), msg.m_code);
-					msg_->m_code.append(",");
-				}
-
+				NPLHttpMessage* pHttpMsg = new NPLHttpMessage();
+				msg_->m_pHttpMsg = pHttpMsg;
+				pHttpMsg->m_url = msg.m_filename;
+				pHttpMsg->m_method = msg.method;
+				pHttpMsg->m_rcode = msg.m_n_filename;
+				pHttpMsg->m_headers.swap(msg.headers);
+				pHttpMsg->m_body.swap(msg.m_code);
 				// add nid or tid so that the runtime state can have access to the current connection object. 
-				// we append last to msg, so that nid or tid in the input message is overridden by the real value. 
-				if(msg.m_pConnection->IsAuthenticated())
-				{
-					msg_->m_code.append("nid=");
-					NPLHelper::EncodeStringInQuotation(msg_->m_code, msg_->m_code.size(), msg.m_pConnection->GetNID());
-					msg_->m_code.append("}");
-				}
-				else
-				{
-					msg_->m_code.append("tid=");
-					NPLHelper::EncodeStringInQuotation(msg_->m_code, msg_->m_code.size(), msg.m_pConnection->GetNID());
-					msg_->m_code.append(",nid=nil}");
-				}
+				pHttpMsg->m_nid = msg.m_pConnection->GetNID();
+				pHttpMsg->m_bAuthenticated = msg.m_pConnection->IsAuthenticated();
 				return pRuntime->Activate_async(msg_);
 			}
 			else
@@ -508,12 +450,10 @@ void NPL::CNPLDispatcher::NPL_accept( const char* sTID, const char* sNID /*= NUL
 	{
 		ParaEngine::Lock lock_(m_mutex);
 		
-		ActiveConnectionMap_Type::iterator iter = m_active_connection_map.find(sTID);
-		if(iter!=m_active_connection_map.end())
+		NPLConnection_ptr pConnection = m_active_connection_map.Find(sTID);
+		if(pConnection)
 		{
-			NPLConnection_ptr pConnection = iter->second;
-			
-			if(pConnection && pConnection->IsConnected())
+			if(pConnection->IsConnected())
 			{
 				pConnection->SetAuthenticated(true);
 				RenameConnectionImp(pConnection, sNID);
@@ -546,59 +486,41 @@ void NPL::CNPLDispatcher::RenameConnectionImp( NPLConnection_ptr pConnection, co
 		if(sNID!=0 && pConnection->GetNID() != sNID)
 		{
 			// Now accept it. 
-
-			// remove sTID old connection
-			ActiveConnectionMap_Type::iterator iter = m_active_connection_map.find(pConnection->GetNID());
-			if(iter!=m_active_connection_map.end())
-			{
-				m_active_connection_map.erase(iter);
-			}
-			
-			iter = m_pending_connection_map.find(pConnection->GetNID());
-			if(iter!=m_pending_connection_map.end())
-			{
-				// PE_ASSERT(iter->second == pConnection);
-				m_pending_connection_map.erase(iter);
-			}
+			string sOldNID = pConnection->GetNID();
 
 			// remove old sNID connection
-			iter = m_active_connection_map.find(sNID);
-			if(iter!=m_active_connection_map.end())
+			NPLConnection_ptr pOldConnection = m_active_connection_map.Find(sNID);
+			if (pOldConnection && pOldConnection != pConnection)
 			{
-				if(iter->second != pConnection)
-				{
-					// this should rarely happen. 
+				// this should rarely happen. 
 #ifdef WIN32
-					// in win32 server mode, we will not close old connection, 
-					// since we may assign the same server, port name to the different nid such as in an All-In-One server. 
-					OUTPUT_LOG("warning: connection %s is ignored and overridden by a new one\n", sNID);
+				// in win32 server mode, we will not close old connection, 
+				// since we may assign the same server, port name to the different nid such as in an All-In-One server. 
+				OUTPUT_LOG("warning: connection %s is ignored and overridden by a new one\n", sNID);
 #else
-					iter->second->stop(true, 1);
-					OUTPUT_LOG("warning: connection %s is stopped and overridden by a new one\n", sNID);
+				pOldConnection->stop(true, 1);
+				OUTPUT_LOG("warning: connection %s is stopped and overridden by a new one\n", sNID);
 #endif
-					
-				}
 			}
 
 			// erase from pending connection map
-			iter = m_pending_connection_map.find(sNID);
-			if(iter!=m_pending_connection_map.end())
+			pOldConnection = m_pending_connection_map.Remove(sNID);
+			if (pOldConnection && pOldConnection != pConnection)
 			{
-				if(iter->second != pConnection)
-				{
-					// this should rarely happen. 
-					iter->second->stop(true, 1);
-					OUTPUT_LOG("warning: connection %s is stopped and overridden by a new one\n", sNID);
-				}
-				m_pending_connection_map.erase(iter);
+				// this should rarely happen. 
+				pOldConnection->stop(true, 1);
+				OUTPUT_LOG("warning: connection %s is stopped and overridden by a new one\n", sNID);
 			}
 
 			// add new active connection. 
 			// modify the address nid
 			pConnection->m_address->SetNID(sNID);
-			// finally update the naming map. 
-			m_active_connection_map[sNID] = pConnection;
+			// finally update the naming map. the new name is added before the old one is removed, so that lock free readers always find the connection. 
+			m_active_connection_map.Set(sNID, pConnection);
+
+			// remove sTID old connection
+			m_active_connection_map.Remove(sOldNID);
+			m_pending_connection_map.Remove(sOldNID);
 		}
 	}
 }
-
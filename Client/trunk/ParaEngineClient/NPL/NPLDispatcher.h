@@ -7,6 +7,7 @@
 #include "NPLCommon.h"
 #include "NPLMessageQueue.h"
 #include "NPLConnection.h"
+#include "NPLConnectionMap.h"
 #include "NPLRuntimeState.h"
 #include "util/mutex.h"
 
@@ -192,6 +193,18 @@ namespace NPL
 		void SetCompressionThreshold(int nThreshold);
 		int GetCompressionThreshold();
 
+		/** max number of bytes queued for sending per connection. 0 means no limit. default to 64MB. a message is always admitted into an empty queue even if it is bigger than the limit. 
+		* when a new message exceeds the limit, the slow consumer policy is applied. 
+		* NPL_QueueHighWatermark and NPL_QueueLowWatermark network events are posted when queued bytes of a connection goes above 3/4 
+		* and then below 1/4 of it. 
+		*/
+		void SetMaxQueuedBytes(int nMaxBytes);
+		int GetMaxQueuedBytes();
+
+		/** what to do when a connection's output queue is full. see CNPLConnection::SlowConsumerPolicy. default to drop the newest message. */
+		void SetSlowConsumerPolicy(int nPolicy);
+		int GetSlowConsumerPolicy();
+
 	protected:
 		/**
 		* Create a new connection with a remote server and immediately connect and start the connection. 
@@ -205,11 +218,13 @@ namespace NPL
 		void RenameConnectionImp(NPLConnection_ptr pConnection, const char* sNid);
 
 	protected:
-		typedef std::map<string, NPLConnection_ptr> ActiveConnectionMap_Type;
+		typedef CNPLConnectionMap ActiveConnectionMap_Type;
 		typedef std::map<string, NPLRuntimeAddress_ptr> ServerAddressMap_Type;
 		typedef boost::bimap<int, std::string>	StringBimap_Type;
 		
-		/** a mapping from the authenticated NPL runtime id (NID) to its associated NPL connection. */
+		/** a mapping from the authenticated NPL runtime id (NID) to its associated NPL connection. 
+		* connection maps are sharded with their own locks, so that resolving a NID does not take m_mutex. 
+		*/
 		ActiveConnectionMap_Type m_active_connection_map;
 
 		/** a mapping from the not connected or authenticated NPL runtime id (NID) to its associated NPL connection. */
@@ -222,6 +237,7 @@ namespace NPL
 		ServerAddressMap_Type m_server_address_map;
 
 		/** provide thread safe access to shared data members in this class. 
+		* Connection maps are only read without it. Writers of connection maps hold it, so that renaming, etc are atomic among writers.
 		* @note: a simple critical section mutex is better than boost::shared_mutex (read_write_lock),  since we only 
 		* lock a few cycles within spin count.
 		*/
@@ -239,6 +255,12 @@ namespace NPL
 		/** when msg is larger than this, we will compress it. */
 		int m_nCompressionThreshold;
 
+		/** max number of bytes queued for sending per connection. 0 means no limit. */
+		int m_nMaxQueuedBytes;
+
+		/** see CNPLConnection::SlowConsumerPolicy */
+		int m_nSlowConsumerPolicy;
+
 		/**
 		* only files in the public file map can be activated remotely. 
 		* bidirectional map between file id and filename. 
@@ -11,6 +11,7 @@
 #include "NPLParser.h"
 #include "NPLHelper.h"
 #include "NPLTable.h"
+#include "NPLByteBuffer.h"
 #include "util/StringHelper.h"
 #include "json/json.h"
 #ifdef PARAENGINE_CLIENT
@@ -99,18 +100,29 @@ const char* NPLHelper::LuaObjectToString(const luabind::object& input, int* pSiz
 			lua_pop(L, 1);
 		}
 	}
+	else if (nType == LUA_TUSERDATA && pSize != 0)
+	{
+		// byte buffers are passed without copying. 
+		lua_State* L = input.interpreter();
+		input.push(L);
+		output = CNPLByteBuffer::GetData(L, -1, pSize);
+		lua_pop(L, 1);
+	}
 	return output;
 }
 
 bool NPLHelper::LuaObjectToString(const luabind::object& input, string& output)
 {
 	int nType = type(input);
-	if (nType == LUA_TSTRING)
+	if (nType == LUA_TSTRING || nType == LUA_TUSERDATA)
 	{
 		int nSize = 0;
 		const char* pStr = LuaObjectToString(input, &nSize);
-		output.assign(pStr, nSize);
-		return true;
+		if (pStr)
+		{
+			output.assign(pStr, nSize);
+			return true;
+		}
 	}
 	return false;
 }
@@ -586,6 +598,14 @@ bool NPLHelper::SerializeToSCode(const char* sStorageVar, const luabind::object&
 	}
 	case LUA_TUSERDATA:
 	{
+		// byte buffers are sent as strings
+		int nSize = 0;
+		const char* pStr = LuaObjectToString(input, &nSize);
+		if (pStr)
+		{
+			EncodeStringInQuotation(sCode, (int)(sCode.size()), pStr, nSize);
+			break;
+		}
 		sCode.append("\"");
 		try
 		{
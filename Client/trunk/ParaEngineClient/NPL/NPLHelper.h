@@ -73,11 +73,12 @@ namespace NPL
 
 		static bool containsControlCharacter(const char* str);
 
-		/** safe convert the lua object to string. if the input is nil, NULL is returned. please note that the returned const char* has the same lifetime as the input object */
+		/** safe convert the lua object to string. if the input is nil, NULL is returned. please note that the returned const char* has the same lifetime as the input object 
+		* if pSize is not NULL, a ByteBuffer userdata is also accepted and its data is returned without copying. */
 		static const char* LuaObjectToString(const luabind::object& input, int* pSize = NULL);
 
 		/** safe convert the lua object to string. if the input is nil, output is not assigned. 
-		* return true if input is a string object and value is written to output. */
+		* return true if input is a string or ByteBuffer object and value is written to output. */
 		static bool LuaObjectToString(const luabind::object& input, string& output);
 
 		/** safe convert the lua object to int */
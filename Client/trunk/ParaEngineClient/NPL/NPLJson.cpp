@@ -0,0 +1,710 @@
+//-----------------------------------------------------------------------------
+// Class:	NPLJson
+// Authors:	LiXizhi
+// Emails:	LiXizhi@yeah.net
+// Company: ParaEngine
+// Date:	2026.10.18
+// Desc: single pass json to lua table reader and lua table to json writer.
+//-----------------------------------------------------------------------------
+#include "ParaEngine.h"
+#include "util/StringBuilder.h"
+#include "util/StringHelper.h"
+#include "NPLJson.h"
+
+extern "C"
+{
+#include "lua.h"
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NPL_JSON_USE_SSE2
+#endif
+
+#include <stdlib.h>
+#include <vector>
+
+using namespace NPL;
+
+namespace NPL
+{
+#ifdef NPL_JSON_USE_SSE2
+	/** index of the lowest set bit. nMask must not be 0. */
+	inline int JsonLowestBit(unsigned int nMask)
+	{
+#ifdef _MSC_VER
+		unsigned long nIndex;
+		_BitScanForward(&nIndex, nMask);
+		return (int)nIndex;
+#else
+		return __builtin_ctz(nMask);
+#endif
+	}
+#endif
+
+	inline bool IsJsonWhiteSpace(char c)
+	{
+		return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+	}
+
+	/** return the first non white space char in [p, end) */
+	inline const char* JsonSkipWhiteSpace(const char* p, const char* end)
+	{
+		// most tokens are separated by zero or one white space, so check the first one before going wide.
+		if (p < end && !IsJsonWhiteSpace(*p))
+			return p;
+#ifdef NPL_JSON_USE_SSE2
+		const __m128i space = _mm_set1_epi8(' ');
+		const __m128i lf = _mm_set1_epi8('\n');
+		const __m128i cr = _mm_set1_epi8('\r');
+		const __m128i tab = _mm_set1_epi8('\t');
+		while (p + 16 <= end)
+		{
+			__m128i s = _mm_loadu_si128((const __m128i*)p);
+			__m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(s, space), _mm_cmpeq_epi8(s, lf)),
+				_mm_or_si128(_mm_cmpeq_epi8(s, cr), _mm_cmpeq_epi8(s, tab)));
+			unsigned int nMask = ~((unsigned int)_mm_movemask_epi8(ws)) & 0xffff;
+			if (nMask != 0)
+				return p + JsonLowestBit(nMask);
+			p += 16;
+		}
+#endif
+		while (p < end && IsJsonWhiteSpace(*p))
+			++p;
+		return p;
+	}
+
+	/** return the first '"' or '\\' in [p, end), or end if not found. */
+	inline const char* JsonScanStringSpecial(const char* p, const char* end)
+	{
+#ifdef NPL_JSON_USE_SSE2
+		const __m128i quote = _mm_set1_epi8('"');
+		const __m128i slash = _mm_set1_epi8('\\');
+		while (p + 16 <= end)
+		{
+			__m128i s = _mm_loadu_si128((const __m128i*)p);
+			unsigned int nMask = (unsigned int)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(s, quote), _mm_cmpeq_epi8(s, slash)));
+			if (nMask != 0)
+				return p + JsonLowestBit(nMask);
+			p += 16;
+		}
+#endif
+		while (p < end && *p != '"' && *p != '\\')
+			++p;
+		return p;
+	}
+
+	/** return the first char in [p, end) that must be escaped in json, i.e. '"', '\\' or [0, 0x1f]. */
+	inline const char* JsonScanEscapeChar(const char* p, const char* end)
+	{
+#ifdef NPL_JSON_USE_SSE2
+		const __m128i quote = _mm_set1_epi8('"');
+		const __m128i slash = _mm_set1_epi8('\\');
+		const __m128i ctrl = _mm_set1_epi8(0x1f);
+		while (p + 16 <= end)
+		{
+			__m128i s = _mm_loadu_si128((const __m128i*)p);
+			// unsigned s <= 0x1f is the same as max(s, 0x1f) == 0x1f
+			__m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(s, quote), _mm_cmpeq_epi8(s, slash)),
+				_mm_cmpeq_epi8(_mm_max_epu8(s, ctrl), ctrl));
+			unsigned int nMask = (unsigned int)_mm_movemask_epi8(special);
+			if (nMask != 0)
+				return p + JsonLowestBit(nMask);
+			p += 16;
+		}
+#endif
+		while (p < end && *p != '"' && *p != '\\' && (unsigned char)(*p) > 0x1f)
+			++p;
+		return p;
+	}
+
+	/** the json reader that pushes values to lua stack. */
+	class NPLJsonReader
+	{
+	public:
+		NPLJsonReader(lua_State* L, const char* sJson, int nSize)
+			:m_L(L), m_begin(sJson), m_cur(sJson), m_end(sJson + nSize), m_nDepth(0), m_error(NULL) {};
+
+		/** parse the root array or object and push it as a new table to the stack. */
+		bool ParseRoot()
+		{
+			m_cur = JsonSkipWhiteSpace(m_cur, m_end);
+			if (m_cur < m_end && (*m_cur == '{' || *m_cur == '['))
+				return ParseValue();
+			return Error("root must be array or object");
+		}
+
+		const char* GetError() { return m_error; }
+		int GetErrorOffset() { return (int)(m_cur - m_begin); }
+
+	private:
+		bool Error(const char* sMsg)
+		{
+			m_error = sMsg;
+			return false;
+		}
+
+		/** parse any value and push it to stack. json null is pushed as lua nil. */
+		bool ParseValue()
+		{
+			m_cur = JsonSkipWhiteSpace(m_cur, m_end);
+			if (m_cur >= m_end)
+				return Error("unexpected end of input");
+			switch (*m_cur)
+			{
+			case '{':
+				return ParseObject();
+			case '[':
+				return ParseArray();
+			case '"':
+				return ParseString();
+			case 't':
+				if (!MatchLiteral("true", 4))
+					return false;
+				lua_pushboolean(m_L, 1);
+				return true;
+			case 'f':
+				if (!MatchLiteral("false", 5))
+					return false;
+				lua_pushboolean(m_L, 0);
+				return true;
+			case 'n':
+				if (!MatchLiteral("null", 4))
+					return false;
+				lua_pushnil(m_L);
+				return true;
+			default:
+				return ParseNumber();
+			}
+		}
+
+		bool MatchLiteral(const char* sLiteral, int nLen)
+		{
+			if ((m_end - m_cur) < nLen || memcmp(m_cur, sLiteral, nLen) != 0)
+				return Error("invalid literal");
+			m_cur += nLen;
+			return true;
+		}
+
+		bool EnterContainer()
+		{
+			if (++m_nDepth > NPL_JSON_MAX_DEPTH)
+				return Error("too deeply nested");
+			// new table, key and value
+			if (!lua_checkstack(m_L, 4))
+				return Error("lua stack overflow");
+			return true;
+		}
+
+		bool ParseObject()
+		{
+			if (!EnterContainer())
+				return false;
+			++m_cur;
+			lua_newtable(m_L);
+			m_cur = JsonSkipWhiteSpace(m_cur, m_end);
+			if (m_cur < m_end && *m_cur == '}')
+			{
+				++m_cur;
+				--m_nDepth;
+				return true;
+			}
+			for (;;)
+			{
+				m_cur = JsonSkipWhiteSpace(m_cur, m_end);
+				if (m_cur >= m_end || *m_cur != '"')
+					return Error("missing member name");
+				if (!ParseString())
+					return false;
+				m_cur = JsonSkipWhiteSpace(m_cur, m_end);
+				if (m_cur >= m_end || *m_cur != ':')
+					return Error("missing ':' after member name");
+				++m_cur;
+				if (!ParseValue())
+					return false;
+				// assigning nil to a new table is a no-op, which is the same as skipping null values.
+				lua_rawset(m_L, -3);
+
+				m_cur = JsonSkipWhiteSpace(m_cur, m_end);
+				if (m_cur >= m_end)
+					return Error("unexpected end of input in object");
+				char c = *(m_cur++);
+				if (c == '}')
+					break;
+				else if (c != ',')
+					return Error("missing ',' or '}' in object");
+			}
+			--m_nDepth;
+			return true;
+		}
+
+		bool ParseArray()
+		{
+			if (!EnterContainer())
+				return false;
+			++m_cur;
+			lua_newtable(m_L);
+			m_cur = JsonSkipWhiteSpace(m_cur, m_end);
+			if (m_cur < m_end && *m_cur == ']')
+			{
+				++m_cur;
+				--m_nDepth;
+				return true;
+			}
+			// NPL use 1 based index
+			int nIndex = 1;
+			for (;;)
+			{
+				if (!ParseValue())
+					return false;
+				lua_rawseti(m_L, -2, nIndex++);
+
+				m_cur = JsonSkipWhiteSpace(m_cur, m_end);
+				if (m_cur >= m_end)
+					return Error("unexpected end of input in array");
+				char c = *(m_cur++);
+				if (c == ']')
+					break;
+				else if (c != ',')
+					return Error("missing ',' or ']' in array");
+			}
+			--m_nDepth;
+			return true;
+		}
+
+		/** the most common number is a small integer, so we compute it directly and only fall back to strtod for the rest. */
+		bool ParseNumber()
+		{
+			const char* pStart = m_cur;
+			const char* p = m_cur;
+			bool bNegative = false;
+			if (p < m_end && *p == '-')
+			{
+				bNegative = true;
+				++p;
+			}
+			int64 nValue = 0;
+			const char* pDigits = p;
+			// only the first 15 digits are accumulated, so that nValue never overflows. longer integers are parsed by strtod.
+			while (p < m_end && *p >= '0' && *p <= '9')
+			{
+				if (p - pDigits < 15)
+					nValue = nValue * 10 + (*p - '0');
+				++p;
+			}
+			int nDigits = (int)(p - pDigits);
+			if (nDigits == 0)
+				return Error("invalid value");
+			if (p >= m_end || (*p != '.' && *p != 'e' && *p != 'E'))
+			{
+				if (nDigits <= 15)
+				{
+					m_cur = p;
+					lua_pushnumber(m_L, (lua_Number)(bNegative ? -nValue : nValue));
+					return true;
+				}
+			}
+			// fraction, exponent or very long integer
+			while (p < m_end && ((*p >= '0' && *p <= '9') || *p == '.' || *p == 'e' || *p == 'E' || *p == '+' || *p == '-'))
+				++p;
+			int nLen = (int)(p - pStart);
+			char buf[64];
+			std::string sLongNumber;
+			const char* sNumber = buf;
+			if (nLen < (int)sizeof(buf))
+			{
+				memcpy(buf, pStart, nLen);
+				buf[nLen] = '\0';
+			}
+			else
+			{
+				sLongNumber.assign(pStart, nLen);
+				sNumber = sLongNumber.c_str();
+			}
+			char* pNumberEnd = NULL;
+			double dValue = strtod(sNumber, &pNumberEnd);
+			if (pNumberEnd != sNumber + nLen)
+				return Error("invalid number");
+			m_cur = p;
+			lua_pushnumber(m_L, (lua_Number)dValue);
+			return true;
+		}
+
+		static int HexValue(char c)
+		{
+			if (c >= '0' && c <= '9')
+				return c - '0';
+			else if (c >= 'a' && c <= 'f')
+				return c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F')
+				return c - 'A' + 10;
+			return -1;
+		}
+
+		bool ParseHex4(unsigned int& nCode)
+		{
+			if ((m_end - m_cur) < 4)
+				return Error("bad unicode escape");
+			nCode = 0;
+			for (int i = 0; i < 4; ++i)
+			{
+				int nHex = HexValue(m_cur[i]);
+				if (nHex < 0)
+					return Error("bad unicode escape");
+				nCode = (nCode << 4) + nHex;
+			}
+			m_cur += 4;
+			return true;
+		}
+
+		void AppendUTF8(unsigned int cp)
+		{
+			if (cp <= 0x7f)
+			{
+				m_buffer += (char)cp;
+			}
+			else if (cp <= 0x7FF)
+			{
+				m_buffer += (char)(0xC0 | (cp >> 6));
+				m_buffer += (char)(0x80 | (cp & 0x3F));
+			}
+			else if (cp <= 0xFFFF)
+			{
+				m_buffer += (char)(0xE0 | (cp >> 12));
+				m_buffer += (char)(0x80 | ((cp >> 6) & 0x3F));
+				m_buffer += (char)(0x80 | (cp & 0x3F));
+			}
+			else
+			{
+				m_buffer += (char)(0xF0 | (cp >> 18));
+				m_buffer += (char)(0x80 | ((cp >> 12) & 0x3F));
+				m_buffer += (char)(0x80 | ((cp >> 6) & 0x3F));
+				m_buffer += (char)(0x80 | (cp & 0x3F));
+			}
+		}
+
+		/** push string. m_cur is at the opening quotation mark. */
+		bool ParseString()
+		{
+			const char* pStart = ++m_cur;
+			const char* p = JsonScanStringSpecial(pStart, m_end);
+			if (p >= m_end)
+				return Error("missing '\"' at end of string");
+			if (*p == '"')
+			{
+				// fast path: no escape characters at all, push directly from the input.
+				lua_pushlstring(m_L, pStart, p - pStart);
+				m_cur = p + 1;
+				return true;
+			}
+			m_buffer.assign(pStart, p - pStart);
+			m_cur = p;
+			for (;;)
+			{
+				// m_cur is at '\\'
+				if (++m_cur >= m_end)
+					return Error("missing '\"' at end of string");
+				char c = *(m_cur++);
+				switch (c)
+				{
+				case '"': m_buffer += '"'; break;
+				case '\\': m_buffer += '\\'; break;
+				case '/': m_buffer += '/'; break;
+				case 'b': m_buffer += '\b'; break;
+				case 'f': m_buffer += '\f'; break;
+				case 'n': m_buffer += '\n'; break;
+				case 'r': m_buffer += '\r'; break;
+				case 't': m_buffer += '\t'; break;
+				case 'u':
+				{
+					unsigned int nCode;
+					if (!ParseHex4(nCode))
+						return false;
+					if (nCode >= 0xD800 && nCode <= 0xDBFF)
+					{
+						// surrogate pair
+						unsigned int nLow;
+						if ((m_end - m_cur) < 2 || m_cur[0] != '\\' || m_cur[1] != 'u')
+							return Error("missing low surrogate");
+						m_cur += 2;
+						if (!ParseHex4(nLow))
+							return false;
+						if (nLow < 0xDC00 || nLow > 0xDFFF)
+							return Error("bad low surrogate");
+						nCode = 0x10000 + ((nCode & 0x3FF) << 10) + (nLow & 0x3FF);
+					}
+					AppendUTF8(nCode);
+					break;
+				}
+				default:
+					return Error("bad escape sequence in string");
+				}
+				p = JsonScanStringSpecial(m_cur, m_end);
+				if (p >= m_end)
+					return Error("missing '\"' at end of string");
+				m_buffer.append(m_cur, p - m_cur);
+				m_cur = p;
+				if (*p == '"')
+					break;
+			}
+			++m_cur;
+			lua_pushlstring(m_L, m_buffer.c_str(), m_buffer.size());
+			return true;
+		}
+
+	private:
+		lua_State* m_L;
+		const char* m_begin;
+		const char* m_cur;
+		const char* m_end;
+		int m_nDepth;
+		const char* m_error;
+		/** only used for strings with escape characters. */
+		std::string m_buffer;
+	};
+
+	/** the json writer that reads lua values from the stack. */
+	template <typename StringType>
+	class NPLJsonWriter
+	{
+	public:
+		NPLJsonWriter(lua_State* L, StringType& sCode, bool bUseEmptyArray)
+			:m_L(L), m_sCode(sCode), m_bUseEmptyArray(bUseEmptyArray) {};
+
+		/** @param nIndex: must be an absolute stack index */
+		bool WriteValue(int nIndex)
+		{
+			switch (lua_type(m_L, nIndex))
+			{
+			case LUA_TNIL:
+				m_sCode.append("null");
+				break;
+			case LUA_TNUMBER:
+			{
+				char buff[40];
+				int nLen = ParaEngine::StringHelper::fast_dtoa((double)lua_tonumber(m_L, nIndex), buff, 40, 5); // similar to "%.5f" but without trailing zeros.
+				m_sCode.append(buff, nLen);
+				break;
+			}
+			case LUA_TBOOLEAN:
+				m_sCode.append(lua_toboolean(m_L, nIndex) ? "true" : "false");
+				break;
+			case LUA_TSTRING:
+			{
+				size_t nSize = 0;
+				const char* pStr = lua_tolstring(m_L, nIndex, &nSize);
+				NPLJson::EncodeString(m_sCode, pStr, (int)nSize);
+				break;
+			}
+			case LUA_TTABLE:
+				return WriteTable(nIndex);
+			default:
+				// we will escape any functions, etc.
+				return false;
+			}
+			return true;
+		}
+
+	private:
+		bool WriteTable(int nIndex)
+		{
+			// check for recursive tables
+			const void* pTable = lua_topointer(m_L, nIndex);
+			for (size_t i = 0; i < m_tables.size(); ++i)
+			{
+				if (m_tables[i] == pTable)
+					return false;
+			}
+			if ((int)m_tables.size() >= NPL_JSON_MAX_DEPTH || !lua_checkstack(m_L, 3))
+				return false;
+			m_tables.push_back(pTable);
+
+			int nTableStartIndex = (int)m_sCode.size();
+			m_sCode.append("{");
+			int64 nNumberIndex = 1;
+			// -1 unset, 0 object, 1 array
+			int nIsArrayTable = -1;
+			lua_pushnil(m_L);
+			while (lua_next(m_L, nIndex) != 0)
+			{
+				// key at -2, value at -1
+				int nValueIndex = lua_gettop(m_L);
+				int nKeyType = lua_type(m_L, -2);
+				if (nKeyType == LUA_TSTRING && nIsArrayTable != 1)
+				{
+					nIsArrayTable = 0;
+					int nOldSize = (int)m_sCode.size();
+					size_t nKeySize = 0;
+					const char* sKey = lua_tolstring(m_L, -2, &nKeySize);
+					NPLJson::EncodeString(m_sCode, sKey, (int)nKeySize);
+					m_sCode.append(":");
+					if (WriteValue(nValueIndex))
+						m_sCode.append(",");
+					else
+						m_sCode.resize(nOldSize);
+				}
+				else if (nKeyType == LUA_TNUMBER)
+				{
+					double dKey = (double)lua_tonumber(m_L, -2);
+					int64 nKey = (int64)(dKey);
+					int nOldSize = (int)m_sCode.size();
+
+					// for number index, we will serialize without square brackets.
+					if (nIsArrayTable != 0 && nNumberIndex == nKey && dKey == nKey)
+					{
+						nIsArrayTable = 1;
+						++nNumberIndex;
+					}
+					else if (nIsArrayTable != 1)
+					{
+						nIsArrayTable = 0;
+						char buff[40];
+						m_sCode.append("\"");
+						int nLen = 0;
+						if (dKey == nKey)
+							nLen = ParaEngine::StringHelper::fast_itoa(nKey, buff, 40);
+						else
+							nLen = ParaEngine::StringHelper::fast_dtoa(dKey, buff, 40, 5);
+						m_sCode.append(buff, nLen);
+						m_sCode.append("\":");
+					}
+					else
+					{
+						// mixing array with string key will be skipped
+						m_sCode.resize(nOldSize);
+						lua_pop(m_L, 2);
+						break;
+					}
+
+					if (WriteValue(nValueIndex))
+					{
+						m_sCode.append(",");
+					}
+					else
+					{
+						nNumberIndex = -1;
+						m_sCode.resize(nOldSize);
+					}
+				}
+				lua_pop(m_L, 1);
+			}
+			m_tables.pop_back();
+
+			if (nIsArrayTable == -1 || (int)m_sCode.size() == (nTableStartIndex + 1))
+			{
+				// for empty table, or tables whose values are all skipped
+				if (m_bUseEmptyArray || nIsArrayTable == 1)
+				{
+					m_sCode[nTableStartIndex] = '[';
+					m_sCode.append("]");
+				}
+				else
+					m_sCode.append("}");
+			}
+			else
+			{
+				// replace the last ','
+				m_sCode[m_sCode.size() - 1] = (nIsArrayTable == 1) ? ']' : '}';
+				if (nIsArrayTable == 1)
+					m_sCode[nTableStartIndex] = '[';
+			}
+			return true;
+		}
+
+	private:
+		lua_State* m_L;
+		StringType& m_sCode;
+		bool m_bUseEmptyArray;
+		/** tables being written, used to detect recursive tables. */
+		std::vector<const void*> m_tables;
+	};
+}
+
+bool NPL::NPLJson::ParseToLuaTable(lua_State* L, int nTableIndex, const char* sJson, int nSize, const char** ppError)
+{
+	if (sJson == NULL)
+		return false;
+	if (nSize < 0)
+		nSize = (int)strlen(sJson);
+	int nTop = lua_gettop(L);
+	if (nTableIndex < 0)
+		nTableIndex = nTop + 1 + nTableIndex;
+	if (lua_type(L, nTableIndex) != LUA_TTABLE || !lua_checkstack(L, 4))
+		return false;
+
+	NPLJsonReader reader(L, sJson, nSize);
+	if (!reader.ParseRoot())
+	{
+		if (ppError)
+			*ppError = reader.GetError();
+		lua_settop(L, nTop);
+		return false;
+	}
+	// copy root members to the output table only after the whole document is parsed,
+	// so that output is not modified on error. Non-raw set is used, since output may have meta tables.
+	int nRoot = lua_gettop(L);
+	lua_pushnil(L);
+	while (lua_next(L, nRoot) != 0)
+	{
+		lua_pushvalue(L, -2);
+		lua_insert(L, -2);
+		lua_settable(L, nTableIndex);
+	}
+	lua_settop(L, nTop);
+	return true;
+}
+
+template <typename StringType>
+bool NPL::NPLJson::WriteLuaValue(lua_State* L, int nIndex, StringType& sCode, bool bUseEmptyArray)
+{
+	if (nIndex < 0)
+		nIndex = lua_gettop(L) + 1 + nIndex;
+	int nOldSize = (int)sCode.size();
+	NPLJsonWriter<StringType> writer(L, sCode, bUseEmptyArray);
+	if (!writer.WriteValue(nIndex))
+	{
+		sCode.resize(nOldSize);
+		return false;
+	}
+	return true;
+}
+
+template <typename StringType>
+void NPL::NPLJson::EncodeString(StringType& output, const char* input, int nInputSize)
+{
+	const char* p = input;
+	const char* end = input + nInputSize;
+	output.append("\"");
+	while (p < end)
+	{
+		const char* pSpecial = JsonScanEscapeChar(p, end);
+		if (pSpecial != p)
+			output.append(p, pSpecial - p);
+		if (pSpecial >= end)
+			break;
+		char c = *pSpecial;
+		switch (c)
+		{
+		case '"': output.append("\\\""); break;
+		case '\\': output.append("\\\\"); break;
+		case '\b': output.append("\\b"); break;
+		case '\n': output.append("\\n"); break;
+		case '\r': output.append("\\r"); break;
+		case '\t': output.append("\\t"); break;
+		default:
+		{
+			static const char s_hex[] = "0123456789abcdef";
+			char buff[6] = { '\\', 'u', '0', '0', s_hex[(c >> 4) & 0xf], s_hex[c & 0xf] };
+			output.append(buff, 6);
+			break;
+		}
+		}
+		p = pSpecial + 1;
+	}
+	output.append("\"");
+}
+
+template bool NPL::NPLJson::WriteLuaValue(lua_State* L, int nIndex, std::string& sCode, bool bUseEmptyArray);
+template bool NPL::NPLJson::WriteLuaValue(lua_State* L, int nIndex, ParaEngine::StringBuilder& sCode, bool bUseEmptyArray);
+template void NPL::NPLJson::EncodeString(std::string& output, const char* input, int nInputSize);
+template void NPL::NPLJson::EncodeString(ParaEngine::StringBuilder& output, const char* input, int nInputSize);
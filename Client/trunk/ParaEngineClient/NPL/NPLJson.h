@@ -0,0 +1,48 @@
+#pragma once
+
+struct lua_State;
+
+namespace NPL
+{
+	/** max nesting depth of json arrays and objects that NPLJson will read or write. */
+#define NPL_JSON_MAX_DEPTH	512
+
+	/**
+	* single pass json reader and writer that works directly on the lua stack.
+	* Unlike jsoncpp, no intermediary DOM is built: values are pushed to the lua stack as soon as they are scanned,
+	* and the writer reads lua tables with lua_next. Strings without escape characters are pushed without any copy.
+	* Scanning of strings and white spaces uses SSE2 when available, which is the most time consuming part for large documents.
+	*
+	* [thread safe]: all functions are reentrant, as long as the lua_State is only used by the calling thread.
+	*/
+	class NPLJson
+	{
+	public:
+		/** parse json string and save all members of the root array or object to the table at nTableIndex.
+		* It has the same semantics as the old jsoncpp strict mode, i.e. the root must be an array or an object,
+		* null values are skipped, numbers are converted to lua number, and arrays are 1 based lua tables.
+		* if parsing failed, the output table is not modified.
+		* @param L: lua state
+		* @param nTableIndex: stack index of the output table.
+		* @param sJson: json string
+		* @param nSize: number of bytes in sJson. if -1, strlen() is used.
+		* @param ppError: if not NULL, it will receive a static error message on failure.
+		* @return true if succeed. the lua stack is always left unchanged.
+		*/
+		static bool ParseToLuaTable(lua_State* L, int nTableIndex, const char* sJson, int nSize = -1, const char** ppError = NULL);
+
+		/** serialize the lua value at nIndex to json. output is the same as NPLHelper::SerializeToJson(),
+		* except that it does not create luabind objects, and is several times faster for big tables.
+		* @param sCode: std::string or StringBuilder. json text is appended to it.
+		* @param bUseEmptyArray: if true, empty table is written as [] instead of {}
+		* @return false if the value can not be serialized, such as a function. sCode is then left unchanged.
+		*/
+		template <typename StringType>
+		static bool WriteLuaValue(lua_State* L, int nIndex, StringType& sCode, bool bUseEmptyArray = false);
+
+		/** append input string as quoted json string to output. The output is the same as NPLHelper::EncodeJsonStringInQuotation(),
+		* however, it copies unescaped runs of characters in one go. */
+		template <typename StringType>
+		static void EncodeString(StringType& output, const char* input, int nInputSize);
+	};
+}
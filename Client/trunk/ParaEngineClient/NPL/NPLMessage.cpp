@@ -10,15 +10,70 @@
 //-----------------------------------------------------------------------------
 #include "ParaEngine.h"
 
+#include "NPLHelper.h"
 #include "NPLMessage.h"
 
 NPL::NPLMessage::NPLMessage()
-:m_type(MSG_TYPE_FILE_ACTIVATION)
+:m_type(MSG_TYPE_FILE_ACTIVATION), m_nEnqueueTime(0), m_pHttpMsg(NULL)
 {
 
 }
 
 NPL::NPLMessage::~NPLMessage()
 {
+	SAFE_DELETE(m_pHttpMsg);
+}
+
+void NPL::NPLHttpMessage::ToCode(ParaEngine::StringBuilder& code) const
+{
+	code.reserve(code.size() + m_body.size() + 36);
+	code.append("msg={");
+
+	code.append("url=");
+	NPLHelper::EncodeStringInQuotation(code, code.size(), m_url);
+	code.append(",");
+
+	code.append("method=");
+	NPLHelper::EncodeStringInQuotation(code, code.size(), m_method);
+	code.append(",");
+
+	code.append("rcode=");
+	code.append(m_rcode);
+	code.append(",");
+
+	int nCount = (int)m_headers.size();
+	for (int i = 0; i < nCount; ++i)
+	{
+		code.append("[");
+		NPLHelper::EncodeStringInQuotation(code, code.size(), m_headers[i].name);
+		code.append("]=");
+		NPLHelper::EncodeStringInQuotation(code, code.size(), m_headers[i].value);
+		code.append(",");
+	}
+
+	if (NPLHelper::CanEncodeStringInDoubleBrackets(m_body.c_str(), (int)m_body.size()))
+	{
+		code.append("body=[[");
+		code.append(m_body);
+		code.append("]],");
+	}
+	else
+	{
+		code.append("body=");
+		NPLHelper::EncodeStringInQuotation(code, code.size(), m_body);
+		code.append(",");
+	}
 
+	if (m_bAuthenticated)
+	{
+		code.append("nid=");
+		NPLHelper::EncodeStringInQuotation(code, code.size(), m_nid);
+		code.append("}");
+	}
+	else
+	{
+		code.append("tid=");
+		NPLHelper::EncodeStringInQuotation(code, code.size(), m_nid);
+		code.append(",nid=nil}");
+	}
 }
\ No newline at end of file
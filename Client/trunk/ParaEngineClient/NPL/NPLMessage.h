@@ -1,6 +1,8 @@
 #pragma once
 #include "util/StringBuilder.h"
 #include "util/PoolBase.h"
+#include "NPLMsgHeader.h"
+#include <vector>
 
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
@@ -25,6 +27,33 @@ namespace NPL
 		MSG_TYPE_FILE_LOAD,
 	};
 
+	/** an HTTP request or response received on the NPL port. 
+	* It is delivered to the runtime state as it is, and the receiving state builds the global msg table 
+	* with the lua C API, instead of compiling a msg={...} source string with the escaped body. 
+	* The table is the same as before: {url, method, rcode, [header_name]=header_value, body, nid|tid}
+	*/
+	struct NPLHttpMessage
+	{
+	public:
+		NPLHttpMessage() :m_rcode(0), m_bAuthenticated(false) {};
+
+		/** append msg={...} code. It is only used for activation targets that only accept code, such as dll and cs files. */
+		void ToCode(ParaEngine::StringBuilder& code) const;
+	public:
+		/// url or the "OK", "Error" string in response's first line
+		std::string m_url;
+		/// GET, POST,  HTTP/1.1, etc. 
+		std::string m_method;
+		/// return code in http response
+		int m_rcode;
+		std::vector<NPLMsgHeader> m_headers;
+		/// the body is swapped from the connection's receive buffer, so that it is never copied before it is pushed to lua. 
+		std::string m_body;
+		/// nid if authenticated, otherwise tid
+		std::string m_nid;
+		bool m_bAuthenticated;
+	};
+
 	/** an NPL message in the message queue.
 	* always create using reference counted pointer like this: 
 	*	NPLMessage_ptr msg(new NPLMessage(...));
@@ -44,6 +73,10 @@ namespace NPL
 		std::string m_filename;
 		/// must be secure code. 
 		ParaEngine::StringBuilder m_code;
+		/// time in microseconds when the message is pushed to the input queue. only set when trace profiler is enabled, otherwise 0.
+		int64 m_nEnqueueTime;
+		/// if not NULL, this is an HTTP message and m_code is empty. it is deleted with the message.
+		NPLHttpMessage* m_pHttpMsg;
 	};
 
 
@@ -230,6 +230,28 @@ namespace NPL
 			return false;
 		}
 
+		/** erase items at or after nFirstIndex for which pred(item) returns true. Items are visited from front to back. 
+		* @param pred: it is called inside the queue lock, so it must not call this queue. 
+		* @return: number of erased items. 
+		*/
+		template <typename Predicate>
+		int erase_if(size_type nFirstIndex, Predicate pred)
+		{
+			boost::mutex::scoped_lock lock(m_mutex);
+			int nCount = 0;
+			for (size_type i = nFirstIndex; i < m_container.size();)
+			{
+				if (pred(m_container[i]))
+				{
+					m_container.erase(m_container.begin() + i);
+					++nCount;
+				}
+				else
+					++i;
+			}
+			return nCount;
+		}
+
 		/**
 		* @return: get a pointer to the front object if exist, or NULL. 
 		* @note this is thread safe, however the returned object may be invalid if it is popped by another thread when you use it. 
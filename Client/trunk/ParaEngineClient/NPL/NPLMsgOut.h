@@ -27,13 +27,31 @@ namespace NPL
 		private boost::noncopyable
 	{
 	public:
-		virtual ~NPLMsgOut(){};
+		NPLMsgOut() :m_pFile(NULL), m_nFileOffset(0), m_nFileSize(0) {};
+		virtual ~NPLMsgOut(){
+			if (m_pFile)
+				fclose(m_pFile);
+		};
 
 		/// The content to be sent in the reply.
 		ParaEngine::StringBuilder m_msg;
 
+		/** a disk file range that is sent after m_msg without loading it to memory. see CNPLConnection::SendFile() */
+		FILE* m_pFile;
+		/// offset of the next file byte to send
+		int64 m_nFileOffset;
+		/// number of file bytes left to send
+		int64 m_nFileSize;
+
+		/** queued messages of the same key are replaced by newer ones with the coalesce slow consumer policy. 
+		* it is the remote file name of NPL messages, and empty for raw messages. */
+		std::string m_sKey;
+
 		/** if message is empty */
-		bool empty() {return m_msg.empty();}
+		bool empty() {return m_msg.empty() && m_pFile == NULL;}
+
+		/** whether a file range is sent after m_msg */
+		bool HasFile() const { return m_pFile != NULL; }
 
 		/** get the internal string buffer */
 		ParaEngine::StringBuilder& GetBuffer() {return m_msg;};
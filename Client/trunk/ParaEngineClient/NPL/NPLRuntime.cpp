@@ -827,6 +827,18 @@ void CNPLRuntime::NPL_accept(const char* sTID, const char* sNID)
 	}
 }
 
+int CNPLRuntime::NPL_SendFile(const char* nid, const char* sHeader, int nHeaderSize, const char* filename, int64 nOffset, int64 nSize)
+{
+	if (nid == 0)
+		return NPL_ConnectionNotEstablished;
+	NPLConnection_ptr pConnection = NPL::CNPLRuntime::GetInstance()->GetNetServer()->GetDispatcher().GetNPLConnectionByNID(nid);
+	if (pConnection)
+	{
+		return pConnection->SendFile(sHeader, nHeaderSize, filename, nOffset, nSize);
+	}
+	return NPL_ConnectionNotEstablished;
+}
+
 void CNPLRuntime::NPL_reject(const char* sNID, int nReason)
 {
 	if(sNID!=0)
@@ -1159,6 +1171,26 @@ int CNPLRuntime::GetCompressionThreshold()
 	return NPL::CNPLRuntime::GetInstance()->GetNetServer()->GetDispatcher().GetCompressionThreshold();
 }
 
+void CNPLRuntime::SetMaxQueuedBytes(int nMaxBytes)
+{
+	NPL::CNPLRuntime::GetInstance()->GetNetServer()->GetDispatcher().SetMaxQueuedBytes(nMaxBytes);
+}
+
+int CNPLRuntime::GetMaxQueuedBytes()
+{
+	return NPL::CNPLRuntime::GetInstance()->GetNetServer()->GetDispatcher().GetMaxQueuedBytes();
+}
+
+void CNPLRuntime::SetSlowConsumerPolicy(int nPolicy)
+{
+	NPL::CNPLRuntime::GetInstance()->GetNetServer()->GetDispatcher().SetSlowConsumerPolicy(nPolicy);
+}
+
+int CNPLRuntime::GetSlowConsumerPolicy()
+{
+	return NPL::CNPLRuntime::GetInstance()->GetNetServer()->GetDispatcher().GetSlowConsumerPolicy();
+}
+
 void CNPLRuntime::SetUDPCompressionThreshold(int nThreshold)
 {
 	GetNetUDPServer()->GetDispatcher().SetCompressionThreshold(nThreshold);
@@ -1341,6 +1373,8 @@ int CNPLRuntime::InstallFields(ParaEngine::CAttributeClass* pClass, bool bOverri
 	pClass->AddField("IdleTimeoutPeriod",FieldType_Int, (void*)SetIdleTimeoutPeriod_s, (void*)GetIdleTimeoutPeriod_s, NULL, NULL, bOverride);
 	pClass->AddField("CompressionThreshold",FieldType_Int, (void*)SetCompressionThreshold_s, (void*)GetCompressionThreshold_s, NULL, NULL, bOverride);
 	pClass->AddField("CompressionLevel",FieldType_Int, (void*)SetCompressionLevel_s, (void*)GetCompressionLevel_s, NULL, NULL, bOverride);
+	pClass->AddField("MaxQueuedBytes", FieldType_Int, (void*)SetMaxQueuedBytes_s, (void*)GetMaxQueuedBytes_s, NULL, NULL, bOverride);
+	pClass->AddField("SlowConsumerPolicy", FieldType_Int, (void*)SetSlowConsumerPolicy_s, (void*)GetSlowConsumerPolicy_s, NULL, NULL, bOverride);
 	pClass->AddField("MaxPendingConnections", FieldType_Int, (void*)SetMaxPendingConnections_s, (void*)GetMaxPendingConnections_s, NULL, NULL, bOverride);
 	pClass->AddField("LogLevel", FieldType_Int, (void*)SetLogLevel_s, (void*)GetLogLevel_s, NULL, NULL, bOverride);
 	pClass->AddField("EnableAnsiMode",FieldType_Bool, (void*)EnableAnsiMode_s, (void*)IsAnsiMode_s, NULL, NULL, bOverride);
@@ -1361,5 +1395,11 @@ int CNPLRuntime::InstallFields(ParaEngine::CAttributeClass* pClass, bool bOverri
 
 	pClass->AddField("ExternalIPList", FieldType_String, (void*)0, (void*)GetExternalIPList_s, NULL, NULL, bOverride);
 	pClass->AddField("BroadcastAddressList", FieldType_String, (void*)0, (void*)GetBroadcastAddressList_s, NULL, NULL, bOverride);
+	pClass->AddField("EnableBytecodeCache", FieldType_Bool, (void*)EnableBytecodeCache_s, (void*)IsBytecodeCacheEnabled_s, NULL, NULL, bOverride);
+	pClass->AddField("BytecodeCacheMaxBytes", FieldType_Int, (void*)SetBytecodeCacheMaxBytes_s, (void*)GetBytecodeCacheMaxBytes_s, NULL, NULL, bOverride);
+	pClass->AddField("BytecodeCacheDir", FieldType_String, (void*)SetBytecodeCacheDir_s, (void*)GetBytecodeCacheDir_s, NULL, NULL, bOverride);
+	pClass->AddField("WatchBytecodeCacheDir", FieldType_String, (void*)WatchBytecodeCacheDir_s, NULL, NULL, NULL, bOverride);
+	pClass->AddField("BytecodeCacheStats", FieldType_String, (void*)0, (void*)GetBytecodeCacheStats_s, NULL, NULL, bOverride);
+	pClass->AddField("ClearBytecodeCache", FieldType_void, (void*)ClearBytecodeCache_s, NULL, NULL, NULL, bOverride);
 	return S_OK;
 }
@@ -9,6 +9,7 @@ struct lua_State;
 /* internal data structure used by NPL runtime */
 #include "NPLCommon.h"
 #include "IAttributeFields.h"
+#include "NPLBytecodeCache.h"
 
 #include <boost/scoped_ptr.hpp>
 #include <boost/thread/shared_mutex.hpp>
@@ -140,6 +141,12 @@ namespace NPL
 		ATTRIBUTE_METHOD1(CNPLRuntime, GetCompressionThreshold_s, int*)	{*p1 = cls->GetCompressionThreshold(); return S_OK;}
 		ATTRIBUTE_METHOD1(CNPLRuntime, SetCompressionThreshold_s, int)	{cls->SetCompressionThreshold(p1); return S_OK;}
 
+		ATTRIBUTE_METHOD1(CNPLRuntime, GetMaxQueuedBytes_s, int*) { *p1 = cls->GetMaxQueuedBytes(); return S_OK; }
+		ATTRIBUTE_METHOD1(CNPLRuntime, SetMaxQueuedBytes_s, int) { cls->SetMaxQueuedBytes(p1); return S_OK; }
+
+		ATTRIBUTE_METHOD1(CNPLRuntime, GetSlowConsumerPolicy_s, int*) { *p1 = cls->GetSlowConsumerPolicy(); return S_OK; }
+		ATTRIBUTE_METHOD1(CNPLRuntime, SetSlowConsumerPolicy_s, int) { cls->SetSlowConsumerPolicy(p1); return S_OK; }
+
 		ATTRIBUTE_METHOD1(CNPLRuntime, GetUDPCompressionThreshold_s, int*) { *p1 = cls->GetUDPCompressionThreshold(); return S_OK; }
 		ATTRIBUTE_METHOD1(CNPLRuntime, SetUDPCompressionThreshold_s, int) { cls->SetUDPCompressionThreshold(p1); return S_OK; }
 
@@ -155,6 +162,16 @@ namespace NPL
 		ATTRIBUTE_METHOD1(CNPLRuntime, EnableUDPServer_s, int) { cls->NPL_StartNetUDPServer(nullptr, p1); return S_OK; }
 		ATTRIBUTE_METHOD(CNPLRuntime, DisableUDPServer_s) { cls->NPL_StopNetUDPServer(); return S_OK; }
 
+		ATTRIBUTE_METHOD1(CNPLRuntime, IsBytecodeCacheEnabled_s, bool*) { *p1 = CNPLBytecodeCache::GetInstance().IsEnabled(); return S_OK; }
+		ATTRIBUTE_METHOD1(CNPLRuntime, EnableBytecodeCache_s, bool) { CNPLBytecodeCache::GetInstance().SetEnabled(p1); return S_OK; }
+		ATTRIBUTE_METHOD1(CNPLRuntime, GetBytecodeCacheMaxBytes_s, int*) { *p1 = CNPLBytecodeCache::GetInstance().GetMaxMemoryBytes(); return S_OK; }
+		ATTRIBUTE_METHOD1(CNPLRuntime, SetBytecodeCacheMaxBytes_s, int) { CNPLBytecodeCache::GetInstance().SetMaxMemoryBytes(p1); return S_OK; }
+		ATTRIBUTE_METHOD1(CNPLRuntime, GetBytecodeCacheDir_s, const char**) { *p1 = CNPLBytecodeCache::GetInstance().GetDiskCacheDir().c_str(); return S_OK; }
+		ATTRIBUTE_METHOD1(CNPLRuntime, SetBytecodeCacheDir_s, const char*) { CNPLBytecodeCache::GetInstance().SetDiskCacheDir(p1); return S_OK; }
+		ATTRIBUTE_METHOD1(CNPLRuntime, WatchBytecodeCacheDir_s, const char*) { CNPLBytecodeCache::GetInstance().WatchDirectory(p1); return S_OK; }
+		ATTRIBUTE_METHOD1(CNPLRuntime, GetBytecodeCacheStats_s, const char**) { *p1 = CNPLBytecodeCache::GetInstance().GetStats().c_str(); return S_OK; }
+		ATTRIBUTE_METHOD(CNPLRuntime, ClearBytecodeCache_s) { CNPLBytecodeCache::GetInstance().Clear(); return S_OK; }
+
 		ATTRIBUTE_METHOD1(CNPLRuntime, GetExternalIPList_s, const char**) { *p1 = CNPLRuntime::GetExternalIPList().c_str(); return S_OK; }
 		ATTRIBUTE_METHOD1(CNPLRuntime, GetBroadcastAddressList_s, const char**) { *p1 = CNPLRuntime::GetBroadcastAddressList().c_str(); return S_OK; }
 	public:
@@ -201,6 +218,17 @@ namespace NPL
 		void SetUDPCompressionThreshold(int nThreshold);
 		int GetUDPCompressionThreshold();
 
+		/** max number of bytes queued for sending per TCP connection. 0 means no limit. default to 64MB. a message is always admitted into an empty queue even if it is bigger than the limit. 
+		* NPL_QueueHighWatermark and NPL_QueueLowWatermark network events are posted when queued bytes of a connection goes above 3/4 
+		* and then below 1/4 of it. */
+		void SetMaxQueuedBytes(int nMaxBytes);
+		int GetMaxQueuedBytes();
+
+		/** what to do when a message does not fit in a connection's output queue. 
+		* 0: drop the new message(default), 1: drop oldest messages, 2: replace queued messages to the same remote file, 3: close the connection. */
+		void SetSlowConsumerPolicy(int nPolicy);
+		int GetSlowConsumerPolicy();
+
 		/** System level Enable/disable SO_KEEPALIVE. 
 		* one needs set following values in linux procfs or windows registry in order to work as expected. 
 		* - tcp_keepalive_intvl (integer; default: 75) 
@@ -419,6 +447,14 @@ namespace NPL
 		*/
 		void NPL_reject(const char* nid, int nReason = 0);
 
+		/** send a raw header followed by a range of a file to a given connection, such as a static file http response. 
+		* The file is streamed by the network thread without loading it to memory, so the caller returns immediately. 
+		* [thread safe]
+		* @param nSize: number of bytes to send. if -1, it is until the end of file.
+		* @return 0(NPL_OK) if succeed. 
+		*/
+		int NPL_SendFile(const char* nid, const char* sHeader, int nHeaderSize, const char* filename, int64 nOffset = 0, int64 nSize = -1);
+
 		virtual void StartNetServer(const char* server=NULL, const char* port=NULL);
 		virtual void StopNetServer();
 		virtual void AddPublicFile(const string& filename, int nID);
@@ -17,8 +17,10 @@
 #include "NPLCommon.h"
 #include "NPLRuntime.h"
 #include "util/ScopedLock.h"
+#include "util/ParaTime.h"
 #include <boost/bind.hpp>
 #include "NPLRuntimeState.h"
+#include "NPLStateMemAllocator.h"
 
 /**
 for luabind, The main drawback of this approach is that the compilation time will increase for the file
@@ -294,10 +296,12 @@ int NPL::CNPLRuntimeState::Run()
 {
 	NPLMessage_ptr msg;
 	int nRes = 0;
+	ParaEngine::CTraceProfiler::GetInstance().SetThreadName(GetName().c_str());
 	while (nRes != -1)
 	{
 		m_input_queue.wait_and_pop(msg);
 		nRes = ProcessMsg(msg);
+		CheckMemoryLimit();
 	}
 	// this is necessary, because we must finalize mono state before the thread is terminated. 
 	// Otherwise there will a exception when application exit via the main thread. 
@@ -313,9 +317,16 @@ int NPL::CNPLRuntimeState::Process()
 	{
 		ProcessMsg(msg);
 	}
+	CheckMemoryLimit();
 	return 0;
 }
 
+/** time in microseconds that the message has waited in the queue, or -1 if unknown. */
+static int64 GetMsgQueueWaitTime(NPL::NPLMessage_ptr& msg)
+{
+	return (msg->m_nEnqueueTime != 0 && ParaEngine::CTraceProfiler::IsEnabled()) ? (ParaEngine::GetTimeUS() - msg->m_nEnqueueTime) : -1;
+}
+
 int NPL::CNPLRuntimeState::ProcessMsg(NPLMessage_ptr msg)
 {
 	if (msg.get() == 0)
@@ -343,7 +354,8 @@ int NPL::CNPLRuntimeState::ProcessMsg(NPLMessage_ptr msg)
 			}
 			else
 			{
-				ActivateFile_any(msg->m_filename, msg->m_code.c_str(), (int)msg->m_code.size());
+				TRACE_SCOPE_DETAIL("NPL.Activate", "npl", msg->m_filename.c_str(), GetMsgQueueWaitTime(msg));
+				ActivateMsg(msg);
 				pFileState->Tick(m_nFrameMoveCount);
 			}
 		}
@@ -374,6 +386,64 @@ int NPL::CNPLRuntimeState::ProcessMsg(NPLMessage_ptr msg)
 	return 0;
 }
 
+NPL::NPLReturnCode NPL::CNPLRuntimeState::ActivateMsg(NPLMessage_ptr& msg)
+{
+	if (msg->m_pHttpMsg)
+	{
+		// dll, so, cs, c and cpp files only take code, see ActivateFile_any
+		const std::string& filepath = msg->m_filename;
+		int nSize = (int)filepath.size();
+		if (nSize > 5 && (filepath[nSize - 3] != 'l' && filepath[nSize - 3] != 'n'))
+		{
+			msg->m_pHttpMsg->ToCode(msg->m_code);
+			SAFE_DELETE(msg->m_pHttpMsg);
+		}
+		else
+		{
+			SetHttpMsg(*(msg->m_pHttpMsg));
+			return ActivateFile_any(filepath);
+		}
+	}
+	return ActivateFile_any(msg->m_filename, msg->m_code.c_str(), (int)msg->m_code.size());
+}
+
+void NPL::CNPLRuntimeState::SetHttpMsg(const NPLHttpMessage& httpMsg)
+{
+	lua_State* L = GetLuaState();
+	if (L == 0)
+		return;
+	// fields are set in the same order as the msg={...} code, so that the real nid or tid overrides any header of the same name. 
+	int nCount = (int)httpMsg.m_headers.size();
+	lua_createtable(L, 0, nCount + 6);
+	lua_pushlstring(L, httpMsg.m_url.c_str(), httpMsg.m_url.size());
+	lua_setfield(L, -2, "url");
+	lua_pushlstring(L, httpMsg.m_method.c_str(), httpMsg.m_method.size());
+	lua_setfield(L, -2, "method");
+	lua_pushinteger(L, httpMsg.m_rcode);
+	lua_setfield(L, -2, "rcode");
+	for (int i = 0; i < nCount; ++i)
+	{
+		const NPLMsgHeader& header = httpMsg.m_headers[i];
+		lua_pushlstring(L, header.name.c_str(), header.name.size());
+		lua_pushlstring(L, header.value.c_str(), header.value.size());
+		lua_rawset(L, -3);
+	}
+	lua_pushlstring(L, httpMsg.m_body.c_str(), httpMsg.m_body.size());
+	lua_setfield(L, -2, "body");
+	lua_pushlstring(L, httpMsg.m_nid.c_str(), httpMsg.m_nid.size());
+	if (httpMsg.m_bAuthenticated)
+	{
+		lua_setfield(L, -2, "nid");
+	}
+	else
+	{
+		lua_setfield(L, -2, "tid");
+		lua_pushnil(L);
+		lua_setfield(L, -2, "nid");
+	}
+	lua_setfield(L, LUA_GLOBALSINDEX, "msg");
+}
+
 static void npl_preemptive_scheduler_hook(lua_State* L, lua_Debug* ar)
 {
 	(void)ar;
@@ -516,7 +586,10 @@ int NPL::CNPLRuntimeState::FrameMoveTick()
 				pFileState->SetProcessing(false);
 				if (pFileState->IsPreemptive())
 				{
-					DoString(msg->m_code.c_str(), (int)msg->m_code.size());
+					if (msg->m_pHttpMsg)
+						SetHttpMsg(*(msg->m_pHttpMsg));
+					else
+						DoString(msg->m_code.c_str(), (int)msg->m_code.size());
 					lua_State * L = GetLuaState();
 					// use coroutine with hooks to simulate preemptive multi-tasking. 
 					lua_State* th = lua_newthread(L);
@@ -595,7 +668,8 @@ int NPL::CNPLRuntimeState::FrameMoveTick()
 				}
 				else
 				{
-					ActivateFile_any(msg->m_filename, msg->m_code.c_str(), (int)msg->m_code.size());
+					TRACE_SCOPE_DETAIL("NPL.Activate", "npl", msg->m_filename.c_str(), GetMsgQueueWaitTime(msg));
+					ActivateMsg(msg);
 				}
 				if (!pFileState->IsProcessing())
 				{
@@ -633,6 +707,38 @@ int NPL::CNPLRuntimeState::GetProcessedMsgCount()
 	return m_processed_msg_count;
 }
 
+void NPL::CNPLRuntimeState::SetMemoryHardLimit(int nMB)
+{
+	if (GetMemTracker())
+		GetMemTracker()->SetHardLimit((int64)nMB * 1024 * 1024);
+}
+
+int NPL::CNPLRuntimeState::GetMemoryHardLimit()
+{
+	return GetMemTracker() ? (int)(GetMemTracker()->GetHardLimit() / (1024 * 1024)) : 0;
+}
+
+void NPL::CNPLRuntimeState::SetMemorySoftLimit(int nMB)
+{
+	if (GetMemTracker())
+		GetMemTracker()->SetSoftLimit((int64)nMB * 1024 * 1024);
+}
+
+int NPL::CNPLRuntimeState::GetMemorySoftLimit()
+{
+	return GetMemTracker() ? (int)(GetMemTracker()->GetSoftLimit() / (1024 * 1024)) : 0;
+}
+
+int NPL::CNPLRuntimeState::GetMemoryUsedKB()
+{
+	return GetMemTracker() ? (int)(GetMemTracker()->GetBytes() / 1024) : 0;
+}
+
+int NPL::CNPLRuntimeState::GetMemoryPeakKB()
+{
+	return GetMemTracker() ? (int)(GetMemTracker()->GetPeakBytes() / 1024) : 0;
+}
+
 template <typename StringType>
 bool NPL::CNPLRuntimeState::LoadFile_any(const StringType & filepath, bool bReload, lua_State* L, bool bNoReturn)
 {
@@ -900,6 +1006,8 @@ int NPL::CNPLRuntimeState::activate(const char * sNPLFilename, const char* sCode
 
 NPL::NPLReturnCode NPL::CNPLRuntimeState::SendMessage(NPLMessage_ptr& msg, int priority/*=0*/)
 {
+	if (ParaEngine::CTraceProfiler::IsEnabled())
+		msg->m_nEnqueueTime = ParaEngine::GetTimeUS();
 	// insert to the input message queue
 	if (priority <= 0)
 	{
@@ -1127,6 +1235,10 @@ int NPL::CNPLRuntimeState::InstallFields(ParaEngine::CAttributeClass* pClass, bo
 	pClass->AddField("PauseAllPreemptiveFunction", FieldType_Bool, (void*)PauseAllPreemptiveFunction_s, (void*)IsAllPreemptiveFunctionPaused_s, NULL, NULL, bOverride);
 	pClass->AddField("filename", FieldType_String, (void*)0, (void*)GetFileName_s, NULL, NULL, bOverride);
 	pClass->AddField("DebugTraceLevel", FieldType_Int, (void*)SetDebugTraceLevel_s, (void*)GetDebugTraceLevel_s, NULL, NULL, bOverride);
+	pClass->AddField("MemoryHardLimit", FieldType_Int, (void*)SetMemoryHardLimit_s, (void*)GetMemoryHardLimit_s, NULL, NULL, bOverride);
+	pClass->AddField("MemorySoftLimit", FieldType_Int, (void*)SetMemorySoftLimit_s, (void*)GetMemorySoftLimit_s, NULL, NULL, bOverride);
+	pClass->AddField("MemoryUsedKB", FieldType_Int, (void*)0, (void*)GetMemoryUsedKB_s, NULL, NULL, bOverride);
+	pClass->AddField("MemoryPeakKB", FieldType_Int, (void*)0, (void*)GetMemoryPeakKB_s, NULL, NULL, bOverride);
 	return S_OK;
 }
 
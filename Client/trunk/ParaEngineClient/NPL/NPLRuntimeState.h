@@ -64,6 +64,12 @@ namespace NPL
 		ATTRIBUTE_METHOD1(CNPLRuntimeState, GetFileName_s, const char**) { *p1 = cls->GetCurrentFileName(); return S_OK; }
 		ATTRIBUTE_METHOD1(CNPLRuntimeState, GetDebugTraceLevel_s, int*) { *p1 = cls->GetDebugTraceLevel(); return S_OK; }
 		ATTRIBUTE_METHOD1(CNPLRuntimeState, SetDebugTraceLevel_s, int) { cls->SetDebugTraceLevel(p1); return S_OK; }
+		ATTRIBUTE_METHOD1(CNPLRuntimeState, SetMemoryHardLimit_s, int) { cls->SetMemoryHardLimit(p1); return S_OK; }
+		ATTRIBUTE_METHOD1(CNPLRuntimeState, GetMemoryHardLimit_s, int*) { *p1 = cls->GetMemoryHardLimit(); return S_OK; }
+		ATTRIBUTE_METHOD1(CNPLRuntimeState, SetMemorySoftLimit_s, int) { cls->SetMemorySoftLimit(p1); return S_OK; }
+		ATTRIBUTE_METHOD1(CNPLRuntimeState, GetMemorySoftLimit_s, int*) { *p1 = cls->GetMemorySoftLimit(); return S_OK; }
+		ATTRIBUTE_METHOD1(CNPLRuntimeState, GetMemoryUsedKB_s, int*) { *p1 = cls->GetMemoryUsedKB(); return S_OK; }
+		ATTRIBUTE_METHOD1(CNPLRuntimeState, GetMemoryPeakKB_s, int*) { *p1 = cls->GetMemoryPeakKB(); return S_OK; }
 
 
 		/** call this function before calling anything else. It will load all NPL modules into the runtime state. */
@@ -123,6 +129,18 @@ namespace NPL
 		*/
 		int GetProcessedMsgCount();
 
+		/** max memory in MB of this state. allocations beyond it fail with "not enough memory" error. 0 (default) for unlimited. */
+		void SetMemoryHardLimit(int nMB);
+		int GetMemoryHardLimit();
+
+		/** memory in MB of this state, beyond which a full gc is done between messages. 0 (default) to disable. */
+		void SetMemorySoftLimit(int nMB);
+		int GetMemorySoftLimit();
+
+		/** [Not thread safe] memory used by this state in KB. This function is usually used for stat printing and monitoring. */
+		int GetMemoryUsedKB();
+		int GetMemoryPeakKB();
+
 		/** get the message queue size. default to 500. For busy server side, we can set this to something like 5000
 		* [thread safe]
 		*/
@@ -293,6 +311,12 @@ namespace NPL
 		*/
 		int ProcessMsg(NPLMessage_ptr msg);
 
+		/** activate the file of a file activation message. HTTP messages in lua files are activated without compiling any code. */
+		NPLReturnCode ActivateMsg(NPLMessage_ptr& msg);
+
+		/** set the global msg table from an HTTP message with the lua C API. It is the same as DoString("msg={...}"), but without escaping and compiling the body. */
+		void SetHttpMsg(const NPLHttpMessage& httpMsg);
+
 		/** any cross-frame pending messages are processed. */
 		int SendTick();
 
@@ -18,6 +18,7 @@
 #include "NPLScriptingState.h"
 #include "util/regularexpression.h"
 #include "NPLRuntimeState.h"
+#include "NPLBytecodeCache.h"
 
 
 /** @def if defined. we will use the luajit recommended way to open lua states and load library. */
@@ -109,7 +110,7 @@ ParaScripting::CNPLScriptingState::CNPLScriptingState(bool bCreateState)
 	// Xizhi: luajit2 requires using luaL_newstate instead of lua_newstate on 64bits system. so I disabled custom allocator for all linux version. 
 	m_nMemAllocatorType(MEM_ALLOC_TYPE_SYS_MALLOC),
 #endif
-	m_pMemAlloc(NULL)
+	m_pMemAlloc(NULL), m_pMemTracker(NULL)
 {
 	bool bIs64Bits = sizeof(void*) > 4;
 	if (bIs64Bits)
@@ -128,6 +129,7 @@ ParaScripting::CNPLScriptingState::~CNPLScriptingState(void)
 {
 	PE_ASSERT(m_stack_current_file.size() == 0);
 	DestroyState();
+	SAFE_DELETE(m_pMemTracker);
 
 	if (m_nMemAllocatorType == MEM_ALLOC_TYPE_POOL_MALLOC)
 	{
@@ -166,6 +168,18 @@ void ParaScripting::CNPLScriptingState::SetDebugTraceLevel(int val)
 	m_nDebugTraceLevel = val;
 }
 
+NPL::CNPLStateMemTracker* ParaScripting::CNPLScriptingState::GetMemTracker()
+{
+	return m_pMemTracker;
+}
+
+bool ParaScripting::CNPLScriptingState::CheckMemoryLimit()
+{
+	if (m_pMemTracker == 0 || m_pState == 0)
+		return true;
+	return m_pMemTracker->CheckSoftLimit();
+}
+
 void ParaScripting::CNPLScriptingState::DestroyState()
 {
 	if (m_pState != NULL)
@@ -173,7 +187,12 @@ void ParaScripting::CNPLScriptingState::DestroyState()
 		m_loaded_files.clear();
 
 		if (m_bOwnLuaState)
+		{
+			// luajit only releases its arena when closed with its own allocator.
+			if (m_pMemTracker)
+				m_pMemTracker->Detach(m_pState);
 			lua_close(m_pState);
+		}
 		m_pState = NULL;
 	}
 }
@@ -215,6 +234,13 @@ bool ParaScripting::CNPLScriptingState::CreateSetState(lua_State* pLuaState)
 	if (m_pState == NULL)
 		return false;
 
+	if (!pLuaState)
+	{
+		if (m_pMemTracker == 0)
+			m_pMemTracker = new NPL::CNPLStateMemTracker();
+		m_pMemTracker->Attach(m_pState);
+	}
+
 	LoadLuabind();
 	/// make this a reasonable size
 	if (m_nStackSize > 0)
@@ -668,7 +694,7 @@ bool ParaScripting::CNPLScriptingState::LoadFile(const string& filePath, bool bR
 					Output messages through log interface */
 					if (L == 0)
 						L = m_pState;
-					int nResult = luaL_loadbuffer(L, codebuf, codesize, filePath.c_str());
+					int nResult = NPL::CNPLBytecodeCache::GetInstance().LoadBuffer(L, codebuf, codesize, filePath);
 					if (nResult == 0) {
 						int top = lua_gettop(L);
 						nResult = Lua_ProtectedCall(L, 0, LUA_MULTRET);
@@ -5,6 +5,7 @@
 namespace NPL
 {
 	class CNPLStateMemAllocator;
+	class CNPLStateMemTracker;
 }
 
 namespace ParaScripting
@@ -185,6 +186,13 @@ namespace ParaScripting
 		* If -1, it means that file is being loaded or something went wrong. 0 means no cached object.
 		*/
 		const std::map <std::string, int32>& GetLoadedFiles();
+
+		/** memory stats and limits of this state. NULL if the lua state is not owned by us. */
+		NPL::CNPLStateMemTracker* GetMemTracker();
+
+		/** see CNPLStateMemTracker::CheckSoftLimit(). this function should be called between activations, not inside a lua call.
+		* @return false if memory is still over the soft limit. */
+		bool CheckMemoryLimit();
 	protected:
 
 		/** destroy the runtime state
@@ -284,6 +292,9 @@ namespace ParaScripting
 			void* m_mspace;
 		};
 
+		/** memory stats and hard/soft limits. it wraps the allocator above, and survives state reset. */
+		NPL::CNPLStateMemTracker* m_pMemTracker;
+
 		/** all loaded files mapping from filename to number of cached objects.
 		* If -1, it means that file is being loaded or something went wrong. 0 means no cached object.
 		*/
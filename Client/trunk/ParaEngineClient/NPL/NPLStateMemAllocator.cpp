@@ -14,6 +14,12 @@
 #endif
 #include "NPLStateMemAllocator.h"
 
+extern "C"
+{
+#include "lua.h"
+#include "lauxlib.h"
+}
+
 namespace NPL
 {
 #ifndef PARAENGINE_MOBILE
@@ -186,5 +192,165 @@ end
 			::free(ptr);
 		}
 	}
-}//NPL
 
+	void * npl_mem_tracked_alloc(void *ud, void *ptr, size_t osize, size_t nsize)
+	{
+		return ((CNPLStateMemTracker*)ud)->reallocate(ptr, osize, nsize);
+	}
+
+	CNPLStateMemTracker::CNPLStateMemTracker()
+		: m_pInnerAlloc(NULL), m_pInnerUserData(NULL), m_pState(NULL), m_pSavedHook(NULL), m_nSavedHookMask(0), m_nSavedHookCount(0),
+		m_bGCPending(false), m_nLastGCBytes(0), m_nBytes(0), m_nPeakBytes(0), m_nHardLimit(0), m_nSoftLimit(0), m_nFailedCount(0)
+	{
+		memset(m_classes, 0, sizeof(m_classes));
+	}
+
+	void CNPLStateMemTracker::Attach(lua_State* L)
+	{
+		m_pInnerAlloc = lua_getallocf(L, &m_pInnerUserData);
+		m_pState = L;
+		m_bGCPending = false;
+		m_nLastGCBytes = 0;
+		memset(m_classes, 0, sizeof(m_classes));
+		m_nFailedCount = 0;
+		// blocks allocated so far are counted as a whole
+		m_nBytes = m_nPeakBytes = (int64)lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+		lua_setallocf(L, npl_mem_tracked_alloc, this);
+	}
+
+	void CNPLStateMemTracker::Detach(lua_State* L)
+	{
+		if (m_pInnerAlloc)
+		{
+			if (m_bGCPending)
+			{
+				lua_sethook(L, m_pSavedHook, m_nSavedHookMask, m_nSavedHookCount);
+				m_bGCPending = false;
+			}
+			lua_setallocf(L, m_pInnerAlloc, m_pInnerUserData);
+			m_pInnerAlloc = NULL;
+		}
+		m_pState = NULL;
+	}
+
+	bool CNPLStateMemTracker::IsGCNeeded(int64 nBytes) const
+	{
+		int64 nThreshold = (m_nSoftLimit > 0) ? m_nSoftLimit : m_nHardLimit;
+		if (m_bGCPending || nThreshold <= 0 || nBytes <= nThreshold)
+			return false;
+		// over the hard limit, we must collect before failing. otherwise only collect again when memory has grown by 1/8 since last full gc.
+		return (m_nHardLimit > 0 && nBytes > m_nHardLimit) || nBytes >= (m_nLastGCBytes + (m_nLastGCBytes >> 3));
+	}
+
+	void CNPLStateMemTracker::RequestGC()
+	{
+		if (m_pState == 0)
+			return;
+		m_pSavedHook = lua_gethook(m_pState);
+		m_nSavedHookMask = lua_gethookmask(m_pState);
+		m_nSavedHookCount = lua_gethookcount(m_pState);
+		m_bGCPending = true;
+		lua_sethook(m_pState, GCHook, LUA_MASKCOUNT, 1);
+	}
+
+	void CNPLStateMemTracker::CollectGarbage()
+	{
+		lua_gc(m_pState, LUA_GCCOLLECT, 0);
+		m_nLastGCBytes = m_nBytes;
+	}
+
+	void CNPLStateMemTracker::GCHook(lua_State* L, lua_Debug* ar)
+	{
+		void* ud = NULL;
+		if (lua_getallocf(L, &ud) != npl_mem_tracked_alloc)
+			return;
+		CNPLStateMemTracker* pTracker = (CNPLStateMemTracker*)ud;
+		if (!pTracker->m_bGCPending)
+			return;
+		pTracker->m_bGCPending = false;
+		lua_sethook(L, pTracker->m_pSavedHook, pTracker->m_nSavedHookMask, pTracker->m_nSavedHookCount);
+		pTracker->CollectGarbage();
+		if (pTracker->m_nHardLimit > 0 && pTracker->m_nBytes > pTracker->m_nHardLimit)
+		{
+			++pTracker->m_nFailedCount;
+			luaL_error(L, "not enough memory: %d KB is used after full gc, which is over the hard limit %d KB",
+				(int)(pTracker->m_nBytes / 1024), (int)(pTracker->m_nHardLimit / 1024));
+		}
+	}
+
+	bool CNPLStateMemTracker::CheckSoftLimit()
+	{
+		if (m_pState == 0 || !IsOverSoftLimit())
+			return true;
+		if (m_nBytes < (m_nLastGCBytes + (m_nLastGCBytes >> 3)))
+			return false;
+		CollectGarbage();
+		if (IsOverSoftLimit())
+		{
+			OUTPUT_LOG("warning: NPL state uses %d KB memory after full gc, which is over its soft limit %d KB\n",
+				(int)(m_nLastGCBytes / 1024), (int)(m_nSoftLimit / 1024));
+			return false;
+		}
+		return true;
+	}
+
+	int CNPLStateMemTracker::GetSizeClassIndex(size_t nSize)
+	{
+		int nIndex = 0;
+		size_t nClassSize = 16;
+		while (nClassSize < nSize && nIndex < (s_size_class_count - 1))
+		{
+			nClassSize <<= 1;
+			++nIndex;
+		}
+		return nIndex;
+	}
+
+	int CNPLStateMemTracker::GetSizeClassSize(int nIndex)
+	{
+		return (nIndex < (s_size_class_count - 1)) ? (16 << nIndex) : -1;
+	}
+
+	void* CNPLStateMemTracker::reallocate(void *ptr, size_t osize, size_t nsize)
+	{
+		if (ptr == 0)
+			osize = 0;
+		if (nsize > osize)
+		{
+			int64 nNewBytes = m_nBytes + (int64)(nsize - osize);
+			if (IsGCNeeded(nNewBytes))
+				RequestGC();
+			if (m_nHardLimit > 0 && nNewBytes > m_nHardLimit && (!m_bGCPending || nNewBytes > (m_nHardLimit + (m_nHardLimit >> 3))))
+			{
+				// lua will raise a memory error, which fails the current activation.
+				++m_nFailedCount;
+				return NULL;
+			}
+		}
+		void* ret = m_pInnerAlloc(m_pInnerUserData, ptr, osize, nsize);
+		if (ret == NULL && nsize > 0)
+			return NULL;
+
+		if (osize > 0)
+		{
+			NPLMemSizeClassStats& stats = m_classes[GetSizeClassIndex(osize)];
+			// blocks allocated before Attach() are not in any class
+			if (stats.m_nCount > 0)
+			{
+				--stats.m_nCount;
+				stats.m_nBytes = (std::max)(stats.m_nBytes - (int64)osize, (int64)0);
+			}
+		}
+		if (nsize > 0)
+		{
+			NPLMemSizeClassStats& stats = m_classes[GetSizeClassIndex(nsize)];
+			++stats.m_nCount;
+			++stats.m_nAllocCount;
+			stats.m_nBytes += nsize;
+		}
+		m_nBytes += (int64)nsize - (int64)osize;
+		if (m_nBytes > m_nPeakBytes)
+			m_nPeakBytes = m_nBytes;
+		return ret;
+	}
+}//NPL
@@ -3,6 +3,9 @@
 #include "math/ParaMath.h"
 #include <boost/pool/object_pool.hpp>
 
+struct lua_State;
+struct lua_Debug;
+
 namespace NPL
 {
 #ifndef PARAENGINE_MOBILE
@@ -61,4 +64,99 @@ namespace NPL
 		/** free an old buffer. */
 		void deallocate(void* const ptr, const size_t n);
 	};
+
+	/** memory usage of a size class in CNPLStateMemTracker */
+	struct NPLMemSizeClassStats
+	{
+		/** bytes currently allocated */
+		int64 m_nBytes;
+		/** number of blocks currently allocated */
+		int64 m_nCount;
+		/** total number of allocations ever made */
+		int64 m_nAllocCount;
+	};
+
+	/** 
+	* memory accounting and limits for a single NPL runtime state. 
+	* It is installed on top of whatever allocator the lua state is created with via lua_setallocf, and forwards every call to it.
+	* So it works with luajit2 on 64 bits systems, where luaL_newstate must be used, since blocks still come from luajit's own allocator.
+	* Like the lua state, it is single threaded, and no lock is needed.
+	*
+	* Size classes are 16,32,64,...,4096 and one for bigger blocks. Blocks allocated before Attach() are only counted in the total bytes.
+	* When an allocation crosses the soft limit (or the hard limit if there is no soft limit), a full gc is requested. 
+	* gc can not run inside the allocator, so a one-shot count hook is installed, which does a full gc before the next instruction
+	* and raises a "not enough memory" error only if memory is still over the hard limit afterwards.
+	* While the gc is pending, allocations may exceed the hard limit by at most 1/8 of it; beyond that they fail right away,
+	* since hooks are not called by luajit compiled code or inside a long C function.
+	* The owner also calls CheckSoftLimit() between activations.
+	*/
+	class CNPLStateMemTracker
+	{
+	public:
+		typedef void * (*LuaAllocFunction) (void *ud, void *ptr, size_t osize, size_t nsize);
+		const static int s_size_class_count = 10;
+
+		CNPLStateMemTracker();
+
+		/** install on the lua state. the current allocator of the state is used for all blocks. */
+		void Attach(lua_State* L);
+		/** restore the original allocator. This must be called before lua_close, so that luajit can release its arena. */
+		void Detach(lua_State* L);
+
+		void* reallocate(void *ptr, size_t osize, size_t nsize);
+
+		/** if memory is over the soft limit, do a full gc, unless memory has hardly grown since the last one.
+		* it must not be called inside the allocator.
+		* @return false if memory is still over the soft limit. */
+		bool CheckSoftLimit();
+
+		/** 0 to disable. in bytes */
+		void SetHardLimit(int64 nBytes) { m_nHardLimit = nBytes; }
+		int64 GetHardLimit() const { return m_nHardLimit; }
+		void SetSoftLimit(int64 nBytes) { m_nSoftLimit = nBytes; }
+		int64 GetSoftLimit() const { return m_nSoftLimit; }
+		bool IsOverSoftLimit() const { return m_nSoftLimit > 0 && m_nBytes > m_nSoftLimit; }
+
+		int64 GetBytes() const { return m_nBytes; }
+		int64 GetPeakBytes() const { return m_nPeakBytes; }
+		/** number of allocations refused by the hard limit */
+		int64 GetFailedCount() const { return m_nFailedCount; }
+		/** the last size class is for blocks bigger than 4096 bytes */
+		const NPLMemSizeClassStats& GetSizeClassStats(int nIndex) const { return m_classes[nIndex]; }
+		/** max block size of a size class, or -1 for the last class */
+		static int GetSizeClassSize(int nIndex);
+
+	protected:
+		static int GetSizeClassIndex(size_t nSize);
+
+		/** whether an allocation that brings memory to nBytes should request a full gc. */
+		bool IsGCNeeded(int64 nBytes) const;
+		/** install the gc hook on the lua state. */
+		void RequestGC();
+		/** do a full gc now. */
+		void CollectGarbage();
+		/** count hook installed by RequestGC() */
+		static void GCHook(lua_State* L, lua_Debug* ar);
+
+	private:
+		LuaAllocFunction m_pInnerAlloc;
+		void* m_pInnerUserData;
+		lua_State* m_pState;
+		/** hook of the state, which is restored when GCHook is called */
+		void (*m_pSavedHook)(lua_State* L, lua_Debug* ar);
+		int m_nSavedHookMask;
+		int m_nSavedHookCount;
+		bool m_bGCPending;
+		/** memory in bytes after the last full gc */
+		int64 m_nLastGCBytes;
+		int64 m_nBytes;
+		int64 m_nPeakBytes;
+		int64 m_nHardLimit;
+		int64 m_nSoftLimit;
+		int64 m_nFailedCount;
+		NPLMemSizeClassStats m_classes[s_size_class_count];
+	};
+
+	/** lua allocator function of CNPLStateMemTracker. @param ud: must be CNPLStateMemTracker */
+	extern void * npl_mem_tracked_alloc(void *ud, void *ptr, size_t osize, size_t nsize);
 }// NPL
\ No newline at end of file
@@ -233,69 +233,19 @@ namespace NPL {
 				int nHTTPCode = -10;
 				if (CNPLRuntime::GetInstance()->GetNetServer()->GetDispatcher().CheckPubFile(filename, nHTTPCode))
 				{
-					// we need to check the input
+					// the request is delivered as a structured message, so that the body is neither escaped nor compiled. 
 					NPLMessage_ptr msg_(new NPLMessage());
 					msg_->m_filename = filename;
-
-					int nSize = (int)(msg.m_code.size());
-					msg_->m_code.reserve(nSize + 36);
-					msg_->m_code.append("msg={");
-
-					// add url or the "OK", "Error" string in response's first line
-					msg_->m_code.append("url=");
-					NPLHelper::EncodeStringInQuotation(msg_->m_code, msg_->m_code.size(), msg.m_filename);
-					msg_->m_code.append(",");
-
-					// add method: GET, POST,  HTTP/1.1, etc. 
-					msg_->m_code.append("method=");
-					NPLHelper::EncodeStringInQuotation(msg_->m_code, msg_->m_code.size(), msg.method);
-					msg_->m_code.append(",");
-
-					// rcode
-					msg_->m_code.append("rcode=");
-					msg_->m_code.append(msg.m_n_filename);
-					msg_->m_code.append(",");
-
-
-					// add headers
-					int nCount = (int)msg.headers.size();
-					for (int i = 0; i <nCount; ++i)
-					{
-						msg_->m_code.append("[");
-						NPLHelper::EncodeStringInQuotation(msg_->m_code, msg_->m_code.size(), msg.headers[i].name);
-						msg_->m_code.append("]=");
-						NPLHelper::EncodeStringInQuotation(msg_->m_code, msg_->m_code.size(), msg.headers[i].value);
-						msg_->m_code.append(",");
-					}
-
-					// add body
-					if (NPLHelper::CanEncodeStringInDoubleBrackets(msg.m_code.c_str(), (int)msg.m_code.size()))
-					{
-						msg_->m_code.append("body=[[");
-						msg_->m_code.append(msg.m_code);
-						msg_->m_code.append("]],");
-					}
-					else
-					{
-						msg_->m_code.append("body=");
-						NPLHelper::EncodeStringInQuotation(msg_->m_code, msg_->m_code.size(), msg.m_code);
-						msg_->m_code.append(",");
-					}
-
+					NPLHttpMessage* pHttpMsg = new NPLHttpMessage();
+					msg_->m_pHttpMsg = pHttpMsg;
+					pHttpMsg->m_url = msg.m_filename;
+					pHttpMsg->m_method = msg.method;
+					pHttpMsg->m_rcode = msg.m_n_filename;
+					pHttpMsg->m_headers.swap(msg.headers);
+					pHttpMsg->m_body.swap(msg.m_code);
 					// add nid or tid so that the runtime state can have access to the current connection object. 
-					// we append last to msg, so that nid or tid in the input message is overridden by the real value. 
-					if (m_server_address_map.find(msg.m_pRoute->GetNID()) != m_server_address_map.end())
-					{
-						msg_->m_code.append("nid=");
-						NPLHelper::EncodeStringInQuotation(msg_->m_code, msg_->m_code.size(), msg.m_pRoute->GetNID());
-						msg_->m_code.append("}");
-					}
-					else
-					{
-						msg_->m_code.append("tid=");
-						NPLHelper::EncodeStringInQuotation(msg_->m_code, msg_->m_code.size(), msg.m_pRoute->GetNID());
-						msg_->m_code.append(",nid=nil}");
-					}
+					pHttpMsg->m_nid = msg.m_pRoute->GetNID();
+					pHttpMsg->m_bAuthenticated = (m_server_address_map.find(msg.m_pRoute->GetNID()) != m_server_address_map.end());
 					return pRuntime->Activate_async(msg_);
 				}
 				else
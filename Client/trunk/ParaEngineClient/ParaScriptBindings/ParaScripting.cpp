@@ -452,6 +452,7 @@ void CNPLScriptingState::LoadParaScene()
 			def("Pick", & ParaScene::Pick),
 			def("MousePick", & ParaScene::MousePick),
 			def("GetObjectsBySphere", & ParaScene::GetObjectsBySphere),
+			def("GetObjectsBySpheres", & ParaScene::GetObjectsBySpheres),
 			def("GetObjectsByScreenRect", & ParaScene::GetObjectsByScreenRect),
 			def("SelectObject", & ParaScene::SelectObject),
 			def("SelectObject", & ParaScene::SelectObject1),
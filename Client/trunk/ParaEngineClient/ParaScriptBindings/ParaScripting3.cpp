@@ -147,6 +147,9 @@ void CNPLScriptingState::LoadHAPI_SceneManager()
 				def("SetChunkColumnTimeStamp", &ParaTerrain::SetChunkColumnTimeStamp),
 				def("GetMapChunkData", &ParaTerrain::GetMapChunkData),
 				def("ApplyMapChunkData", &ParaTerrain::ApplyMapChunkData),
+				def("GetMapChunkVersion", &ParaTerrain::GetMapChunkVersion),
+				def("GetMapChunkDelta", &ParaTerrain::GetMapChunkDelta),
+				def("ApplyMapChunkDelta", &ParaTerrain::ApplyMapChunkDelta),
 				def("GetBlockFullData", &ParaTerrain::GetBlockFullData, pure_out_value(_4) + pure_out_value(_5)),
 				def("SetBlockWorldSunIntensity",&ParaTerrain::SetBlockWorldSunIntensity)
 			]
@@ -342,6 +345,10 @@ void CNPLScriptingState::LoadHAPI_NPL()
 				def("accept", &CNPL::accept),
 				def("SetProtocol", &CNPL::SetProtocol),
 				def("reject", &CNPL::reject),
+				def("SendFile", &CNPL::SendFile3),
+				def("SendFile", &CNPL::SendFile4),
+				def("SendFile", &CNPL::SendFile5),
+				def("GetConnectionStats", &CNPL::GetConnectionStats),
 				def("SetUseCompression", &CNPL::SetUseCompression),
 				def("SetCompressionKey", &CNPL::SetCompressionKey),
 				def("GetAttributeObject", &CNPL::GetAttributeObject),
@@ -194,6 +194,7 @@ namespace ParaScripting
 					def("LeaveWorld", &ParaBlockWorld::LeaveWorld),
 					def("GetBlockAttributeObject", &ParaBlockWorld::GetBlockAttributeObject),
 					def("SaveBlockWorld", &ParaBlockWorld::SaveBlockWorld),
+					def("SaveBlockWorldAsync", &ParaBlockWorld::SaveBlockWorldAsync),
 					def("LoadRegion", &ParaBlockWorld::LoadRegion),
 					def("UnloadRegion", &ParaBlockWorld::UnloadRegion),
 					def("RegisterBlockTemplate", &ParaBlockWorld::RegisterBlockTemplate),
@@ -202,6 +203,8 @@ namespace ParaScripting
 					def("GetBlockId", &ParaBlockWorld::GetBlockId),
 					def("SetBlockData", &ParaBlockWorld::SetBlockData),
 					def("GetBlockData", &ParaBlockWorld::GetBlockData),
+					def("SetBlocks", &ParaBlockWorld::SetBlocks),
+					def("GetBlocks", &ParaBlockWorld::GetBlocks),
 					def("GetBlocksInRegion", &ParaBlockWorld::GetBlocksInRegion),
 					def("SetBlockWorldSunIntensity", &ParaBlockWorld::SetBlockWorldSunIntensity),
 					def("FindFirstBlock", &ParaBlockWorld::FindFirstBlock),
@@ -210,6 +213,7 @@ namespace ParaScripting
 					// client only functions
 					def("GetVisibleChunkRegion", &ParaBlockWorld::GetVisibleChunkRegion),
 					def("Pick", &ParaBlockWorld::Pick),
+					def("PickBatch", &ParaBlockWorld::PickBatch),
 					def("MousePick", &ParaBlockWorld::MousePick),
 					def("SelectBlock", &ParaBlockWorld::SelectBlock),
 					def("SelectBlock1", &ParaBlockWorld::SelectBlock1),
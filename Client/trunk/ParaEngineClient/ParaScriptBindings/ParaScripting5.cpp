@@ -12,6 +12,7 @@
 #include "util/StringHelper.h"
 #include "util/bitlib_lua.h"
 #include "util/lua_pack.h"
+#include "NPL/NPLByteBuffer.h"
 
 using namespace ParaEngine;
 
@@ -244,6 +245,8 @@ void CNPLScriptingState::LoadHAPI_Globals()
 	lua_register(L, "luaopen_bit", luaopen_bit_local);
 	// load string.pack
 	lua_register(L, "luaopen_lua_pack", luaopen_lua_pack);
+	// load ByteBuffer
+	lua_register(L, "luaopen_bytebuffer", NPL::CNPLByteBuffer::luaopen_bytebuffer);
 
 #if defined(USE_NPL_CURL)
 	// load cURL
@@ -528,6 +531,8 @@ void CNPLScriptingState::LoadHAPI_Globals()
 				.def("ReadByte", &ParaFileObject::ReadByte)
 				.def("GetFileSize", &ParaFileObject::GetFileSize)
 				.def("ReadString", &ParaFileObject::ReadString, raw(_3))
+				.def("ReadBuffer", &ParaFileObject::ReadBuffer, raw(_3))
+				.def("WriteBuffer", &ParaFileObject::WriteBuffer)
 				.def("WriteString", &ParaFileObject::WriteString)
 				.def("WriteString", &ParaFileObject::WriteString2)
 				.def("writeline", &ParaFileObject::writeline)
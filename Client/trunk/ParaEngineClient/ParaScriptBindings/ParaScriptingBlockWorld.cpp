@@ -346,6 +346,39 @@ uint32_t ParaScripting::ParaBlockWorld::GetBlockData(const object& pWorld_, uint
 	return pWorld->GetBlockUserDataByIdx(x,y,z);	
 }
 
+int ParaScripting::ParaBlockWorld::SetBlocks(const object& pWorld_, const object& sRecords, int nFlags)
+{
+	GETBLOCKWORLD(pWorld, pWorld_);
+	if (luabind::type(sRecords) != LUA_TSTRING)
+		return 0;
+	sRecords.push(L);
+	size_t nSize = 0;
+	// lua string buffers are suitably aligned for BlockRecord
+	const BlockRecord* pRecords = (const BlockRecord*)lua_tolstring(L, -1, &nSize);
+	int nCount = pWorld->SetBlocks(pRecords, (int)(nSize / sizeof(BlockRecord)), nFlags);
+	lua_pop(L, 1);
+	return nCount;
+}
+
+luabind::object ParaScripting::ParaBlockWorld::GetBlocks(const object& pWorld_, const object& sRecords)
+{
+	GETBLOCKWORLD(pWorld, pWorld_);
+	if (luabind::type(sRecords) != LUA_TSTRING)
+		return object();
+	sRecords.push(L);
+	size_t nSize = 0;
+	const char* pData = lua_tolstring(L, -1, &nSize);
+	int nCount = (int)(nSize / sizeof(BlockRecord));
+	std::vector<BlockRecord> records(nCount);
+	if (nCount > 0)
+		memcpy(&(records[0]), pData, nCount * sizeof(BlockRecord));
+	lua_pop(L, 1);
+	if (nCount == 0)
+		return object(L, std::string());
+	pWorld->GetBlocks(&(records[0]), nCount);
+	return object(L, std::string((const char*)(&(records[0])), nCount * sizeof(BlockRecord)));
+}
+
 luabind::object ParaScripting::ParaBlockWorld::GetBlocksInRegion(const object& pWorld_, int32_t startChunkX, int32_t startChunkY, int32_t startChunkZ, int32_t endChunkX, int32_t endChunkY, int32_t endChunkZ, uint32_t matchType, const object& result)
 {
 	GETBLOCKWORLD(pWorld, pWorld_);
@@ -441,6 +474,33 @@ luabind::object ParaScripting::ParaBlockWorld::Pick(const object& pWorld_, float
 	return object(result);
 }
 
+luabind::object ParaScripting::ParaBlockWorld::PickBatch(const object& pWorld_, const object& rays, float fMaxDistance, const object& result, uint32_t filter /*= 0xffffffff*/)
+{
+	GETBLOCKWORLD(pWorld, pWorld_);
+	if (pWorld && type(rays) == LUA_TTABLE && type(result) == LUA_TTABLE)
+	{
+		std::vector<Vector3> rayOrigs;
+		std::vector<Vector3> rayDirs;
+		for (int i = 1; type(rays[i + 5]) == LUA_TNUMBER; i += 6)
+		{
+			rayOrigs.push_back(Vector3((float)object_cast<double>(rays[i]), (float)object_cast<double>(rays[i + 1]), (float)object_cast<double>(rays[i + 2])));
+			rayDirs.push_back(Vector3((float)object_cast<double>(rays[i + 3]), (float)object_cast<double>(rays[i + 4]), (float)object_cast<double>(rays[i + 5])));
+		}
+		int nCount = (int)rayOrigs.size();
+		if (nCount > 0)
+		{
+			std::vector<float> lengths(nCount, fMaxDistance);
+			std::vector<PickResult> results(nCount);
+			pWorld->PickBatch(&rayOrigs[0], &rayDirs[0], &lengths[0], nCount, &results[0], filter);
+			for (int i = 0; i < nCount; ++i)
+			{
+				result[i + 1] = (results[i].Distance >= 0) ? results[i].Distance : (fMaxDistance + 10000);
+			}
+		}
+	}
+	return object(result);
+}
+
 luabind::object ParaScripting::ParaBlockWorld::MousePick(const object& pWorld_, float fMaxDistance, const object& result, uint32_t filter /*= 0xffffffff*/)
 {
 	GETBLOCKWORLD(pWorld, pWorld_);
@@ -507,6 +567,12 @@ void ParaScripting::ParaBlockWorld::SaveBlockWorld(const object& pWorld_, bool s
 	pWorld->SaveToFile(saveToTemp);
 }
 
+void ParaScripting::ParaBlockWorld::SaveBlockWorldAsync(const object& pWorld_, bool saveToTemp)
+{
+	GETBLOCKWORLD(pWorld, pWorld_);
+	pWorld->SaveToFileAsync(saveToTemp);
+}
+
 ParaScripting::ParaAttributeObject ParaScripting::ParaBlockWorld::GetBlockAttributeObject(const object& pWorld_)
 {
 	GETBLOCKWORLD(pWorld, pWorld_);
@@ -536,6 +602,16 @@ extern "C" {
 		return ((CBlockWorld*)pWorld)->GetBlockUserDataByIdx(x, y, z);
 	}
 
+	PE_CORE_DECL int ParaBlockWorld_SetBlocks(void* pWorld, const void* pRecords, int nCount, int nFlags)
+	{
+		return ((CBlockWorld*)pWorld)->SetBlocks((const BlockRecord*)pRecords, nCount, nFlags);
+	}
+
+	PE_CORE_DECL void ParaBlockWorld_GetBlocks(void* pWorld, void* pRecords, int nCount)
+	{
+		((CBlockWorld*)pWorld)->GetBlocks((BlockRecord*)pRecords, nCount);
+	}
+
 	PE_CORE_DECL int ParaBlockWorld_FindFirstBlock(void* pWorld, uint16_t x, uint16_t y, uint16_t z, uint16_t nSide /*= 4*/, uint32_t max_dist /*= 32*/, uint32_t attrFilter /*= 0xffffffff*/, int nCategoryID /*= -1*/)
 	{
 		return ((CBlockWorld*)pWorld)->FindFirstBlock(x, y, z, nSide, max_dist, attrFilter, nCategoryID);
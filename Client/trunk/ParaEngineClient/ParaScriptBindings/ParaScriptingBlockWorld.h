@@ -71,6 +71,11 @@ namespace ParaScripting
 
 		static void SaveBlockWorld(const object& pWorld, bool saveToTemp);
 
+		/** save modified regions in background threads. the world is only locked while taking a snapshot of modified regions.
+		* "OnSaveWorldCallbackScript" attribute of the block world is activated with msg={count, failed, temp} when finished.
+		*/
+		static void SaveBlockWorldAsync(const object& pWorld, bool saveToTemp);
+
 		/** load region at the given position. current implementation will load entire region rather than just chunk. 
 		* one need to call load chunk before SetBlock/GetBlock api can be called in the region. 
 		*/
@@ -97,6 +102,20 @@ namespace ParaScripting
 		*/
 		static uint32_t GetBlockData(const object& pWorld, uint16_t x, uint16_t y, uint16_t z);
 
+		/** set many blocks in one call, which is much faster than calling SetBlockId/SetBlockData for each block.
+		* @param sRecords: packed binary string of 12 bytes records, each is x,y,z,id as uint16 and data as uint32 in little endian.
+		*  such as string.pack("<HHHHI4", x, y, z, id, data) in lua 5.3, or a ffi array of the same struct in LuaJIT.
+		* @param nFlags: 1 to set id, 2 to set data, 3 for both.
+		* @return number of blocks whose id is changed.
+		*/
+		static int SetBlocks(const object& pWorld, const object& sRecords, int nFlags);
+
+		/** get many blocks in one call.
+		* @param sRecords: packed records in the same format as SetBlocks, only x,y,z of each record is used.
+		* @return packed records of the same size, with id and data filled in. nil if input is not a string.
+		*/
+		static object GetBlocks(const object& pWorld, const object& sRecords);
+
 		
 		/** get block in [startChunk,endChunk]
 		* @param result: in/out containing the result. 
@@ -153,6 +172,12 @@ namespace ParaScripting
 		*/
 		static object Pick(const object& pWorld, float rayX, float rayY, float rayZ, float dirX, float dirY, float dirZ, float fMaxDistance, const object& result, uint32_t filter = 0xffffffff);
 
+		/** cast many rays at once, such as line of sight checks for many NPCs. It does not select the hit block.
+		* @param rays: array of 6 numbers per ray, {rayX1, rayY1, rayZ1, dirX1, dirY1, dirZ1, rayX2, ...}
+		* @param result: result[i] is the hit distance of the i-th ray, or fMaxDistance+10000 if nothing is hit.
+		*/
+		static object PickBatch(const object& pWorld, const object& rays, float fMaxDistance, const object& result, uint32_t filter = 0xffffffff);
+
 		/**
 		picking by current mouse position.
 		only used on client world
@@ -1958,9 +1958,9 @@ bool ParaScripting::ParaGlobal::OpenFileDialog(const object& inout)
 
 double ParaScripting::ParaGlobal::getAccurateTime()
 {
-	static int64 start_time = CParaUtils::GetTimeMS();
-	double elapsedTime = (double)(CParaUtils::GetTimeMS() - start_time);
-	return elapsedTime / 1000;
+	static int64 start_time = GetTimeUS();
+	double elapsedTime = (double)(GetTimeUS() - start_time);
+	return elapsedTime / 1000000;
 }
 
 bool ParaScripting::ParaBootStrapper::LoadFromFile(const char* sXMLfile)
@@ -22,6 +22,7 @@
 #include "util/StringHelper.h"
 #include "NPLWriter.h"
 #include "NPLHelper.h"
+#include "NPLByteBuffer.h"
 #include <boost/thread/tss.hpp>
 
 #include <vector>
@@ -1173,6 +1174,34 @@ namespace ParaScripting
 		return object(L, "");
 	}
 
+	object ParaFileObject::ReadBuffer(int nCount, lua_State* L)
+	{
+		int nSize = 0;
+		if (IsValid())
+		{
+			int fromPos = (int)m_pFile->getPos();
+			nSize = (int)m_pFile->getSize() - fromPos;
+			if (nCount >= 0 && nCount < nSize)
+				nSize = nCount;
+		}
+		nSize = (std::max)(nSize, 0);
+		char* pData = NPL::CNPLByteBuffer::PushNewBuffer(L, nSize);
+		if (nSize > 0)
+			m_pFile->read(pData, nSize);
+		object o(from_stack(L, -1));
+		lua_pop(L, 1);
+		return o;
+	}
+
+	int ParaFileObject::WriteBuffer(const object& buffer)
+	{
+		int nSize = 0;
+		const char* pData = NPL::NPLHelper::LuaObjectToString(buffer, &nSize);
+		if (IsValid() && pData && nSize > 0)
+			return m_pFile->write(pData, nSize);
+		return 0;
+	}
+
 	void ParaFileObject::WriteString2(const char* buffer, int nSize)
 	{
 		return write(buffer, nSize);
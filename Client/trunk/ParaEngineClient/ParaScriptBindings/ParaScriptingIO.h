@@ -141,6 +141,9 @@ namespace ParaScripting
 		*/
 		object ReadString(int nCount, lua_State* L);
 
+		/** same as ReadString, except that a ByteBuffer is returned. see NPLByteBuffer.h */
+		object ReadBuffer(int nCount, lua_State* L);
+
 		/** write a string to the current file. */
 		void WriteString(const char* str);
 		/** write a buffer to the current file. */
@@ -149,6 +152,10 @@ namespace ParaScripting
 		/** write a buffer to the current file. */
 		void write(const char* buffer, int nSize);
 
+		/** write a string or ByteBuffer to the current file without copying it. 
+		* @return number of bytes written */
+		int WriteBuffer(const object& buffer);
+
 		/**
 		* write bytes to file; e.g. local nBytes = file:WriteBytes(3, {[1]=255, [2]=0, [3]=128});
 		* @param nSize: number of bytes to write
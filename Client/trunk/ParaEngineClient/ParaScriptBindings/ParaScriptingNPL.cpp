@@ -22,6 +22,8 @@ using namespace luabind;
 #include "NPLNetUDPServer.h"
 #include "NPLUDPRoute.h"
 #include "NPLHelper.h"
+#include "NPLByteBuffer.h"
+#include "NPLStateMemAllocator.h"
 #include "NPLCompiler.h"
 #include "ParaScriptingNPL.h"
 #include "ParaScriptingGlobal.h"
@@ -37,9 +39,10 @@ using namespace luabind;
 #elif defined USE_RAPID_JSON
 #include "external/json/rapidjson.h"
 #include "external/json/document.h"
-
-#else
+#elif defined USE_JSON_CPP
 #include "json/json.h"
+#else
+#include "NPLJson.h"
 #endif
 #include "UrlLoaders.h"
 #include "AsyncLoader.h"
@@ -57,6 +60,17 @@ buffers sizes on the order of 128K or 256K bytes should be used. */
 
 namespace ParaScripting
 {
+	/** if output.result is a ByteBuffer, data is written to it. otherwise output.result is set to a new string. */
+	static void SetCompressResult(const object& output, const std::string& data)
+	{
+		lua_State* L = output.interpreter();
+		object result = output["result"];
+		result.push(L);
+		bool bIsBuffer = NPL::CNPLByteBuffer::SetData(L, -1, data.c_str(), (int)data.size());
+		lua_pop(L, 1);
+		if (!bIsBuffer)
+			output["result"] = data;
+	}
 
 	// only used in NPL::GetStats
 	struct NPL_GetNidsStr_Iterator : public NPL::CNPLConnectionManager::NPLConnectionCallBack
@@ -1190,7 +1204,7 @@ namespace ParaScripting
             // ERROR: unknown type...
         }
     }
-#else
+#elif defined USE_JSON_CPP
 	template <class T>
 	void traverse(const Json::Value & var, const object& outTable, const T& sKey, bool bFirstTable=false)
 	{
@@ -1305,7 +1319,7 @@ namespace ParaScripting
                 return false;
             }
             traverse(doc, output, 0, true);
-#else
+#elif defined USE_JSON_CPP
 			Json::Value var;   // will contains the root value after parsing.
 			// strict mode: no comments are allowed, root must be array or object, and string must be in utf8
 			Json::Reader reader(Json::Features().strictMode());
@@ -1318,6 +1332,19 @@ namespace ParaScripting
 				return false;
 			}
 			traverse(var, output, 0, true);
+#else
+			// single pass parser that pushes values directly to the lua stack without any DOM. 
+			lua_State* L = output.interpreter();
+			int nTop = lua_gettop(L);
+			output.push(L);
+			const char* sError = NULL;
+			bool bSucceed = NPL::NPLJson::ParseToLuaTable(L, nTop + 1, sJson, -1, &sError);
+			lua_settop(L, nTop);
+			if (!bSucceed)
+			{
+				OUTPUT_LOG("warning: NPL.FromJson cannot parse input string. error message is %s\n", sError ? sError : "");
+				return false;
+			}
 #endif
 		}
 		catch (...)
@@ -1336,7 +1363,14 @@ namespace ParaScripting
 		{
 			std::string& sCode = runtime_state->GetStringBuffer(0);
 			sCode.clear();
+#if defined(USE_TINY_JSON) || defined(USE_RAPID_JSON) || defined(USE_JSON_CPP)
 			NPL::NPLHelper::SerializeToJson(input, sCode, 0, NULL, bUseEmptyArray);
+#else
+			lua_State* L = input.interpreter();
+			input.push(L);
+			NPL::NPLJson::WriteLuaValue(L, -1, sCode, bUseEmptyArray);
+			lua_pop(L, 1);
+#endif
 			return sCode;
 		}
 		else
@@ -1354,9 +1388,13 @@ namespace ParaScripting
 	{
 		if (type(output) == LUA_TTABLE)
 		{
-			std::string sMethod, content, outstring;
+			std::string sMethod, outstring;
 			NPL::NPLHelper::LuaObjectToString(output["method"], sMethod);
-			NPL::NPLHelper::LuaObjectToString(output["content"], content);
+			// content can be a string or ByteBuffer, which is read without copying.
+			int nContentSize = 0;
+			const char* content = NPL::NPLHelper::LuaObjectToString(output["content"], &nContentSize);
+			if (content == NULL)
+				return false;
 
 			int windowBits = 15;
 			if (type(output["windowBits"]) == LUA_TNUMBER)
@@ -1370,7 +1408,7 @@ namespace ParaScripting
 			}
 			
 
-			if (content.empty())
+			if (nContentSize == 0)
 				return false;
 			if (sMethod == "zlib")
 			{
@@ -1383,9 +1421,9 @@ namespace ParaScripting
 					return false;
 				}
 
-				zs.next_in = (Bytef*)content.c_str();
+				zs.next_in = (Bytef*)content;
 				// set the z_stream's input
-				zs.avail_in = (int)content.size();
+				zs.avail_in = nContentSize;
 
 				int ret;
 				char outbuffer[NPL_ZLIB_CHUNK];
@@ -1409,7 +1447,7 @@ namespace ParaScripting
 					OUTPUT_LOG("warning: NPL::Compress failed an error occurred that was not EOF.\n");
 					return false;
 				}
-				output["result"] = outstring;
+				SetCompressResult(output, outstring);
 				return true;
 			}
 			else if (sMethod == "gzip")
@@ -1425,9 +1463,9 @@ namespace ParaScripting
 					return false;
 				}
 
-				zs.next_in = (Bytef*)content.c_str();
+				zs.next_in = (Bytef*)content;
 				// set the z_stream's input
-				zs.avail_in = (int)content.size();
+				zs.avail_in = nContentSize;
 
 				int ret;
 				char outbuffer[NPL_ZLIB_CHUNK];
@@ -1451,7 +1489,7 @@ namespace ParaScripting
 					OUTPUT_LOG("warning: NPL::Compress failed an error occurred that was not EOF.\n");
 					return false;
 				}
-				output["result"] = outstring;
+				SetCompressResult(output, outstring);
 				return true;
 			}
 		}
@@ -1462,9 +1500,13 @@ namespace ParaScripting
 	{
 		if (type(output) == LUA_TTABLE)
 		{
-			std::string sMethod, content, outstring;
+			std::string sMethod, outstring;
 			NPL::NPLHelper::LuaObjectToString(output["method"], sMethod);
-			NPL::NPLHelper::LuaObjectToString(output["content"], content);
+			// content can be a string or ByteBuffer, which is read without copying.
+			int nContentSize = 0;
+			const char* content = NPL::NPLHelper::LuaObjectToString(output["content"], &nContentSize);
+			if (content == NULL)
+				return false;
 
 			int windowBits = 15;
 			if (type(output["windowBits"]) == LUA_TNUMBER)
@@ -1483,8 +1525,8 @@ namespace ParaScripting
 					return false;
 				}
 
-				zs.next_in = (Bytef*)content.c_str();
-				zs.avail_in = (int)content.size();
+				zs.next_in = (Bytef*)content;
+				zs.avail_in = nContentSize;
 
 				int ret;
 				char outbuffer[NPL_ZLIB_CHUNK];
@@ -1509,7 +1551,7 @@ namespace ParaScripting
 					OUTPUT_LOG("warning: NPL::Decompress inflateInit an error occurred that was not EOF\n");
 					return false;
 				}
-				output["result"] = outstring;
+				SetCompressResult(output, outstring);
 				return true;
 			}
 			else if (sMethod == "gzip")
@@ -1525,8 +1567,8 @@ namespace ParaScripting
 					return false;
 				}
 
-				zs.next_in = (Bytef*)content.c_str();
-				zs.avail_in = (int)content.size();
+				zs.next_in = (Bytef*)content;
+				zs.avail_in = nContentSize;
 
 				int ret;
 				char outbuffer[NPL_ZLIB_CHUNK];
@@ -1551,7 +1593,7 @@ namespace ParaScripting
 					OUTPUT_LOG("warning: NPL::Decompress inflateInit an error occurred that was not EOF\n");
 					return false;
 				}
-				output["result"] = outstring;
+				SetCompressResult(output, outstring);
 				return true;
 			}
 		}
@@ -1774,6 +1816,44 @@ namespace ParaScripting
 		NPL::CNPLRuntime::GetInstance()->NPL_reject(sNID, nReason);
 	}
 
+	object CNPL::GetConnectionStats(lua_State* L, const char* nid)
+	{
+		NPL::NPLConnection_ptr pConnection;
+		if (nid)
+			pConnection = NPL::CNPLRuntime::GetInstance()->GetNetServer()->GetDispatcher().GetNPLConnectionByNID(nid);
+		if (!pConnection)
+			return object();
+		int64 nTotalIn = 0, nTotalOut = 0;
+		pConnection->GetStatistics64(nTotalIn, nTotalOut);
+		object stats = newtable(L);
+		stats["queued_bytes"] = (double)pConnection->GetQueuedBytes();
+		stats["queued_count"] = pConnection->GetQueuedCount();
+		stats["dropped_count"] = pConnection->GetDroppedCount();
+		stats["dropped_bytes"] = (double)pConnection->GetDroppedBytes();
+		stats["total_in"] = (double)nTotalIn;
+		stats["total_out"] = (double)nTotalOut;
+		return stats;
+	}
+
+	int CNPL::SendFile5(const char* nid, const char* sHeader, const char* filename, const object& nOffset, const object& nSize)
+	{
+		// lua numbers are doubles, which are exact for offsets up to 2^53. 
+		int64 nFileOffset = (type(nOffset) == LUA_TNUMBER) ? (int64)object_cast<double>(nOffset) : 0;
+		int64 nFileSize = (type(nSize) == LUA_TNUMBER) ? (int64)object_cast<double>(nSize) : -1;
+		return NPL::CNPLRuntime::GetInstance()->NPL_SendFile(nid, sHeader, -1, filename, nFileOffset, nFileSize);
+	}
+
+	int CNPL::SendFile4(const char* nid, const char* sHeader, const char* filename, const object& nOffset)
+	{
+		int64 nFileOffset = (type(nOffset) == LUA_TNUMBER) ? (int64)object_cast<double>(nOffset) : 0;
+		return NPL::CNPLRuntime::GetInstance()->NPL_SendFile(nid, sHeader, -1, filename, nFileOffset, -1);
+	}
+
+	int CNPL::SendFile3(const char* nid, const char* sHeader, const char* filename)
+	{
+		return NPL::CNPLRuntime::GetInstance()->NPL_SendFile(nid, sHeader, -1, filename, 0, -1);
+	}
+
 	void CNPL::RegisterEvent(int nType, const char* sID, const char* sScript)
 	{
 		std::string strID = "_n";
@@ -1868,6 +1948,33 @@ namespace ParaScripting
 						}
 						output[sFieldName] = files_map;
 					}
+					else if (sFieldName == "memory")
+					{
+						// {bytes, peak, limit, softlimit, failed, classes={{size, bytes, count, allocs}, ...}}, size is -1 for large blocks
+						NPL::CNPLStateMemTracker* pTracker = m_rts->GetMemTracker();
+						if (pTracker)
+						{
+							luabind::object memory = luabind::newtable(input.interpreter());
+							memory["bytes"] = (double)pTracker->GetBytes();
+							memory["peak"] = (double)pTracker->GetPeakBytes();
+							memory["limit"] = (double)pTracker->GetHardLimit();
+							memory["softlimit"] = (double)pTracker->GetSoftLimit();
+							memory["failed"] = (double)pTracker->GetFailedCount();
+							luabind::object classes = luabind::newtable(input.interpreter());
+							for (int i = 0; i < NPL::CNPLStateMemTracker::s_size_class_count; ++i)
+							{
+								const NPL::NPLMemSizeClassStats& stats = pTracker->GetSizeClassStats(i);
+								luabind::object item = luabind::newtable(input.interpreter());
+								item["size"] = NPL::CNPLStateMemTracker::GetSizeClassSize(i);
+								item["bytes"] = (double)stats.m_nBytes;
+								item["count"] = (double)stats.m_nCount;
+								item["allocs"] = (double)stats.m_nAllocCount;
+								classes[i + 1] = item;
+							}
+							memory["classes"] = classes;
+							output[sFieldName] = memory;
+						}
+					}
 				}
 			}
 
@@ -452,6 +452,30 @@ namespace ParaScripting
 		/** this function is used by C++ API interface. */
 		static void reject_(const char* nid, int nReason = 0);
 
+		/** send a raw header followed by a range of a file to a given connection. It is mostly used for static files in http response. 
+		* The file is streamed by the network thread with sendfile when possible, and never loaded to lua, so the caller returns immediately. 
+		* It keeps the order of other messages sent to the same connection. Files in zip archives are read to memory. 
+		* [thread safe]
+		* @param nid: the nid or tid of the connection. usually it is from msg.tid or msg.nid. 
+		* @param sHeader: raw header, such as "HTTP/1.1 200 OK\r\nContent-Length: 100\r\n\r\n". The content length should be the file range size. 
+		* @param filename: the file to send. 
+		* @param nOffset: nil or file offset of the first byte to send. default to 0. it can be larger than 2GB. 
+		* @param nSize: nil or number of bytes to send. default to the end of file. 
+		* @return 0 if succeed. non-zero if file is not found or the connection does not exist, in which case nothing is sent. 
+		*/
+		static int SendFile5(const char* nid, const char* sHeader, const char* filename, const object& nOffset, const object& nSize);
+		/** same as SendFile5, but send from nOffset to the end of file. */
+		static int SendFile4(const char* nid, const char* sHeader, const char* filename, const object& nOffset);
+		/** same as SendFile5, but send the whole file. */
+		static int SendFile3(const char* nid, const char* sHeader, const char* filename);
+
+		/** get send queue statistics of a given TCP connection. 
+		* [thread safe]
+		* @param nid: nid or tid of the connection. 
+		* @return nil if connection is not found, or a table of {queued_bytes, queued_count, dropped_count, dropped_bytes, total_in, total_out}
+		*/
+		static object GetConnectionStats(lua_State* L, const char* nid);
+
 		/** whether to use compression on transport layer for incoming and outgoing connections
 		* @param bCompressIncoming: if true, compression is used for all incoming connections. default to false.
 		* @param bCompressIncoming: if true, compression is used for all outgoing connections. default to false.
@@ -732,7 +756,7 @@ namespace ParaScripting
 		*/
 		static bool ChangeRequestPoolSize(const char* sPoolName, int nCount);
 
-		/** convert json string to NPL object. Internally TinyJson is used.  
+		/** convert json string to NPL object. Internally NPLJson is used, which pushes values directly to the lua stack in a single pass.
 		* @param sJson: the json code to parse. the first level must be array or table. otherwise, false is returned. 
 		* @param output: [in|out] it must be a table. and usually empty table. the output is written to this table. 
 		* @return true if succeed. false if parsing failed. 
@@ -745,6 +769,7 @@ namespace ParaScripting
 
 		/** compress using zlib/gzip, etc
 		* @param output: {method="zlib|gzip", content=string, [level=number, windowBits=number,] result=string}
+		* content can also be a ByteBuffer. If result is a ByteBuffer before the call, the output is written to it instead of a new string.
 		* @return return true if success. 
 		*/
 		static bool Compress(const object& output);
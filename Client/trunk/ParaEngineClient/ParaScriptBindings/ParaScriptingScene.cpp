@@ -352,11 +352,8 @@ void ParaObject::SetPosition(double x, double y, double z)
 	*/
 	//m_pObj->SetPosition(&Vector3(x,y+CGlobals::GetGlobalTerrain()->GetElevation(x, z),z));
 
-	//{
-	//	/** since the object has moved, we may need to update its location in the scene graph 
-	//	* we only do this for static object.
-	//	*/
-	//}
+	// since the object has moved, update its location in the spatial index of the scene. 
+	CGlobals::GetScene()->GetRootTile()->OnObjectMoved(m_pObj.get());
 }
 
 void ParaObject::GetPosition(double *x, double *y, double *z)
@@ -493,7 +490,8 @@ void ParaObject::SetScale( float s )
 {
 	if(IsValid())
 	{
-		return m_pObj->SetScaling(s);
+		m_pObj->SetScaling(s);
+		CGlobals::GetScene()->GetRootTile()->OnObjectMoved(m_pObj.get());
 	}
 }
 
@@ -2557,6 +2555,37 @@ int ParaScene::GetObjectsBySphere( const object& inout, float x, float y, float
 	return nCount;
 }
 
+int ParaScene::GetObjectsBySpheres(const object& inout, const object& spheres, const char* sFilterFunc)
+{
+	if (type(inout) != LUA_TTABLE || type(spheres) != LUA_TTABLE)
+		return 0;
+	OBJECT_FILTER_CALLBACK pFilterFunc = GetFilterFuncByName(sFilterFunc);
+
+	std::vector<CShapeSphere> listSpheres;
+	for (int i = 1;; ++i)
+	{
+		object sphere = spheres[i];
+		if (type(sphere) != LUA_TTABLE)
+			break;
+		listSpheres.push_back(CShapeSphere(Vector3(object_cast_checkNumber(sphere[1]), object_cast_checkNumber(sphere[2]), object_cast_checkNumber(sphere[3])), object_cast_checkNumber(sphere[4])));
+	}
+	if (listSpheres.empty())
+		return 0;
+
+	std::vector<CBaseObject*> output;
+	std::vector<int> offsets;
+	int nCount = CGlobals::GetScene()->GetObjectsBySpheres(output, offsets, &(listSpheres[0]), (int)listSpheres.size(), pFilterFunc, true);
+	lua_State* L = inout.interpreter();
+	for (int i = 0; i < (int)listSpheres.size(); ++i)
+	{
+		object result = newtable(L);
+		for (int k = offsets[i]; k < offsets[i + 1]; ++k)
+			result[k - offsets[i] + 1] = ParaObject(output[k]);
+		inout[i + 1] = result;
+	}
+	return nCount;
+}
+
 void ParaScene::OnTerrainChanged( float x,float y, float fRadius )
 {
 	CGlobals::GetScene()->OnTerrainChanged(Vector3(x,0,y), fRadius);
@@ -1874,6 +1874,16 @@ namespace ParaScripting
 		*/
 		static int GetObjectsBySphere(const object& inout, float x, float y, float z, float radius, const char* sFilterFunc);
 
+		/**
+		* same as GetObjectsBySphere, but for many spheres in one call. It is much faster when there are many spheres, 
+		* such as AI perception of many characters, since the scene is only traversed once. 
+		* @param inout: input and output, it should be an empty table. inout[i] will be an array of objects in the i-th sphere. 
+		* @param spheres: array of spheres, such as {{x,y,z,radius}, {x,y,z,radius}, ...}
+		* @param sFnctFilter: same as GetObjectsBySphere
+		* @return: total number of objects found in all spheres. 
+		*/
+		static int GetObjectsBySpheres(const object& inout, const object& spheres, const char* sFilterFunc);
+
 		/**
 		* Get objects inside or intersect with a screen rect. screen rect is translated to a 3d cone from the camera eye position to a plane fMaxDistance away.
 		* This function is usually used for finding other static mesh objects near a certain character. 
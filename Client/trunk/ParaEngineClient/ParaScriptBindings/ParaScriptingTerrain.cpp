@@ -732,6 +732,52 @@ namespace ParaScripting
 		return out;
 	}
 
+	uint32 ParaTerrain::GetMapChunkVersion(uint32_t chunkX, uint32_t chunkZ)
+	{
+		BlockWorldClient* mgr = BlockWorldClient::GetInstance();
+		if (mgr)
+		{
+			BlockRegion* pRegion = mgr->CreateGetRegion((uint16_t)(chunkX >> 5), (uint16_t)(chunkZ >> 5));
+			if (pRegion)
+			{
+				return pRegion->GetMapChunkVersion(chunkX, chunkZ);
+			}
+		}
+		return 0;
+	}
+
+	const std::string& ParaTerrain::GetMapChunkDelta(uint32_t chunkX, uint32_t chunkZ, uint32 nLastVersion, uint32_t verticalSectionFilter)
+	{
+		BlockWorldClient* mgr = BlockWorldClient::GetInstance();
+		if (mgr)
+		{
+			BlockRegion* pRegion = mgr->CreateGetRegion((uint16_t)(chunkX >> 5), (uint16_t)(chunkZ >> 5));
+			if (pRegion)
+			{
+				return pRegion->GetMapChunkDelta(chunkX, chunkZ, nLastVersion, verticalSectionFilter);
+			}
+		}
+		return CGlobals::GetString();
+	}
+
+	object ParaTerrain::ApplyMapChunkDelta(uint32_t chunkX, uint32_t chunkZ, const std::string& chunkData, const object& out)
+	{
+		BlockWorldClient* mgr = BlockWorldClient::GetInstance();
+		if (mgr)
+		{
+			BlockRegion* pRegion = mgr->CreateGetRegion((uint16_t)(chunkX >> 5), (uint16_t)(chunkZ >> 5));
+			if (pRegion)
+			{
+				pRegion->ApplyMapChunkDelta(chunkX, chunkZ, chunkData, out);
+			}
+			else
+			{
+				OUTPUT_LOG("error: ApplyMapChunkDelta called when region is not loaded. ");
+			}
+		}
+		return out;
+	}
+
 
 	void ParaTerrain::GetBlockFullData(uint16_t x, uint16_t y, uint16_t z, uint16_t* pId, uint32_t* pUserData)
 	{
@@ -519,6 +519,20 @@ namespace ParaScripting
 
 		static object ApplyMapChunkData(uint32_t chunkX, uint32_t chunkZ, uint32_t verticalSectionFilter, const std::string& chunkData, const object& out);
 
+		/** modification version of the chunk column. Keep it for each client after sending chunk data to it,
+		* so that only changed blocks are sent next time with GetMapChunkDelta().
+		*/
+		static uint32 GetMapChunkVersion(uint32_t chunkX, uint32_t chunkZ);
+
+		/** get only the blocks changed after nLastVersion. It is much smaller than GetMapChunkData() after a few block edits.
+		* @param nLastVersion: GetMapChunkVersion() when the client was last synced. 0 to get all sections in full.
+		* @param verticalSectionFilter: default to 0xffff.  each bit is for one of the 16 vertical sections.
+		*/
+		static const std::string& GetMapChunkDelta(uint32_t chunkX, uint32_t chunkZ, uint32 nLastVersion, uint32_t verticalSectionFilter);
+
+		/** apply data returned by GetMapChunkDelta(). out has the same fields as ApplyMapChunkData(). */
+		static object ApplyMapChunkDelta(uint32_t chunkX, uint32_t chunkZ, const std::string& chunkData, const object& out);
+
 		/** get block id and userdata at the given block position. */
 		static void GetBlockFullData(uint16_t x, uint16_t y, uint16_t z, uint16_t* pId, uint32_t* pUserData);
 
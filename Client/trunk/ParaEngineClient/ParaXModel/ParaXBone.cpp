@@ -78,7 +78,8 @@ bool Bone::calcMatrix(Bone *allbones, const AnimIndex & CurrentAnim, const AnimI
 	if (IsStaticTransform() && IsTransformationNode())
 	{
 		if (parent >= 0) {
-			allbones[parent].calcMatrix(allbones, CurrentAnim, BlendingAnim, blendingFactor, pAnimInstance);
+			if (!allbones[parent].calc)
+				allbones[parent].calcMatrix(allbones, CurrentAnim, BlendingAnim, blendingFactor, pAnimInstance);
 			mat = matTransform * allbones[parent].mat;
 			if (allbones[parent].IsDummyNode() && !IsDummyNode())
 			{
@@ -325,7 +326,8 @@ bool Bone::calcMatrix(Bone *allbones, const AnimIndex & CurrentAnim, const AnimI
 		}
 
 		if (parent >= 0) {
-			allbones[parent].calcMatrix(allbones, CurrentAnim, BlendingAnim, blendingFactor, pAnimInstance);
+			if (!allbones[parent].calc)
+				allbones[parent].calcMatrix(allbones, CurrentAnim, BlendingAnim, blendingFactor, pAnimInstance);
 			mat = m * allbones[parent].mat;
 		}
 		else
@@ -534,7 +536,8 @@ bool Bone::calcMatrix(Bone *allbones, const AnimIndex & CurrentAnim, const AnimI
 
 
 		if (parent >= 0) {
-			allbones[parent].calcMatrix(allbones, CurrentAnim, BlendingAnim, blendingFactor, pAnimInstance);
+			if (!allbones[parent].calc)
+				allbones[parent].calcMatrix(allbones, CurrentAnim, BlendingAnim, blendingFactor, pAnimInstance);
 			mat = m * allbones[parent].mat;
 		}
 		else
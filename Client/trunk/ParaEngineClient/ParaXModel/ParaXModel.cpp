@@ -17,6 +17,7 @@
 #include "EdgeBuilder.h"
 #endif
 #include "SortedFaceGroups.h"
+#include "ParaXSkinning.h"
 #include "CustomCharCommon.h"
 #include "particle.h"
 #include "ParaXBone.h"
@@ -745,6 +746,34 @@ void CParaXModel::PostCalculateBoneMatrix(uint32 nBones)
 	}
 }
 
+const std::vector<int>& CParaXModel::GetBoneOrder()
+{
+	int nBones = (int)GetObjectNum().nBones;
+	if ((int)m_boneOrder.size() != nBones)
+	{
+		// sort by depth in the bone tree. depth is -1 if not known yet.
+		std::vector<int> depths(nBones, -1);
+		for (int i = 0; i < nBones; ++i)
+		{
+			int nDepth = 0;
+			int nBone = bones[i].parent;
+			// stop at a bone of known depth, or at most nBones steps in case of bad parent links.
+			for (; nBone >= 0 && nBone < nBones && depths[nBone] < 0 && nDepth < nBones; nBone = bones[nBone].parent)
+				++nDepth;
+			if (nBone >= 0 && nBone < nBones && depths[nBone] >= 0)
+				nDepth += depths[nBone] + 1;
+			depths[i] = nDepth;
+		}
+		m_boneOrder.resize(nBones);
+		for (int i = 0; i < nBones; ++i)
+			m_boneOrder[i] = i;
+		std::stable_sort(m_boneOrder.begin(), m_boneOrder.end(), [&depths](int a, int b) {
+			return depths[a] < depths[b];
+		});
+	}
+	return m_boneOrder;
+}
+
 void CParaXModel::calcBones()
 {
 	uint32 nBones = (uint32)GetObjectNum().nBones;
@@ -753,8 +782,8 @@ void CParaXModel::calcBones()
 		bones[i].MakeDirty();
 	}
 
-	for (uint32 i = 0; i < nBones; i++) {
-		bones[i].calcMatrix(bones);
+	for (int nBone : GetBoneOrder()) {
+		bones[nBone].calcMatrix(bones);
 	}
 	PostCalculateBoneMatrix(nBones);
 }
@@ -847,26 +876,24 @@ void CParaXModel::calcBones(CharacterPose* pPose, const AnimIndex& CurrentAnim,
 #ifdef PERFOAMRNCE_TEST_calcBones
 	PERF1("calcBones");
 #endif
-	vector<Matrix4> lower_mats;
-	vector<Matrix4> upper_mats;
-	lower_mats.reserve(nBones);
-	for (uint32 i = 0; i < nBones; i++) {
-		bones[i].calcMatrix(bones, CurrentAnim, BlendingAnim, blendingFactor, pAnimInstance);
-		lower_mats.push_back(bones[i].mat);
+	// parent bones are always calculated before their children, so that calcMatrix never recurse. 
+	const std::vector<int>& boneOrder = GetBoneOrder();
+	for (int nBone : boneOrder) {
+		bones[nBone].calcMatrix(bones, CurrentAnim, BlendingAnim, blendingFactor, pAnimInstance);
 	}
 	if (upperAnim.IsValid())
 	{
+		vector<Matrix4> lower_mats;
+		lower_mats.reserve(nBones);
 		for (uint32 i = 0; i < nBones; i++) {
+			lower_mats.push_back(bones[i].mat);
 			bones[i].MakeDirty();
 		}
-		for (uint32 i = 0; i < nBones; i++) {
-			bones[i].calcMatrix(bones, upperAnim, upperBlendingAnim, upperBlendingFactor, pAnimInstance);
-			upper_mats.push_back(bones[i].mat);
+		for (int nBone : boneOrder) {
+			bones[nBone].calcMatrix(bones, upperAnim, upperBlendingAnim, upperBlendingFactor, pAnimInstance);
 		}
 		for (uint32 i = 0; i < nBones; i++) {
-			if (bones[i].mIsUpper)
-				bones[i].mat = upper_mats[i];
-			else
+			if (!bones[i].mIsUpper)
 				bones[i].mat = lower_mats[i];
 		}
 	}
@@ -1645,7 +1672,6 @@ void CParaXModel::DrawPass(ModelRenderPass &p)
 #endif
 	RenderDevicePtr pd3dDevice = CGlobals::GetRenderDevice();
 	mesh_vertex_normal* vb_vertices = NULL;
-	ModelVertex *ov = m_origVertices;
 	int nVertexOffset = p.GetVertexStart(this);
 	int nNumLockedVertice;
 	int nNumFinishedVertice = 0;
@@ -1663,51 +1689,35 @@ void CParaXModel::DrawPass(ModelRenderPass &p)
 			{
 				PERF1("SoftSkinning");
 #endif
-				mesh_vertex_normal  vertex;
 				int nIndexOffset = p.m_nIndexStart + nNumFinishedVertice;
-				for (int i = 0; i < nLockedNum; ++i)
+				int nIndexCount = nLockedNum * 3;
+				// collect vertices that are not animated in this frame yet, and skin them in a single batch. 
+				// animated vertices are saved in m_vertices and m_normals in case they are reused in the same frame. 
+				m_skinningIndices.clear();
+				for (int i = 0; i < nIndexCount; ++i)
 				{
-					int nVB = 3 * i;
-					for (int k = 0; k < 3; ++k, ++nVB)
-					{
-						int a = m_indices[nIndexOffset + nVB] + nVertexOffset;
-						mesh_vertex_normal& out_vertex = vb_vertices[nVB];
-						// weighted vertex
-						ov = m_origVertices + a;
-
-						// uncomment to detect incorrect index. 
-						// assert(a < m_objNum.nVertices, "index overflow");
+					int a = m_indices[nIndexOffset + i] + nVertexOffset;
+					// uncomment to detect incorrect index. 
+					// assert(a < m_objNum.nVertices, "index overflow");
 
-						// TODO: m_nCurrentFrameNumber can not be replaced by CGlobals::GetViewportManager()->getCurrentFrameNumber()
-						if (m_frame_number_vertices[a] != m_nCurrentFrameNumber)
-						{
-							m_frame_number_vertices[a] = m_nCurrentFrameNumber;
-
-							float weight = ov->weights[0] * (1 / 255.0f);
-							Bone& bone = bones[ov->bones[0]];
-							Vector3 v = (ov->pos * bone.mat)*weight;
-							Vector3 n = ov->normal.TransformNormal(bone.mrot) * weight;
-							for (int b = 1; b < 4 && ov->weights[b]>0; b++) {
-								weight = ov->weights[b] * (1 / 255.0f);
-								Bone& bone = bones[ov->bones[b]];
-								v += (ov->pos * bone.mat) * weight;
-								n += ov->normal.TransformNormal(bone.mrot) * weight;
-							}
-							out_vertex.p = v;
-							out_vertex.n = n;
-
-							// save the animated vertex in case it is reused in the same frame. 
-							m_vertices[a] = v;
-							m_normals[a] = n;
-						}
-						else
-						{
-							out_vertex.p = m_vertices[a];
-							out_vertex.n = m_normals[a];
-						}
-						out_vertex.uv = ov->texcoords;
+					// TODO: m_nCurrentFrameNumber can not be replaced by CGlobals::GetViewportManager()->getCurrentFrameNumber()
+					if (m_frame_number_vertices[a] != m_nCurrentFrameNumber)
+					{
+						m_frame_number_vertices[a] = m_nCurrentFrameNumber;
+						m_skinningIndices.push_back(a);
 					}
 				}
+				if (!m_skinningIndices.empty())
+					CParaXSkinning::SkinVertices(m_origVertices, bones, &(m_skinningIndices[0]), (int)m_skinningIndices.size(), m_vertices, m_normals);
+
+				for (int i = 0; i < nIndexCount; ++i)
+				{
+					int a = m_indices[nIndexOffset + i] + nVertexOffset;
+					mesh_vertex_normal& out_vertex = vb_vertices[i];
+					out_vertex.p = m_vertices[a];
+					out_vertex.n = m_normals[a];
+					out_vertex.uv = m_origVertices[a].texcoords;
+				}
 #ifdef DO_PERFORMANCE_TEST
 			}
 #endif
@@ -2305,25 +2315,18 @@ HRESULT CParaXModel::ClonePhysicsMesh(DWORD* pNumVertices, Vector3 ** ppVerts, D
 				if (m_RenderMethod == SOFT_ANIM)
 				{
 					int nIndexOffset = pass.m_nIndexStart;
+					m_skinningIndices.clear();
 					for (int i = 0; i < pass.indexCount; ++i)
 					{
 						int a = m_indices[nIndexOffset + i] + nVertexOffset;
 						if (m_frame_number_vertices[a] != 1)
 						{
 							m_frame_number_vertices[a] = 1;
-							auto ov = m_origVertices + a;
-							float weight = ov->weights[0] * (1 / 255.0f);
-							Bone& bone = bones[ov->bones[0]];
-							Vector3 v = (ov->pos * bone.mat)*weight;
-							for (int b = 1; b < 4 && ov->weights[b]>0; b++)
-							{
-								weight = ov->weights[b] * (1 / 255.0f);
-								Bone& bone = bones[ov->bones[b]];
-								v += (ov->pos * bone.mat) * weight;
-							}
-							verts[a] = v;
+							m_skinningIndices.push_back(a);
 						}
 					}
+					if (!m_skinningIndices.empty())
+						CParaXSkinning::SkinVertices(m_origVertices, bones, &(m_skinningIndices[0]), (int)m_skinningIndices.size(), verts, NULL);
 				}
 
 #ifdef INVERT_PHYSICS_FACE_WINDING
@@ -157,6 +157,10 @@ namespace ParaEngine
 
 		void PostCalculateBoneMatrix(uint32 nBones);
 
+		/** bone indices sorted by parent, so that a parent bone always comes before its children. 
+		* calculating bones in this order never recurse into parent bones. It is built when first used. */
+		const std::vector<int>& GetBoneOrder();
+
 		/** calculate only specified bone in the attachment, all parent bones will also be calculated in order to get the matrix for the specified bone.
 		* @param pOut: the bone transform matrix.
 		* @param nAttachmentID: the bone index.
@@ -307,6 +311,8 @@ namespace ParaEngine
 		int* m_frame_number_vertices;
 		int m_nCurrentFrameNumber;
 		Vector3 * m_vertices, *m_normals;// the position and normals for the vertices
+		/** scratch list of vertices to be skinned in a batch by CParaXSkinning */
+		std::vector<int> m_skinningIndices;
 		Vector2 *texcoords1;// the texture coordinates for the vertices
 		uint16 *m_indices;
 
@@ -315,6 +321,8 @@ namespace ParaEngine
 
 		ModelCamera cam;
 		Bone *bones;
+		/** see GetBoneOrder() */
+		std::vector<int> m_boneOrder;
 		asset_ptr<TextureEntity> *textures;
 
 		std::vector<ModelRenderPass> passes;
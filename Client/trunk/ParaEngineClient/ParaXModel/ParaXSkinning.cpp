@@ -0,0 +1,119 @@
+//-----------------------------------------------------------------------------
+// Class:	CParaXSkinning
+// Authors:	LiXizhi
+// Emails:	LiXizhi@yeah.net
+// Company: ParaEngine
+// Date:	2026.10.18
+// Desc: batched cpu skinning kernel for soft animated ParaX models
+//-----------------------------------------------------------------------------
+#include "ParaEngine.h"
+#include "modelheaders.h"
+#include "ParaXBone.h"
+#include "ParaXSkinning.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PARAX_SKINNING_USE_SSE
+#endif
+
+using namespace ParaEngine;
+
+/** @def number of vertices ahead to prefetch original vertices */
+#define PARAX_SKINNING_PREFETCH_DISTANCE	4
+
+bool CParaXSkinning::IsSIMDEnabled()
+{
+#ifdef PARAX_SKINNING_USE_SSE
+	return true;
+#else
+	return false;
+#endif
+}
+
+#ifdef PARAX_SKINNING_USE_SSE
+void CParaXSkinning::SkinVertices(const ModelVertex* pVertices, const Bone* bones, const int* pVertexIndices, int nCount, Vector3* pOutPos, Vector3* pOutNormal)
+{
+	const __m128 fInv255 = _mm_set1_ps(1 / 255.0f);
+	float pos[4], normal[4];
+	for (int i = 0; i < nCount; ++i)
+	{
+		if ((i + PARAX_SKINNING_PREFETCH_DISTANCE) < nCount)
+			_mm_prefetch((const char*)(pVertices + pVertexIndices[i + PARAX_SKINNING_PREFETCH_DISTANCE]), _MM_HINT_T0);
+
+		const int a = pVertexIndices[i];
+		const ModelVertex& ov = pVertices[a];
+
+		// blend the rows of bone matrices by weights. mat is used for position, and mrot for normal.
+		const Bone& bone = bones[ov.bones[0]];
+		__m128 w = _mm_mul_ps(_mm_set1_ps((float)ov.weights[0]), fInv255);
+		__m128 m0 = _mm_mul_ps(_mm_loadu_ps(bone.mat.m[0]), w);
+		__m128 m1 = _mm_mul_ps(_mm_loadu_ps(bone.mat.m[1]), w);
+		__m128 m2 = _mm_mul_ps(_mm_loadu_ps(bone.mat.m[2]), w);
+		__m128 m3 = _mm_mul_ps(_mm_loadu_ps(bone.mat.m[3]), w);
+		__m128 r0 = _mm_mul_ps(_mm_loadu_ps(bone.mrot.m[0]), w);
+		__m128 r1 = _mm_mul_ps(_mm_loadu_ps(bone.mrot.m[1]), w);
+		__m128 r2 = _mm_mul_ps(_mm_loadu_ps(bone.mrot.m[2]), w);
+		for (int b = 1; b < 4 && ov.weights[b]>0; b++)
+		{
+			const Bone& bone = bones[ov.bones[b]];
+			w = _mm_mul_ps(_mm_set1_ps((float)ov.weights[b]), fInv255);
+			m0 = _mm_add_ps(m0, _mm_mul_ps(_mm_loadu_ps(bone.mat.m[0]), w));
+			m1 = _mm_add_ps(m1, _mm_mul_ps(_mm_loadu_ps(bone.mat.m[1]), w));
+			m2 = _mm_add_ps(m2, _mm_mul_ps(_mm_loadu_ps(bone.mat.m[2]), w));
+			m3 = _mm_add_ps(m3, _mm_mul_ps(_mm_loadu_ps(bone.mat.m[3]), w));
+			r0 = _mm_add_ps(r0, _mm_mul_ps(_mm_loadu_ps(bone.mrot.m[0]), w));
+			r1 = _mm_add_ps(r1, _mm_mul_ps(_mm_loadu_ps(bone.mrot.m[1]), w));
+			r2 = _mm_add_ps(r2, _mm_mul_ps(_mm_loadu_ps(bone.mrot.m[2]), w));
+		}
+
+		// row vector times matrix: v' = x*row0 + y*row1 + z*row2 + row3
+		__m128 p = _mm_add_ps(m3, _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(_mm_set1_ps(ov.pos.x), m0),
+			_mm_mul_ps(_mm_set1_ps(ov.pos.y), m1)),
+			_mm_mul_ps(_mm_set1_ps(ov.pos.z), m2)));
+		_mm_storeu_ps(pos, p);
+		pOutPos[a].x = pos[0]; pOutPos[a].y = pos[1]; pOutPos[a].z = pos[2];
+
+		if (pOutNormal)
+		{
+			__m128 n = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(_mm_set1_ps(ov.normal.x), r0),
+				_mm_mul_ps(_mm_set1_ps(ov.normal.y), r1)),
+				_mm_mul_ps(_mm_set1_ps(ov.normal.z), r2));
+			_mm_storeu_ps(normal, n);
+			pOutNormal[a].x = normal[0]; pOutNormal[a].y = normal[1]; pOutNormal[a].z = normal[2];
+		}
+	}
+}
+#else
+void CParaXSkinning::SkinVertices(const ModelVertex* pVertices, const Bone* bones, const int* pVertexIndices, int nCount, Vector3* pOutPos, Vector3* pOutNormal)
+{
+	for (int i = 0; i < nCount; ++i)
+	{
+		const int a = pVertexIndices[i];
+		const ModelVertex* ov = pVertices + a;
+		float weight = ov->weights[0] * (1 / 255.0f);
+		const Bone& bone = bones[ov->bones[0]];
+		Vector3 v = (ov->pos * bone.mat)*weight;
+		if (pOutNormal)
+		{
+			Vector3 n = ov->normal.TransformNormal(bone.mrot) * weight;
+			for (int b = 1; b < 4 && ov->weights[b]>0; b++) {
+				weight = ov->weights[b] * (1 / 255.0f);
+				const Bone& bone = bones[ov->bones[b]];
+				v += (ov->pos * bone.mat) * weight;
+				n += ov->normal.TransformNormal(bone.mrot) * weight;
+			}
+			pOutNormal[a] = n;
+		}
+		else
+		{
+			for (int b = 1; b < 4 && ov->weights[b]>0; b++) {
+				weight = ov->weights[b] * (1 / 255.0f);
+				v += (ov->pos * bones[ov->bones[b]].mat) * weight;
+			}
+		}
+		pOutPos[a] = v;
+	}
+}
+#endif
@@ -0,0 +1,30 @@
+#pragma once
+
+namespace ParaEngine
+{
+	struct ModelVertex;
+	class Bone;
+
+	/**
+	* batched cpu skinning of ParaX model vertices with up to 4 bones per vertex.
+	* Vertices to be skinned are first collected into an index list, so that the kernel runs as a tight loop without branching on frame numbers.
+	* When SSE is available, each row of the blended bone matrix is a SSE register, so that a vertex is blended and transformed
+	* with a few multiply-adds per bone, instead of 16 scalar multiply-adds per matrix.
+	*/
+	class CParaXSkinning
+	{
+	public:
+		/** skin the given vertices.
+		* @param pVertices: original vertices of the model
+		* @param bones: animated bones of the model.
+		* @param pVertexIndices: indices into pVertices of vertices to skin.
+		* @param nCount: number of indices in pVertexIndices
+		* @param pOutPos: animated position of vertex i is written to pOutPos[i], for each i in pVertexIndices.
+		* @param pOutNormal: animated normal of vertex i is written to pOutNormal[i]. It can be NULL, if normals are not needed.
+		*/
+		static void SkinVertices(const ModelVertex* pVertices, const Bone* bones, const int* pVertexIndices, int nCount, Vector3* pOutPos, Vector3* pOutNormal);
+
+		/** whether SSE kernel is compiled in. */
+		static bool IsSIMDEnabled();
+	};
+}
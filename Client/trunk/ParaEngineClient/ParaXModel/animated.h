@@ -23,7 +23,7 @@ namespace ParaEngine
 	class Animated : public IAnimated
 	{
 	public:
-		Animated() :used(false), type(INTERPOLATION_LINEAR), seq(-1), globals(0) {};
+		Animated() :used(false), type(INTERPOLATION_LINEAR), seq(-1), globals(0), m_nLastKeyIndex(0) {};
 		/** whether it is a constant value(not animated).*/
 		bool used;
 		/** interpolation of type Interpolations */
@@ -42,6 +42,10 @@ namespace ParaEngine
 		std::vector<T> data;
 		// for nonlinear interpolations:
 		std::vector<T> in, out;
+		/** the key index found by the last getValue() call. Since animations are mostly played forward, 
+		* the next call usually hits the same or the next key, so that no binary search is needed. 
+		* It is only a hint, which is always validated before use, since the same model may be shared by many characters. */
+		int m_nLastKeyIndex;
 
 		inline static float Absolute1(float v) { return fabs(v); };
 		inline static float Absolute1(double v) { return (float)abs(v); };
@@ -135,6 +139,23 @@ namespace ParaEngine
 				else if (range.first != range.second && time > times[range.first])
 				{
 					size_t pos = range.first; // this can be 0.
+					// try the same key as last time and the next one, before doing a binary search
+					int nHint = m_nLastKeyIndex;
+					if (nHint >= (int)range.first && nHint < (int)range.second && times[nHint] <= time)
+					{
+						if (time >= times[nHint + 1] && (nHint + 1) < (int)range.second)
+							++nHint;
+						if (time >= times[nHint + 1])
+							nHint = -1;
+					}
+					else
+						nHint = -1;
+
+					if (nHint >= 0)
+					{
+						pos = nHint;
+					}
+					else
 					{
 						/** by LiXizhi: use binary search for the time frame: 2005/09:
 						* modify the brutal force search by binary search
@@ -180,6 +201,7 @@ namespace ParaEngine
 							}
 						}// while(nStart<=nEnd)
 					}
+					m_nLastKeyIndex = (int)pos;
 					int t1 = times[pos];
 					int t2 = times[pos + 1];
 					float r = (time - t1) / (float)(t2 - t1);
@@ -97,7 +97,7 @@ static map<string,_performance_struct> _performance_data;
 /* CProfiler                                                            */
 /************************************************************************/
 CProfiler::CProfiler(const char* name)
-	: m_name(name)
+	: m_name(name), m_nTraceStartTime(0)
 {
 	Start();
 }
@@ -109,11 +109,18 @@ CProfiler::~CProfiler(void)
 
 void CProfiler::Start()
 {
+	if (ParaEngine::CTraceProfiler::IsEnabled())
+		m_nTraceStartTime = ParaEngine::GetTimeUS();
 	Start_S(m_name);
 }
 void CProfiler::Stop()
 {
 	Stop_S(m_name);
+	if (m_nTraceStartTime != 0)
+	{
+		ParaEngine::CTraceProfiler::GetInstance().AddEvent(m_name, "perf", m_nTraceStartTime, ParaEngine::GetTimeUS() - m_nTraceStartTime);
+		m_nTraceStartTime = 0;
+	}
 }
 void CProfiler::ResetRange_S(const char* name, int nFrom, int nMaxCount)
 {
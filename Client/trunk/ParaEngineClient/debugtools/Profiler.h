@@ -1,7 +1,9 @@
 #pragma once
 #include <string>
+#include "TraceProfiler.h"
 /** A C++ scope based profiler. It also support name based profiler.
 Scope based profiler is preferred, since its start()/stop() functions are guarenteed to be paired.
+When CTraceProfiler is enabled, scoped sections are also recorded as trace spans of the calling thread.
 Usage:
 {
 PERF()
@@ -21,6 +23,8 @@ public:
 	void Stop();
 private:
 	const char* m_name;
+	/** start time of the trace span, 0 if tracing is disabled. */
+	int64 m_nTraceStartTime;
 	static bool m_bEnableProfiling;
 public:
 	/* providing name based profiler */
@@ -47,8 +51,9 @@ public:
 #	define PERF_CLEAR(x) CProfiler::Clear_S((x));
 #	define PERF_REPORT() CProfiler::ReportAll_S();
 #else
-#	define PERF()
-#	define PERF1(x)
+/** without performance monitor, scoped sections are still recorded by the trace profiler if it is enabled at runtime. */
+#	define PERF() ParaEngine::CTraceScope profiler__(__FUNCTION__);
+#	define PERF1(x) ParaEngine::CTraceScope profiler__(x);
 #	define PERF_BEGIN(x)
 #	define PERF_END(x) 
 #	define PERF_CLEAR(x)
@@ -0,0 +1,294 @@
+//-----------------------------------------------------------------------------
+// Class: CTraceProfiler
+// Authors:	LiXizhi
+// Emails:	LiXizhi@yeah.net
+// Company: ParaEngine
+// Date:	2026.10.18
+// Desc: per thread ring buffer tracer that dumps Chrome trace/Perfetto json.
+//-----------------------------------------------------------------------------
+#include "ParaEngine.h"
+#include "util/ParaTime.h"
+#include "util/StringHelper.h"
+#include "NPLJson.h"
+#include "TraceProfiler.h"
+#include <boost/thread/tss.hpp>
+
+using namespace ParaEngine;
+
+std::atomic<bool> CTraceProfiler::s_bEnabled(false);
+
+namespace ParaEngine
+{
+	/** called when a thread exits. the buffer is kept, since its events may still be dumped. */
+	static void ReleaseTraceBuffer(CTraceBuffer* pBuffer)
+	{
+		if (pBuffer)
+			pBuffer->Release();
+	}
+	static boost::thread_specific_ptr<CTraceBuffer> g_thread_trace_buffer(ReleaseTraceBuffer);
+	/** thread name is kept separately, so that naming a thread does not allocate its ring buffer when tracing is disabled. */
+	static boost::thread_specific_ptr<std::string> g_thread_trace_name;
+}
+
+/************************************************************************/
+/* CTraceBuffer                                                         */
+/************************************************************************/
+CTraceBuffer::CTraceBuffer(int nThreadIndex, int nCapacity)
+	:m_nWriteCount(0), m_nThreadIndex(nThreadIndex), m_bInUse(true)
+{
+	m_events.resize(nCapacity > 0 ? nCapacity : 1);
+}
+
+void CTraceBuffer::AddEvent(const char* name, const char* category, int64 nStartTime, int64 nDuration, const char* sDetail, int64 nArg)
+{
+	ParaEngine::Lock lock_(m_mutex);
+	TraceEvent& event = m_events[(size_t)(m_nWriteCount % (int64)m_events.size())];
+	event.m_name = name;
+	event.m_category = category;
+	event.m_nStartTime = nStartTime;
+	event.m_nDuration = nDuration;
+	event.m_nArg = nArg;
+	if (sDetail)
+	{
+		strncpy(event.m_detail, sDetail, TRACE_EVENT_DETAIL_SIZE - 1);
+		event.m_detail[TRACE_EVENT_DETAIL_SIZE - 1] = '\0';
+	}
+	else
+		event.m_detail[0] = '\0';
+	++m_nWriteCount;
+}
+
+void CTraceBuffer::Clear()
+{
+	ParaEngine::Lock lock_(m_mutex);
+	m_nWriteCount = 0;
+}
+
+void CTraceBuffer::Resize(int nCapacity)
+{
+	ParaEngine::Lock lock_(m_mutex);
+	if (nCapacity <= 0 || nCapacity == (int)m_events.size())
+		return;
+	int64 nOldCapacity = (int64)m_events.size();
+	int64 nFirst = (std::max)(m_nWriteCount - nOldCapacity, m_nWriteCount - (int64)nCapacity);
+	if (nFirst < 0)
+		nFirst = 0;
+	std::vector<TraceEvent> events;
+	events.resize(nCapacity);
+	for (int64 k = nFirst; k < m_nWriteCount; ++k)
+		events[(size_t)(k - nFirst)] = m_events[(size_t)(k % nOldCapacity)];
+	m_events.swap(events);
+	m_nWriteCount -= nFirst;
+}
+
+void CTraceBuffer::SetThreadName(const char* sName)
+{
+	ParaEngine::Lock lock_(m_mutex);
+	m_sThreadName = sName ? sName : "";
+}
+
+void CTraceBuffer::Release()
+{
+	ParaEngine::Lock lock_(m_mutex);
+	m_bInUse = false;
+}
+
+/************************************************************************/
+/* CTraceScope                                                          */
+/************************************************************************/
+int64 CTraceScope::GetTimeUS()
+{
+	return ParaEngine::GetTimeUS();
+}
+
+/************************************************************************/
+/* CTraceProfiler                                                       */
+/************************************************************************/
+CTraceProfiler::CTraceProfiler()
+	:m_nBufferSize(TRACE_DEFAULT_BUFFER_SIZE)
+{
+}
+
+CTraceProfiler::~CTraceProfiler()
+{
+	// buffers are intentionally not freed, since thread exit callbacks may still reference them during process exit.
+	s_bEnabled.store(false, std::memory_order_relaxed);
+}
+
+CTraceProfiler& CTraceProfiler::GetInstance()
+{
+	static CTraceProfiler s_instance;
+	return s_instance;
+}
+
+void CTraceProfiler::SetEnabled(bool bEnable)
+{
+	s_bEnabled.store(bEnable, std::memory_order_relaxed);
+}
+
+void CTraceProfiler::SetBufferSize(int nEventCount)
+{
+	ParaEngine::Lock lock_(m_mutex);
+	m_nBufferSize = (nEventCount > 0) ? nEventCount : TRACE_DEFAULT_BUFFER_SIZE;
+	for (size_t i = 0; i < m_buffers.size(); ++i)
+	{
+		m_buffers[i]->Resize(m_nBufferSize);
+	}
+}
+
+int CTraceProfiler::GetBufferSize()
+{
+	return m_nBufferSize;
+}
+
+CTraceBuffer* CTraceProfiler::GetThreadBuffer()
+{
+	CTraceBuffer* pBuffer = g_thread_trace_buffer.get();
+	if (pBuffer == 0)
+	{
+		ParaEngine::Lock lock_(m_mutex);
+		// reuse the buffer of an exited thread if any, so that thread pools that come and go do not grow memory.
+		for (size_t i = 0; i < m_buffers.size() && pBuffer == 0; ++i)
+		{
+			CTraceBuffer* pOld = m_buffers[i];
+			ParaEngine::Lock lock2_(pOld->m_mutex);
+			if (!pOld->m_bInUse)
+			{
+				pOld->m_bInUse = true;
+				pOld->m_nWriteCount = 0;
+				pOld->m_sThreadName.clear();
+				pBuffer = pOld;
+			}
+		}
+		if (pBuffer == 0)
+		{
+			pBuffer = new CTraceBuffer((int)m_buffers.size() + 1, m_nBufferSize);
+			m_buffers.push_back(pBuffer);
+		}
+		if (g_thread_trace_name.get())
+			pBuffer->SetThreadName(g_thread_trace_name->c_str());
+		g_thread_trace_buffer.reset(pBuffer);
+	}
+	return pBuffer;
+}
+
+void CTraceProfiler::AddEvent(const char* name, const char* category, int64 nStartTime, int64 nDuration, const char* sDetail, int64 nArg)
+{
+	if (!IsEnabled())
+		return;
+	GetThreadBuffer()->AddEvent(name, category, nStartTime, nDuration, sDetail, nArg);
+}
+
+void CTraceProfiler::SetThreadName(const char* sName)
+{
+	if (!g_thread_trace_name.get())
+		g_thread_trace_name.reset(new std::string());
+	*g_thread_trace_name = sName ? sName : "";
+	if (g_thread_trace_buffer.get())
+		g_thread_trace_buffer->SetThreadName(sName);
+}
+
+void CTraceProfiler::Clear()
+{
+	ParaEngine::Lock lock_(m_mutex);
+	for (size_t i = 0; i < m_buffers.size(); ++i)
+	{
+		m_buffers[i]->Clear();
+	}
+}
+
+int CTraceProfiler::DumpChromeTrace(std::string& output)
+{
+	int nCount = 0;
+	char buf[40];
+	std::vector<TraceEvent> events;
+	std::string sThreadName;
+	output.append("{\"traceEvents\":[");
+
+	ParaEngine::Lock lock_(m_mutex);
+	for (size_t i = 0; i < m_buffers.size(); ++i)
+	{
+		CTraceBuffer* pBuffer = m_buffers[i];
+		int nThreadIndex = pBuffer->m_nThreadIndex;
+		{
+			// copy out the events in time order, so that recording threads are only blocked for a memcpy
+			ParaEngine::Lock lock2_(pBuffer->m_mutex);
+			int64 nCapacity = (int64)pBuffer->m_events.size();
+			int64 nFirst = (pBuffer->m_nWriteCount > nCapacity) ? (pBuffer->m_nWriteCount - nCapacity) : 0;
+			events.clear();
+			events.reserve((size_t)(pBuffer->m_nWriteCount - nFirst));
+			for (int64 k = nFirst; k < pBuffer->m_nWriteCount; ++k)
+				events.push_back(pBuffer->m_events[(size_t)(k % nCapacity)]);
+			sThreadName = pBuffer->m_sThreadName;
+		}
+		if (events.empty())
+			continue;
+
+		if (!sThreadName.empty())
+		{
+			if (nCount > 0)
+				output.append(",");
+			output.append("\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+			output.append(buf, StringHelper::fast_itoa(nThreadIndex, buf, 40));
+			output.append(",\"args\":{\"name\":");
+			NPL::NPLJson::EncodeString(output, sThreadName.c_str(), (int)sThreadName.size());
+			output.append("}}");
+			++nCount;
+		}
+		for (size_t k = 0; k < events.size(); ++k)
+		{
+			const TraceEvent& event = events[k];
+			if (nCount > 0)
+				output.append(",");
+			output.append("\n{\"name\":");
+			NPL::NPLJson::EncodeString(output, event.m_name, (int)strlen(event.m_name));
+			output.append(",\"cat\":");
+			NPL::NPLJson::EncodeString(output, event.m_category, (int)strlen(event.m_category));
+			output.append(",\"ph\":\"X\",\"pid\":1,\"tid\":");
+			output.append(buf, StringHelper::fast_itoa(nThreadIndex, buf, 40));
+			output.append(",\"ts\":");
+			output.append(buf, StringHelper::fast_itoa(event.m_nStartTime, buf, 40));
+			output.append(",\"dur\":");
+			output.append(buf, StringHelper::fast_itoa(event.m_nDuration, buf, 40));
+			if (event.m_detail[0] != '\0' || event.m_nArg >= 0)
+			{
+				output.append(",\"args\":{");
+				if (event.m_detail[0] != '\0')
+				{
+					output.append("\"detail\":");
+					NPL::NPLJson::EncodeString(output, event.m_detail, (int)strlen(event.m_detail));
+					if (event.m_nArg >= 0)
+						output.append(",");
+				}
+				if (event.m_nArg >= 0)
+				{
+					output.append("\"arg\":");
+					output.append(buf, StringHelper::fast_itoa(event.m_nArg, buf, 40));
+				}
+				output.append("}");
+			}
+			output.append("}");
+			++nCount;
+		}
+	}
+	output.append("\n],\"displayTimeUnit\":\"ms\"}\n");
+	return nCount;
+}
+
+int CTraceProfiler::DumpChromeTrace(const char* filename)
+{
+	if (filename == 0 || filename[0] == '\0')
+		return -1;
+	std::string output;
+	int nCount = DumpChromeTrace(output);
+	FILE* file = fopen(filename, "wb");
+	if (file == NULL)
+	{
+		OUTPUT_LOG("warning: can not open trace file %s\n", filename);
+		return -1;
+	}
+	fwrite(output.c_str(), 1, output.size(), file);
+	fclose(file);
+	OUTPUT_LOG("%d trace events are written to %s\n", nCount, filename);
+	return nCount;
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include "util/mutex.h"
+#include <atomic>
+#include <vector>
+#include <string>
+
+namespace ParaEngine
+{
+	/** max number of bytes (including the trailing '\0') kept for the detail string of a trace event. */
+#define TRACE_EVENT_DETAIL_SIZE		48
+	/** default number of events kept per thread. older events are overwritten. */
+#define TRACE_DEFAULT_BUFFER_SIZE	32768
+
+	/** a single completed span. name and category must be string literals or strings that outlive the profiler. */
+	struct TraceEvent
+	{
+		const char* m_name;
+		const char* m_category;
+		/** start time in microseconds */
+		int64 m_nStartTime;
+		/** duration in microseconds */
+		int64 m_nDuration;
+		/** optional integer argument, such as queue wait time in microseconds. -1 means none. */
+		int64 m_nArg;
+		/** optional copied detail string, such as the NPL file name */
+		char m_detail[TRACE_EVENT_DETAIL_SIZE];
+	};
+
+	/** per thread ring buffer of trace events. Only the owner thread writes to it, the lock is only contended during dump. */
+	class CTraceBuffer
+	{
+	public:
+		CTraceBuffer(int nThreadIndex, int nCapacity);
+
+		void AddEvent(const char* name, const char* category, int64 nStartTime, int64 nDuration, const char* sDetail, int64 nArg);
+		void Clear();
+		/** change capacity, keeping the most recent events. */
+		void Resize(int nCapacity);
+		void SetThreadName(const char* sName);
+		/** the owner thread has exited, so that this buffer can be reused by a new thread. */
+		void Release();
+	public:
+		ParaEngine::mutex m_mutex;
+		std::vector<TraceEvent> m_events;
+		/** total number of events ever written. m_events[m_nWriteCount % capacity] is the next slot. */
+		int64 m_nWriteCount;
+		int m_nThreadIndex;
+		std::string m_sThreadName;
+		bool m_bInUse;
+	};
+
+	/**
+	* Thread-aware trace profiler. Each thread records scoped spans to its own ring buffer,
+	* so recording never contends with other threads. Spans from all threads can be dumped at any time
+	* to Chrome trace / Perfetto json format, which can be opened by chrome://tracing or ui.perfetto.dev.
+	* PERF1 sections, NPL message activations, async IO requests and block world lock waits are recorded.
+	*
+	* Enable it with ParaEngine.GetAttributeObject():SetField("EnableTracing", true),
+	* and dump it with ParaEngine.GetAttributeObject():SetField("DumpTrace", "temp/trace.json").
+	*/
+	class CTraceProfiler
+	{
+	public:
+		CTraceProfiler();
+		~CTraceProfiler();
+		static CTraceProfiler& GetInstance();
+
+		/** it is safe to call from any thread, and it is the only cost when tracing is disabled. */
+		inline static bool IsEnabled() { return s_bEnabled.load(std::memory_order_relaxed); }
+		static void SetEnabled(bool bEnable);
+
+		/** number of events kept per thread. Existing buffers are resized at once, keeping their most recent events. */
+		void SetBufferSize(int nEventCount);
+		int GetBufferSize();
+
+		/** add a completed span for the calling thread.
+		* @param sDetail: it is copied and truncated to TRACE_EVENT_DETAIL_SIZE. can be NULL.
+		* @param nArg: optional integer arg. -1 if not used.
+		*/
+		void AddEvent(const char* name, const char* category, int64 nStartTime, int64 nDuration, const char* sDetail = NULL, int64 nArg = -1);
+
+		/** give the calling thread a name in the trace output. */
+		void SetThreadName(const char* sName);
+
+		/** clear all events of all threads. */
+		void Clear();
+
+		/** write all events to a Chrome trace json file.
+		* @return number of events written, or -1 if file can not be opened. */
+		int DumpChromeTrace(const char* filename);
+
+		/** write all events as Chrome trace json to output string. return number of events written. */
+		int DumpChromeTrace(std::string& output);
+
+	protected:
+		CTraceBuffer* GetThreadBuffer();
+
+	private:
+		/** only a hint for recording, so it is read and written with relaxed order. */
+		static std::atomic<bool> s_bEnabled;
+		ParaEngine::mutex m_mutex;
+		/** all buffers ever created. buffers of exited threads are reused by new threads. */
+		std::vector<CTraceBuffer*> m_buffers;
+		int m_nBufferSize;
+	};
+
+	/** scoped span. it only reads the time when tracing is enabled. */
+	class CTraceScope
+	{
+	public:
+		CTraceScope(const char* name, const char* category = "perf", const char* sDetail = NULL, int64 nArg = -1)
+			: m_name(name), m_category(category), m_sDetail(sDetail), m_nArg(nArg), m_nStartTime(0)
+		{
+			if (CTraceProfiler::IsEnabled())
+				m_nStartTime = GetTimeUS();
+		}
+		~CTraceScope()
+		{
+			if (m_nStartTime != 0)
+				CTraceProfiler::GetInstance().AddEvent(m_name, m_category, m_nStartTime, GetTimeUS() - m_nStartTime, m_sDetail, m_nArg);
+		}
+	private:
+		static int64 GetTimeUS();
+		const char* m_name;
+		const char* m_category;
+		const char* m_sDetail;
+		int64 m_nArg;
+		int64 m_nStartTime;
+	};
+}
+
+/** scoped trace span with a category such as "npl", "io", "lock" */
+#define TRACE_SCOPE(name, category) ParaEngine::CTraceScope trace_scope__(name, category);
+/** scoped trace span with a detail string that is copied when the span ends, such as a file name. */
+#define TRACE_SCOPE_DETAIL(name, category, detail, arg) ParaEngine::CTraceScope trace_scope__(name, category, detail, arg);
@@ -0,0 +1,159 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_CULLING_USE_SSE
+#endif
+
+namespace ParaEngine
+{
+	/**
+	* batch culling of bounding volumes in structure-of-arrays layout against a set of planes.
+	* It only depends on plain float arrays, so that it is shared by CShapeFrustum and can be tested on its own.
+	* Planes are given as nPlaneCount groups of 4 floats (normal.x, normal.y, normal.z, d); a point p is inside a plane if dot(normal,p)+d >= 0.
+	* A volume is culled only if it is entirely outside some plane. NaN distances never cull, in both the SSE and scalar code path.
+	*/
+	namespace FrustumCulling
+	{
+		/** whether TestBoxes() and TestSpheres() are compiled with SSE. */
+		inline bool IsSIMDEnabled()
+		{
+#ifdef FRUSTUM_CULLING_USE_SSE
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		inline void SetVisible(uint32_t* pVisibleMask, int nIndex)
+		{
+			pVisibleMask[nIndex >> 5] |= 1u << (nIndex & 31);
+		}
+
+		/** test an array of AABBs.
+		* a box with center c and half extent e is outside a plane, if dot(n,c) + d + dot(|n|,e) < 0.
+		* @param pVisibleMask: bit (i%32) of pVisibleMask[i/32] is set if box i is visible, and cleared otherwise. It must have at least (nCount+31)/32 elements.
+		* @param bUseSIMD: false to force the scalar code path, which gives the same result.
+		* @return number of visible boxes.
+		*/
+		inline int TestBoxes(const float* pPlanes, int nPlaneCount, const float* pMinX, const float* pMinY, const float* pMinZ,
+			const float* pMaxX, const float* pMaxY, const float* pMaxZ, int nCount, uint32_t* pVisibleMask, bool bUseSIMD = true)
+		{
+			memset(pVisibleMask, 0, ((nCount + 31) / 32)*sizeof(uint32_t));
+			int nVisibleCount = 0;
+			int i = 0;
+#ifdef FRUSTUM_CULLING_USE_SSE
+			if (bUseSIMD)
+			{
+				const __m128 fHalf = _mm_set1_ps(0.5f);
+				const __m128 fZero = _mm_setzero_ps();
+				for (; (i + 4) <= nCount; i += 4)
+				{
+					__m128 minX = _mm_loadu_ps(pMinX + i), maxX = _mm_loadu_ps(pMaxX + i);
+					__m128 minY = _mm_loadu_ps(pMinY + i), maxY = _mm_loadu_ps(pMaxY + i);
+					__m128 minZ = _mm_loadu_ps(pMinZ + i), maxZ = _mm_loadu_ps(pMaxZ + i);
+					__m128 cx = _mm_mul_ps(_mm_add_ps(minX, maxX), fHalf), ex = _mm_mul_ps(_mm_sub_ps(maxX, minX), fHalf);
+					__m128 cy = _mm_mul_ps(_mm_add_ps(minY, maxY), fHalf), ey = _mm_mul_ps(_mm_sub_ps(maxY, minY), fHalf);
+					__m128 cz = _mm_mul_ps(_mm_add_ps(minZ, maxZ), fHalf), ez = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), fHalf);
+					__m128 outside = _mm_setzero_ps();
+					for (int k = 0; k < nPlaneCount; ++k)
+					{
+						const float* plane = pPlanes + k * 4;
+						__m128 dist = _mm_add_ps(_mm_add_ps(
+							_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane[0])), _mm_mul_ps(cy, _mm_set1_ps(plane[1]))),
+							_mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane[2])), _mm_set1_ps(plane[3]))),
+							_mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(fabsf(plane[0]))), _mm_mul_ps(ey, _mm_set1_ps(fabsf(plane[1])))),
+							_mm_mul_ps(ez, _mm_set1_ps(fabsf(plane[2])))));
+						outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, fZero));
+					}
+					uint32_t nMask = (~(uint32_t)_mm_movemask_ps(outside)) & 0xf;
+					if (nMask != 0)
+					{
+						pVisibleMask[i >> 5] |= nMask << (i & 31);
+						nVisibleCount += (nMask & 1) + ((nMask >> 1) & 1) + ((nMask >> 2) & 1) + (nMask >> 3);
+					}
+				}
+			}
+#endif
+			// same operation order as the SSE path, so that both give the same result.
+			for (; i < nCount; ++i)
+			{
+				float cx = (pMinX[i] + pMaxX[i])*0.5f, ex = (pMaxX[i] - pMinX[i])*0.5f;
+				float cy = (pMinY[i] + pMaxY[i])*0.5f, ey = (pMaxY[i] - pMinY[i])*0.5f;
+				float cz = (pMinZ[i] + pMaxZ[i])*0.5f, ez = (pMaxZ[i] - pMinZ[i])*0.5f;
+				bool bOutside = false;
+				for (int k = 0; (k < nPlaneCount) && !bOutside; ++k)
+				{
+					const float* plane = pPlanes + k * 4;
+					float dist = ((cx*plane[0] + cy*plane[1]) + (cz*plane[2] + plane[3])) + ((ex*fabsf(plane[0]) + ey*fabsf(plane[1])) + ez*fabsf(plane[2]));
+					bOutside = dist < 0.f;
+				}
+				if (!bOutside)
+				{
+					SetVisible(pVisibleMask, i);
+					++nVisibleCount;
+				}
+			}
+			return nVisibleCount;
+		}
+
+		/** test an array of spheres. a sphere is outside a plane, if dot(n,center) + d + radius < 0.
+		* @param pVisibleMask, bUseSIMD: see TestBoxes()
+		* @return number of visible spheres.
+		*/
+		inline int TestSpheres(const float* pPlanes, int nPlaneCount, const float* pX, const float* pY, const float* pZ, const float* pRadius,
+			int nCount, uint32_t* pVisibleMask, bool bUseSIMD = true)
+		{
+			memset(pVisibleMask, 0, ((nCount + 31) / 32)*sizeof(uint32_t));
+			int nVisibleCount = 0;
+			int i = 0;
+#ifdef FRUSTUM_CULLING_USE_SSE
+			if (bUseSIMD)
+			{
+				const __m128 fZero = _mm_setzero_ps();
+				for (; (i + 4) <= nCount; i += 4)
+				{
+					__m128 x = _mm_loadu_ps(pX + i);
+					__m128 y = _mm_loadu_ps(pY + i);
+					__m128 z = _mm_loadu_ps(pZ + i);
+					__m128 r = _mm_loadu_ps(pRadius + i);
+					__m128 outside = _mm_setzero_ps();
+					for (int k = 0; k < nPlaneCount; ++k)
+					{
+						const float* plane = pPlanes + k * 4;
+						__m128 dist = _mm_add_ps(
+							_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane[0])), _mm_mul_ps(y, _mm_set1_ps(plane[1]))),
+							_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane[2])), _mm_add_ps(_mm_set1_ps(plane[3]), r)));
+						outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, fZero));
+					}
+					uint32_t nMask = (~(uint32_t)_mm_movemask_ps(outside)) & 0xf;
+					if (nMask != 0)
+					{
+						pVisibleMask[i >> 5] |= nMask << (i & 31);
+						nVisibleCount += (nMask & 1) + ((nMask >> 1) & 1) + ((nMask >> 2) & 1) + (nMask >> 3);
+					}
+				}
+			}
+#endif
+			for (; i < nCount; ++i)
+			{
+				bool bOutside = false;
+				for (int k = 0; (k < nPlaneCount) && !bOutside; ++k)
+				{
+					const float* plane = pPlanes + k * 4;
+					float dist = (pX[i] * plane[0] + pY[i] * plane[1]) + (pZ[i] * plane[2] + (plane[3] + pRadius[i]));
+					bOutside = dist < 0.f;
+				}
+				if (!bOutside)
+				{
+					SetVisible(pVisibleMask, i);
+					++nVisibleCount;
+				}
+			}
+			return nVisibleCount;
+		}
+	}
+}
@@ -12,6 +12,8 @@
 
 #include "ShapeFrustum.h"
 
+#include "FrustumCulling.h"
+
 using namespace ParaEngine;
 
 CShapeFrustum::CShapeFrustum()
@@ -48,12 +50,12 @@ void CShapeFrustum::UpdateFrustum( const Matrix4* matViewProj, bool bInversedMat
 	for (int i = 0; i < 8; i++)
 		ParaVec3TransformCoord(&vecFrustum[i], &vecFrustum[i], &mat);
 	
-	planeFrustum[0].redefine(vecFrustum[0], vecFrustum[1], vecFrustum[2] ); // Near
-	planeFrustum[5].redefine(vecFrustum[6], vecFrustum[7], vecFrustum[5] ); // Far
-	planeFrustum[1].redefine(vecFrustum[2], vecFrustum[6], vecFrustum[4] ); // Left
-	planeFrustum[2].redefine(vecFrustum[7], vecFrustum[3], vecFrustum[5] ); // Right
-	planeFrustum[4].redefine(vecFrustum[2], vecFrustum[3], vecFrustum[6] ); // Top
-	planeFrustum[3].redefine(vecFrustum[1], vecFrustum[0], vecFrustum[4] ); // Bottom
+	planeFrustum[PLANE_NEAR].redefine(vecFrustum[0], vecFrustum[1], vecFrustum[2] ); // Near
+	planeFrustum[PLANE_FAR].redefine(vecFrustum[6], vecFrustum[7], vecFrustum[5] ); // Far
+	planeFrustum[PLANE_LEFT].redefine(vecFrustum[2], vecFrustum[6], vecFrustum[4] ); // Left
+	planeFrustum[PLANE_RIGHT].redefine(vecFrustum[7], vecFrustum[3], vecFrustum[5] ); // Right
+	planeFrustum[PLANE_TOP].redefine(vecFrustum[2], vecFrustum[3], vecFrustum[6] ); // Top
+	planeFrustum[PLANE_BOTTOM].redefine(vecFrustum[1], vecFrustum[0], vecFrustum[4] ); // Bottom
 
 	//  build a bit-field that will tell us the indices for the nearest and farthest vertices from each plane...
 	for (int i=0; i<6; i++)
@@ -154,6 +156,62 @@ int CShapeFrustum::TestBox( const CShapeAABB* box ) const
 	return (intersect)?2 : 1;
 }
 
+bool CShapeFrustum::IsSIMDEnabled()
+{
+	return FrustumCulling::IsSIMDEnabled();
+}
+
+/** pack the selected planes as (normal.x, normal.y, normal.z, d) for FrustumCulling. return the number of planes. */
+static int PackPlanes(const Plane* planes, uint32 nPlaneMask, float* pPlanes)
+{
+	int nPlaneCount = 0;
+	for (int k = 0; k < 6; ++k)
+	{
+		if (nPlaneMask & (1 << k))
+		{
+			float* plane = pPlanes + (nPlaneCount++) * 4;
+			plane[0] = planes[k].normal.x;
+			plane[1] = planes[k].normal.y;
+			plane[2] = planes[k].normal.z;
+			plane[3] = planes[k].d;
+		}
+	}
+	return nPlaneCount;
+}
+
+int CShapeFrustum::TestBoxes(const CShapeAABBArray& boxes, uint32* pVisibleMask) const
+{
+	if (boxes.size() == 0)
+		return 0;
+	return TestBoxes(&boxes.m_minX[0], &boxes.m_minY[0], &boxes.m_minZ[0], &boxes.m_maxX[0], &boxes.m_maxY[0], &boxes.m_maxZ[0], boxes.size(), pVisibleMask);
+}
+
+int CShapeFrustum::TestBoxes(const float* pMinX, const float* pMinY, const float* pMinZ, const float* pMaxX, const float* pMaxY, const float* pMaxZ, int nCount, uint32* pVisibleMask) const
+{
+	float planes[24];
+	int nPlaneCount = PackPlanes(planeFrustum, PLANE_MASK_ALL, planes);
+	return FrustumCulling::TestBoxes(planes, nPlaneCount, pMinX, pMinY, pMinZ, pMaxX, pMaxY, pMaxZ, nCount, pVisibleMask);
+}
+
+int CShapeFrustum::TestSpheres(const float* pX, const float* pY, const float* pZ, const float* pRadius, int nCount, uint32* pVisibleMask, uint32 nPlaneMask) const
+{
+	float planes[24];
+	int nPlaneCount = PackPlanes(planeFrustum, nPlaneMask, planes);
+	return FrustumCulling::TestSpheres(planes, nPlaneCount, pX, pY, pZ, pRadius, nCount, pVisibleMask);
+}
+
+void CShapeAABBArray::clear()
+{
+	m_minX.clear(); m_minY.clear(); m_minZ.clear();
+	m_maxX.clear(); m_maxY.clear(); m_maxZ.clear();
+}
+
+void CShapeAABBArray::push_back(const Vector3& vMin, const Vector3& vMax)
+{
+	m_minX.push_back(vMin.x); m_minY.push_back(vMin.y); m_minZ.push_back(vMin.z);
+	m_maxX.push_back(vMax.x); m_maxY.push_back(vMax.y); m_maxZ.push_back(vMax.z);
+}
+
 bool ParaEngine::CShapeFrustum::CullPointWithPlane( int iPlane, const Vector3* vPos )
 {
 	return (planeFrustum[iPlane].PlaneDotCoord(*vPos) < 0.f);
@@ -5,10 +5,43 @@ namespace ParaEngine
 	class CShapeAABB;
 	class CShapeSphere;
 
+	/** axis aligned bounding boxes in structure-of-arrays layout, for batch culling with CShapeFrustum::TestBoxes(). */
+	struct CShapeAABBArray
+	{
+		std::vector<float> m_minX, m_minY, m_minZ;
+		std::vector<float> m_maxX, m_maxY, m_maxZ;
+
+		void clear();
+		void push_back(const Vector3& vMin, const Vector3& vMax);
+		inline int size() const { return (int)m_minX.size(); }
+	};
+
 	/** a general view frustum class.*/
 	class CShapeFrustum
 	{
 	public:
+		/** index of planes in planeFrustum, see UpdateFrustum() */
+		enum FrustumPlane
+		{
+			PLANE_NEAR = 0,
+			PLANE_LEFT = 1,
+			PLANE_RIGHT = 2,
+			PLANE_BOTTOM = 3,
+			PLANE_TOP = 4,
+			PLANE_FAR = 5,
+		};
+		/** bits of the plane mask of TestSpheres() */
+		enum FrustumPlaneMask
+		{
+			PLANE_MASK_NEAR = 1 << PLANE_NEAR,
+			PLANE_MASK_LEFT = 1 << PLANE_LEFT,
+			PLANE_MASK_RIGHT = 1 << PLANE_RIGHT,
+			PLANE_MASK_BOTTOM = 1 << PLANE_BOTTOM,
+			PLANE_MASK_TOP = 1 << PLANE_TOP,
+			PLANE_MASK_FAR = 1 << PLANE_FAR,
+			PLANE_MASK_ALL = 0x3f,
+		};
+
 		CShapeFrustum();
 		/** build a frustum from a camera (projection, or viewProjection) matrix*/
 		CShapeFrustum(const Matrix4* matrix);
@@ -21,6 +54,28 @@ namespace ParaEngine
 		* 0 is fast reject, 
 		*/
 		int  TestBox        ( const CShapeAABB* box ) const;
+
+		/** test an array of AABBs in a single call. Four boxes are tested per iteration with SSE when available. see FrustumCulling::TestBoxes()
+		* Unlike TestBox(), it does not tell inside from intersecting.
+		* @param pMinX, pMinY, pMinZ, pMaxX, pMaxY, pMaxZ: min and max corners of boxes, each array has nCount floats.
+		* @param pVisibleMask: bit (i%32) of pVisibleMask[i/32] is set if box i is inside or intersecting the frustum, and cleared otherwise.
+		*	it must have at least (nCount+31)/32 elements.
+		* @return number of visible boxes.
+		*/
+		int TestBoxes(const float* pMinX, const float* pMinY, const float* pMinZ, const float* pMaxX, const float* pMaxY, const float* pMaxZ, int nCount, uint32* pVisibleMask) const;
+		int TestBoxes(const CShapeAABBArray& boxes, uint32* pVisibleMask) const;
+
+		/** same as TestSphere(), but for an array of spheres.
+		* @param pX, pY, pZ, pRadius: centers and radius of spheres, each array has nCount floats.
+		* @param pVisibleMask: see TestBoxes()
+		* @param nPlaneMask: bit i is set to test against GetPlane(i), see FrustumPlaneMask. 
+		*	For example, (PLANE_MASK_ALL & ~PLANE_MASK_FAR) = 0x1f skips the far plane. 
+		* @return number of visible spheres.
+		*/
+		int TestSpheres(const float* pX, const float* pY, const float* pZ, const float* pRadius, int nCount, uint32* pVisibleMask, uint32 nPlaneMask = PLANE_MASK_ALL) const;
+
+		/** whether TestBoxes() and TestSpheres() are compiled with SSE. */
+		static bool IsSIMDEnabled();
 		
 		/** build a frustum from a camera (projection, or viewProjection) matrix
 		* @param matViewProj the view projection matrix. 
@@ -31,12 +86,12 @@ namespace ParaEngine
 		virtual void UpdateFrustum(const Matrix4* matViewProj, bool bInversedMatrix=false, float fNearPlane = 0.f, float fFarPlane = 1.f);
 
 		/** Get a given frustum plane.
-		* @param nIndex: 0 is near plane, 1 is far plane, 2-5 is left, right, top, bottom.  
+		* @param nIndex: see FrustumPlane. 0 is near plane, 1-4 is left, right, bottom, top, 5 is far plane. 
 		*/
 		inline Plane& GetPlane(int nIndex) {return planeFrustum[nIndex];}
 
 		/**  whether the point is inside a given plane. 
-		* @param iPlane: 0 is near plane, 1 is far plane, 2-5 is left, right, top, bottom.  
+		* @param iPlane: see FrustumPlane. 0 is near plane, 1-4 is left, right, bottom, top, 5 is far plane. 
 		*/
 		bool CullPointWithPlane(int iPlane, const Vector3* vPos);
 
@@ -565,6 +565,22 @@ float CGlobalTerrain::GetElevation(float x, float y)
 	return m_fDefaultHeight;
 }
 
+void CGlobalTerrain::GetElevationBatch(const float* pX, const float* pY, int nCount, float* pOutHeights)
+{
+	if (m_nTerrainType == LATTICED_TERRAIN)
+	{
+		if (m_pTerrainLattice)
+			return m_pTerrainLattice->GetElevationBatch(pX, pY, nCount, pOutHeights);
+	}
+	else if (m_nTerrainType == SINGLE_TERRAIN)
+	{
+		if (m_pTerrainSingle)
+			return m_pTerrainSingle->GetElevationBatchW(pX, pY, nCount, pOutHeights);
+	}
+	for (int i = 0; i < nCount; ++i)
+		pOutHeights[i] = m_fDefaultHeight;
+}
+
 // TODO: untested
 void CGlobalTerrain::SetVertexElevation(float x, float y, float fHeight)
 {
@@ -711,6 +727,27 @@ void CGlobalTerrain::GetNormal(float x, float y, float &normalX, float &normalY,
 	normalZ = 0;
 }
 
+void CGlobalTerrain::GetNormalBatch(const float* pX, const float* pY, int nCount, float* pNormalX, float* pNormalY, float* pNormalZ)
+{
+	// secretly swap y,z, since the terrain use z as the terrain height.
+	if (m_nTerrainType == LATTICED_TERRAIN)
+	{
+		if (m_pTerrainLattice)
+			return m_pTerrainLattice->GetNormalBatch(pX, pY, nCount, pNormalX, pNormalZ, pNormalY);
+	}
+	else if (m_nTerrainType == SINGLE_TERRAIN)
+	{
+		if (m_pTerrainSingle)
+			return m_pTerrainSingle->GetNormalBatchW(pX, pY, nCount, pNormalX, pNormalZ, pNormalY);
+	}
+	for (int i = 0; i < nCount; ++i)
+	{
+		pNormalX[i] = 0;
+		pNormalY[i] = 1.f;
+		pNormalZ[i] = 0;
+	}
+}
+
 void CGlobalTerrain::Paint(TextureEntity* detailTexture, float brushRadius, float brushIntensity, float maxIntensity, bool erase, float x, float y)
 {
 	if (brushRadius <= 0)
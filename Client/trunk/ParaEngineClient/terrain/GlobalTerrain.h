@@ -185,6 +185,14 @@ namespace ParaTerrain
 		/** get elevation at the world position. */
 		float GetElevation(float x, float y);
 
+		/** same as GetElevation() for nCount points. It is faster than calling GetElevation() per point,
+		* since the terrain tile is only looked up once for each run of points on the same tile.
+		* so sort nearby points together when possible.
+		* @param pX, pY: world x, z location of points
+		* @param pOutHeights: elevation of point i is written to pOutHeights[i]
+		*/
+		void GetElevationBatch(const float* pX, const float* pY, int nCount, float* pOutHeights);
+
 		/** get value of a given terrain region layer 
 		* @param x The x location of the point on the Terrain's surface in world units.
 		* @param y The y location of the point on the Terrain's surface in world units.
@@ -233,6 +241,8 @@ namespace ParaTerrain
 		/// \param normalY Gets filled with the surface normal y component
 		/// \param normalZ Gets filled with the surface normal z component
 		void GetNormal(float x, float y, float &normalX, float &normalY, float &normalZ);
+		/** same as GetNormal() for nCount points. see GetElevationBatch(). */
+		void GetNormalBatch(const float* pX, const float* pY, int nCount, float* pNormalX, float* pNormalY, float* pNormalZ);
 
 		/**
 		* Create and set the single tile based global terrain from height map and texture files.
@@ -762,6 +762,18 @@ float Terrain::GetElevationW(float x, float y) const
 {
 	return GetElevation(x- m_OffsetX,y- m_OffsetY);
 }
+void Terrain::GetElevationBatchW(const float* pX, const float* pY, int nCount, float* pOutHeights) const
+{
+	if (m_pVertices == NULL)
+	{
+		for (int i = 0; i < nCount; ++i)
+			pOutHeights[i] = DEFAULT_TERRAIN_HEIGHT;
+		return;
+	}
+	for (int i = 0; i < nCount; ++i)
+		pOutHeights[i] = GetElevation(pX[i] - m_OffsetX, pY[i] - m_OffsetY);
+}
+
 float Terrain::GetElevation(float x, float y) const
 {
 	if(m_pVertices == NULL)
@@ -843,6 +855,12 @@ void Terrain::GetNormalW(float x, float y, float &normalX, float &normalY, float
 	return GetNormal(x- m_OffsetX,y- m_OffsetY, normalX, normalY, normalZ);
 }
 
+void Terrain::GetNormalBatchW(const float* pX, const float* pY, int nCount, float* pNormalX, float* pNormalY, float* pNormalZ) const
+{
+	for (int i = 0; i < nCount; ++i)
+		GetNormal(pX[i] - m_OffsetX, pY[i] - m_OffsetY, pNormalX[i], pNormalY[i], pNormalZ[i]);
+}
+
 void Terrain::GetNormal(float x, float y, float &normalX, float &normalY, float &normalZ) const
 {
 	if(m_pVertices == NULL)
@@ -597,6 +597,11 @@ namespace ParaTerrain
 		/// \param x The x location of the point on the Terrain's surface in world units.
 		/// \param y The y location of the point on the Terrain's surface in world units.
 		float GetElevationW(float x, float y) const;
+		/** same as GetElevationW() for nCount points, which are usually all on this terrain tile.
+		* @param pX, pY: world x, y location of points
+		* @param pOutHeights: elevation of point i is written to pOutHeights[i]
+		*/
+		void GetElevationBatchW(const float* pX, const float* pY, int nCount, float* pOutHeights) const;
 
 		/** get value of a given terrain region layer 
 		* @param x The x location of the point on the Terrain's surface in local units.
@@ -628,6 +633,8 @@ namespace ParaTerrain
 		/// \param normalY Gets filled with the surface normal y component
 		/// \param normalZ Gets filled with the surface normal z component
 		void GetNormalW(float x, float y, float &normalX, float &normalY, float &normalZ) const;
+		/** same as GetNormalW() for nCount points, which are usually all on this terrain tile. */
+		void GetNormalBatchW(const float* pX, const float* pY, int nCount, float* pNormalX, float* pNormalY, float* pNormalZ) const;
 		/// \brief Returns the elevation (z-coordinate) in real units of the highest point on the terrain.
 		float GetMaxElevation() const;
 		/// \brief Returns the index of the vertex closest to the specified point.
@@ -299,6 +299,56 @@ void TerrainLattice::GetNormal(float x, float y, float &normalX, float &normalY,
 	}
 }
 
+int TerrainLattice::GetTileRunLength(const float* pX, const float* pY, int nCount, int& indexX, int& indexY)
+{
+	indexX = (int)(pX[0] / m_TerrainWidth);
+	indexY = (int)(pY[0] / m_TerrainHeight);
+	int nRunLength = 1;
+	while (nRunLength < nCount && (int)(pX[nRunLength] / m_TerrainWidth) == indexX && (int)(pY[nRunLength] / m_TerrainHeight) == indexY)
+		++nRunLength;
+	return nRunLength;
+}
+
+void TerrainLattice::GetElevationBatch(const float* pX, const float* pY, int nCount, float* pOutHeights)
+{
+	int indexX, indexY;
+	for (int i = 0; i < nCount;)
+	{
+		int nRunLength = GetTileRunLength(pX + i, pY + i, nCount - i, indexX, indexY);
+		Terrain *pTerrain = GetTerrain(indexX, indexY);
+		if (pTerrain != NULL)
+			pTerrain->GetElevationBatchW(pX + i, pY + i, nRunLength, pOutHeights + i);
+		else
+		{
+			for (int k = 0; k < nRunLength; ++k)
+				pOutHeights[i + k] = 0.0f;
+		}
+		i += nRunLength;
+	}
+}
+
+void TerrainLattice::GetNormalBatch(const float* pX, const float* pY, int nCount, float* pNormalX, float* pNormalY, float* pNormalZ)
+{
+	int indexX, indexY;
+	for (int i = 0; i < nCount;)
+	{
+		int nRunLength = GetTileRunLength(pX + i, pY + i, nCount - i, indexX, indexY);
+		Terrain *pTerrain = GetTerrain(indexX, indexY);
+		if (pTerrain != NULL)
+			pTerrain->GetNormalBatchW(pX + i, pY + i, nRunLength, pNormalX + i, pNormalY + i, pNormalZ + i);
+		else
+		{
+			for (int k = i; k < i + nRunLength; ++k)
+			{
+				pNormalX[k] = 0;
+				pNormalY[k] = 0;
+				pNormalZ[k] = 1.0f;
+			}
+		}
+		i += nRunLength;
+	}
+}
+
 ParaTerrain::DIRECTION TerrainLattice::GetOppositeDirection(ParaTerrain::DIRECTION direction)
 {
 	ParaTerrain::DIRECTION oppositeDirection;
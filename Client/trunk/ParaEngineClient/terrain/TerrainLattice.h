@@ -82,6 +82,10 @@ namespace ParaTerrain
 		void ModelViewMatrixChanged();
 		void Render();
 		float GetElevation(float x, float y);
+		/** same as GetElevation() for nCount points. The terrain tile is only looked up once for each run of points on the same tile.
+		* @param pOutHeights: elevation of point i is written to pOutHeights[i]
+		*/
+		void GetElevationBatch(const float* pX, const float* pY, int nCount, float* pOutHeights);
 
 		/** get value of a given terrain region layer
 		* @param x The x location of the point on the Terrain's surface in world units.
@@ -96,6 +100,8 @@ namespace ParaTerrain
 		/// \param normalY Gets filled with the surface normal y component
 		/// \param normalZ Gets filled with the surface normal z component
 		void GetNormal(float x, float y, float &normalX, float &normalY, float &normalZ);
+		/** same as GetNormal() for nCount points. The terrain tile is only looked up once for each run of points on the same tile. */
+		void GetNormalBatch(const float* pX, const float* pY, int nCount, float* pNormalX, float* pNormalY, float* pNormalZ);
 		float IntersectRay(float startX, float startY, float startZ, float dirX, float dirY, float dirZ, float &intersectX, float &intersectY, float &intersectZ, float fMaxDistance = INFINITY);
 
 		/** Set the height of the lowest visible terrain point. This may be used to render the ocean*/
@@ -323,6 +329,8 @@ namespace ParaTerrain
 		void Tessellate();
 		Terrain * CreateTerrainTile(int positionX, int positionY);
 		ParaTerrain::DIRECTION GetOppositeDirection(ParaTerrain::DIRECTION direction);
+		/** get the tile index of the first point, and the number of leading points on the same tile. nCount must be positive. */
+		int GetTileRunLength(const float* pX, const float* pY, int nCount, int& indexX, int& indexY);
 		Terrain *GetTerrainRelative(Terrain * pTerrain, int positionX, int positionY);
 		Terrain *GetTerrainRelative(Terrain * pTerrain, ParaTerrain::DIRECTION direction);
 		Terrain *LoadTerrain(int index);
@@ -0,0 +1,110 @@
+//-----------------------------------------------------------------------------
+// Class:	BlockLightBatchTest
+// Authors:	LiXizhi
+// Emails:	LiXizhi@yeah.net
+// Company: ParaEngine
+// Date:	2026.10.18
+// Desc: BlockLightBatch must relight each changed block at most once, and never relight blocks one by one in columns that are relit as a whole.
+// It also counts light block updates of a batch that clears blocks to air, compared with the old way, where the region setter
+// already marked each removed block dirty and the batch added it again.
+//-----------------------------------------------------------------------------
+#include "../BlockEngine/BlockLightBatch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <set>
+#include <tuple>
+
+using namespace ParaEngine;
+
+/** same as BLOCK_BATCH_COLUMN_RELIGHT_COUNT in BlockWorld.cpp */
+#define COLUMN_RELIGHT_COUNT	512
+
+struct Change
+{
+	uint16_t x, y, z;
+	bool m_bSunLight;
+};
+
+int main(int argc, char** argv)
+{
+	srand(1234);
+	std::vector<Change> changes;
+	// a 16*16*4 slab cleared to air, which fills one column over the relight count
+	for (int y = 60; y < 64; ++y)
+		for (int z = 0; z < 16; ++z)
+			for (int x = 0; x < 16; ++x)
+			{
+				Change c = { (uint16_t)(19200 + x), (uint16_t)y, (uint16_t)(19200 + z), true };
+				changes.push_back(c);
+			}
+	// scattered removals, some of them changed more than once in the batch
+	for (int i = 0; i < 2000; ++i)
+	{
+		Change c = { (uint16_t)(19300 + rand() % 64), (uint16_t)(rand() % 8), (uint16_t)(19300 + rand() % 64), (rand() % 2) == 0 };
+		changes.push_back(c);
+	}
+
+	BlockLightBatch batch(COLUMN_RELIGHT_COUNT);
+	for (auto& c : changes)
+		batch.AddBlock(c.x, c.y, c.z, c.m_bSunLight);
+
+	int nErrors = 0;
+	std::set<std::pair<uint16_t, uint16_t> > columns;
+	std::set<std::tuple<uint16_t, uint16_t, uint16_t> > blocks;
+	int nSunLightUpdates = 0;
+	int nBlocks = batch.Flush([&](uint16_t chunkX_ws, uint16_t chunkZ_ws) {
+		if (!columns.insert(std::make_pair(chunkX_ws, chunkZ_ws)).second)
+			++nErrors;
+	}, [&](uint16_t x, uint16_t y, uint16_t z, bool bSunLight) {
+		if (!blocks.insert(std::make_tuple(x, y, z)).second)
+		{
+			printf("block %d %d %d is relit twice\n", x, y, z);
+			++nErrors;
+		}
+		if (columns.find(std::make_pair((uint16_t)(x >> 4), (uint16_t)(z >> 4))) != columns.end())
+		{
+			printf("block %d %d %d is in a column that is already relit\n", x, y, z);
+			++nErrors;
+		}
+		if (bSunLight)
+			++nSunLightUpdates;
+	});
+
+	// every changed block is either relit or in a relit column
+	for (auto& c : changes)
+	{
+		if (blocks.find(std::make_tuple(c.x, c.y, c.z)) == blocks.end() && columns.find(std::make_pair((uint16_t)(c.x >> 4), (uint16_t)(c.z >> 4))) == columns.end())
+		{
+			printf("block %d %d %d is not relit\n", c.x, c.y, c.z);
+			++nErrors;
+			break;
+		}
+	}
+	if (columns.size() != 1 || nBlocks != (int)blocks.size())
+	{
+		printf("%d columns relit, expected 1\n", (int)columns.size());
+		++nErrors;
+	}
+
+	// the old way: the region setter marked block and sun light dirty for every removal, then the batch added them again
+	int nOldUpdates = 0;
+	for (auto& c : changes)
+	{
+		nOldUpdates += 2;
+		if (columns.find(std::make_pair((uint16_t)(c.x >> 4), (uint16_t)(c.z >> 4))) == columns.end())
+			nOldUpdates += c.m_bSunLight ? 2 : 1;
+	}
+	int nNewUpdates = nBlocks + nSunLightUpdates;
+	printf("%d changes, %d distinct blocks: %d light block updates and %d column relights, was %d light block updates\n",
+		(int)changes.size(), batch.GetBlockCount(), nNewUpdates, (int)columns.size(), nOldUpdates);
+	if (nNewUpdates >= nOldUpdates)
+		++nErrors;
+
+	if (nErrors > 0)
+	{
+		printf("TEST_FAILED: %d errors\n", nErrors);
+		return 1;
+	}
+	printf("TEST_PASSED\n");
+	return 0;
+}
@@ -0,0 +1,172 @@
+//-----------------------------------------------------------------------------
+// Class:	BlockRayCastTest
+// Authors:	LiXizhi
+// Emails:	LiXizhi@yeah.net
+// Company: ParaEngine
+// Date:	2026.10.18
+// Desc: 3D DDA ray casting with BlockRayCast::SkipEmptyCell must hit the same block, side and distance as the plain DDA. 
+//-----------------------------------------------------------------------------
+#include "../BlockEngine/BlockRayCast.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+using namespace ParaEngine;
+
+/** size of the test grid in blocks, and of an empty cell (chunk) */
+#define GRID_SIZE	64
+#define CELL_SIZE	16
+#define CELL_COUNT	(GRID_SIZE / CELL_SIZE)
+/** max ray length */
+#define MAX_RAY_DIST	200.f
+
+static bool s_blocks[GRID_SIZE][GRID_SIZE][GRID_SIZE];
+static bool s_cells[CELL_COUNT][CELL_COUNT][CELL_COUNT];
+
+struct RayHit
+{
+	int32_t m_block[3];
+	int32_t m_side;
+	float m_fDist;
+};
+
+/** the same 3D DDA as CBlockWorld::Pick with unit blocks. 
+* @param bSkipEmptyCell: whether to skip cells that have no blocks. */
+static bool CastRay(const float vOrig[3], const float vDir[3], bool bSkipEmptyCell, RayHit& hit)
+{
+	int32_t curBlockId[3], blockStep[3];
+	float errDist[3], delta[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		curBlockId[i] = (int32_t)floorf(vOrig[i]);
+		float fNextPos;
+		if (vDir[i] > 0)
+		{
+			blockStep[i] = 1;
+			fNextPos = (float)(curBlockId[i] + 1);
+		}
+		else
+		{
+			blockStep[i] = -1;
+			fNextPos = (float)curBlockId[i];
+		}
+		if (vDir[i] != 0)
+		{
+			float fInv = 1.0f / vDir[i];
+			errDist[i] = (fNextPos - vOrig[i]) * fInv;
+			delta[i] = blockStep[i] * fInv;
+		}
+		else
+		{
+			errDist[i] = 100000;
+			delta[i] = 0;
+		}
+	}
+	float distTraveled = 0;
+	int32_t side = 0;
+	bool bStepToNextBlock = true;
+	while (true)
+	{
+		if (!bStepToNextBlock)
+			bStepToNextBlock = true;
+		else
+		{
+			int nAxis;
+			if (errDist[0] < errDist[1])
+				nAxis = (errDist[0] < errDist[2]) ? 0 : 2;
+			else
+				nAxis = (errDist[1] < errDist[2]) ? 1 : 2;
+			distTraveled = errDist[nAxis];
+			curBlockId[nAxis] += blockStep[nAxis];
+			errDist[nAxis] += delta[nAxis];
+			side = (nAxis == 0) ? 0 : ((nAxis == 1) ? 4 : 2);
+		}
+		for (int i = 0; i < 3; ++i)
+		{
+			if (curBlockId[i] < 0 || curBlockId[i] >= GRID_SIZE)
+				return false;
+		}
+		if (bSkipEmptyCell && !s_cells[curBlockId[0] / CELL_SIZE][curBlockId[1] / CELL_SIZE][curBlockId[2] / CELL_SIZE])
+		{
+			int32_t cellMin[3], cellMax[3];
+			for (int i = 0; i < 3; ++i)
+			{
+				cellMin[i] = curBlockId[i] & ~(CELL_SIZE - 1);
+				cellMax[i] = cellMin[i] + CELL_SIZE;
+			}
+			distTraveled = BlockRayCast::SkipEmptyCell(curBlockId, blockStep, errDist, delta, cellMin, cellMax, side);
+			if (distTraveled > MAX_RAY_DIST)
+				return false;
+			bStepToNextBlock = false;
+			continue;
+		}
+		if (s_blocks[curBlockId[0]][curBlockId[1]][curBlockId[2]])
+		{
+			for (int i = 0; i < 3; ++i)
+				hit.m_block[i] = curBlockId[i];
+			hit.m_side = side;
+			hit.m_fDist = distTraveled;
+			return true;
+		}
+		if (distTraveled > MAX_RAY_DIST)
+			return false;
+	}
+}
+
+/** about 1/3 of the cells have blocks, and 1/50 of blocks in those cells are solid. */
+static void MakeRandomGrid()
+{
+	for (int x = 0; x < CELL_COUNT; ++x)
+		for (int y = 0; y < CELL_COUNT; ++y)
+			for (int z = 0; z < CELL_COUNT; ++z)
+				s_cells[x][y][z] = (rand() % 3) == 0;
+	for (int x = 0; x < GRID_SIZE; ++x)
+		for (int y = 0; y < GRID_SIZE; ++y)
+			for (int z = 0; z < GRID_SIZE; ++z)
+				s_blocks[x][y][z] = s_cells[x / CELL_SIZE][y / CELL_SIZE][z / CELL_SIZE] && (rand() % 50) == 0;
+}
+
+int main(int argc, char** argv)
+{
+	srand(1);
+	int nErrorCount = 0;
+	int nHitCount = 0;
+	for (int nGrid = 0; nGrid < 50; ++nGrid)
+	{
+		MakeRandomGrid();
+		for (int nRay = 0; nRay < 2000; ++nRay)
+		{
+			float vOrig[3], vDir[3];
+			for (int i = 0; i < 3; ++i)
+			{
+				vOrig[i] = 1 + (rand() % 6200) / 100.0f;
+				// axis aligned rays are included, since they have no boundary crossing in some axis.
+				vDir[i] = ((rand() % 10) == 0) ? 0.f : (rand() % 2001 - 1000) / 1000.0f;
+			}
+			float fLength = sqrtf(vDir[0] * vDir[0] + vDir[1] * vDir[1] + vDir[2] * vDir[2]);
+			if (fLength == 0)
+				continue;
+			for (int i = 0; i < 3; ++i)
+				vDir[i] /= fLength;
+
+			RayHit hit, hitSkip;
+			bool bHit = CastRay(vOrig, vDir, false, hit);
+			bool bHitSkip = CastRay(vOrig, vDir, true, hitSkip);
+			if (bHit)
+				++nHitCount;
+			if (bHit != bHitSkip || (bHit && (hit.m_block[0] != hitSkip.m_block[0] || hit.m_block[1] != hitSkip.m_block[1] || hit.m_block[2] != hitSkip.m_block[2]
+				|| hit.m_side != hitSkip.m_side || fabsf(hit.m_fDist - hitSkip.m_fDist) > 1e-3f)))
+			{
+				if (nErrorCount < 5)
+				{
+					printf("mismatch: ray (%f %f %f) dir (%f %f %f) hit %d/%d\n", vOrig[0], vOrig[1], vOrig[2], vDir[0], vDir[1], vDir[2], bHit ? 1 : 0, bHitSkip ? 1 : 0);
+				}
+				++nErrorCount;
+			}
+		}
+	}
+	printf("%d hits, %d mismatches\n", nHitCount, nErrorCount);
+	if (nErrorCount == 0 && nHitCount > 0)
+		printf("TEST_PASSED\n");
+	return (nErrorCount == 0 && nHitCount > 0) ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+//-----------------------------------------------------------------------------
+// Class:	LargeFileTest
+// Authors:	LiXizhi
+// Emails:	LiXizhi@yeah.net
+// Company: ParaEngine
+// Date:	2026.10.18
+// Desc: LargeFile::Seek and LargeFile::Tell must not truncate offsets beyond 2GB and 4GB, which CNPLConnection::SendFile relies on. 
+// It writes a few bytes at large offsets of a sparse temporary file, so it does not use much disk space. 
+//-----------------------------------------------------------------------------
+#include "../IO/LargeFile.h"
+#include <stdio.h>
+#include <string.h>
+
+using namespace ParaEngine;
+
+static int TestOffset(FILE* pFile, int64_t nOffset)
+{
+	const char marker[] = "NPL";
+	if (LargeFile::Seek(pFile, nOffset, SEEK_SET) != 0 || fwrite(marker, 1, sizeof(marker), pFile) != sizeof(marker))
+	{
+		printf("failed to write at offset %lld\n", (long long)nOffset);
+		return 1;
+	}
+	if (LargeFile::Tell(pFile) != nOffset + (int64_t)sizeof(marker))
+	{
+		printf("tell after write at offset %lld returns %lld\n", (long long)nOffset, (long long)LargeFile::Tell(pFile));
+		return 1;
+	}
+	// the same as SendFile: get the file size from the end, and then read the range back
+	if (LargeFile::Seek(pFile, 0, SEEK_END) != 0 || LargeFile::Tell(pFile) != nOffset + (int64_t)sizeof(marker))
+	{
+		printf("file size is %lld, expected %lld\n", (long long)LargeFile::Tell(pFile), (long long)(nOffset + sizeof(marker)));
+		return 1;
+	}
+	char buffer[sizeof(marker)] = { 0 };
+	if (LargeFile::Seek(pFile, nOffset, SEEK_SET) != 0 || fread(buffer, 1, sizeof(buffer), pFile) != sizeof(buffer) || memcmp(buffer, marker, sizeof(marker)) != 0)
+	{
+		printf("failed to read back at offset %lld\n", (long long)nOffset);
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	FILE* pFile = tmpfile();
+	if (pFile == 0)
+	{
+		printf("TEST_FAILED: can not create temporary file\n");
+		return 1;
+	}
+	int nFailed = 0;
+	// below 2GB, just above 2GB (the limit of long on windows), and above 4GB
+	const int64_t offsets[] = { 1000, 0x7fffffffLL - 1, 0x80000000LL + 100, 0x100000000LL + 12345 };
+	for (int64_t nOffset : offsets)
+		nFailed += TestOffset(pFile, nOffset);
+	fclose(pFile);
+
+	if (nFailed > 0)
+	{
+		printf("TEST_FAILED: %d offsets\n", nFailed);
+		return 1;
+	}
+	printf("TEST_PASSED\n");
+	return 0;
+}
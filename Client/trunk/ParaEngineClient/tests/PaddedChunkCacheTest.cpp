@@ -0,0 +1,108 @@
+//-----------------------------------------------------------------------------
+// Class:	PaddedChunkCacheTest
+// Authors:	LiXizhi
+// Emails:	LiXizhi@yeah.net
+// Company: ParaEngine
+// Date:	2026.10.18
+// Desc: PaddedChunkCache must return the same blocks and light as fetching them from the world for every neighbor of every block
+// in a chunk, while fetching each cell of the padded chunk at most once. CombineBrightness must match light type 3 of the light grid.
+//-----------------------------------------------------------------------------
+#include "../BlockEngine/PaddedChunkCache.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace ParaEngine;
+
+/** a synthetic world with deterministic blocks and light, which counts fetches per cell. */
+struct TestWorld
+{
+	int m_fetchCounts[NEIGHBOR_CACHE_DIM * NEIGHBOR_CACHE_DIM * NEIGHBOR_CACHE_DIM][2];
+	int m_nBlockFetches;
+	int m_nLightFetches;
+
+	TestWorld() : m_nBlockFetches(0), m_nLightFetches(0) { memset(m_fetchCounts, 0, sizeof(m_fetchCounts)); }
+
+	static int GetBlock(int x, int y, int z) { return ((x * 7 + y * 13 + z * 29) % 5 == 0) ? 0 : (x + 1) * 10000 + (y + 1) * 100 + (z + 1); }
+	static uint8_t GetBlockLight(int x, int y, int z) { return (uint8_t)((x * 3 + y + z * 5) & 0xf); }
+	static uint8_t GetSunLight(int x, int y, int z) { return (uint8_t)((x + y * 7 + z * 2) & 0xf); }
+};
+
+int main(int argc, char** argv)
+{
+	TestWorld world;
+	auto fetchBlock = [&world](int x, int y, int z) -> int {
+		world.m_fetchCounts[PaddedChunkCache<int>::GetIndex(x, y, z)][0]++;
+		world.m_nBlockFetches++;
+		return TestWorld::GetBlock(x, y, z);
+	};
+	auto fetchLight = [&world](int x, int y, int z, uint8_t* pLight) {
+		world.m_fetchCounts[PaddedChunkCache<int>::GetIndex(x, y, z)][1]++;
+		world.m_nLightFetches++;
+		pLight[0] = TestWorld::GetBlockLight(x, y, z);
+		pLight[1] = TestWorld::GetSunLight(x, y, z);
+	};
+
+	PaddedChunkCache<int> cache;
+	cache.Clear();
+	int nErrors = 0;
+	int nLookups = 0;
+	// visit all 27 neighbors of all blocks in the chunk, as FetchNearbyBlockInfo does
+	for (int y = 0; y < 16; ++y)
+		for (int z = 0; z < 16; ++z)
+			for (int x = 0; x < 16; ++x)
+				for (int i = 0; i < 27; ++i)
+				{
+					int nx = x + (i % 3) - 1, ny = y + (i / 9) - 1, nz = z + ((i / 3) % 3) - 1;
+					++nLookups;
+					if (cache.GetBlock(nx, ny, nz, fetchBlock) != TestWorld::GetBlock(nx, ny, nz))
+						++nErrors;
+					const uint8_t* pLight = cache.GetLight(nx, ny, nz, fetchLight);
+					if (pLight[0] != TestWorld::GetBlockLight(nx, ny, nz) || pLight[1] != TestWorld::GetSunLight(nx, ny, nz))
+						++nErrors;
+				}
+	const int nCellCount = NEIGHBOR_CACHE_DIM * NEIGHBOR_CACHE_DIM * NEIGHBOR_CACHE_DIM;
+	for (int i = 0; i < nCellCount; ++i)
+	{
+		if (world.m_fetchCounts[i][0] != 1 || world.m_fetchCounts[i][1] != 1)
+		{
+			if (nErrors < 10)
+				printf("cell %d fetched %d blocks and %d lights, expected 1\n", i, world.m_fetchCounts[i][0], world.m_fetchCounts[i][1]);
+			++nErrors;
+		}
+	}
+	printf("%d neighbor lookups: %d block fetches and %d light fetches, was %d each\n", nLookups, world.m_nBlockFetches, world.m_nLightFetches, nLookups);
+
+	// after Clear(), cells are fetched again
+	cache.Clear();
+	cache.GetBlock(3, 4, 5, fetchBlock);
+	if (world.m_fetchCounts[PaddedChunkCache<int>::GetIndex(3, 4, 5)][0] != 2)
+		++nErrors;
+
+	// CombineBrightness against the light grid formula for every light level and a few sun intensities
+	uint8_t blockLight[256], sunLight[256], brightness[256];
+	for (int i = 0; i < 256; ++i)
+	{
+		blockLight[i] = (uint8_t)(i & 0xf);
+		sunLight[i] = (uint8_t)(i >> 4);
+	}
+	float intensities[] = { 0.f, 0.3f, 0.5f, 0.77f, 1.f };
+	for (float fSunIntensity : intensities)
+	{
+		PaddedChunkCache<int>::CombineBrightness(blockLight, sunLight, 256, fSunIntensity, brightness);
+		for (int i = 0; i < 256; ++i)
+		{
+			uint8_t nSunLight = (uint8_t)(sunLight[i] * fSunIntensity);
+			uint8_t nExpected = (blockLight[i] > nSunLight ? blockLight[i] : nSunLight);
+			if (brightness[i] != nExpected)
+				++nErrors;
+		}
+	}
+
+	if (nErrors > 0)
+	{
+		printf("TEST_FAILED: %d errors\n", nErrors);
+		return 1;
+	}
+	printf("TEST_PASSED\n");
+	return 0;
+}
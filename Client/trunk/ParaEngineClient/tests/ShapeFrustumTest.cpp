@@ -0,0 +1,116 @@
+//-----------------------------------------------------------------------------
+// Class:	ShapeFrustumTest
+// Authors:	LiXizhi
+// Emails:	LiXizhi@yeah.net
+// Company: ParaEngine
+// Date:	2026.10.18
+// Desc: the SSE and scalar code path of FrustumCulling must give the same visibility mask. 
+//-----------------------------------------------------------------------------
+#include "../math/FrustumCulling.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+using namespace ParaEngine;
+
+static int s_nErrorCount = 0;
+
+#define TEST_CHECK(expr) if(!(expr)) { printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #expr); ++s_nErrorCount; }
+
+static float RandomFloat(float fFrom, float fTo)
+{
+	return fFrom + (fTo - fFrom) * (float)rand() / (float)RAND_MAX;
+}
+
+static bool IsVisible(const std::vector<uint32_t>& mask, int nIndex)
+{
+	return (mask[nIndex >> 5] & (1u << (nIndex & 31))) != 0;
+}
+
+/** six planes of an axis aligned box frustum [-10,10]^3, slightly tilted so that all normal components are used. */
+static void MakePlanes(float* pPlanes)
+{
+	const float normals[6][3] = { { 0, 0, 1 }, { 0, 0, -1 }, { 1, 0.2f, 0 }, { -1, 0.1f, 0 }, { 0.1f, 1, 0 }, { -0.2f, -1, 0.1f } };
+	for (int k = 0; k < 6; ++k)
+	{
+		float fLength = sqrtf(normals[k][0] * normals[k][0] + normals[k][1] * normals[k][1] + normals[k][2] * normals[k][2]);
+		pPlanes[k * 4] = normals[k][0] / fLength;
+		pPlanes[k * 4 + 1] = normals[k][1] / fLength;
+		pPlanes[k * 4 + 2] = normals[k][2] / fLength;
+		pPlanes[k * 4 + 3] = 10.f;
+	}
+}
+
+static void TestBoxes(const float* pPlanes)
+{
+	const int nCount = 1003;
+	std::vector<float> minX(nCount), minY(nCount), minZ(nCount), maxX(nCount), maxY(nCount), maxZ(nCount);
+	for (int i = 0; i < nCount; ++i)
+	{
+		minX[i] = RandomFloat(-20.f, 20.f); maxX[i] = minX[i] + RandomFloat(0.f, 4.f);
+		minY[i] = RandomFloat(-20.f, 20.f); maxY[i] = minY[i] + RandomFloat(0.f, 4.f);
+		minZ[i] = RandomFloat(-20.f, 20.f); maxZ[i] = minZ[i] + RandomFloat(0.f, 4.f);
+	}
+	// NaN boxes in both the SSE block and the scalar tail
+	minX[1] = NAN;
+	maxY[nCount - 1] = NAN;
+
+	std::vector<uint32_t> maskSIMD((nCount + 31) / 32), maskScalar((nCount + 31) / 32);
+	int nVisibleSIMD = FrustumCulling::TestBoxes(pPlanes, 6, &minX[0], &minY[0], &minZ[0], &maxX[0], &maxY[0], &maxZ[0], nCount, &maskSIMD[0], true);
+	int nVisibleScalar = FrustumCulling::TestBoxes(pPlanes, 6, &minX[0], &minY[0], &minZ[0], &maxX[0], &maxY[0], &maxZ[0], nCount, &maskScalar[0], false);
+	TEST_CHECK(nVisibleSIMD == nVisibleScalar);
+	TEST_CHECK(maskSIMD == maskScalar);
+	TEST_CHECK(nVisibleSIMD > 0 && nVisibleSIMD < nCount);
+	TEST_CHECK(IsVisible(maskSIMD, 1) && IsVisible(maskSIMD, nCount - 1));
+
+	// a box inside, and a box outside of the frustum
+	float fMin = -1.f, fMax = 1.f, fFarMin = 30.f, fFarMax = 31.f;
+	uint32_t nMask = 0;
+	TEST_CHECK(FrustumCulling::TestBoxes(pPlanes, 6, &fMin, &fMin, &fMin, &fMax, &fMax, &fMax, 1, &nMask) == 1 && nMask == 1);
+	TEST_CHECK(FrustumCulling::TestBoxes(pPlanes, 6, &fFarMin, &fMin, &fMin, &fFarMax, &fMax, &fMax, 1, &nMask) == 0 && nMask == 0);
+}
+
+static void TestSpheres(const float* pPlanes)
+{
+	const int nCount = 1002;
+	std::vector<float> x(nCount), y(nCount), z(nCount), radius(nCount);
+	for (int i = 0; i < nCount; ++i)
+	{
+		x[i] = RandomFloat(-20.f, 20.f);
+		y[i] = RandomFloat(-20.f, 20.f);
+		z[i] = RandomFloat(-20.f, 20.f);
+		radius[i] = RandomFloat(0.f, 3.f);
+	}
+	x[2] = NAN;
+	radius[nCount - 2] = NAN;
+
+	for (int nPlaneCount = 1; nPlaneCount <= 6; ++nPlaneCount)
+	{
+		std::vector<uint32_t> maskSIMD((nCount + 31) / 32), maskScalar((nCount + 31) / 32);
+		int nVisibleSIMD = FrustumCulling::TestSpheres(pPlanes, nPlaneCount, &x[0], &y[0], &z[0], &radius[0], nCount, &maskSIMD[0], true);
+		int nVisibleScalar = FrustumCulling::TestSpheres(pPlanes, nPlaneCount, &x[0], &y[0], &z[0], &radius[0], nCount, &maskScalar[0], false);
+		TEST_CHECK(nVisibleSIMD == nVisibleScalar);
+		TEST_CHECK(maskSIMD == maskScalar);
+		TEST_CHECK(IsVisible(maskSIMD, 2) && IsVisible(maskSIMD, nCount - 2));
+	}
+	// all spheres are visible without planes
+	std::vector<uint32_t> mask((nCount + 31) / 32);
+	TEST_CHECK(FrustumCulling::TestSpheres(pPlanes, 0, &x[0], &y[0], &z[0], &radius[0], nCount, &mask[0]) == nCount);
+}
+
+int main(int argc, char** argv)
+{
+	srand(1234);
+	float planes[24];
+	MakePlanes(planes);
+	printf("SIMD enabled: %s\n", FrustumCulling::IsSIMDEnabled() ? "true" : "false");
+	for (int i = 0; i < 20; ++i)
+	{
+		TestBoxes(planes);
+		TestSpheres(planes);
+	}
+	if (s_nErrorCount == 0)
+		printf("TEST_PASSED\n");
+	return s_nErrorCount == 0 ? 0 : 1;
+}
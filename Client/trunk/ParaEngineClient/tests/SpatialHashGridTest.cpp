@@ -0,0 +1,169 @@
+//-----------------------------------------------------------------------------
+// Class:	SpatialHashGridTest
+// Authors:	LiXizhi
+// Emails:	LiXizhi@yeah.net
+// Company: ParaEngine
+// Date:	2026.10.18
+// Desc: SpatialHashGrid queries must match brute force sphere tests after objects are added, moved and removed.
+// It also compares an incrementally updated grid with a grid that is rebuilt before each batch, on a 10k object scene.
+//-----------------------------------------------------------------------------
+#include "../3dengine/SpatialHashGrid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+using namespace ParaEngine;
+
+/** number of objects in the scene and size of the scene in world units */
+#define OBJECT_COUNT	10000
+#define WORLD_SIZE		1000.f
+/** number of frames, spheres per batch and objects moved per frame */
+#define FRAME_COUNT		50
+#define QUERY_COUNT		256
+#define MOVE_COUNT		100
+
+struct Sphere
+{
+	float x, y, z, r;
+};
+
+static float Random(float fMin, float fMax)
+{
+	return fMin + (fMax - fMin) * ((float)rand() / (float)RAND_MAX);
+}
+
+static Sphere RandomObject()
+{
+	Sphere s = { Random(0.f, WORLD_SIZE), Random(0.f, 50.f), Random(0.f, WORLD_SIZE), Random(0.5f, 4.f) };
+	// a few big objects, which are bigger than a cell
+	if ((rand() % 100) == 0)
+		s.r = Random(20.f, 60.f);
+	return s;
+}
+
+static bool Intersect(const Sphere& a, const Sphere& b)
+{
+	float dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+	float fRange = a.r + b.r;
+	return (dx*dx + dy*dy + dz*dz) <= fRange*fRange;
+}
+
+typedef SpatialHashGrid<int> Grid_type;
+
+static void Query(const Grid_type& grid, const Sphere& sphere, std::vector<int>& output)
+{
+	output.clear();
+	grid.Query(sphere.x, sphere.y, sphere.z, sphere.r, [&output](int nIndex) { output.push_back(nIndex); });
+}
+
+int main(int argc, char** argv)
+{
+	srand(1234);
+	std::vector<Sphere> objects(OBJECT_COUNT);
+	std::vector<bool> alive(OBJECT_COUNT, true);
+	Grid_type grid, rebuiltGrid;
+	for (int i = 0; i < OBJECT_COUNT; ++i)
+	{
+		objects[i] = RandomObject();
+		grid.Update(i, i, objects[i].x, objects[i].y, objects[i].z, objects[i].r);
+	}
+
+	std::vector<Sphere> spheres(QUERY_COUNT);
+	std::vector<int> result, expected;
+	int nMismatches = 0;
+	long long nHits = 0;
+	double fIncrementalTime = 0.0, fRebuildTime = 0.0;
+
+	for (int nFrame = 0; nFrame < FRAME_COUNT; ++nFrame)
+	{
+		// move some objects, and remove or re-add a few
+		std::vector<int> moved;
+		for (int i = 0; i < MOVE_COUNT; ++i)
+		{
+			int nIndex = rand() % OBJECT_COUNT;
+			objects[nIndex] = RandomObject();
+			moved.push_back(nIndex);
+		}
+		std::vector<int> toggled;
+		for (int i = 0; i < 10; ++i)
+			toggled.push_back(rand() % OBJECT_COUNT);
+		for (int i = 0; i < QUERY_COUNT; ++i)
+		{
+			Sphere s = { Random(0.f, WORLD_SIZE), Random(0.f, 50.f), Random(0.f, WORLD_SIZE), Random(1.f, 30.f) };
+			spheres[i] = s;
+		}
+
+		// incremental: only changed objects are updated
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int nIndex : moved)
+		{
+			if (alive[nIndex])
+				grid.Update(nIndex, nIndex, objects[nIndex].x, objects[nIndex].y, objects[nIndex].z, objects[nIndex].r);
+		}
+		for (int nIndex : toggled)
+		{
+			alive[nIndex] = !alive[nIndex];
+			if (alive[nIndex])
+				grid.Update(nIndex, nIndex, objects[nIndex].x, objects[nIndex].y, objects[nIndex].z, objects[nIndex].r);
+			else
+				grid.Remove(nIndex);
+		}
+		for (int i = 0; i < QUERY_COUNT; ++i)
+		{
+			Query(grid, spheres[i], result);
+			nHits += (long long)result.size();
+		}
+		fIncrementalTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		// rebuild: all objects are inserted again before each batch
+		start = std::chrono::high_resolution_clock::now();
+		rebuiltGrid.Clear();
+		for (int i = 0; i < OBJECT_COUNT; ++i)
+		{
+			if (alive[i])
+				rebuiltGrid.Update(i, i, objects[i].x, objects[i].y, objects[i].z, objects[i].r);
+		}
+		for (int i = 0; i < QUERY_COUNT; ++i)
+		{
+			Query(rebuiltGrid, spheres[i], result);
+			nHits -= (long long)result.size();
+		}
+		fRebuildTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		// verify with brute force
+		for (int i = 0; i < QUERY_COUNT; ++i)
+		{
+			Query(grid, spheres[i], result);
+			expected.clear();
+			for (int k = 0; k < OBJECT_COUNT; ++k)
+			{
+				if (alive[k] && Intersect(objects[k], spheres[i]))
+					expected.push_back(k);
+			}
+			std::sort(result.begin(), result.end());
+			if (result != expected)
+			{
+				if (nMismatches < 10)
+					printf("mismatch at frame %d sphere %d: %d objects, expected %d\n", nFrame, i, (int)result.size(), (int)expected.size());
+				++nMismatches;
+			}
+		}
+	}
+
+	if (grid.GetCount() != rebuiltGrid.GetCount() || nHits != 0)
+	{
+		printf("incremental grid has %d objects, rebuilt grid has %d objects, hit difference %lld\n", grid.GetCount(), rebuiltGrid.GetCount(), nHits);
+		++nMismatches;
+	}
+	printf("%d objects, %d frames of %d spheres: incremental %.2f ms, rebuild %.2f ms, speed up %.1fx\n",
+		OBJECT_COUNT, FRAME_COUNT, QUERY_COUNT, fIncrementalTime, fRebuildTime, fRebuildTime / (fIncrementalTime > 0.0 ? fIncrementalTime : 1.0));
+	if (nMismatches > 0)
+	{
+		printf("TEST_FAILED: %d mismatches\n", nMismatches);
+		return 1;
+	}
+	printf("TEST_PASSED\n");
+	return 0;
+}
@@ -0,0 +1,95 @@
+--[[
+Title: test of asset manifest file sync
+Author(s): LiXizhi
+Date: 2026/10/18
+Desc: asset manifest entries are downloaded from a file:// asset server, so that no http server is needed.
+It covers a fresh download, resuming from a partial file, dropping a corrupted partial file and a missing server file.
+Prints "TEST_PASSED" or "TEST_FAILED: reason", and exits with 0 or 1.
+Use Lib:
+-------------------------------------------------------
+npl tests/asset_manifest_sync.lua
+-------------------------------------------------------
+]]
+local server_dir = "temp/test_asset_server/";
+local manifest_file = "temp/test_asset_manifest.txt";
+
+local manifest = ParaEngine.GetAttributeObject():GetChild("AssetManager"):GetChild("CAssetManifest");
+
+local function WriteFile(filename, content)
+	ParaIO.CreateDirectory(filename);
+	local file = ParaIO.open(filename, "w");
+	assert(file:IsValid(), "can not write "..filename);
+	file:write(content, #content);
+	file:close();
+end
+
+local function ReadFile(filename)
+	local file = ParaIO.open(filename, "r");
+	if(file:IsValid()) then
+		local content = file:GetText(0, -1);
+		file:close();
+		return content;
+	end
+end
+
+-- add a file to the asset server, and return its manifest line and local cache file name.
+local function AddServerFile(key, content)
+	local md5 = ParaMisc.md5(content);
+	local line = string.format("%s.p,%s,%d", key, md5, #content);
+	WriteFile(server_dir..line, content);
+	return line, string.format("temp/cache/%s/%s%d", md5:sub(1, 1), md5, #content);
+end
+
+-- reload the manifest, so that download retry counts are reset, and sync all files.
+local function Sync(lines)
+	WriteFile(manifest_file, table.concat(lines, "\n"));
+	manifest:CallField("Clear");
+	manifest:SetField("LoadManifestFile", manifest_file);
+	manifest:CallField("SyncAllFilesBlocking");
+end
+
+local function Run()
+	ParaAsset.SetAssetServerUrl("file://"..ParaIO.GetCurDirectory(0)..server_dir);
+	manifest:SetField("Enabled", true);
+
+	local content = string.rep("asset manifest sync test data\n", 2000);
+	local line, local_file = AddServerFile("tests/asset_sync.txt", content);
+	local part_file = local_file..".part";
+
+	-- fresh download
+	ParaIO.DeleteFile(local_file);
+	ParaIO.DeleteFile(part_file);
+	Sync({line});
+	assert(ReadFile(local_file) == content, "fresh download");
+	assert(not ParaIO.DoesFileExist(part_file, false), "partial file is left after download");
+
+	-- resume from the first half
+	ParaIO.DeleteFile(local_file);
+	WriteFile(part_file, content:sub(1, #content / 2));
+	Sync({line});
+	assert(ReadFile(local_file) == content, "resumed download");
+
+	-- a corrupted partial file fails the md5 check, and the retry starts over.
+	ParaIO.DeleteFile(local_file);
+	WriteFile(part_file, string.rep("x", #content - 1));
+	Sync({line});
+	assert(ReadFile(local_file) == content, "download after corrupted partial file");
+
+	-- a missing server file fails without leaving any file behind.
+	local missing_line, missing_local_file = AddServerFile("tests/asset_missing.txt", "missing file");
+	ParaIO.DeleteFile(server_dir..missing_line);
+	ParaIO.DeleteFile(missing_local_file);
+	Sync({missing_line});
+	assert(not ParaIO.DoesFileExist(missing_local_file, false), "missing server file is synced");
+	assert(not ParaIO.DoesFileExist(missing_local_file..".part", false), "partial file is left for missing server file");
+end
+
+local ok, err = pcall(Run);
+manifest:CallField("Clear");
+if(ok) then
+	print("TEST_PASSED");
+	ParaGlobal.Exit(0);
+else
+	print("TEST_FAILED: "..tostring(err));
+	ParaGlobal.Exit(1);
+end
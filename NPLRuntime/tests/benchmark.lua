@@ -0,0 +1,331 @@
+--[[
+Title: micro benchmarks of NPL runtime hot paths
+Author(s): LiXizhi
+Date: 2026/10/18
+Desc: repeatable micro benchmarks, so that performance changes can be measured.
+Each benchmark runs a number of samples, each sample is a batch of operations timed with ParaGlobal.getAccurateTime().
+One line is printed per benchmark in the form of
+	BENCHMARK {"name":"serialize","ops_per_sec":123456,"p50_us":7.9,"p90_us":8.3,"p99_us":9.1,"samples":50,"ops":50000}
+benchmarks that can not run in the current build print an "error" field instead.
+Results are also written as a json array to the "output" command line file, if specified.
+
+Command line params:
+	filter: only run benchmarks whose name contains this string
+	output: json file to write results to. default to "" (none)
+	samples: number of samples per benchmark. default to 50
+	port: tcp port for the loopback benchmark. default to 60099
+Use Lib:
+-------------------------------------------------------
+npl tests/benchmark.lua
+npl tests/benchmark.lua filter="activate" output="temp/benchmark.json"
+-------------------------------------------------------
+]]
+local filename = "tests/benchmark.lua";
+local worker_name = "bench_worker";
+local server_nid = "bench_server";
+local client_nid = "bench_client";
+
+-- this file is also loaded in the worker runtime state, where it only replies to messages.
+if(__rts__:GetName() ~= "main") then
+	local received = 0;
+	NPL.this(function()
+		local msg = msg;
+		if(msg.type == "ping") then
+			if(msg.tid) then
+				-- the first message from the loopback connection
+				NPL.accept(msg.tid, client_nid);
+			end
+			if(msg.tid or msg.nid) then
+				-- reply via the loopback connection
+				NPL.activate(string.format("(main)%s:%s", client_nid, filename), {type="pong", seq=msg.seq});
+			else
+				NPL.activate("(main)"..filename, {type="pong", seq=msg.seq});
+			end
+		elseif(msg.type == "count") then
+			received = received + 1;
+			if(msg.last) then
+				NPL.activate("(main)"..filename, {type="counted", count=received});
+				received = 0;
+			end
+		end
+	end);
+	return;
+end
+
+local function GetParam(name, default)
+	local value = ParaEngine.GetAppCommandLineByParam(name, "");
+	if(value == nil or value == "") then
+		return default;
+	end
+	return value;
+end
+
+local filter = GetParam("filter", "");
+local output = GetParam("output", "");
+local sample_count = tonumber(GetParam("samples", "50"));
+local port = GetParam("port", "60099");
+
+local timeout_timer_id = 9901;
+local results = {};
+-- coroutine of the running benchmark
+local runner;
+-- message type that the running benchmark is waiting for
+local waiting_type;
+local runner_name;
+local RunNext;
+
+local function GetTime()
+	return ParaGlobal.getAccurateTime();
+end
+
+local function Percentile(sorted, p)
+	local index = math.max(1, math.min(#sorted, math.ceil(#sorted * p)));
+	return sorted[index];
+end
+
+local function Report(name, latencies, total_ops, total_time, err)
+	local result = {name = name};
+	if(err) then
+		result.error = tostring(err);
+	else
+		table.sort(latencies);
+		result.ops_per_sec = math.floor(total_ops / math.max(total_time, 0.000001));
+		result.p50_us = math.floor(Percentile(latencies, 0.5) * 1000000 * 100) / 100;
+		result.p90_us = math.floor(Percentile(latencies, 0.9) * 1000000 * 100) / 100;
+		result.p99_us = math.floor(Percentile(latencies, 0.99) * 1000000 * 100) / 100;
+		result.samples = #latencies;
+		result.ops = total_ops;
+	end
+	results[#results + 1] = result;
+	print("BENCHMARK "..NPL.ToJson(result));
+end
+
+-- run func(batch_size) for a number of samples, and report latency per operation.
+local function RunSync(name, batch_size, func)
+	local latencies = {};
+	local total_time = 0;
+	-- warm up
+	func(batch_size);
+	for i = 1, sample_count do
+		local start_time = GetTime();
+		func(batch_size);
+		local elapsed = GetTime() - start_time;
+		total_time = total_time + elapsed;
+		latencies[i] = elapsed / batch_size;
+	end
+	Report(name, latencies, batch_size * sample_count, total_time);
+end
+
+-- wait in the benchmark coroutine until a message of the given type is received.
+-- @param timeout: if not nil, it raises an error if no message is received within this number of seconds.
+local function WaitFor(msg_type, timeout)
+	waiting_type = msg_type;
+	if(timeout) then
+		NPL.SetTimer(timeout_timer_id, timeout, string.format(";NPL.activate(\"(main)%s\", {type=\"timeout\"});", filename));
+	end
+	local msg = coroutine.yield();
+	if(timeout) then
+		NPL.KillTimer(timeout_timer_id);
+	end
+	if(msg.type == "timeout") then
+		error(string.format("timed out waiting for %s", msg_type));
+	end
+	return msg;
+end
+
+-- resume the running benchmark, and start the next one when it is finished.
+local function Resume(name, msg)
+	local ok, err = coroutine.resume(runner, msg);
+	if(not ok) then
+		Report(name, nil, 0, 0, err);
+	end
+	if(coroutine.status(runner) == "dead") then
+		RunNext();
+	end
+end
+
+NPL.this(function()
+	local msg = msg;
+	if(runner and waiting_type and (msg.type == waiting_type or msg.type == "timeout")) then
+		waiting_type = nil;
+		Resume(runner_name, msg);
+	end
+end);
+
+local benchmarks = {};
+
+benchmarks[#benchmarks + 1] = {name = "activate_throughput", func = function()
+	local batch_size = 1000;
+	local worker = NPL.CreateRuntimeState(worker_name, 0);
+	-- the whole batch is queued before the worker gets a chance to run, so the queue must hold all of it.
+	worker:SetMsgQueueSize(batch_size * 2);
+	worker:Start();
+	local address = "("..worker_name..")"..filename;
+	local latencies = {};
+	local total_time = 0;
+	for i = 1, sample_count do
+		local start_time = GetTime();
+		for k = 1, batch_size do
+			if(NPL.activate(address, {type = "count", last = (k == batch_size) or nil}) ~= 0) then
+				error("message dropped, because the worker queue is full");
+			end
+		end
+		local msg = WaitFor("counted", 10);
+		if(msg.count ~= batch_size) then
+			error(string.format("worker received %s of %d messages", tostring(msg.count), batch_size));
+		end
+		local elapsed = GetTime() - start_time;
+		total_time = total_time + elapsed;
+		latencies[i] = elapsed / batch_size;
+	end
+	Report("activate_throughput", latencies, batch_size * sample_count, total_time);
+end};
+
+benchmarks[#benchmarks + 1] = {name = "activate_roundtrip", func = function()
+	local worker = NPL.CreateRuntimeState(worker_name, 0);
+	worker:Start();
+	local address = "("..worker_name..")"..filename;
+	local latencies = {};
+	local total_time = 0;
+	local count = sample_count * 10;
+	for i = 1, count do
+		local start_time = GetTime();
+		NPL.activate(address, {type = "ping", seq = i});
+		WaitFor("pong", 5);
+		latencies[i] = GetTime() - start_time;
+		total_time = total_time + latencies[i];
+	end
+	Report("activate_roundtrip", latencies, count, total_time);
+end};
+
+benchmarks[#benchmarks + 1] = {name = "tcp_loopback_roundtrip", func = function()
+	NPL.AddPublicFile(filename, -99);
+	NPL.StartNetServer("127.0.0.1", port);
+	NPL.AddNPLRuntimeAddress({host = "127.0.0.1", port = port, nid = server_nid});
+	local address = "("..worker_name..")"..server_nid..":"..filename;
+	local worker = NPL.CreateRuntimeState(worker_name, 0);
+	worker:Start();
+	-- the first message also establishes the connection.
+	NPL.activate(address, {type = "ping", seq = 0});
+	WaitFor("pong", 5);
+	local latencies = {};
+	local total_time = 0;
+	local count = sample_count * 10;
+	for i = 1, count do
+		local start_time = GetTime();
+		NPL.activate(address, {type = "ping", seq = i});
+		WaitFor("pong", 5);
+		latencies[i] = GetTime() - start_time;
+		total_time = total_time + latencies[i];
+	end
+	Report("tcp_loopback_roundtrip", latencies, count, total_time);
+end};
+
+benchmarks[#benchmarks + 1] = {name = "serialize", func = function()
+	local data = {name = "benchmark", pos = {1.5, 2.5, 3.5}, items = {}, flag = true};
+	for i = 1, 20 do
+		data.items[i] = {id = i, count = i * 2, text = "item"..i};
+	end
+	RunSync("serialize", 1000, function(n)
+		for i = 1, n do
+			NPL.SerializeToSCode("msg", data);
+		end
+	end);
+	local code = NPL.SerializeToSCode("msg", data);
+	RunSync("deserialize", 1000, function(n)
+		for i = 1, n do
+			NPL.LoadTableFromString(code);
+		end
+	end);
+	RunSync("to_json", 1000, function(n)
+		for i = 1, n do
+			NPL.ToJson(data);
+		end
+	end);
+end};
+
+benchmarks[#benchmarks + 1] = {name = "zip_read", func = function()
+	local zipfile = "temp/benchmark/benchmark.zip";
+	local file_count = 100;
+	ParaIO.CreateDirectory(zipfile);
+	local writer = ParaIO.CreateZip(zipfile, "");
+	local text = string.rep("0123456789abcdef", 256);
+	for i = 1, file_count do
+		writer:ZipAddData("benchmark_zip/file"..i..".txt", text);
+	end
+	writer:close();
+	if(not ParaAsset.OpenArchive(zipfile, false)) then
+		Report("zip_read", nil, 0, 0, "can not open "..zipfile);
+		return;
+	end
+	RunSync("zip_read", file_count, function(n)
+		for i = 1, n do
+			local file = ParaIO.open("benchmark_zip/file"..i..".txt", "r");
+			file:GetText();
+			file:close();
+		end
+	end);
+	ParaAsset.CloseArchive(zipfile);
+end};
+
+benchmarks[#benchmarks + 1] = {name = "block_get_set", func = function()
+	-- chunk (600, 600) in the middle of the world
+	local x, y, z = 600 * 16, 64, 600 * 16;
+	ParaTerrain.EnterBlockWorld(x, y, z);
+	ParaTerrain.GetMapChunkData(600, 600, false, 0xffff);
+	ParaTerrain.SetBlockTemplateByIdx(x, y, z, 1);
+	if(ParaTerrain.GetBlockTemplateByIdx(x, y, z) ~= 1) then
+		Report("block_get_set", nil, 0, 0, "block world is not available");
+		return;
+	end
+	RunSync("block_set", 4096, function(n)
+		for i = 0, n - 1 do
+			ParaTerrain.SetBlockTemplateByIdx(x + i % 16, y + math.floor(i / 256), z + math.floor(i / 16) % 16, 1 + i % 2);
+		end
+	end);
+	RunSync("block_get", 4096, function(n)
+		for i = 0, n - 1 do
+			ParaTerrain.GetBlockTemplateByIdx(x + i % 16, y + math.floor(i / 256), z + math.floor(i / 16) % 16);
+		end
+	end);
+	RunSync("chunk_serialize", 10, function(n)
+		for i = 1, n do
+			ParaTerrain.GetMapChunkData(600, 600, false, 0xffff);
+		end
+	end);
+	local data = ParaTerrain.GetMapChunkData(600, 600, false, 0xffff);
+	RunSync("chunk_deserialize", 10, function(n)
+		for i = 1, n do
+			ParaTerrain.ApplyMapChunkData(600, 600, 0xffff, data, {});
+		end
+	end);
+end};
+
+local next_index = 1;
+-- run benchmarks one after another. Each benchmark runs in its own coroutine, so that it can wait for messages.
+function RunNext()
+	while(next_index <= #benchmarks) do
+		local benchmark = benchmarks[next_index];
+		next_index = next_index + 1;
+		if(filter == "" or benchmark.name:find(filter, 1, true)) then
+			runner_name = benchmark.name;
+			runner = coroutine.create(benchmark.func);
+			Resume(runner_name);
+			return;
+		end
+	end
+	runner = nil;
+	if(output ~= "") then
+		ParaIO.CreateDirectory(output);
+		local file = ParaIO.open(output, "w");
+		if(file:IsValid()) then
+			file:WriteString(NPL.ToJson(results));
+			file:close();
+		end
+	end
+	print("BENCHMARK_END");
+	ParaGlobal.Exit(0);
+end
+
+print(string.format("BENCHMARK_START {\"samples\":%d}", sample_count));
+RunNext();